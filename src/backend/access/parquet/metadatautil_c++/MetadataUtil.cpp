@@ -119,6 +119,14 @@ MetadataUtil::convertPageMetadata(parquet::PageHeader& parquetHeader,
 	hawqPageMetadata->crc = parquetHeader.crc;
 	hawqPageMetadata->page_type = (enum PageType) parquetHeader.type;
 
+	if (parquetHeader.type == parquet::PageType::DICTIONARY_PAGE) {
+		hawqPageMetadata->encoding =
+				(enum Encoding) parquetHeader.dictionary_page_header.encoding;
+		hawqPageMetadata->num_values =
+				parquetHeader.dictionary_page_header.num_values;
+		return;
+	}
+
 	hawqPageMetadata->definition_level_encoding =
 			(enum Encoding) parquetHeader.data_page_header.definition_level_encoding;
 	hawqPageMetadata->encoding =
@@ -144,6 +152,16 @@ MetadataUtil::convertToPageMetadata(parquet::PageHeader *parquetHeader,
 	parquetHeader->__set_uncompressed_page_size(
 			hawqPageMetadata->uncompressed_page_size);
 
+	if (hawqPageMetadata->page_type == DICTIONARY_PAGE) {
+		parquet::DictionaryPageHeader dictionaryPageHeader;
+
+		dictionaryPageHeader.__set_encoding(
+				(enum parquet::Encoding::type) hawqPageMetadata->encoding);
+		dictionaryPageHeader.__set_num_values(hawqPageMetadata->num_values);
+
+		parquetHeader->__set_dictionary_page_header(dictionaryPageHeader);
+		return 0;
+	}
 
 	dataPageHeader.__set_definition_level_encoding(
 			(enum parquet::Encoding::type) hawqPageMetadata->definition_level_encoding);
@@ -172,7 +190,11 @@ MetadataUtil::convertToColumnMetadata(
 			(parquet::CompressionCodec::type) hawqColumnMetadata->codec);
 	columnchunk_metadata->__set_data_page_offset(
 			hawqColumnMetadata->firstDataPage);
-	columnchunk_metadata->__set_dictionary_page_offset(-1);
+	if (hawqColumnMetadata->dictionaryPageOffset > 0)
+		columnchunk_metadata->__set_dictionary_page_offset(
+				hawqColumnMetadata->dictionaryPageOffset);
+	else
+		columnchunk_metadata->__set_dictionary_page_offset(-1);
 	columnchunk_metadata->__set_index_page_offset(-1);
 	columnchunk_metadata->__set_num_values(hawqColumnMetadata->valueCount);
 	columnchunk_metadata->__set_total_compressed_size(
@@ -21,6 +21,7 @@
 #include "catalog/pg_attribute_encoding.h"
 #include "catalog/catquery.h"
 #include "utils/lsyscache.h"
+#include "utils/guc.h"
 #include "utils/builtins.h"
 #include "catalog/pg_statistic.h"
 #include "cdb/cdbparquetfooterbuffer.h"
@@ -137,6 +138,7 @@ parquet_beginscan(
 	scan->pqs_filenamepath = (char*)palloc0(scan->pqs_filenamepath_maxlen);
 	scan->pqs_rd = relation;
 	scan->parquetScanInitContext = CurrentMemoryContext;
+	scan->prefetcher = ParquetPrefetch_Create(scan->parquetScanInitContext);
 
 	/*
 	 * Fill in Parquet Storage layer attributes.
@@ -191,6 +193,12 @@ void parquet_endscan(ParquetScanDesc scan) {
 
 	MemoryContext oldContext = MemoryContextSwitchTo(scan->parquetScanInitContext);
 
+	if (scan->prefetcher != NULL)
+	{
+		ParquetPrefetch_Destroy(scan->prefetcher);
+		scan->prefetcher = NULL;
+	}
+
 	/* Free the column readers information*/
 	if(rowGroupReader.columnReaders != NULL)
 	{
@@ -208,6 +216,16 @@ void parquet_endscan(ParquetScanDesc scan) {
 				pfree(reader->pageBuffer);
 			}
 
+			if (reader->dictionary != NULL)
+			{
+				pfree(reader->dictionary);
+			}
+
+			if (reader->dictionaryBuffer != NULL)
+			{
+				pfree(reader->dictionaryBuffer);
+			}
+
 			if (reader->geoval != NULL)
 			{
 				pfree(reader->geoval);
@@ -217,6 +235,17 @@ void parquet_endscan(ParquetScanDesc scan) {
 			}
 		}
 		pfree(rowGroupReader.columnReaders);
+
+		for (int i = 0; i < rowGroupReader.columnReaderCount; ++i)
+		{
+			if (rowGroupReader.batchValues[i] != NULL)
+			{
+				pfree(rowGroupReader.batchValues[i]);
+				pfree(rowGroupReader.batchNulls[i]);
+			}
+		}
+		pfree(rowGroupReader.batchValues);
+		pfree(rowGroupReader.batchNulls);
 	}
 
 	if(scan->hawqAttrToParquetColChunks != NULL){
@@ -227,6 +256,10 @@ void parquet_endscan(ParquetScanDesc scan) {
 		pfree(scan->aoEntry);
 	}
 
+	if(scan->rowGroupFilter != NIL){
+		list_free_deep(scan->rowGroupFilter);
+	}
+
 	ParquetStorageRead_FinishSession(&(scan->storageRead));
 
 	MemoryContextSwitchTo(oldContext);
@@ -313,6 +346,7 @@ static bool getNextRowGroup(ParquetScanDesc scan)
 												scan->proj,
 												scan->pqs_tupDesc,
 												scan->hawqAttrToParquetColChunks,
+												scan->rowGroupFilter,
 												scan->toCloseFile)) {
 		ParquetRowGroupReader_GetContents(&scan->rowGroupReader);
 	}
@@ -370,6 +404,8 @@ SetNextFileSegForRead(ParquetScanDesc scan)
 							NameStr(scan->pqs_rd->rd_rel->relname),
 							&scan->storageAttributes);
 
+		scan->storageRead.prefetcher = scan->prefetcher;
+
 		ParquetRowGroupReader_Init(
 							&scan->rowGroupReader,
 							scan->pqs_rd,
@@ -1052,6 +1088,12 @@ uint64 memReservedForParquetInsert(Oid rel_oid) {
  * rowgroup limit, we can estimate the worst case of memory consuming to be
  * (columnwidth)/recordwidth * rowgroupsize * 2.
  *
+ * 3) Non-repeated columns are streamed page by page through a window of
+ * gp_parquet_scan_buffer_size (enlarged to a page if pagesize is larger),
+ * plus a page buffer for decompression and one for the dictionary of
+ * dictionary-encoded columns. If that is less than the estimation above,
+ * only that much is reserved, which doesn't grow with rowgroup size.
+ *
  * @rel_oid		The oid of relation to be inserted
  * @attr_list		The list of attributes to be scanned
  * @return		The memory allocated for this table insert
@@ -1061,12 +1103,18 @@ uint64 memReservedForParquetScan(Oid rel_oid, List* attr_list) {
 	uint64		rowgroupsize = 0;
 	char		*compresstype = NULL;
 	uint64		memReserved = 0;
+	uint64		pagesize = 0;
+	uint64		streamReserved = 0;	/*memory of streaming scan*/
+	uint64		streamChunks = 0;	/*number of streamed column chunks*/
+	bool		compressed = false;
 
 	int 		attrNum = get_relnatts(rel_oid); /*Get the total attribute number of the relation*/
 	uint64		attsWidth = 0;		/*the sum width of attributes to be scanned*/
 	uint64		recordWidth = 0;	/*the average width of one record in the relation*/
 	/* The width array for all the attributes in the relation*/
 	int32		*attWidth = (int32*)palloc0(attrNum * sizeof(int32));
+	/* The type array for all the attributes in the relation*/
+	Oid			*attType = (Oid*)palloc0(attrNum * sizeof(Oid));
 
 	/** The variables for traversing through attribute list*/
 	ListCell	*cell;
@@ -1074,8 +1122,9 @@ uint64 memReservedForParquetScan(Oid rel_oid, List* attr_list) {
 	/* Get rowgroup size and compress type */
 	AppendOnlyEntry *aoEntry = GetAppendOnlyEntry(rel_oid, SnapshotNow);
 	rowgroupsize = aoEntry->blocksize;
+	pagesize = aoEntry->pagesize;
 	compresstype = aoEntry->compresstype;
-
+	compressed = (compresstype != NULL && (strcmp(compresstype, "none") != 0));
 
 	/** For each column in the relation, get the column width
 	 * 1) Get the column width from pg_attribute, estimate column width for to-be-scanned columns:
@@ -1096,6 +1145,7 @@ uint64 memReservedForParquetScan(Oid rel_oid, List* attr_list) {
 			Form_pg_attribute att = (Form_pg_attribute) GETSTRUCT(attTuple);
 			estimateColumnWidth(attWidth, &i, att, false);
 			i--;
+			attType[i] = att->atttypid;
 
 			int32 stawidth = 0;
 			/*Step2: adjust addwidth according to pg_statistic*/
@@ -1130,15 +1180,65 @@ uint64 memReservedForParquetScan(Oid rel_oid, List* attr_list) {
 		Assert(1 <= att_id);
 		Assert(att_id <= attrNum);
 		attsWidth += attWidth[att_id - 1];	/*sum up the attribute width in the to-be-scanned list*/
+
+		/*sum up the memory of streaming the attribute's column chunks*/
+		uint64 columnReserved = Max((uint64) gp_parquet_scan_buffer_size * 1024, pagesize);
+		if (compressed)
+			columnReserved += pagesize;
+
+		switch (attType[att_id - 1])
+		{
+			case HAWQ_TYPE_PATH:
+			case HAWQ_TYPE_POLYGON:
+				/*repeated column chunk is read as a whole*/
+				streamReserved += (attWidth[att_id - 1] * rowgroupsize) / recordWidth * (compressed ? 2 : 1);
+				break;
+			case HAWQ_TYPE_POINT:
+				streamReserved += 2 * columnReserved;
+				streamChunks += 2;
+				break;
+			case HAWQ_TYPE_CIRCLE:
+				streamReserved += 3 * columnReserved;
+				streamChunks += 3;
+				break;
+			case HAWQ_TYPE_LSEG:
+			case HAWQ_TYPE_BOX:
+				streamReserved += 4 * columnReserved;
+				streamChunks += 4;
+				break;
+			case HAWQ_TYPE_BYTE:
+			case HAWQ_TYPE_CHAR:
+			case HAWQ_TYPE_BPCHAR:
+			case HAWQ_TYPE_VARCHAR:
+			case HAWQ_TYPE_TEXT:
+				/*may be dictionary encoded*/
+				streamReserved += columnReserved + pagesize;
+				streamChunks++;
+				break;
+			default:
+				streamReserved += columnReserved;
+				streamChunks++;
+				break;
+		}
 	}
 
 	pfree(attWidth);
+	pfree(attType);
 
 	memReserved = (attsWidth * rowgroupsize) / recordWidth;
-	if(compresstype != NULL && (strcmp(compresstype, "none") != 0))
+	if(compressed)
 	{
 		memReserved *= 2;
 	}
+
+	if (streamReserved < memReserved)
+	{
+		memReserved = streamReserved;
+	}
+
+	/*read-ahead holds at most one window per streamed column chunk*/
+	memReserved += Min((uint64) gp_parquet_prefetch_memory * 1024,
+					   streamChunks * (uint64) gp_parquet_scan_buffer_size * 1024);
 	pfree(aoEntry);
 	/* Since memory allocated to parquet scan depends on the columns get scanned, it is possible
 	 * to allocate very small chunk of memory if the scanned columns are very small in terms of the
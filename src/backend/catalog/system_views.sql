@@ -409,6 +409,51 @@ CREATE VIEW pg_resqueue_status AS
 				paused text)
 			ON (s.rsqname = q.rsqname);
 
+-- Metadata cache views
+
+-- Times are in microseconds. lookup_time is what planning spent looking up
+-- block locations of the relation, saved_time estimates what the hits saved
+-- from the average time of fetching block locations from the namenode.
+CREATE VIEW gp_metadata_cache_stats AS
+	SELECT
+			s.tablespace,
+			s.database,
+			s.relfilenode,
+			c.relname,
+			s.cached_files,
+			s.cached_blocks,
+			s.hits,
+			s.partial_hits,
+			s.misses,
+			s.evictions,
+			s.refreshes,
+			CASE WHEN s.hits + s.partial_hits + s.misses > 0
+				THEN (s.hits + s.partial_hits)::float8 / (s.hits + s.partial_hits + s.misses)
+				ELSE NULL END AS hit_ratio,
+			s.lookup_time,
+			s.fetch_time,
+			CASE WHEN s.partial_hits + s.misses > 0
+				THEN (s.hits * s.fetch_time / (s.partial_hits + s.misses))
+				ELSE NULL END AS saved_time,
+			s.refresh_time
+	FROM gp_metadata_cache_stats() AS s
+			(	tablespace oid,
+				database oid,
+				relfilenode oid,
+				cached_files int8,
+				cached_blocks int8,
+				hits int8,
+				partial_hits int8,
+				misses int8,
+				evictions int8,
+				refreshes int8,
+				lookup_time int8,
+				fetch_time int8,
+				refresh_time int8)
+			LEFT JOIN pg_class c
+			ON (c.relfilenode = s.relfilenode
+				AND s.database = (SELECT oid FROM pg_database WHERE datname = current_database()));
+
 -- External table views
 
 CREATE VIEW pg_max_external_files AS
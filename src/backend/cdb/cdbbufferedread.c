@@ -154,6 +154,9 @@ void BufferedReadSetFile(
 
 /*
  * Perform a large read i/o.
+ *
+ * Data is read with positional reads at largeReadPosition, so the position
+ * of the file does not matter and random access needs no seek.
  */
 static void BufferedReadIo(
     BufferedRead        *bufferedRead)
@@ -166,39 +169,15 @@ static void BufferedReadIo(
 	Assert(bufferedRead->largeReadLen > 0);
 	largeReadMemory = bufferedRead->largeReadMemory;
 
-#ifdef USE_ASSERT_CHECKING
-	{
-		int64 currentReadPosition; 
-		
-		currentReadPosition = FileNonVirtualTell(bufferedRead->file);
-		if (currentReadPosition < 0)
-			ereport(ERROR, (errcode_for_file_access(),
-							errmsg("unable to get current position for table \"%s\" in file \"%s\" (errcode %d)",
-								   bufferedRead->relationName,
-							       bufferedRead->filePathName,
-								   errno),
-						    errdetail("%s", HdfsGetLastError())));
-			
-		if (currentReadPosition != bufferedRead->largeReadPosition)
-		{
-			ereport(ERROR, (errcode_for_file_access(),
-							errmsg("Current position mismatch actual "
-								   INT64_FORMAT ", expected " INT64_FORMAT " for table \"%s\" in file \"%s\"",
-								   currentReadPosition, bufferedRead->largeReadPosition,
-								   bufferedRead->relationName,
-								   bufferedRead->filePathName),
-						    errdetail("%s", HdfsGetLastError())));
-		}
-	}
-#endif
 
 	offset = 0;
 	while (largeReadLen > 0) 
 	{
-		int actualLen = FileRead(
+		int actualLen = FilePread(
 							bufferedRead->file,
 							(char*)largeReadMemory,
-							largeReadLen);
+							largeReadLen,
+							bufferedRead->largeReadPosition + offset);
 
 		if (actualLen == 0) 
 			ereport(ERROR, (errcode_for_file_access(),
@@ -407,23 +386,14 @@ void BufferedReadSetTemporaryRange(
 	{
 		int64	remainingFileLen;
 
-		/* 
-		 * Seek to the requested beginning position. 
-		 * MPP-17061: allow seeking backward(negative offset) in file,
-		 * this could happen during index scan, if we do look up for a
-		 * block directory entry at the end of the segment file, followed
-		 * by a look up for a block directory entry at the beginning of file.
+		/*
+		 * Read at the requested beginning position, no seek is needed since
+		 * BufferedReadIo reads by position.
+		 * MPP-17061: the position may be before the current read, this could
+		 * happen during index scan, if we do look up for a block directory
+		 * entry at the end of the segment file, followed by a look up for a
+		 * block directory entry at the beginning of file.
 		 */
-			int64 seekOffset = beginFileOffset - largeReadAfterPos;
-			int64 seekPos = FileSeek(bufferedRead->file, seekOffset, SEEK_CUR);
-			if (seekPos != beginFileOffset)
-				ereport(ERROR, (errcode_for_file_access(),
-							errmsg("unable to seek to position for table \"%s\" in file \"%s\" (errcode %d):%m",
-									   bufferedRead->relationName,
-									   bufferedRead->filePathName,
-									   errno),
-						    errdetail("%s", HdfsGetLastError())));
-
 		bufferedRead->bufferOffset = 0;
 
 		remainingFileLen = afterFileOffset - beginFileOffset;
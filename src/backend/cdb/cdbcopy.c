@@ -28,6 +28,7 @@
 #include "utils/memutils.h"
 #include "cdb/cdbsrlz.h"
 #include "commands/copy.h"
+#include "nodes/makefuncs.h"
 #include "optimizer/prep.h"
 #include "tcop/pquery.h"	/* PortalGetResource, should move to upper call! */
 #include "utils/faultinjector.h"
@@ -54,6 +55,7 @@ makeCdbCopy(bool is_copy_in, QueryResource *resource)
 	c->outseglist = NIL;
 	c->partitions = NULL;
 	c->ao_segnos = NIL;
+	c->raw_chunks = false;
 	initStringInfo(&(c->err_msg));
 	initStringInfo(&(c->err_context));
 	initStringInfo(&(c->copy_out_buf));	
@@ -175,6 +177,12 @@ cdbCopyStart(CdbCopy *c, char *copyCmd, Oid relid, Oid relerror, List *err_aoseg
 	
 	((CopyStmt *)q->utilityStmt)->err_aosegnos = err_aosegnos;
 
+	/* the data will come in raw chunks of lines, see gp_copy_raw_chunks */
+	if (c->raw_chunks)
+		((CopyStmt *)q->utilityStmt)->options =
+			lappend(((CopyStmt *)q->utilityStmt)->options,
+					makeDefElem("raw_chunks", (Node *) makeInteger(TRUE)));
+
 	MemoryContextSwitchTo(oldcontext);
 
     q->contextdisp = CreateQueryContextInfo();
@@ -12,6 +12,7 @@
 
 #include "access/genam.h"
 #include "access/aomd.h"
+#include "access/hash.h"
 #include "access/heapam.h"
 #include "access/filesplit.h"
 #include "access/parquetsegfiles.h"
@@ -20,12 +21,14 @@
 #include "cdb/cdbutil.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbpartition.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/tqual.h"
 #include "utils/memutils.h"
 #include "executor/execdesc.h"
 #include "nodes/nodes.h"
 #include "nodes/parsenodes.h"
+#include "optimizer/plancat.h"
 #include "optimizer/walkers.h"
 #include "parser/parsetree.h"
 #include "storage/fd.h"
@@ -289,14 +292,61 @@ typedef struct split_to_segment_mapping_context {
 	int64 total_size; /* total data size for all relations */
 	int64 total_split_count;
 	int64 total_file_count;
+
+	HTAB *prefetched_locations; /* block locations looked up in advance */
+	int prefetch_file_count; /* files looked up in advance */
+	int64 prefetch_time; /* elapsed time of the lookup, in us */
+	int64 prefetch_serial_time; /* sum of the namenode call times, in us */
 } split_to_segment_mapping_context;
 
+/*
+ * Block locations of a segment file looked up by prefetch_block_locations,
+ * keyed by the relfilenode and segno of the file.
+ */
+typedef struct PrefetchedLocationKey {
+	RelFileNode rnode;
+	int segno;
+} PrefetchedLocationKey;
+
+typedef struct PrefetchedLocationEntry {
+	PrefetchedLocationKey key;
+	BlockLocation *locations; /* NULL once taken */
+	int block_num;
+	int64 elapsed; /* time of the namenode call, in us */
+} PrefetchedLocationEntry;
+
 typedef struct vseg_list{
 	List* vsegList;
 }vseg_list;
 
+/*
+ * An assignment result of an earlier query. The QD keeps the results of
+ * recent queries so that a query over segment files that have not changed
+ * since, on the same virtual segments, skips the allocation algorithm.
+ * The key covers everything the algorithm reads: the eof, splits and block
+ * hosts of every file of every relation, the relation policies, the
+ * virtual segment hostnames and the GUCs steering the assignment. An append
+ * changes the eof of a file and so the key; results of older versions are
+ * evicted least recently used first.
+ */
+typedef struct AssignmentCacheEntry {
+	MemoryContext memorycontext; /* holds the entry and all it points to */
+	uint32 hashvalue;
+	char *key;
+	int keylen;
+	List *alloc_results;
+	List *relsType;
+	bool forbid_optimizer;
+	char *datalocalityInfo;
+	int vseg_num;
+	int *vseg_order; /* former position of each vseg, NULL if unchanged */
+} AssignmentCacheEntry;
+
 static MemoryContext DataLocalityMemoryContext = NULL;
 
+static MemoryContext AssignmentCacheMemoryContext = NULL;
+static List *AssignmentCache = NIL; /* most recently used first */
+
 static void init_datalocality_memory_context(void);
 
 static void init_split_assignment_result(Split_Assignment_Result *result,
@@ -320,11 +370,32 @@ static void check_keep_hash_and_external_table(
 static int64 get_block_locations_and_claculte_table_size(
 		split_to_segment_mapping_context *collector_context);
 
+static void prefetch_block_locations(split_to_segment_mapping_context *context,
+		Snapshot metadataSnapshot);
+
+static void free_prefetched_block_locations(
+		split_to_segment_mapping_context *context);
+
 static List *get_virtual_segments(QueryResource *resource);
 
 static List *run_allocation_algorithm(SplitAllocResult *result, List *virtual_segments, QueryResource ** resourcePtr,
 		split_to_segment_mapping_context *context);
 
+static StringInfo build_assignment_cache_key(
+		split_to_segment_mapping_context *context, List *virtual_segments);
+
+static AssignmentCacheEntry *lookup_assignment_cache(StringInfo key);
+
+static List *use_cached_assignment(AssignmentCacheEntry *entry,
+		SplitAllocResult *result, QueryResource *resource);
+
+static void store_assignment_cache(StringInfo key, SplitAllocResult *result,
+		List *alloc_result, List *former_segments, QueryResource *resource);
+
+static void trim_assignment_cache(int max_entries);
+
+static List *copy_alloc_result(List *alloc_result);
+
 static void AOGetSegFileDataLocation(Relation relation,
 		AppendOnlyEntry *aoEntry, Snapshot metadataSnapshot,
 		split_to_segment_mapping_context *context, int64 splitsize,
@@ -337,7 +408,8 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 		Relation_Data *rel_data, int* hitblocks,
 		int* allblocks);
 
-static BlockLocation *fetch_hdfs_data_block_location(char *filepath, int64 len,
+static BlockLocation *fetch_hdfs_data_block_location(
+		split_to_segment_mapping_context *context, char *filepath, int64 len,
 		int *block_num, RelFileNode rnode, uint32_t segno, double* hit_ratio);
 
 static void free_hdfs_data_block_location(BlockLocation *locations,
@@ -520,6 +592,11 @@ static void init_datalocality_context(split_to_segment_mapping_context *context)
 	context->total_split_count = 0;
 	context->total_file_count = 0;
 
+	context->prefetched_locations = NULL;
+	context->prefetch_file_count = 0;
+	context->prefetch_time = 0;
+	context->prefetch_serial_time = 0;
+
 	return;
 }
 
@@ -780,6 +857,345 @@ get_virtual_segments(QueryResource *resource) {
 	return result;
 }
 
+/*
+ * append_partition_parent_to_key: the allocation algorithm balances the
+ * partitions of a table together, so add the partition parent of the
+ * relation and the children the parent has in pg_inherits to the key.
+ */
+static void
+append_partition_parent_to_key(StringInfo key, Oid relid) {
+	cqContext *pcqCtx;
+	HeapTuple inhtup;
+	Oid parent = InvalidOid;
+	List *children = NIL;
+	ListCell *lc;
+	int childCount;
+
+	pcqCtx = caql_beginscan(
+			NULL,
+			cql("SELECT * FROM pg_inherits "
+				" WHERE inhrelid = :1 ",
+				ObjectIdGetDatum(relid)));
+	if (HeapTupleIsValid(inhtup = caql_getnext(pcqCtx))) {
+		parent = ((Form_pg_inherits) GETSTRUCT(inhtup))->inhparent;
+	}
+	caql_endscan(pcqCtx);
+
+	appendBinaryStringInfo(key, (char *) &parent, sizeof(Oid));
+	if (!OidIsValid(parent)) {
+		return;
+	}
+
+	children = find_inheritance_children(parent);
+	childCount = list_length(children);
+	appendBinaryStringInfo(key, (char *) &childCount, sizeof(int));
+	foreach(lc, children)
+	{
+		Oid child = lfirst_oid(lc);
+		appendBinaryStringInfo(key, (char *) &child, sizeof(Oid));
+	}
+	list_free(children);
+}
+
+/*
+ * build_assignment_cache_key: serialize the input of the allocation
+ * algorithm, return NULL if assignment results are not cached.
+ */
+static StringInfo
+build_assignment_cache_key(split_to_segment_mapping_context *context,
+		List *virtual_segments) {
+	StringInfo key;
+	ListCell *lc;
+	MemoryContext old;
+	int relationCount = list_length(context->chsl_context.relations);
+	int vsegCount = list_length(virtual_segments);
+
+	if (datalocality_assignment_cache_size <= 0 || debug_fake_datalocality) {
+		trim_assignment_cache(0);
+		return NULL;
+	}
+
+	old = MemoryContextSwitchTo(context->datalocality_memorycontext);
+
+	key = makeStringInfo();
+	appendBinaryStringInfo(key, (char *) &context->keep_hash, sizeof(bool));
+	appendBinaryStringInfo(key, (char *) &datalocality_remedy_enable, sizeof(bool));
+	appendBinaryStringInfo(key, (char *) &prefer_datalocality_to_iobalance, sizeof(bool));
+	appendBinaryStringInfo(key, (char *) &balance_on_partition_table_level, sizeof(bool));
+	appendBinaryStringInfo(key, (char *) &balance_on_whole_query_level, sizeof(bool));
+	appendBinaryStringInfo(key, (char *) &net_disk_ratio, sizeof(int));
+
+	appendBinaryStringInfo(key, (char *) &vsegCount, sizeof(int));
+	foreach(lc, virtual_segments)
+	{
+		VirtualSegmentNode *vsn = (VirtualSegmentNode *) lfirst(lc);
+		appendBinaryStringInfo(key, vsn->hostname, strlen(vsn->hostname) + 1);
+	}
+
+	appendBinaryStringInfo(key, (char *) &relationCount, sizeof(int));
+	foreach(lc, context->chsl_context.relations)
+	{
+		Relation_Data *rel_data = (Relation_Data *) lfirst(lc);
+		GpPolicy *policy = GpPolicyFetch(CurrentMemoryContext, rel_data->relid);
+		int fileCount = list_length(rel_data->files);
+		ListCell *lc_file;
+
+		appendBinaryStringInfo(key, (char *) &rel_data->relid, sizeof(Oid));
+		appendBinaryStringInfo(key, (char *) &rel_data->type,
+				sizeof(DATALOCALITY_RELATION_TYPE));
+		appendBinaryStringInfo(key, (char *) &rel_data->total_size, sizeof(int64));
+		append_partition_parent_to_key(key, rel_data->relid);
+		appendBinaryStringInfo(key, (char *) &policy->bucketnum, sizeof(int));
+		appendBinaryStringInfo(key, (char *) &policy->nattrs, sizeof(int));
+		appendBinaryStringInfo(key, (char *) policy->attrs,
+				sizeof(AttrNumber) * policy->nattrs);
+		pfree(policy);
+
+		appendBinaryStringInfo(key, (char *) &fileCount, sizeof(int));
+		foreach(lc_file, rel_data->files)
+		{
+			Relation_File *rel_file = (Relation_File *) lfirst(lc_file);
+
+			appendBinaryStringInfo(key, (char *) &rel_file->segno, sizeof(int));
+			appendBinaryStringInfo(key, (char *) &rel_file->logic_len, sizeof(int64));
+			appendBinaryStringInfo(key, (char *) &rel_file->split_num, sizeof(int));
+			for (int i = 0; i < rel_file->split_num; i++) {
+				File_Split *split = rel_file->splits + i;
+				appendBinaryStringInfo(key, (char *) &split->offset, sizeof(int64));
+				appendBinaryStringInfo(key, (char *) &split->length, sizeof(int64));
+				appendBinaryStringInfo(key, (char *) &split->logiceof, sizeof(int64));
+			}
+			appendBinaryStringInfo(key, (char *) &rel_file->block_num, sizeof(int));
+			if (rel_file->locations == NULL) {
+				continue;
+			}
+			for (int i = 0; i < rel_file->block_num; i++) {
+				BlockLocation *location = rel_file->locations + i;
+				appendBinaryStringInfo(key, (char *) &location->numOfNodes, sizeof(int));
+				for (int j = 0; j < location->numOfNodes; j++) {
+					appendBinaryStringInfo(key, location->hosts[j],
+							strlen(location->hosts[j]) + 1);
+				}
+			}
+		}
+	}
+
+	MemoryContextSwitchTo(old);
+
+	return key;
+}
+
+/*
+ * lookup_assignment_cache: find the result of an earlier run of the
+ * allocation algorithm on the same input.
+ */
+static AssignmentCacheEntry *
+lookup_assignment_cache(StringInfo key) {
+	uint32 hashvalue;
+	ListCell *lc;
+
+	if (key == NULL) {
+		return NULL;
+	}
+
+	hashvalue = DatumGetUInt32(hash_any((unsigned char *) key->data, key->len));
+	foreach(lc, AssignmentCache)
+	{
+		AssignmentCacheEntry *entry = (AssignmentCacheEntry *) lfirst(lc);
+		if (entry->hashvalue == hashvalue && entry->keylen == key->len
+				&& memcmp(entry->key, key->data, key->len) == 0) {
+			MemoryContext old = MemoryContextSwitchTo(AssignmentCacheMemoryContext);
+			AssignmentCache = lcons(entry,
+					list_delete_ptr(AssignmentCache, entry));
+			MemoryContextSwitchTo(old);
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * use_cached_assignment: set up the result of the query as the cached run of
+ * the allocation algorithm did, return the split assignment.
+ */
+static List *
+use_cached_assignment(AssignmentCacheEntry *entry, SplitAllocResult *result,
+		QueryResource *resource) {
+	ListCell *lc;
+
+	Assert(list_length(resource->segments) == entry->vseg_num);
+
+	/* change the virtual segment order as change_hash_virtual_segments_order did */
+	if (entry->vseg_order != NULL) {
+		MemoryContext old = MemoryContextSwitchTo(TopMemoryContext);
+		Segment **segmentsVector = (Segment **) palloc(
+				sizeof(Segment *) * entry->vseg_num);
+		int p = 0;
+		foreach (lc, resource->segments)
+		{
+			segmentsVector[p++] = (Segment *) lfirst(lc);
+		}
+		resource->segments = NIL;
+		for (p = 0; p < entry->vseg_num; p++) {
+			Segment *info = segmentsVector[entry->vseg_order[p]];
+			info->segindex = p;
+			resource->segments = lappend(resource->segments, info);
+		}
+		pfree(segmentsVector);
+		MemoryContextSwitchTo(old);
+	}
+
+	foreach(lc, entry->relsType)
+	{
+		CurrentRelType *relType = (CurrentRelType *) palloc(sizeof(CurrentRelType));
+		*relType = *(CurrentRelType *) lfirst(lc);
+		result->relsType = lappend(result->relsType, relType);
+	}
+	result->forbid_optimizer = entry->forbid_optimizer;
+	appendStringInfoString(result->datalocalityInfo, entry->datalocalityInfo);
+
+	elog(LOG, "%s (cached assignment)", entry->datalocalityInfo);
+
+	return copy_alloc_result(entry->alloc_results);
+}
+
+/*
+ * store_assignment_cache: keep the result of a run of the allocation
+ * algorithm for later queries on the same input. `former_segments` is the
+ * order of the virtual segments before the run.
+ */
+static void
+store_assignment_cache(StringInfo key, SplitAllocResult *result,
+		List *alloc_result, List *former_segments, QueryResource *resource) {
+	AssignmentCacheEntry *entry;
+	MemoryContext entrycontext;
+	MemoryContext old;
+	ListCell *lc;
+	int p = 0;
+
+	if (key == NULL) {
+		return;
+	}
+
+	if (AssignmentCacheMemoryContext == NULL) {
+		AssignmentCacheMemoryContext = AllocSetContextCreate(TopMemoryContext,
+				"AssignmentCacheMemoryContext",
+				ALLOCSET_DEFAULT_MINSIZE,
+				ALLOCSET_DEFAULT_INITSIZE,
+				ALLOCSET_DEFAULT_MAXSIZE);
+	}
+
+	/* make room for the new entry */
+	trim_assignment_cache(datalocality_assignment_cache_size - 1);
+
+	entrycontext = AllocSetContextCreate(AssignmentCacheMemoryContext,
+			"AssignmentCacheEntry",
+			ALLOCSET_SMALL_MINSIZE,
+			ALLOCSET_SMALL_INITSIZE,
+			ALLOCSET_DEFAULT_MAXSIZE);
+	old = MemoryContextSwitchTo(entrycontext);
+
+	entry = (AssignmentCacheEntry *) palloc0(sizeof(AssignmentCacheEntry));
+	entry->memorycontext = entrycontext;
+	entry->hashvalue = DatumGetUInt32(
+			hash_any((unsigned char *) key->data, key->len));
+	entry->key = (char *) palloc(key->len);
+	memcpy(entry->key, key->data, key->len);
+	entry->keylen = key->len;
+	entry->alloc_results = copy_alloc_result(alloc_result);
+	foreach(lc, result->relsType)
+	{
+		CurrentRelType *relType = (CurrentRelType *) palloc(sizeof(CurrentRelType));
+		*relType = *(CurrentRelType *) lfirst(lc);
+		entry->relsType = lappend(entry->relsType, relType);
+	}
+	entry->forbid_optimizer = result->forbid_optimizer;
+	entry->datalocalityInfo = pstrdup(result->datalocalityInfo->data);
+
+	entry->vseg_num = list_length(resource->segments);
+	foreach(lc, resource->segments)
+	{
+		ListCell *lc_former;
+		int former = 0;
+		foreach(lc_former, former_segments)
+		{
+			if (lfirst(lc_former) == lfirst(lc)) {
+				break;
+			}
+			former++;
+		}
+		if (former != p && entry->vseg_order == NULL) {
+			entry->vseg_order = (int *) palloc(sizeof(int) * entry->vseg_num);
+			for (int i = 0; i < p; i++) {
+				entry->vseg_order[i] = i;
+			}
+		}
+		if (entry->vseg_order != NULL) {
+			entry->vseg_order[p] = former;
+		}
+		p++;
+	}
+
+	MemoryContextSwitchTo(AssignmentCacheMemoryContext);
+	AssignmentCache = lcons(entry, AssignmentCache);
+	MemoryContextSwitchTo(old);
+}
+
+/*
+ * trim_assignment_cache: evict the least recently used results until at
+ * most `max_entries` are left.
+ */
+static void
+trim_assignment_cache(int max_entries) {
+	if (max_entries < 0) {
+		max_entries = 0;
+	}
+
+	while (list_length(AssignmentCache) > max_entries) {
+		AssignmentCacheEntry *entry = (AssignmentCacheEntry *) llast(AssignmentCache);
+		AssignmentCache = list_delete_ptr(AssignmentCache, entry);
+		MemoryContextDelete(entry->memorycontext);
+	}
+
+	return;
+}
+
+/*
+ * copy_alloc_result: copy a split assignment built by
+ * post_process_assign_result into the current memory context.
+ */
+static List *
+copy_alloc_result(List *alloc_result) {
+	List *copy = NIL;
+	ListCell *lc;
+
+	foreach(lc, alloc_result)
+	{
+		SegFileSplitMapNode *map_node = (SegFileSplitMapNode *) lfirst(lc);
+		SegFileSplitMapNode *new_map_node = makeNode(SegFileSplitMapNode);
+		ListCell *per_seg_splits;
+
+		new_map_node->relid = map_node->relid;
+		new_map_node->splits = NIL;
+		foreach(per_seg_splits, map_node->splits)
+		{
+			List *splits = NIL;
+			ListCell *lc_split;
+			foreach(lc_split, (List *) lfirst(per_seg_splits))
+			{
+				FileSplit fileSplit = makeNode(FileSplitNode);
+				*fileSplit = *(FileSplit) lfirst(lc_split);
+				splits = lappend(splits, fileSplit);
+			}
+			new_map_node->splits = lappend(new_map_node->splits, splits);
+		}
+		copy = lappend(copy, new_map_node);
+	}
+
+	return copy;
+}
+
 /*
  * get_block_locations_and_claculte_table_size: the HDFS block information
  * corresponding to the required relations, and calculate relation size
@@ -800,6 +1216,8 @@ int64 get_block_locations_and_claculte_table_size(split_to_segment_mapping_conte
 	ActiveSnapshot = CopySnapshot(ActiveSnapshot);
 	ActiveSnapshot->curcid = GetCurrentCommandId();
 
+	prefetch_block_locations(context, ActiveSnapshot);
+
 	foreach(lc, context->rtc_context.full_range_tables)
 	{
 		Oid rel_oid = lfirst_oid(lc);
@@ -865,6 +1283,8 @@ int64 get_block_locations_and_claculte_table_size(split_to_segment_mapping_conte
 		relation_close(rel, AccessShareLock);
 	}
 
+	free_prefetched_block_locations(context);
+
 	MemoryContextSwitchTo(context->old_memorycontext);
 
 	ActiveSnapshot = saveActiveSnapshot;
@@ -874,11 +1294,233 @@ int64 get_block_locations_and_claculte_table_size(split_to_segment_mapping_conte
 	double hitrate = (allblocks == 0) ? 0 : (double) hitblocks / allblocks;
 	elog(LOG, "fetch blocks of %d files overall execution time:"
 	" %d us with hit rate %f \n", totalFileCount,eclaspeTime,hitrate);
+	if (debug_print_split_alloc_result && context->prefetch_file_count > 0) {
+		elog(LOG, "prefetch blocks of %d files with %d threads execution time:"
+		" " INT64_FORMAT " us, namenode call time " INT64_FORMAT " us, saved "
+		INT64_FORMAT " us \n", context->prefetch_file_count,
+		datalocality_fetch_threads, context->prefetch_time,
+		context->prefetch_serial_time,
+		context->prefetch_serial_time - context->prefetch_time);
+	}
 	context->total_file_count = totalFileCount;
 	context->total_size = total_size;
 	return total_size;
 }
 
+/*
+ * prefetch_block_locations: look up the HDFS block locations of the segment
+ * files of all required relations concurrently, so that the walk over the
+ * relations that follows does not wait for the namenode file by file.
+ * Files already in the metadata cache are skipped; files whose lookup fails
+ * are looked up again, and the error reported, by that walk.
+ */
+static void prefetch_block_locations(split_to_segment_mapping_context *context,
+		Snapshot metadataSnapshot) {
+	HdfsBlockLocationRequest *requests;
+	PrefetchedLocationKey *keys;
+	int nrequests = 0;
+	int maxrequests = 64;
+	uint64_t beginTime;
+	ListCell *lc;
+
+	if (datalocality_fetch_threads <= 1 || debug_fake_datalocality
+			|| (metadata_cache_enable && metadata_cache_testfile
+					&& metadata_cache_testfile[0])) {
+		return;
+	}
+
+	beginTime = gettime_microsec();
+
+	requests = (HdfsBlockLocationRequest *) palloc(
+			sizeof(HdfsBlockLocationRequest) * maxrequests);
+	keys = (PrefetchedLocationKey *) palloc(
+			sizeof(PrefetchedLocationKey) * maxrequests);
+
+	foreach(lc, context->rtc_context.full_range_tables)
+	{
+		Oid rel_oid = lfirst_oid(lc);
+		Relation rel = relation_open(rel_oid, AccessShareLock);
+		AppendOnlyEntry *aoEntry;
+		Relation segrel;
+		TupleDesc segdsc;
+		SysScanDesc segscan;
+		HeapTuple tuple;
+		char *basepath;
+		int segnoAttr;
+		int eofAttr;
+
+		if (RelationIsAoRows(rel)) {
+			segnoAttr = Anum_pg_aoseg_segno;
+			eofAttr = Anum_pg_aoseg_eof;
+		} else if (RelationIsParquet(rel)) {
+			segnoAttr = Anum_pg_parquetseg_segno;
+			eofAttr = Anum_pg_parquetseg_eof;
+		} else {
+			relation_close(rel, AccessShareLock);
+			continue;
+		}
+
+		aoEntry = GetAppendOnlyEntry(rel_oid, SnapshotNow);
+		basepath = relpath(rel->rd_node);
+
+		segrel = heap_open(aoEntry->segrelid, AccessShareLock);
+		segdsc = RelationGetDescr(segrel);
+		segscan = systable_beginscan(segrel, InvalidOid, FALSE,
+				metadataSnapshot, 0, NULL);
+		while (HeapTupleIsValid(tuple = systable_getnext(segscan))) {
+			int segno = DatumGetInt32(
+					fastgetattr(tuple, segnoAttr, segdsc, NULL));
+			int64 logic_len = (int64) DatumGetFloat8(
+					fastgetattr(tuple, eofAttr, segdsc, NULL));
+			char *segfile_path;
+
+			if (logic_len == 0) {
+				continue;
+			}
+
+			segfile_path = (char *) palloc0(strlen(basepath) + 9);
+			FormatAOSegmentFileName(basepath, segno, -1, 0, &segno, segfile_path);
+
+			if (metadata_cache_enable) {
+				HdfsFileInfo *file_info = CreateHdfsFileInfo(rel->rd_node, segno);
+				bool cached = HdfsFileBlockLocationsCached(file_info);
+				DestroyHdfsFileInfo(file_info);
+				if (cached) {
+					pfree(segfile_path);
+					continue;
+				}
+			}
+
+			if (nrequests >= maxrequests) {
+				maxrequests <<= 1;
+				requests = (HdfsBlockLocationRequest *) repalloc(requests,
+						sizeof(HdfsBlockLocationRequest) * maxrequests);
+				keys = (PrefetchedLocationKey *) repalloc(keys,
+						sizeof(PrefetchedLocationKey) * maxrequests);
+			}
+			requests[nrequests].path = segfile_path;
+			requests[nrequests].length = logic_len;
+			MemSet(&keys[nrequests], 0, sizeof(PrefetchedLocationKey));
+			keys[nrequests].rnode = rel->rd_node;
+			keys[nrequests].segno = segno;
+			nrequests++;
+		}
+		systable_endscan(segscan);
+		heap_close(segrel, AccessShareLock);
+
+		pfree(basepath);
+		relation_close(rel, AccessShareLock);
+	}
+
+	/* a single file is not worth the threads */
+	if (nrequests > 1) {
+		HASHCTL ctl;
+
+		HdfsGetFileBlockLocationsBatch(requests, nrequests,
+				datalocality_fetch_threads);
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(PrefetchedLocationKey);
+		ctl.entrysize = sizeof(PrefetchedLocationEntry);
+		ctl.hash = tag_hash;
+		ctl.hcxt = context->datalocality_memorycontext;
+		context->prefetched_locations = hash_create(
+				"Prefetched Block Location Hash", nrequests, &ctl,
+				HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+		for (int i = 0; i < nrequests; i++) {
+			PrefetchedLocationEntry *entry;
+			bool found;
+
+			context->prefetch_serial_time += requests[i].elapsed;
+			if (requests[i].locations == NULL) {
+				continue;
+			}
+
+			entry = (PrefetchedLocationEntry *) hash_search(
+					context->prefetched_locations, (void *) &keys[i],
+					HASH_ENTER, &found);
+			Assert(!found);
+			entry->locations = requests[i].locations;
+			entry->block_num = requests[i].block_num;
+			entry->elapsed = requests[i].elapsed;
+			context->prefetch_file_count++;
+		}
+
+		context->prefetch_time = gettime_microsec() - beginTime;
+	}
+
+	for (int i = 0; i < nrequests; i++) {
+		pfree(requests[i].path);
+	}
+	pfree(requests);
+	pfree(keys);
+}
+
+/*
+ * free_prefetched_block_locations: free the prefetched block locations
+ * that were not taken by fetch_hdfs_data_block_location.
+ */
+static void free_prefetched_block_locations(
+		split_to_segment_mapping_context *context) {
+	HASH_SEQ_STATUS status;
+	PrefetchedLocationEntry *entry;
+
+	if (context->prefetched_locations == NULL) {
+		return;
+	}
+
+	hash_seq_init(&status, context->prefetched_locations);
+	while ((entry = (PrefetchedLocationEntry *) hash_seq_search(&status)) != NULL) {
+		if (entry->locations != NULL) {
+			HdfsFreeFileBlockLocations(entry->locations, entry->block_num);
+		}
+	}
+
+	hash_destroy(context->prefetched_locations);
+	context->prefetched_locations = NULL;
+}
+
+/*
+ * take_prefetched_block_location: take the block locations of a file
+ * looked up by prefetch_block_locations, return NULL if there are none.
+ * The result is the same as that of fetch_hdfs_data_block_location.
+ */
+static BlockLocation *
+take_prefetched_block_location(split_to_segment_mapping_context *context,
+		RelFileNode rnode, uint32_t segno, int64 len, int *block_num) {
+	PrefetchedLocationKey key;
+	PrefetchedLocationEntry *entry;
+	BlockLocation *locations;
+
+	if (context->prefetched_locations == NULL) {
+		return NULL;
+	}
+
+	MemSet(&key, 0, sizeof(key));
+	key.rnode = rnode;
+	key.segno = segno;
+	entry = (PrefetchedLocationEntry *) hash_search(
+			context->prefetched_locations, (void *) &key, HASH_FIND, NULL);
+	if (entry == NULL || entry->locations == NULL) {
+		return NULL;
+	}
+
+	*block_num = entry->block_num;
+	if (metadata_cache_enable) {
+		HdfsFileInfo *file_info = CreateHdfsFileInfo(rnode, segno);
+		locations = PutHdfsFileBlockLocations(file_info, len, entry->locations,
+				entry->block_num, entry->elapsed);
+		DestroyHdfsFileInfo(file_info);
+		HdfsFreeFileBlockLocations(entry->locations, entry->block_num);
+	} else {
+		locations = entry->locations;
+	}
+	entry->locations = NULL;
+
+	return locations;
+}
+
 /*
  * search_host_in_stat_context: search a host name in the statistic
  * context; if not found, create a new one.
@@ -921,7 +1563,8 @@ search_host_in_stat_context(split_to_segment_mapping_context *context,
  * collect all its data block location information.
  */
 static BlockLocation *
-fetch_hdfs_data_block_location(char *filepath, int64 len, int *block_num,
+fetch_hdfs_data_block_location(split_to_segment_mapping_context *context,
+		char *filepath, int64 len, int *block_num,
 		RelFileNode rnode, uint32_t segno, double* hit_ratio) {
 	// for fakse test, the len of file always be zero
 	if(len == 0  && !debug_fake_datalocality){
@@ -934,7 +1577,11 @@ fetch_hdfs_data_block_location(char *filepath, int64 len, int *block_num,
 	uint64_t beginTime;
 	beginTime = gettime_microsec();
 
-	if (metadata_cache_enable) {
+	locations = take_prefetched_block_location(context, rnode, segno, len,
+			block_num);
+	if (locations != NULL) {
+		*hit_ratio = 0.0;
+	} else if (metadata_cache_enable) {
 		file_info = CreateHdfsFileInfo(rnode, segno);
 		if (metadata_cache_testfile && metadata_cache_testfile[0]) {
 			locations = GetHdfsFileBlockLocationsForTest(filepath, len, block_num);
@@ -1086,7 +1733,7 @@ static void AOGetSegFileDataLocation(Relation relation,
 			if (!context->keep_hash || !isRelationHash) {
 				FormatAOSegmentFileName(basepath, segno, -1, 0, &segno, segfile_path);
 				double hit_ratio;
-				locations = fetch_hdfs_data_block_location(segfile_path, logic_len,
+				locations = fetch_hdfs_data_block_location(context, segfile_path, logic_len,
 						&block_num, relation->rd_node, segno, &hit_ratio);
 				*allblocks += block_num;
 				*hitblocks += block_num * hit_ratio;
@@ -1158,7 +1805,7 @@ static void AOGetSegFileDataLocation(Relation relation,
 
 				FormatAOSegmentFileName(basepath, segno, -1, 0, &segno, segfile_path);
 				double hit_ratio;
-				locations = fetch_hdfs_data_block_location(segfile_path, logic_len,
+				locations = fetch_hdfs_data_block_location(context, segfile_path, logic_len,
 						&block_num, relation->rd_node, segno, &hit_ratio);
 				*allblocks += block_num;
 				*hitblocks += block_num * hit_ratio;
@@ -1242,7 +1889,7 @@ static void AOGetSegFileDataLocation(Relation relation,
 			if (!context->keep_hash || !isRelationHash) {
 				FormatAOSegmentFileName(basepath, segno, -1, 0, &segno, segfile_path);
 				double hit_ratio;
-				locations = fetch_hdfs_data_block_location(segfile_path, logic_len,
+				locations = fetch_hdfs_data_block_location(context, segfile_path, logic_len,
 						&block_num, relation->rd_node, segno, &hit_ratio);
 				*allblocks += block_num;
 				*hitblocks += block_num * hit_ratio;
@@ -1296,7 +1943,7 @@ static void AOGetSegFileDataLocation(Relation relation,
 
 				FormatAOSegmentFileName(basepath, segno, -1, 0, &segno, segfile_path);
 				double hit_ratio;
-				locations = fetch_hdfs_data_block_location(segfile_path, logic_len,
+				locations = fetch_hdfs_data_block_location(context, segfile_path, logic_len,
 						&block_num, relation->rd_node, segno, &hit_ratio);
 				*allblocks += block_num;
 				*hitblocks += block_num * hit_ratio;
@@ -1417,7 +2064,7 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 		if (!context->keep_hash || !isRelationHash) {
 			FormatAOSegmentFileName(basepath, segno, -1, 0, &segno, segfile_path);
 			double hit_ratio;
-			locations = fetch_hdfs_data_block_location(segfile_path, logic_len,
+			locations = fetch_hdfs_data_block_location(context, segfile_path, logic_len,
 					&block_num, relation->rd_node, segno, &hit_ratio);
 			*allblocks += block_num;
 			*hitblocks += block_num * hit_ratio;
@@ -1472,7 +2119,7 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 		} else {
 			FormatAOSegmentFileName(basepath, segno, -1, 0, &segno, segfile_path);
 			double hit_ratio;
-			locations = fetch_hdfs_data_block_location(segfile_path, logic_len,
+			locations = fetch_hdfs_data_block_location(context, segfile_path, logic_len,
 					&block_num, relation->rd_node, segno, &hit_ratio);
 			*allblocks += block_num;
 			*hitblocks += block_num * hit_ratio;
@@ -4066,8 +4713,25 @@ calculate_planner_segment_num(Query *query, QueryResourceLife resourceLife,
 
 	MemoryContextSwitchTo(context.old_memorycontext);
 
-	/* data locality allocation algorithm*/
-	alloc_result = run_allocation_algorithm(result, virtual_segments, &resource, &context);
+	/* data locality allocation algorithm, unless it ran on the same input before*/
+	StringInfo cache_key = build_assignment_cache_key(&context, virtual_segments);
+	AssignmentCacheEntry *cached_assignment = lookup_assignment_cache(cache_key);
+	if (cached_assignment != NULL) {
+		if (debug_print_split_alloc_result) {
+			elog(LOG, "use the split assignment of an earlier query, %d assignments cached",
+					list_length(AssignmentCache));
+		}
+		alloc_result = use_cached_assignment(cached_assignment, result, resource);
+	} else {
+		MemoryContextSwitchTo(context.datalocality_memorycontext);
+		List *former_segments = list_copy(resource->segments);
+		MemoryContextSwitchTo(context.old_memorycontext);
+
+		alloc_result = run_allocation_algorithm(result, virtual_segments, &resource, &context);
+
+		store_assignment_cache(cache_key, result, alloc_result, former_segments,
+				resource);
+	}
 
 	result->resource = resource;
 	result->alloc_results = alloc_result;
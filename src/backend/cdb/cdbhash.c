@@ -165,15 +165,133 @@ addToCdbHash(void *cdbHash, void *buf, size_t len)
 
 extern void varattrib_untoast_ptr_len(Datum d, char **datastart, int *len, void **tofree);
 
+/*
+ * FNV-1 hash of a buffer whose length is known at compile time, the same
+ * as fnv1_32_buf but unrolled by the compiler once inlined.
+ */
+static inline uint32
+fnv1_32_fixed(const void *buf, int len, uint32 hval)
+{
+	const unsigned char *bp = (const unsigned char *) buf;
+
+	for (int i = 0; i < len; i++)
+	{
+		hval *= FNV_32_PRIME;
+		hval ^= (uint32) bp[i];
+	}
+
+	return hval;
+}
+
+static inline float4
+normalizeFloat4(float4 f)
+{
+	/* minus zero and zero must hash the same, see hashDatum */
+	return f == (float4) 0 ? 0.0 : f;
+}
+
+static inline float8
+normalizeFloat8(float8 f)
+{
+	return f == (float8) 0 ? 0.0 : f;
+}
+
+/*
+ * Type-specialized kernel, the value is converted to the same canonical
+ * form as hashDatum uses for the type.
+ */
+#define CDBHASH_FIXED(ctype, expr) \
+	do { \
+		ctype canonical = (expr); \
+		h->hash = fnv1_32_fixed(&canonical, sizeof(canonical), h->hash); \
+	} while (0)
+
 /*
  * Add an attribute to the CdbHash calculation.
+ *
+ * Common fixed-width types are hashed by kernels specialized for the type,
+ * which give the same result as hashDatum. Other types, and other hash
+ * algorithms than FNV-1, go through hashDatum.
  */
 void
 cdbhash(CdbHash *h, Datum datum, Oid type)
 {
+	if (h->hashalg == HASH_FNV_1)
+	{
+		switch (type)
+		{
+			case INT2OID:
+				CDBHASH_FIXED(int64, (int64) DatumGetInt16(datum));
+				return;
+			case INT4OID:
+				CDBHASH_FIXED(int64, (int64) DatumGetInt32(datum));
+				return;
+			case INT8OID:
+				CDBHASH_FIXED(int64, DatumGetInt64(datum));
+				return;
+			case OIDOID:
+			case REGPROCOID:
+			case REGPROCEDUREOID:
+			case REGOPEROID:
+			case REGOPERATOROID:
+			case REGCLASSOID:
+			case REGTYPEOID:
+				CDBHASH_FIXED(int64, (int64) DatumGetUInt32(datum));
+				return;
+			case FLOAT4OID:
+				CDBHASH_FIXED(float4, normalizeFloat4(DatumGetFloat4(datum)));
+				return;
+			case FLOAT8OID:
+				CDBHASH_FIXED(float8, normalizeFloat8(DatumGetFloat8(datum)));
+				return;
+			case TIMESTAMPOID:
+				CDBHASH_FIXED(Timestamp, DatumGetTimestamp(datum));
+				return;
+			case TIMESTAMPTZOID:
+				CDBHASH_FIXED(TimestampTz, DatumGetTimestampTz(datum));
+				return;
+			case DATEOID:
+				CDBHASH_FIXED(DateADT, DatumGetDateADT(datum));
+				return;
+			case TIMEOID:
+				CDBHASH_FIXED(TimeADT, DatumGetTimeADT(datum));
+				return;
+			case CHAROID:
+				CDBHASH_FIXED(char, DatumGetChar(datum));
+				return;
+			case BOOLOID:
+				CDBHASH_FIXED(bool, DatumGetBool(datum));
+				return;
+			default:
+				break;
+		}
+	}
+
 	hashDatum(datum, type, addToCdbHash, (void*)h);
 }
 
+/*
+ * Return the fast hashing kernel for values hashed by hashfn.
+ */
+CdbHashMixKind
+cdbhashmixkind(Oid hashfn)
+{
+	switch (hashfn)
+	{
+		case F_HASHINT2:
+			return CDBHASH_MIX_INT2;
+		case F_HASHINT4:
+		case F_HASHOID:
+			return CDBHASH_MIX_INT4;
+		case F_HASHINT8:
+			return CDBHASH_MIX_INT8;
+		case F_HASHCHAR:
+			return CDBHASH_MIX_CHAR;
+		default:
+			return CDBHASH_MIX_NONE;
+	}
+}
+
 /*
  * Add an attribute to the hash calculation.
  * **IMPORTANT: any new hard coded support for a data type in here
@@ -45,11 +45,18 @@
 #include "funcapi.h"
 #include "fmgr.h"
 #include "utils/builtins.h"
+#include "utils/tuplestore.h"
+#include "catalog/pg_type.h"
+#include "portability/instr_time.h"
 
 #define MAX_HDFS_FILE_NUM               (2 << 15)       // 1PB / 32G = 32K, 2^15
 #define MAX_HDFS_HOST_NUM               1024
 #define MAX_BLOCK_INFO_LEN              128
 #define BLOCK_INFO_BIT_NUM              16
+#define MAX_METADATA_CACHE_STAT_NUM     4096
+
+#define FREE_SLOT_HEAD                  (MetadataCacheSharedDataInstance->free_slot_head)
+#define CLOCK_HAND                      (MetadataCacheSharedDataInstance->clock_hand)
 
 /*
  *  HDFS Block Info Structure
@@ -85,6 +92,12 @@ MetadataBlockInfoTablesInit(void);
 static bool 
 MetadataCacheHdfsBlockArrayInit(void);
 
+static bool
+MetadataCacheClockRingInit(void);
+
+static bool
+MetadataCacheStatTableInit(void);
+
 /*
  *  Metadata Cache Operation Functions
  */
@@ -97,8 +110,23 @@ MetadataCacheExists(const HdfsFileInfo *file_info);
 static MetadataCacheEntry *
 MetadataCacheEnter(const HdfsFileInfo *file_info);
 
-static void 
-MetadataCacheRemove(const HdfsFileInfo *file_info);
+static uint32_t
+AllocMetadataCacheSlot(const MetadataCacheKey *key);
+
+static void
+ReleaseMetadataCacheSlot(uint32_t slot);
+
+/*
+ *  Metadata Cache Statistics Functions
+ */
+static uint64_t
+MetadataCacheGetTime(void);
+
+static MetadataCacheStatEntry *
+MetadataCacheStatEnter(const MetadataCacheKey *key);
+
+static void
+MetadataCacheRecordLookup(const MetadataCacheKey *key, MetadataCacheLookupType type, uint64_t lookup_time, uint64_t fetch_time);
 
 /*
  *  HDFS Block Operation Functions
@@ -122,6 +150,9 @@ MetadataCacheSharedData  *MetadataCacheSharedDataInstance = NULL;
 HTAB                     *MetadataCache = NULL;
 MetadataHdfsBlockInfo    *MetadataBlockArray = NULL;
 
+static MetadataCacheClockSlot   *MetadataCacheClockRing = NULL;
+static HTAB                     *MetadataCacheStat = NULL;
+
 static HTAB                     *BlockHostsMap = NULL;
 static HTAB                     *BlockNamesMap = NULL;
 static HTAB                     *BlockTopologyPathsMap = NULL;
@@ -131,9 +162,10 @@ static BlockLocation *MergeHdfsFileBlockLocations(BlockLocation *locations1, int
 
 
 // create block locations for user
-static BlockLocation *GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesize, int *block_num);
+static BlockLocation *GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesize, int *block_num, uint64_t begin_time);
 static BlockLocation *GetHdfsFileBlockLocationsFromCache(MetadataCacheEntry *entry, uint64_t filesize, int *block_num);
-static BlockLocation *AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *file_info, MetadataCacheEntry *entry, uint64_t filesize, int *block_num, double *hit_ratio);
+static BlockLocation *AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *file_info, MetadataCacheEntry *entry, uint64_t filesize, int *block_num, double *hit_ratio, uint64_t begin_time);
+static BlockLocation *PutHdfsFileBlockLocationsInternal(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation *hdfs_locations, int block_num, uint64_t begin_time, uint64_t fetch_time);
 
 /*
  *  Estimate metadata cache shared memory size
@@ -141,6 +173,8 @@ static BlockLocation *AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *fi
  *      - Block info (3 types) hash size
  *      - Metadata cache shared structure size
  *      - Metadata hdfs block array size
+ *      - Metadata cache clock ring size
+ *      - Metadata cache statistics hash size
  */
 Size 
 MetadataCache_ShmemSize(void)
@@ -155,6 +189,10 @@ MetadataCache_ShmemSize(void)
 
     size = add_size(size, metadata_cache_block_capacity* sizeof(MetadataHdfsBlockInfo));
 
+    size = add_size(size, mul_size(MAX_HDFS_FILE_NUM, sizeof(MetadataCacheClockSlot)));
+
+    size = add_size(size, hash_estimate_size((Size)MAX_METADATA_CACHE_STAT_NUM, sizeof(MetadataCacheStatEntry)));
+
     return size;
 }
 
@@ -164,6 +202,8 @@ MetadataCache_ShmemSize(void)
  *      - Metadata cache hash table
  *      - Metadata cache block info hash tables (3 types) 
  *      - Metadata hdfs block array
+ *      - Metadata cache clock ring
+ *      - Metadata cache statistics hash table
  */
 void 
 MetadataCache_ShmemInit(void)
@@ -204,6 +244,16 @@ MetadataCache_ShmemInit(void)
         elog(FATAL, "[MetadataCache] fail to allocate share memory for metadata cache hdfs block array");
     }
 
+    if (!MetadataCacheClockRingInit())
+    {
+        elog(FATAL, "[MetadataCache] fail to allocate share memory for metadata cache clock ring");
+    }
+
+    if (!MetadataCacheStatTableInit())
+    {
+        elog(FATAL, "[MetadataCache] fail to allocate share memory for metadata cache statistics hash table");
+    }
+
     elog(LOG, "[MetadataCache] Metadata cache initialize successfully. block_capacity:%d", metadata_cache_block_capacity);
 
     return;
@@ -304,6 +354,63 @@ MetadataCacheHdfsBlockArrayInit(void)
     return true;
 }
 
+/*
+ *  Initialize metadata cache clock ring, all the slots are free
+ */
+bool
+MetadataCacheClockRingInit(void)
+{
+    Insist(MetadataCacheSharedDataInstance != NULL);
+
+    int i = 0;
+    bool found;
+
+    MetadataCacheClockRing = (MetadataCacheClockSlot *)ShmemInitStruct("Metadata Cache Clock Ring",
+                                MAX_HDFS_FILE_NUM * sizeof(MetadataCacheClockSlot), &found);
+
+    if (NULL == MetadataCacheClockRing)
+    {
+        return false;
+    }
+
+    for (i=0;i<MAX_HDFS_FILE_NUM;i++)
+    {
+        MetadataCacheClockRing[i].in_use = false;
+        MetadataCacheClockRing[i].next_free_slot = i + 1;
+    }
+    MetadataCacheClockRing[MAX_HDFS_FILE_NUM - 1].next_free_slot = END_OF_SLOT;
+
+    FREE_SLOT_HEAD = 0;
+    CLOCK_HAND = 0;
+
+    return true;
+}
+
+/*
+ *  Initialize metadata cache statistics hash table
+ */
+bool
+MetadataCacheStatTableInit(void)
+{
+    HASHCTL     info;
+    int         hash_flags;
+
+    MemSet(&info, 0, sizeof(info));
+
+    info.keysize = sizeof(MetadataCacheStatKey);
+    info.entrysize = sizeof(MetadataCacheStatEntry);
+    info.hash = tag_hash;
+    hash_flags = (HASH_ELEM | HASH_FUNCTION);
+
+    MetadataCacheStat = ShmemInitHash("Metadata Cache Statistics", MAX_METADATA_CACHE_STAT_NUM, MAX_METADATA_CACHE_STAT_NUM, &info, hash_flags);
+    if (NULL == MetadataCacheStat)
+    {
+        return false;
+    }
+
+    return true;
+}
+
 /*
  *  Create HdfsFileInfo structure before calling GetHdfsFileBlockLocations 
  */
@@ -396,18 +503,215 @@ MetadataCacheEnter(const HdfsFileInfo *file_info)
 }
 
 /*
- *  Metadata cache remove
+ *  Metadata cache remove, release its blocks and clock slot
  */
-void 
-MetadataCacheRemove(const HdfsFileInfo *file_info)
+void
+MetadataCacheRemoveEntry(MetadataCacheEntry *entry)
 {
-    Insist(file_info != NULL);
-    
+    Insist(entry != NULL);
+
     bool found;
-    MetadataCacheKey key;
 
-    InitMetadataCacheKey(&key, file_info);
-    hash_search(MetadataCache, (void *)&key, HASH_REMOVE, &found);
+    ReleaseMetadataBlock(entry->block_num, entry->first_block_id, entry->last_block_id);
+    ReleaseMetadataCacheSlot(entry->clock_slot);
+    hash_search(MetadataCache, (void *)&entry->key, HASH_REMOVE, &found);
+}
+
+/*
+ *  Allocate slot in the clock ring
+ */
+uint32_t
+AllocMetadataCacheSlot(const MetadataCacheKey *key)
+{
+    Insist(FREE_SLOT_HEAD != END_OF_SLOT);
+
+    uint32_t slot = FREE_SLOT_HEAD;
+
+    FREE_SLOT_HEAD = MetadataCacheClockRing[slot].next_free_slot;
+    MetadataCacheClockRing[slot].key = *key;
+    MetadataCacheClockRing[slot].in_use = true;
+
+    return slot;
+}
+
+/*
+ *  Release slot in the clock ring
+ */
+void
+ReleaseMetadataCacheSlot(uint32_t slot)
+{
+    Insist(slot < MAX_HDFS_FILE_NUM);
+    Insist(MetadataCacheClockRing[slot].in_use);
+
+    MetadataCacheClockRing[slot].in_use = false;
+    MetadataCacheClockRing[slot].next_free_slot = FREE_SLOT_HEAD;
+    FREE_SLOT_HEAD = slot;
+}
+
+/*
+ *  Evict entries by clock sweep until there are free_block_num free blocks and
+ *  a free slot for one more entry. An entry whose usage count is not zero gets
+ *  its count decreased and survives the sweep; the entry of the pinned key is
+ *  never evicted. Return false if the space can not be made.
+ */
+bool
+MetadataCacheEvict(uint32_t free_block_num, const MetadataCacheKey *pinned)
+{
+    uint32_t tries;
+    int total_evict_files = 0;
+
+    if (free_block_num > metadata_cache_block_capacity)
+    {
+        return false;
+    }
+
+    // every entry but the pinned one reaches zero usage within these sweeps
+    tries = (METADATA_CACHE_MAX_USAGE + 1) * MAX_HDFS_FILE_NUM;
+
+    while (FREE_BLOCK_NUM < free_block_num || FREE_SLOT_HEAD == END_OF_SLOT)
+    {
+        MetadataCacheClockSlot *slot;
+        MetadataCacheEntry *entry;
+        MetadataCacheStatEntry *stat;
+        bool found;
+
+        if (tries-- == 0)
+        {
+            elog(DEBUG1, "[MetadataCache] MetadataCacheEvict fail. free_block_num:%u expected_free_block_num:%u evict_files:%d",
+                            FREE_BLOCK_NUM,
+                            free_block_num,
+                            total_evict_files);
+            return false;
+        }
+
+        slot = &MetadataCacheClockRing[CLOCK_HAND];
+        CLOCK_HAND = (CLOCK_HAND + 1) % MAX_HDFS_FILE_NUM;
+
+        if (!slot->in_use)
+        {
+            continue;
+        }
+
+        if (pinned && memcmp(&slot->key, pinned, sizeof(MetadataCacheKey)) == 0)
+        {
+            continue;
+        }
+
+        entry = (MetadataCacheEntry *)hash_search(MetadataCache, (void *)&slot->key, HASH_FIND, &found);
+        Insist(entry != NULL);
+
+        if (entry->usage_count > 0)
+        {
+            entry->usage_count--;
+            continue;
+        }
+
+        stat = MetadataCacheStatEnter(&entry->key);
+        if (stat)
+        {
+            stat->evictions++;
+        }
+        MetadataCacheRemoveEntry(entry);
+        total_evict_files++;
+    }
+
+    elog(DEBUG1, "[MetadataCache] MetadataCacheEvict free_block_num:%u evict_files:%d", FREE_BLOCK_NUM, total_evict_files);
+
+    return true;
+}
+
+/*
+ *  Get current time in us
+ */
+uint64_t
+MetadataCacheGetTime(void)
+{
+    instr_time now;
+
+    INSTR_TIME_SET_CURRENT(now);
+    return INSTR_TIME_GET_MICROSEC(now);
+}
+
+/*
+ *  Get statistics entry of a relation, the relations beyond the capacity of the
+ *  statistics hash table share the entry with zero key
+ */
+MetadataCacheStatEntry *
+MetadataCacheStatEnter(const MetadataCacheKey *key)
+{
+    MetadataCacheStatKey stat_key;
+    MetadataCacheStatEntry *entry;
+    bool found;
+
+    MemSet(&stat_key, 0, sizeof(stat_key));
+    stat_key.tablespace_oid = key->tablespace_oid;
+    stat_key.database_oid = key->database_oid;
+    stat_key.relation_oid = key->relation_oid;
+
+    entry = (MetadataCacheStatEntry *)hash_search(MetadataCacheStat, (void *)&stat_key, HASH_FIND, &found);
+    if (entry)
+    {
+        return entry;
+    }
+
+    if (hash_get_num_entries(MetadataCacheStat) >= MAX_METADATA_CACHE_STAT_NUM - 1)
+    {
+        MemSet(&stat_key, 0, sizeof(stat_key));
+    }
+
+    entry = (MetadataCacheStatEntry *)hash_search(MetadataCacheStat, (void *)&stat_key, HASH_ENTER_NULL, &found);
+    if (entry && !found)
+    {
+        MemSet((char *)entry + sizeof(MetadataCacheStatKey), 0, sizeof(MetadataCacheStatEntry) - sizeof(MetadataCacheStatKey));
+    }
+
+    return entry;
+}
+
+/*
+ *  Account a lookup of the file of key to its relation
+ */
+void
+MetadataCacheRecordLookup(const MetadataCacheKey *key, MetadataCacheLookupType type, uint64_t lookup_time, uint64_t fetch_time)
+{
+    MetadataCacheStatEntry *stat = MetadataCacheStatEnter(key);
+    if (NULL == stat)
+    {
+        return;
+    }
+
+    switch (type)
+    {
+    case METADATA_CACHE_LOOKUP_HIT:
+        stat->hits++;
+        break;
+
+    case METADATA_CACHE_LOOKUP_PARTIAL_HIT:
+        stat->partial_hits++;
+        break;
+
+    case METADATA_CACHE_LOOKUP_MISS:
+        stat->misses++;
+        break;
+    }
+    stat->lookup_time += lookup_time;
+    stat->fetch_time += fetch_time;
+}
+
+/*
+ *  Account a refresh of the file of key by metadata cache process to its relation
+ */
+void
+MetadataCacheRecordRefresh(const MetadataCacheKey *key, uint64_t refresh_time)
+{
+    MetadataCacheStatEntry *stat = MetadataCacheStatEnter(key);
+    if (NULL == stat)
+    {
+        return;
+    }
+
+    stat->refreshes++;
+    stat->refresh_time += refresh_time;
 }
 
 
@@ -578,6 +882,7 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
 
     MetadataCacheEntry *cache_entry = NULL;
     BlockLocation *locations = NULL;
+    uint64_t begin_time = MetadataCacheGetTime();
 
     LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
 
@@ -591,7 +896,7 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
                                 file_info->filepath, 
                                 filesize);
 
-        locations = GetHdfsFileBlockLocationsNoCache(file_info, filesize, block_num);
+        locations = GetHdfsFileBlockLocationsNoCache(file_info, filesize, block_num, begin_time);
         *hit_ratio = 0;
     }
     else
@@ -611,6 +916,7 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
             locations = GetHdfsFileBlockLocationsFromCache(cache_entry, filesize, block_num);
             *hit_ratio = 1.0;    
 
+            MetadataCacheRecordLookup(&cache_entry->key, METADATA_CACHE_LOOKUP_HIT, MetadataCacheGetTime() - begin_time, 0);
             LWLockRelease(MetadataCacheLock); 
         } 
         else 
@@ -622,7 +928,7 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
                 RemoveHdfsFileBlockLocations(file_info);
                 LWLockRelease(MetadataCacheLock); 
                 
-                locations = GetHdfsFileBlockLocationsNoCache(file_info, filesize, block_num);
+                locations = GetHdfsFileBlockLocationsNoCache(file_info, filesize, block_num, begin_time);
                 *hit_ratio = 0;
             }
             else
@@ -630,7 +936,7 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
                 LWLockRelease(MetadataCacheLock); 
                 
                 // fetch extra hdfs block locations and append to cache
-                locations = AppendHdfsFileBlockLocationsToCache(file_info, cache_entry, filesize, block_num, hit_ratio);
+                locations = AppendHdfsFileBlockLocationsToCache(file_info, cache_entry, filesize, block_num, hit_ratio, begin_time);
             }
         }
     }
@@ -642,14 +948,16 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
  *  Get hdfs file block locations from Hadoop HDFS and put the result into metadata cache
  */
 BlockLocation *
-GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesize, int *block_num)
+GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesize, int *block_num, uint64_t begin_time)
 {
     BlockLocation *hdfs_locations = NULL; 
     BlockLocation *locations = NULL; 
-    MetadataCacheEntry *entry = NULL;
+    uint64_t fetch_time = 0;
 
     // 1. fetch hdfs block locations
+    fetch_time = MetadataCacheGetTime();
     hdfs_locations = HdfsGetFileBlockLocations(file_info->filepath, filesize, block_num);
+    fetch_time = MetadataCacheGetTime() - fetch_time;
     if ((NULL == hdfs_locations) || (0 == *block_num))
     {
         elog(DEBUG1, "[MetadataCache] GetHdfsFileBlockLocationsNoCache fetch hdfs block locatons fail. filename:%s filesize:"INT64_FORMAT" block_num:%d",
@@ -664,36 +972,76 @@ GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesiz
                                 filesize, 
                                 *block_num);
 
-    // 2. insert fetch results into cache
+    // 2. insert fetch results into cache and generate result block locations
+    locations = PutHdfsFileBlockLocationsInternal(file_info, filesize, hdfs_locations, *block_num, begin_time, fetch_time);
+
+done:
+    if (hdfs_locations)
+    {
+        HdfsFreeFileBlockLocations(hdfs_locations, *block_num);
+        hdfs_locations = NULL;
+    }
+
+    return locations;
+}
+
+/*
+ *  Put hdfs file block locations fetched by the caller into metadata cache, return result block locations.
+ *  The caller still owns and frees hdfs_locations, fetch_time is the time the caller spent fetching them.
+ */
+BlockLocation *
+PutHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation *hdfs_locations, int block_num, uint64_t fetch_time)
+{
+    return PutHdfsFileBlockLocationsInternal(file_info, filesize, hdfs_locations, block_num, MetadataCacheGetTime() - fetch_time, fetch_time);
+}
+
+/*
+ *  Put hdfs file block locations into metadata cache and account the lookup started at begin_time as a miss
+ */
+BlockLocation *
+PutHdfsFileBlockLocationsInternal(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation *hdfs_locations, int block_num, uint64_t begin_time, uint64_t fetch_time)
+{
+    BlockLocation *locations = NULL; 
+    MetadataCacheEntry *entry = NULL;
+    MetadataCacheKey key;
+
+    InitMetadataCacheKey(&key, file_info);
+
     LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
 
-    // 3. generate result block locations
-    locations = CreateHdfsFileBlockLocations(hdfs_locations, *block_num);
+    locations = CreateHdfsFileBlockLocations(hdfs_locations, block_num);
 
-    entry = MetadataCacheNew(file_info, filesize, hdfs_locations, *block_num); 
+    entry = MetadataCacheNew(file_info, filesize, hdfs_locations, block_num); 
     if (NULL == entry)
     {
-        LWLockRelease(MetadataCacheLock);
-        elog(DEBUG1, "[MetadataCache] GetHdfsFileBlockLocationsNoCache put hdfs block locations info cache fail. filename:%s filesize:"INT64_FORMAT" block_num:%d",
+        elog(DEBUG1, "[MetadataCache] PutHdfsFileBlockLocations put hdfs block locations info cache fail. filename:%s filesize:"INT64_FORMAT" block_num:%d",
                                 file_info->filepath, 
                                 filesize, 
-                                *block_num);
-        goto done;
+                                block_num);
     }
-    entry->last_access_time = entry->create_time = time(NULL);
 
-    LWLockRelease(MetadataCacheLock);
+    MetadataCacheRecordLookup(&key, METADATA_CACHE_LOOKUP_MISS, MetadataCacheGetTime() - begin_time, fetch_time);
 
-done:
-    if (hdfs_locations)
-    {
-        HdfsFreeFileBlockLocations(hdfs_locations, *block_num);
-        hdfs_locations = NULL;
-    }
+    LWLockRelease(MetadataCacheLock);
 
     return locations;
 }
 
+/*
+ *  Check whether metadata cache has an entry for the file, whatever its size
+ */
+bool
+HdfsFileBlockLocationsCached(const HdfsFileInfo *file_info)
+{
+    bool found;
+
+    LWLockAcquire(MetadataCacheLock, LW_SHARED);
+    found = (MetadataCacheExists(file_info) != NULL);
+    LWLockRelease(MetadataCacheLock);
+
+    return found;
+}
+
 /*
  *  Get hdfs file block locations from metadata cache 
  */
@@ -791,6 +1139,11 @@ GetHdfsFileBlockLocationsFromCache(MetadataCacheEntry *entry, uint64_t filesize,
     }
 
     entry->last_access_time = time(NULL);
+    entry->access_count++;
+    if (entry->usage_count < METADATA_CACHE_MAX_USAGE)
+    {
+        entry->usage_count++;
+    }
 
     return locations;
 
@@ -804,34 +1157,39 @@ err:
  *  Get hdfs block locations from cache and fetch extra part from hadoop hdfs
  */
 BlockLocation *
-AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *file_info, MetadataCacheEntry *entry, uint64_t filesize, int *block_num, double *hit_ratio)
+AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *file_info, MetadataCacheEntry *entry, uint64_t filesize, int *block_num, double *hit_ratio, uint64_t begin_time)
 {
     Insist(file_info != NULL);
     Insist(entry != NULL);
-    Insist(entry->block_num > 1);
-    Insist(entry->file_size < filesize);
     
     int block_size = 0;
     uint64_t entry_file_size = 0;
+    uint64_t fetch_time = 0;
     BlockLocation *hdfs_locations = NULL; 
     BlockLocation *locations_from_cache = NULL; 
     BlockLocation *locations_from_hdfs = NULL;
-    BlockLocation *locations;
+    BlockLocation *locations = NULL;
     uint32_t extra_first_block_id = 0;
     uint32_t extra_last_block_id = 0;
     uint32_t extra_block_num = 0;
     int i, j;
-    int hit_block_num = entry->block_num;
+    int hit_block_num = 0;
 
     LWLockAcquire(MetadataCacheLock, LW_SHARED);
 
+    Insist(entry->block_num > 1);
+    Insist(entry->file_size < filesize);
+
     block_size = GET_BLOCK(entry->first_block_id)->length;
     entry_file_size = entry->file_size;
+    hit_block_num = entry->block_num;
 
     LWLockRelease(MetadataCacheLock);
    
     // 1. fetch extra hdfs block locations
+    fetch_time = MetadataCacheGetTime();
     hdfs_locations = HdfsGetFileBlockLocations2(file_info->filepath, entry_file_size, filesize - entry_file_size, block_num);
+    fetch_time = MetadataCacheGetTime() - fetch_time;
     if (!hdfs_locations)
     {
         elog(DEBUG1, "[MetadataCache] AppendHdfsFileBlockLocationsToCache fetch extra hdfs block locations fail. \
@@ -840,7 +1198,8 @@ AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *file_info, MetadataCache
                             entry_file_size, 
                             filesize, 
                             *block_num);
-        goto done;
+        *hit_ratio = 0;
+        return NULL;
     }
     
     elog(DEBUG1, "[MetadataCache] AppendHdfsFileBlockLocationsToCache fetch extra hdfs block locations successfully. \
@@ -852,6 +1211,17 @@ AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *file_info, MetadataCache
    
     LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
 
+    // the entry may have been evicted or refreshed while the lock was released
+    entry = MetadataCacheExists(file_info);
+    if (NULL == entry || entry->file_size != entry_file_size)
+    {
+        LWLockRelease(MetadataCacheLock);
+        HdfsFreeFileBlockLocations(hdfs_locations, *block_num);
+
+        *hit_ratio = 0;
+        return GetHdfsFileBlockLocationsNoCache(file_info, filesize, block_num, begin_time);
+    }
+
     locations_from_cache = GetHdfsFileBlockLocationsFromCache(entry, entry->file_size, (int *)&entry->block_num);
     locations_from_hdfs = CreateHdfsFileBlockLocations(hdfs_locations, *block_num);
 
@@ -871,7 +1241,7 @@ AppendHdfsFileBlockLocationsToCache(const HdfsFileInfo *file_info, MetadataCache
     FreeHdfsFileBlockLocations(locations_from_cache, entry->block_num);
     FreeHdfsFileBlockLocations(locations_from_hdfs, *block_num);
 
-    if (*block_num > FREE_BLOCK_NUM)
+    if (*block_num > FREE_BLOCK_NUM && !MetadataCacheEvict(*block_num, &entry->key))
     {
         elog(DEBUG1, "[MetadataCache] AppendHdfsFileBlockLocationsToCache not enough free block. \
                         filename:%s filesize:"INT64_FORMAT","INT64_FORMAT" block_num:%d",
@@ -932,6 +1302,7 @@ done:
     
     *block_num = entry->block_num;
     *hit_ratio = (hit_block_num * 1.0) / (*block_num);
+    MetadataCacheRecordLookup(&entry->key, METADATA_CACHE_LOOKUP_PARTIAL_HIT, MetadataCacheGetTime() - begin_time, fetch_time);
     LWLockRelease(MetadataCacheLock);
 
     return locations;
@@ -1110,7 +1481,14 @@ MetadataCacheNew(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation
     int i, j;
     MetadataCacheEntry *entry = NULL;
 
-    if (block_num > FREE_BLOCK_NUM)
+    // the blocks of an existing entry are replaced
+    entry = MetadataCacheExists(file_info);
+    if (entry)
+    {
+        MetadataCacheRemoveEntry(entry);
+    }
+
+    if ((block_num > FREE_BLOCK_NUM || FREE_SLOT_HEAD == END_OF_SLOT) && !MetadataCacheEvict(block_num, NULL))
     {
         elog(DEBUG1, "[Metadata] MetadataCacheNew not enough free block. \
                     filename:%s filesize:"INT64_FORMAT" block_num:%d free_block_num:%d",
@@ -1134,6 +1512,10 @@ MetadataCacheNew(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation
 
     entry->file_size = filesize;
     entry->block_num = block_num;
+    entry->last_access_time = entry->create_time = time(NULL);
+    entry->clock_slot = AllocMetadataCacheSlot(&entry->key);
+    entry->usage_count = 1;
+    entry->access_count = 0;
     
     AllocMetadataBlock(entry->block_num, &entry->first_block_id, &entry->last_block_id);
 
@@ -1174,8 +1556,7 @@ RemoveHdfsFileBlockLocations(const HdfsFileInfo *file_info)
         elog(DEBUG1, "[Metadata] RemoveHdfsFileBlockLocations, filename:%s block_num:%d", 
                     file_info->filepath,
                     entry->block_num); 
-        ReleaseMetadataBlock(entry->block_num, entry->first_block_id, entry->last_block_id);
-        MetadataCacheRemove(file_info);
+        MetadataCacheRemoveEntry(entry);
     }
 }
 
@@ -1189,7 +1570,6 @@ extern Datum gp_metadata_cache_clear(PG_FUNCTION_ARGS)
 {
     HASH_SEQ_STATUS hstat;
     MetadataCacheEntry *entry;
-    bool found;
     long entry_num = 0;
 
     LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
@@ -1204,8 +1584,7 @@ extern Datum gp_metadata_cache_clear(PG_FUNCTION_ARGS)
     hash_seq_init(&hstat, MetadataCache);
     while ((entry = (MetadataCacheEntry *)hash_seq_search(&hstat)) != NULL)
     {
-        ReleaseMetadataBlock(entry->block_num, entry->first_block_id, entry->last_block_id);
-        hash_search(MetadataCache, (void *)&entry->key, HASH_REMOVE, &found);
+        MetadataCacheRemoveEntry(entry);
     }
     
     LWLockRelease(MetadataCacheLock);
@@ -1314,3 +1693,174 @@ extern Datum gp_metadata_cache_info(PG_FUNCTION_ARGS)
     PG_RETURN_TEXT_P(cstring_to_text(message));    
 }
 
+/*
+ *  Metadata Cache UDF
+ *
+ *  Get statistics of metadata cache per relation. The time spent in lookups is
+ *  the contribution of the cache to planning latency, the time spent in refreshes
+ *  is spent by metadata cache process. Relations beyond the capacity of the
+ *  statistics hash table are accounted together with zero oids.
+ */
+typedef struct MetadataCacheStatRow
+{
+    MetadataCacheStatEntry  stat;
+    int64                   cached_files;
+    int64                   cached_blocks;
+} MetadataCacheStatRow;
+
+#define METADATA_CACHE_STAT_COLS    13
+
+extern Datum gp_metadata_cache_stats(PG_FUNCTION_ARGS)
+{
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    TupleDesc tupdesc;
+    Tuplestorestate *tupstore;
+    MemoryContext per_query_ctx;
+    MemoryContext oldcontext;
+    HASHCTL info;
+    HTAB *rows;
+    HASH_SEQ_STATUS hstat;
+    MetadataCacheStatEntry *stat;
+    MetadataCacheEntry *entry;
+    MetadataCacheStatRow *row;
+    bool found;
+
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+    if (!(rsinfo->allowedModes & SFRM_Materialize))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("materialize mode required, but it is not allowed in this context")));
+
+    per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+    oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+    /* This must match the definition of gp_metadata_cache_stats view in system_views.sql */
+    tupdesc = CreateTemplateTupleDesc(METADATA_CACHE_STAT_COLS, false);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 1, "tablespace", OIDOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 2, "database", OIDOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 3, "relfilenode", OIDOID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 4, "cached_files", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 5, "cached_blocks", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 6, "hits", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 7, "partial_hits", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 8, "misses", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 9, "evictions", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 10, "refreshes", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 11, "lookup_time", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 12, "fetch_time", INT8OID, -1, 0);
+    TupleDescInitEntry(tupdesc, (AttrNumber) 13, "refresh_time", INT8OID, -1, 0);
+
+    tupstore = tuplestore_begin_heap(true, false, work_mem);
+
+    MemSet(&info, 0, sizeof(info));
+    info.keysize = sizeof(MetadataCacheStatKey);
+    info.entrysize = sizeof(MetadataCacheStatRow);
+    info.hash = tag_hash;
+    info.hcxt = per_query_ctx;
+    rows = hash_create("Metadata Cache Statistics Rows", MAX_METADATA_CACHE_STAT_NUM, &info,
+                        HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+    // copy the statistics and count cached files to their relations
+    LWLockAcquire(MetadataCacheLock, LW_SHARED);
+
+    hash_seq_init(&hstat, MetadataCacheStat);
+    while ((stat = (MetadataCacheStatEntry *)hash_seq_search(&hstat)) != NULL)
+    {
+        row = (MetadataCacheStatRow *)hash_search(rows, (void *)&stat->key, HASH_ENTER, &found);
+        row->stat = *stat;
+        row->cached_files = 0;
+        row->cached_blocks = 0;
+    }
+
+    hash_seq_init(&hstat, MetadataCache);
+    while ((entry = (MetadataCacheEntry *)hash_seq_search(&hstat)) != NULL)
+    {
+        MetadataCacheStatKey key;
+
+        MemSet(&key, 0, sizeof(key));
+        key.tablespace_oid = entry->key.tablespace_oid;
+        key.database_oid = entry->key.database_oid;
+        key.relation_oid = entry->key.relation_oid;
+
+        row = (MetadataCacheStatRow *)hash_search(rows, (void *)&key, HASH_ENTER, &found);
+        if (!found)
+        {
+            MemSet(row, 0, sizeof(MetadataCacheStatRow));
+            row->stat.key = key;
+        }
+        row->cached_files++;
+        row->cached_blocks += entry->block_num;
+    }
+
+    LWLockRelease(MetadataCacheLock);
+
+    hash_seq_init(&hstat, rows);
+    while ((row = (MetadataCacheStatRow *)hash_seq_search(&hstat)) != NULL)
+    {
+        Datum values[METADATA_CACHE_STAT_COLS];
+        bool nulls[METADATA_CACHE_STAT_COLS];
+        HeapTuple tuple;
+
+        MemSet(nulls, 0, sizeof(nulls));
+        values[0] = ObjectIdGetDatum(row->stat.key.tablespace_oid);
+        values[1] = ObjectIdGetDatum(row->stat.key.database_oid);
+        values[2] = ObjectIdGetDatum(row->stat.key.relation_oid);
+        values[3] = Int64GetDatum(row->cached_files);
+        values[4] = Int64GetDatum(row->cached_blocks);
+        values[5] = Int64GetDatum(row->stat.hits);
+        values[6] = Int64GetDatum(row->stat.partial_hits);
+        values[7] = Int64GetDatum(row->stat.misses);
+        values[8] = Int64GetDatum(row->stat.evictions);
+        values[9] = Int64GetDatum(row->stat.refreshes);
+        values[10] = Int64GetDatum(row->stat.lookup_time);
+        values[11] = Int64GetDatum(row->stat.fetch_time);
+        values[12] = Int64GetDatum(row->stat.refresh_time);
+
+        tuple = heap_form_tuple(tupdesc, values, nulls);
+        tuplestore_puttuple(tupstore, tuple);
+    }
+
+    hash_destroy(rows);
+
+    tuplestore_donestoring(tupstore);
+
+    MemoryContextSwitchTo(oldcontext);
+
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+
+    return (Datum) 0;
+}
+
+/*
+ *  Metadata Cache UDF
+ *
+ *  Reset statistics of metadata cache
+ */
+extern Datum gp_metadata_cache_stats_reset(PG_FUNCTION_ARGS)
+{
+    HASH_SEQ_STATUS hstat;
+    MetadataCacheStatEntry *stat;
+    bool found;
+    long entry_num = 0;
+
+    LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
+
+    entry_num = hash_get_num_entries(MetadataCacheStat);
+
+    hash_seq_init(&hstat, MetadataCacheStat);
+    while ((stat = (MetadataCacheStatEntry *)hash_seq_search(&hstat)) != NULL)
+    {
+        hash_search(MetadataCacheStat, (void *)&stat->key, HASH_REMOVE, &found);
+    }
+
+    LWLockRelease(MetadataCacheLock);
+
+    char message[1024] = {0};
+    snprintf(message, 1024, "Metadata cache statistics reset %ld items", entry_num);
+    PG_RETURN_TEXT_P(cstring_to_text(message));
+}
@@ -44,6 +44,7 @@
 #include "funcapi.h"
 #include "fmgr.h"
 #include "utils/builtins.h"
+#include "portability/instr_time.h"
 
 /*
  * Metadata Cache Process Functions
@@ -57,9 +58,6 @@ InitMetadataCacheMemoryContext(void);
 static void 
 MetadataCacheServerLoop(void);
 
-static void
-GenerateMetadataCacheLRUList(void);
-
 static void
 GenerateMetadataCacheRefreshList(void);
 
@@ -70,14 +68,13 @@ static void
 ProcessMetadataCacheRefresh(void);
 
 static int
-CompareMetadataCacheEntryByLastAccessTime(const void *e1, const void *e2);
+CompareMetadataCacheCheckInfoByAccessCount(const void *e1, const void *e2);
 
 extern bool 
 FindMyDatabase(const char *name, Oid *db_id, Oid *db_tablespace);
 
 static MemoryContext            MetadataCacheMemoryContext = NULL;
 
-List                     *MetadataCacheLRUList = NULL;
 List                     *MetadataCacheRefreshList = NULL;
 
 static volatile bool            shutdown_requested = false;
@@ -302,67 +299,44 @@ InitMetadataCacheMemoryContext(void)
     return;
 }
 
-void
-GenerateMetadataCacheLRUList()
-{
-    HASH_SEQ_STATUS hstat;
-    MetadataCacheEntry *entry;
-    long cache_entry_num = hash_get_num_entries(MetadataCache);
-
-    LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
-
-    if (MetadataCacheLRUList)
-    {
-        list_free_deep(MetadataCacheLRUList);
-        MetadataCacheLRUList = NULL;
-    }
-
-    MetadataCacheEntry** entry_vector = (MetadataCacheEntry**)palloc(sizeof(MetadataCacheEntry*) * cache_entry_num);   
-
-    int i=0;
-    hash_seq_init(&hstat, MetadataCache);
-    while ((entry = (MetadataCacheEntry *)hash_seq_search(&hstat)) != NULL)
-    {
-        entry_vector[i++] = entry; 
-    }
-
-    qsort(entry_vector, cache_entry_num, sizeof(MetadataCacheEntry*), CompareMetadataCacheEntryByLastAccessTime);
-
-    for (i=0;i<cache_entry_num;i++) 
-    {
-        MetadataCacheCheckInfo *check_info = (MetadataCacheCheckInfo *)palloc(sizeof(MetadataCacheCheckInfo));
-        check_info->key = entry_vector[i]->key;
-        check_info->file_size = entry_vector[i]->file_size;
-        check_info->block_num = entry_vector[i]->block_num;
-        check_info->create_time = entry_vector[i]->create_time;
-        check_info->last_access_time = entry_vector[i]->last_access_time;
-        MetadataCacheLRUList = lappend(MetadataCacheLRUList, check_info);
-    }
-
-    pfree(entry_vector);
-
-    LWLockRelease(MetadataCacheLock);
-}
-
+/*
+ * Entries accessed since they were filled are hot, they are refreshed one
+ * refresh interval ahead of the timeout so that lookups keep hitting them,
+ * the hottest first. Expired entries which nobody accessed are removed
+ * instead of refreshed.
+ */
 void
 GenerateMetadataCacheRefreshList()
 {
     HASH_SEQ_STATUS hstat;
     MetadataCacheEntry *entry;
+    MetadataCacheCheckInfo **refresh_vector;
     uint32_t cur_time = time(NULL);
+    uint32_t refresh_ahead_time;
+    int refresh_num = 0;
+    int total_remove_files = 0;
+    int i;
     
     if (MetadataCacheRefreshList)
     {
         list_free_deep(MetadataCacheRefreshList);
         MetadataCacheRefreshList = NULL;
     }
+
+    refresh_ahead_time = 0;
+    if (metadata_cache_refresh_timeout > metadata_cache_refresh_interval)
+    {
+        refresh_ahead_time = metadata_cache_refresh_timeout - metadata_cache_refresh_interval;
+    }
     
     LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
+
+    refresh_vector = (MetadataCacheCheckInfo **)palloc(sizeof(MetadataCacheCheckInfo *) * (hash_get_num_entries(MetadataCache) + 1));
     
     hash_seq_init(&hstat, MetadataCache);
     while ((entry = (MetadataCacheEntry *)hash_seq_search(&hstat)) != NULL)
     {
-        if (cur_time - entry->create_time >= metadata_cache_refresh_timeout)
+        if (entry->access_count > 0 && cur_time - entry->create_time >= refresh_ahead_time)
         {
             MetadataCacheCheckInfo *refresh_info = (MetadataCacheCheckInfo *)palloc(sizeof(MetadataCacheCheckInfo));
             refresh_info->key = entry->key;
@@ -370,25 +344,44 @@ GenerateMetadataCacheRefreshList()
             refresh_info->block_num = entry->block_num;
             refresh_info->create_time = entry->create_time;
             refresh_info->last_access_time = entry->last_access_time;
-            MetadataCacheRefreshList = lappend(MetadataCacheRefreshList, refresh_info);
-            if (list_length(MetadataCacheRefreshList) >= metadata_cache_refresh_max_num)
-            {
-                break;
-            }
+            refresh_info->access_count = entry->access_count;
+            refresh_vector[refresh_num++] = refresh_info;
+        }
+        else if (cur_time - entry->create_time >= metadata_cache_refresh_timeout)
+        {
+            MetadataCacheRemoveEntry(entry);
+            total_remove_files++;
         }
     }
 
     LWLockRelease(MetadataCacheLock);
+
+    qsort(refresh_vector, refresh_num, sizeof(MetadataCacheCheckInfo *), CompareMetadataCacheCheckInfoByAccessCount);
+
+    for (i=0;i<refresh_num;i++)
+    {
+        if (i < metadata_cache_refresh_max_num)
+        {
+            MetadataCacheRefreshList = lappend(MetadataCacheRefreshList, refresh_vector[i]);
+        }
+        else
+        {
+            pfree(refresh_vector[i]);
+        }
+    }
+
+    pfree(refresh_vector);
     
-    elog(DEBUG1, "[MetadataCache] ProcessMetadataCacheRefresh, get refresh list:%d", list_length(MetadataCacheRefreshList));
+    elog(DEBUG1, "[MetadataCache] ProcessMetadataCacheRefresh, get refresh list:%d remove files:%d",
+                    list_length(MetadataCacheRefreshList),
+                    total_remove_files);
 }
 
 void 
 ProcessMetadataCacheCheck()
 {
-    ListCell *lc;
-    RelFileNode rnode;
-    HdfsFileInfo *file_info;
+    uint32_t normal_free_block_num;
+    long total_remove_files;
 
     double free_block_ratio = (FREE_BLOCK_NUM * 1.0) / metadata_cache_block_capacity;
 
@@ -396,39 +389,17 @@ ProcessMetadataCacheCheck()
 
     if (free_block_ratio < metadata_cache_free_block_max_ratio)
     {
-        if (NULL == MetadataCacheLRUList) 
-        {
-            GenerateMetadataCacheLRUList();
-        }
+        normal_free_block_num = metadata_cache_block_capacity * metadata_cache_free_block_normal_ratio;
 
-        int total_remove_files = 0;
         LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
 
-        foreach(lc, MetadataCacheLRUList)
-        {
-            MetadataCacheCheckInfo *check_info = (MetadataCacheCheckInfo *)lfirst(lc);
-
-            rnode.spcNode = check_info->key.tablespace_oid;
-            rnode.dbNode = check_info->key.database_oid;
-            rnode.relNode = check_info->key.relation_oid;
-
-            file_info = CreateHdfsFileInfo(rnode, check_info->key.segno);
-            RemoveHdfsFileBlockLocations(file_info);
-            DestroyHdfsFileInfo(file_info);
-            total_remove_files++;
-
-            if (((FREE_BLOCK_NUM * 1.0) / metadata_cache_block_capacity) >= metadata_cache_free_block_normal_ratio)
-            {
-                break;
-            }
-        }
-    
-        list_free_deep(MetadataCacheLRUList);
-        MetadataCacheLRUList = NULL;
+        total_remove_files = hash_get_num_entries(MetadataCache);
+        MetadataCacheEvict(normal_free_block_num, NULL);
+        total_remove_files -= hash_get_num_entries(MetadataCache);
 
         LWLockRelease(MetadataCacheLock);
             
-        elog(DEBUG1, "[MetadataCache] ProcessMetadataCacheCheck, total remove files:%d", total_remove_files);
+        elog(DEBUG1, "[MetadataCache] ProcessMetadataCacheCheck, total remove files:%ld", total_remove_files);
     }
 }
 
@@ -438,6 +409,8 @@ ProcessMetadataCacheRefresh()
     ListCell *lc;
     BlockLocation *hdfs_locations;
     int block_num;
+    instr_time fetch_begin;
+    instr_time fetch_end;
 
     if (NULL == MetadataCacheRefreshList)
     {
@@ -455,9 +428,13 @@ ProcessMetadataCacheRefresh()
 
         HdfsFileInfo *file_info = CreateHdfsFileInfo(rnode, refresh_file->key.segno);
 
+        INSTR_TIME_SET_CURRENT(fetch_begin);
         hdfs_locations = HdfsGetFileBlockLocations(file_info->filepath, refresh_file->file_size, &block_num);
+        INSTR_TIME_SET_CURRENT(fetch_end);
+        INSTR_TIME_SUBTRACT(fetch_end, fetch_begin);
     
         LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
+        MetadataCacheRecordRefresh(&refresh_file->key, INSTR_TIME_GET_MICROSEC(fetch_end));
         if (!hdfs_locations)
         {
             // error file, delete
@@ -491,20 +468,24 @@ ProcessMetadataCacheRefresh()
 
         DestroyHdfsFileInfo(file_info);
     }
+
+    // regenerate the list at next refresh time
+    list_free_deep(MetadataCacheRefreshList);
+    MetadataCacheRefreshList = NULL;
 }
 
 int
-CompareMetadataCacheEntryByLastAccessTime(const void *e1, const void *e2)
+CompareMetadataCacheCheckInfoByAccessCount(const void *e1, const void *e2)
 {
-    MetadataCacheEntry **ce1 = (MetadataCacheEntry**)e1;
-    MetadataCacheEntry **ce2 = (MetadataCacheEntry**)e2;
+    MetadataCacheCheckInfo **ci1 = (MetadataCacheCheckInfo**)e1;
+    MetadataCacheCheckInfo **ci2 = (MetadataCacheCheckInfo**)e2;
     
-    if ((*ce1)->last_access_time < (*ce2)->last_access_time)
+    if ((*ci1)->access_count > (*ci2)->access_count)
     {
         return -1;
     }
 
-    if ((*ce1)->last_access_time > (*ce2)->last_access_time)
+    if ((*ci1)->access_count < (*ci2)->access_count)
     {
         return 1;
     }
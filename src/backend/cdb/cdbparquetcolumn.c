@@ -11,6 +11,7 @@
 #include "utils/timestamp.h"
 #include "utils/geo_decls.h"
 #include "utils/memutils.h"
+#include "utils/guc.h"
 
 #include "snappy-c.h"
 #include "zlib.h"
@@ -18,12 +19,36 @@
 #define BUFFER_SCALE_FACTOR	1.2
 #define BUFFER_SIZE_LIMIT_BEFORE_SCALED ((Size) ((MaxAllocSize) * 1.0 / (BUFFER_SCALE_FACTOR))) 
 
+/* bytes first tried when deserializing a page header in streaming mode */
+#define PAGE_HEADER_READ_SIZE	256
+
 static void consume(ParquetColumnReader *columnReader);
+static bool advanceToNextPage(ParquetColumnReader *columnReader);
+static bool readNextStreamingPage(ParquetColumnReader *columnReader);
+static int32 fillWindow(ParquetColumnReader *columnReader, int32 nbytes);
+static void reserveWindow(ParquetColumnReader *columnReader, int32 nbytes);
+static int compareReaderOffset(const void *a, const void *b);
+static void startReadAhead(ParquetColumnReader *columnReader);
+static void freePageReaders(ParquetDataPage page);
 static void readRepetitionAndDefinitionLevels(ParquetColumnReader *columnReader);
 static void decodeCurrentPage(ParquetColumnReader *columnReader);
+static void decompressPage(ColumnChunkMetadata_4C *chunkmd, ParquetPageHeader header,
+						   uint8_t *src, uint8_t *dst, int pageNumber);
+static void readDictionaryPage(ParquetColumnReader *columnReader,
+							   ParquetPageHeader header, uint8_t *data);
 
 static bool decodePlain(Datum *value, uint8_t **buffer, int hawqTypeID);
 
+static Datum readDictionaryValue(ParquetColumnReader *columnReader);
+
+static int readBatchNulls(ParquetDataPage page, int maxDefinitionLevel,
+						  bool *nulls, int count);
+static void decodeBatch(ParquetDataPage page, Datum *values, bool *nulls,
+						int count, int numNotNull, int hawqTypeID);
+
+/* number of definition levels decoded at a time by readBatchNulls */
+#define DEFINITION_LEVEL_BATCH_SIZE 256
+
 /* return size of PATH struct given number of points in it */
 static inline int get_path_size(int npts) { return offsetof(PATH, p[0]) + sizeof(Point) * npts; }
 
@@ -35,10 +60,50 @@ ParquetExecutorReadColumn(ParquetColumnReader *columnReader, File file)
 {
 	struct ColumnChunkMetadata_4C* columnChunkMetadata = columnReader->columnMetadata;
 
-	int64 firstPageOffset = columnChunkMetadata->firstDataPage;
+	/* dictionary page, if any, is the first page of column chunk */
+	int64 firstPageOffset = columnChunkMetadata->dictionaryPageOffset > 0 ?
+							columnChunkMetadata->dictionaryPageOffset :
+							columnChunkMetadata->firstDataPage;
 
 	int64 columnChunkSize = columnChunkMetadata->totalSize;
 
+	MemoryContext oldContext = MemoryContextSwitchTo(columnReader->memoryContext);
+
+	/*only if first column reader set, just need palloc the data pages*/
+	if(columnReader->dataPageCapacity == 0)
+	{
+		columnReader->dataPageCapacity = DAFAULT_DATAPAGE_NUM_PER_COLUMNCHUNK;
+		columnReader->dataPageNum = 0;
+		columnReader->dataPages = (ParquetDataPage)palloc0
+			(columnReader->dataPageCapacity *sizeof(struct ParquetDataPage_S));
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	columnReader->currentPageValueRemained = 0;	/* indicate to read next page */
+	columnReader->dataPageProcessed = 0;
+
+	/*
+	 * non-repeatable column streams its pages through a bounded window,
+	 * nothing is read until the first value is asked for.
+	 */
+	if (columnChunkMetadata->r == 0)
+	{
+		columnReader->streaming				= true;
+		columnReader->file					= file;
+		columnReader->fileOffset			= firstPageOffset;
+		columnReader->chunkBytesRemained	= columnChunkSize;
+		columnReader->chunkValuesRemained	= columnChunkMetadata->valueCount;
+		columnReader->windowStart			= 0;
+		columnReader->windowEnd				= 0;
+
+		/* the first windows of all projected columns are read in parallel */
+		startReadAhead(columnReader);
+		return;
+	}
+
+	columnReader->streaming = false;
+
 	if ( columnChunkSize > MaxAllocSize ) 
 	{
         ereport(ERROR,
@@ -49,7 +114,7 @@ ParquetExecutorReadColumn(ParquetColumnReader *columnReader, File file)
 
 	int64 actualReadSize = 0;
 
-	MemoryContext oldContext = MemoryContextSwitchTo(columnReader->memoryContext);
+	oldContext = MemoryContextSwitchTo(columnReader->memoryContext);
 
 	/*reuse the column reader data buffer to avoid memory re-allocation*/
 	if(columnReader->dataLen == 0)
@@ -76,37 +141,14 @@ ParquetExecutorReadColumn(ParquetColumnReader *columnReader, File file)
 
 	int64 numValuesProcessed = 0;
 
-	/*seek to the beginning of the column chunk*/
-	int64 seekResult = FileSeek(file, firstPageOffset, SEEK_SET);
-	if (seekResult != firstPageOffset)
+	/*read out the whole column chunk, without moving the file position*/
+	actualReadSize = FilePread(file, buffer, columnChunkSize, firstPageOffset);
+	if (actualReadSize != columnChunkSize)
 	{
 		ereport(ERROR,
 				(errcode_for_file_access(),
-				 errmsg("file seek error to position " INT64_FORMAT ": %s", firstPageOffset, strerror(errno)),
-				 errdetail("%s", HdfsGetLastError())));
-	}
-
-	/*recursively read, until get the total column chunk data out*/
-	while(actualReadSize < columnChunkSize)
-	{
-		/*read out all the buffer of the column chunk*/
-		int columnChunkLen = FileRead(file, buffer + actualReadSize, columnChunkSize - actualReadSize);
-		if (columnChunkLen < 0) {
-			ereport(ERROR,
-					(errcode_for_file_access(),
-							errmsg("parquet storage read error on reading column %s ", columnChunkMetadata->colName),
-							errdetail("%s", HdfsGetLastError())));
-		}
-		actualReadSize += columnChunkLen;
-	}
-
-	/*only if first column reader set, just need palloc the data pages*/
-	if(columnReader->dataPageCapacity == 0)
-	{
-		columnReader->dataPageCapacity = DAFAULT_DATAPAGE_NUM_PER_COLUMNCHUNK;
-		columnReader->dataPageNum = 0;
-		columnReader->dataPages = (ParquetDataPage)palloc0
-			(columnReader->dataPageCapacity *sizeof(struct ParquetDataPage_S));
+						errmsg("parquet storage read error on reading column %s ", columnChunkMetadata->colName),
+						errdetail("%s", HdfsGetLastError())));
 	}
 
 	/* read all the data pages of the column chunk */
@@ -125,7 +167,15 @@ ParquetExecutorReadColumn(ParquetColumnReader *columnReader, File file)
 
 		buffer += header_size;
 
-		/*just process data page now*/
+		if (pageHeader->page_type == DICTIONARY_PAGE)
+		{
+			readDictionaryPage(columnReader, pageHeader, (uint8_t *) buffer);
+			buffer += pageHeader->compressed_page_size;
+			pfree(pageHeader);
+			continue;
+		}
+
+		/*skip other pages (e.g. index page)*/
 		if(pageHeader->page_type != DATA_PAGE){
 			buffer += pageHeader->compressed_page_size;
 			continue;
@@ -155,13 +205,347 @@ ParquetExecutorReadColumn(ParquetColumnReader *columnReader, File file)
 
 	MemoryContextSwitchTo(oldContext);
 
-	columnReader->currentPageValueRemained = 0;	/* indicate to read next page */
-	columnReader->dataPageProcessed = 0;
+	consume(columnReader);
+}
+
+/*
+ * Prepare readers of all column chunks of a row group.
+ *
+ * The first windows of streaming columns, which are not being read ahead,
+ * are read here in one vectored read instead of a seek and read per column
+ * later on.
+ */
+void
+ParquetExecutorReadColumns(ParquetColumnReader *columnReaders, int count,
+						   File file)
+{
+	FileReadRange *ranges;
+	ParquetColumnReader **rangeReaders;
+	int			nranges = 0;
+
+	for (int i = 0; i < count; i++)
+		ParquetExecutorReadColumn(&columnReaders[i], file);
 
-	if (columnChunkMetadata->r > 0)
+	ranges = (FileReadRange *) palloc(count * sizeof(FileReadRange));
+	rangeReaders = (ParquetColumnReader **) palloc(count * sizeof(ParquetColumnReader *));
+
+	for (int i = 0; i < count; i++)
 	{
-		consume(columnReader);
+		ParquetColumnReader *columnReader = &columnReaders[i];
+
+		if (!columnReader->streaming || columnReader->chunkBytesRemained == 0)
+			continue;
+		if (columnReader->prefetch != NULL &&
+			columnReader->prefetch->state != PREFETCH_IDLE)
+			continue;
+
+		rangeReaders[nranges++] = columnReader;
+	}
+
+	if (nranges == 0)
+	{
+		pfree(ranges);
+		pfree(rangeReaders);
+		return;
+	}
+
+	/* in file order, so that adjacent column chunks need no seek */
+	qsort(rangeReaders, nranges, sizeof(ParquetColumnReader *), compareReaderOffset);
+
+	for (int i = 0; i < nranges; i++)
+	{
+		ParquetColumnReader *columnReader = rangeReaders[i];
+
+		reserveWindow(columnReader, 0);
+
+		ranges[i].offset = columnReader->fileOffset;
+		ranges[i].buffer = columnReader->dataBuffer;
+		ranges[i].length = (int) Min(columnReader->dataLen,
+									 columnReader->chunkBytesRemained);
+		ranges[i].bytesRead = 0;
+	}
+
+	if (FilePreadv(file, ranges, nranges) != 0)
+	{
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("parquet storage read error on reading %d columns", nranges),
+				 errdetail("%s", HdfsGetLastError())));
+	}
+
+	for (int i = 0; i < nranges; i++)
+	{
+		ParquetColumnReader *columnReader = rangeReaders[i];
+
+		if (ranges[i].bytesRead != ranges[i].length)
+		{
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("parquet storage read error on reading column %s ",
+							 columnReader->columnMetadata->colName),
+					 errdetail("%s", HdfsGetLastError())));
+		}
+
+		columnReader->fileOffset += ranges[i].length;
+		columnReader->chunkBytesRemained -= ranges[i].length;
+		columnReader->windowEnd = ranges[i].length;
+
+		startReadAhead(columnReader);
 	}
+
+	pfree(ranges);
+	pfree(rangeReaders);
+}
+
+static int
+compareReaderOffset(const void *a, const void *b)
+{
+	const ParquetColumnReader *ra = *(ParquetColumnReader * const *) a;
+	const ParquetColumnReader *rb = *(ParquetColumnReader * const *) b;
+
+	if (ra->fileOffset == rb->fileOffset)
+		return 0;
+	return ra->fileOffset < rb->fileOffset ? -1 : 1;
+}
+
+/*
+ * Make next data page of column chunk the current page and decode it.
+ *
+ * Return false if there is no more data page.
+ */
+static bool
+advanceToNextPage(ParquetColumnReader *columnReader)
+{
+	if (columnReader->streaming)
+	{
+		if (!readNextStreamingPage(columnReader))
+			return false;
+
+		columnReader->currentPage = &columnReader->dataPages[0];
+	}
+	else
+	{
+		if (columnReader->dataPageProcessed >= columnReader->dataPageNum)
+			return false;
+
+		columnReader->currentPage = &columnReader->dataPages[columnReader->dataPageProcessed];
+	}
+
+	decodeCurrentPage(columnReader);
+
+	columnReader->currentPageValueRemained = columnReader->currentPage->header->num_values;
+	columnReader->dataPageProcessed++;
+	return true;
+}
+
+/*
+ * Read next data page of a streaming column into the window, it replaces
+ * the previous page in dataPages[0]. Dictionary page met on the way is
+ * decoded, other pages are skipped.
+ *
+ * Return false if column chunk has no more data page.
+ */
+static bool
+readNextStreamingPage(ParquetColumnReader *columnReader)
+{
+	ColumnChunkMetadata_4C *chunkmd = columnReader->columnMetadata;
+	MemoryContext oldContext = MemoryContextSwitchTo(columnReader->memoryContext);
+
+	while (columnReader->chunkValuesRemained > 0)
+	{
+		ParquetPageHeader	pageHeader;
+		uint32_t			header_size;
+		int32				wanted = PAGE_HEADER_READ_SIZE;
+		uint8_t				*data;
+
+		/* page header has variable length, read more until it deserializes */
+		for (;;)
+		{
+			int32 available = fillWindow(columnReader, wanted);
+
+			header_size = available;
+			if (readPageMetadata((uint8_t *) columnReader->dataBuffer + columnReader->windowStart,
+								 &header_size, /*compact*/1, &pageHeader) == 0)
+				break;
+
+			pfree(pageHeader);
+			if (available < wanted)
+			{
+				ereport(ERROR, (errcode(ERRCODE_GP_INTERNAL_ERROR),
+					errmsg("thrift deserialize failure on reading page header of column %s ",
+							chunkmd->colName)));
+			}
+			wanted *= 2;
+		}
+		columnReader->windowStart += header_size;
+
+		if (fillWindow(columnReader, pageHeader->compressed_page_size) <
+			pageHeader->compressed_page_size)
+		{
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERNAL_ERROR),
+				errmsg("parquet storage read error on reading column %s: page exceeds column chunk",
+						chunkmd->colName)));
+		}
+		data = (uint8_t *) columnReader->dataBuffer + columnReader->windowStart;
+		columnReader->windowStart += pageHeader->compressed_page_size;
+
+		if (pageHeader->page_type == DICTIONARY_PAGE)
+		{
+			readDictionaryPage(columnReader, pageHeader, data);
+			pfree(pageHeader);
+			continue;
+		}
+
+		/*skip other pages (e.g. index page)*/
+		if (pageHeader->page_type != DATA_PAGE)
+		{
+			pfree(pageHeader);
+			continue;
+		}
+
+		if (columnReader->dataPageNum > 0)
+		{
+			freePageReaders(&columnReader->dataPages[0]);
+			memset(&columnReader->dataPages[0], 0, sizeof(struct ParquetDataPage_S));
+		}
+		columnReader->dataPages[0].header = pageHeader;
+		columnReader->dataPages[0].data = data;
+		columnReader->dataPageNum = 1;
+
+		columnReader->chunkValuesRemained -= pageHeader->num_values;
+
+		MemoryContextSwitchTo(oldContext);
+		return true;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+	return false;
+}
+
+/*
+ * Make sure at least `nbytes` unconsumed bytes of a streaming column are in
+ * the window, unless the column chunk ends before that.
+ *
+ * Unconsumed bytes are moved to the beginning of dataBuffer, which therefore
+ * must not be referenced by the current page any more. The window is
+ * enlarged if `nbytes` exceeds gp_parquet_scan_buffer_size.
+ *
+ * Return number of unconsumed bytes in window.
+ */
+static int32
+fillWindow(ParquetColumnReader *columnReader, int32 nbytes)
+{
+	ColumnChunkMetadata_4C *chunkmd = columnReader->columnMetadata;
+	int32 available = columnReader->windowEnd - columnReader->windowStart;
+	int64 readSize;
+	int64 actualReadSize = 0;
+
+	if (available >= nbytes || columnReader->chunkBytesRemained == 0)
+		return available;
+
+	if (columnReader->windowStart > 0)
+	{
+		memmove(columnReader->dataBuffer,
+				columnReader->dataBuffer + columnReader->windowStart,
+				available);
+		columnReader->windowStart = 0;
+		columnReader->windowEnd = available;
+	}
+
+	reserveWindow(columnReader, nbytes);
+
+	readSize = Min(columnReader->dataLen - columnReader->windowEnd,
+				   columnReader->chunkBytesRemained);
+
+	/* take what has been read ahead, read the rest synchronously */
+	if (columnReader->prefetcher != NULL)
+	{
+		actualReadSize = ParquetPrefetch_Take(columnReader->prefetcher,
+											  columnReader->prefetch,
+											  columnReader->fileOffset,
+											  columnReader->dataBuffer + columnReader->windowEnd,
+											  readSize);
+	}
+
+	if (actualReadSize < readSize)
+	{
+		int readLen = FilePread(columnReader->file,
+								columnReader->dataBuffer + columnReader->windowEnd + actualReadSize,
+								readSize - actualReadSize,
+								columnReader->fileOffset + actualReadSize);
+		if (readLen != readSize - actualReadSize)
+		{
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("parquet storage read error on reading column %s ", chunkmd->colName),
+					 errdetail("%s", HdfsGetLastError())));
+		}
+	}
+
+	columnReader->fileOffset += readSize;
+	columnReader->chunkBytesRemained -= readSize;
+	columnReader->windowEnd += readSize;
+
+	/* read the next window while this one is decoded */
+	startReadAhead(columnReader);
+
+	return columnReader->windowEnd - columnReader->windowStart;
+}
+
+/*
+ * Make dataBuffer of a streaming column hold at least a window of
+ * gp_parquet_scan_buffer_size, or `nbytes` if that is larger.
+ */
+static void
+reserveWindow(ParquetColumnReader *columnReader, int32 nbytes)
+{
+	int64 windowSize = Max((int64) gp_parquet_scan_buffer_size * 1024, nbytes);
+
+	if (windowSize > MaxAllocSize)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("parquet storage read error on reading column %s due to too large page size: %d",
+						 columnReader->columnMetadata->colName, nbytes)));
+	}
+
+	if (columnReader->dataLen < windowSize)
+	{
+		MemoryContext oldContext = MemoryContextSwitchTo(columnReader->memoryContext);
+
+		if (columnReader->dataBuffer == NULL)
+			columnReader->dataBuffer = (char *) palloc(windowSize);
+		else
+			columnReader->dataBuffer = (char *) repalloc(columnReader->dataBuffer, windowSize);
+		columnReader->dataLen = windowSize;
+
+		MemoryContextSwitchTo(oldContext);
+	}
+}
+
+/*
+ * Ask the prefetcher to read the next window of a streaming column in
+ * background. Nothing is done if read-ahead is disabled, the previous
+ * read-ahead data is not taken yet, or the memory budget is used up.
+ */
+static void
+startReadAhead(ParquetColumnReader *columnReader)
+{
+	int64 length;
+
+	if (columnReader->prefetcher == NULL || columnReader->chunkBytesRemained == 0)
+		return;
+
+	if (columnReader->prefetch == NULL)
+		columnReader->prefetch = ParquetPrefetch_CreateRequest(columnReader->prefetcher);
+
+	if (columnReader->prefetch->state != PREFETCH_IDLE)
+		return;
+
+	length = Min((int64) gp_parquet_scan_buffer_size * 1024,
+				 columnReader->chunkBytesRemained);
+	ParquetPrefetch_Start(columnReader->prefetcher, columnReader->prefetch,
+						  columnReader->fileOffset, (int32) length);
 }
 
 /*
@@ -174,19 +558,13 @@ consume(ParquetColumnReader *columnReader)
 	/* make sure we have values to read in current page */
 	if (columnReader->currentPageValueRemained == 0)
 	{
-		if (columnReader->dataPageProcessed >= columnReader->dataPageNum)
+		/* read next page */
+		if (!advanceToNextPage(columnReader))
 		{
 			/* next r must be 0 when reached chunk end */
 			columnReader->repetitionLevel = 0;
 			return;
 		}
-
-		/* read next page */
-		columnReader->currentPage = &columnReader->dataPages[columnReader->dataPageProcessed];
-		decodeCurrentPage(columnReader);
-
-		columnReader->currentPageValueRemained = columnReader->currentPage->header->num_values;
-		columnReader->dataPageProcessed++;
 	}
 
 	readRepetitionAndDefinitionLevels(columnReader);
@@ -264,89 +642,8 @@ decodeCurrentPage(ParquetColumnReader *columnReader)
 			buf = (uint8_t *) columnReader->pageBuffer;
 		}
 
-		/*
-		 * call corresponding decompress routine
-		 */
-		switch (chunkmd->codec)
-		{
-			case SNAPPY:
-			{
-				size_t uncompressedLen;
-				if (snappy_uncompressed_length((char *) page->data,
-											   header->compressed_page_size,
-											   &uncompressedLen) != SNAPPY_OK)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("invalid snappy compressed data for column %s, page number %d",
-									chunkmd->colName, columnReader->dataPageProcessed)));
-				}
-
-				Insist(uncompressedLen == header->uncompressed_page_size);
-
-				if (snappy_uncompress((char *) page->data,		header->compressed_page_size,
-									  (char *) buf,				&uncompressedLen) != SNAPPY_OK)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("failed to decompress snappy data for column %s, page number %d, "
-									"uncompressed size %d, compressed size %d",
-									chunkmd->colName, columnReader->dataPageProcessed,
-									header->uncompressed_page_size, header->compressed_page_size)));
-				}
-				
-				page->data = buf;
-				break;
-			}
-			case GZIP:
-			{
-				int ret;
-				/* 15(default windowBits for deflate) + 16(ouput GZIP header/tailer) */
-				const int windowbits = 31;
-
-				z_stream stream;
-				stream.zalloc	= Z_NULL;
-				stream.zfree	= Z_NULL;
-				stream.opaque	= Z_NULL;
-				stream.avail_in	= header->compressed_page_size;
-				stream.next_in	= (Bytef *) page->data;
-				
-				ret = inflateInit2(&stream, windowbits);
-				if (ret != Z_OK)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("zlib inflateInit2 failed: %s", stream.msg)));
-				}
-
-				size_t uncompressedLen = header->uncompressed_page_size;
-
-				stream.avail_out = uncompressedLen;
-				stream.next_out  = (Bytef *) buf;
-				ret = inflate(&stream, Z_FINISH);
-				if (ret != Z_STREAM_END)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("zlib inflate failed: %s", stream.msg)));
-				
-				}
-				/* should fill all uncompressed_page_size bytes */
-				Assert(stream.avail_out == 0);
-
-				inflateEnd(&stream);
-
-				page->data = buf;
-				break;
-			}
-			case LZO:
-				/* TODO */
-				Insist(false);
-				break;
-			default:
-				Insist(false);
-				break;
-		}
+		decompressPage(chunkmd, header, page->data, buf, columnReader->dataPageProcessed);
+		page->data = buf;
 	}
 
 	/*----------------------------------------------------------------
@@ -380,7 +677,20 @@ decodeCurrentPage(ParquetColumnReader *columnReader)
 		buf += num_definition_bytes;
 	}
 
-	if (chunkmd->type == BOOLEAN)
+	if (header->encoding == PLAIN_DICTIONARY)
+	{
+		/* values are <1-byte bit width> + <RLE encoded dictionary indexes> */
+		uint8_t *pageEnd = page->data + header->uncompressed_page_size;
+		int bitWidth = *buf;
+		buf += 1;
+
+		page->dictionary_index_reader = (RLEDecoder *) palloc0(sizeof(RLEDecoder));
+		RLEDecoder_Init(page->dictionary_index_reader,
+						bitWidth,
+						buf,
+						pageEnd - buf);
+	}
+	else if (chunkmd->type == BOOLEAN)
 	{
 		page->bool_values_reader = (ByteBasedBitPackingDecoder *)
 				palloc0(sizeof(ByteBasedBitPackingDecoder));
@@ -394,6 +704,152 @@ decodeCurrentPage(ParquetColumnReader *columnReader)
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Decompress page data from `src` into `dst`, which should be large enough
+ * for uncompressed_page_size bytes.
+ */
+static void
+decompressPage(ColumnChunkMetadata_4C *chunkmd, ParquetPageHeader header,
+			   uint8_t *src, uint8_t *dst, int pageNumber)
+{
+	switch (chunkmd->codec)
+	{
+		case SNAPPY:
+		{
+			size_t uncompressedLen;
+			if (snappy_uncompressed_length((char *) src,
+										   header->compressed_page_size,
+										   &uncompressedLen) != SNAPPY_OK)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("invalid snappy compressed data for column %s, page number %d",
+								chunkmd->colName, pageNumber)));
+			}
+
+			Insist(uncompressedLen == header->uncompressed_page_size);
+
+			if (snappy_uncompress((char *) src,		header->compressed_page_size,
+								  (char *) dst,				&uncompressedLen) != SNAPPY_OK)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("failed to decompress snappy data for column %s, page number %d, "
+								"uncompressed size %d, compressed size %d",
+								chunkmd->colName, pageNumber,
+								header->uncompressed_page_size, header->compressed_page_size)));
+			}
+
+			break;
+		}
+		case GZIP:
+		{
+			int ret;
+			/* 15(default windowBits for deflate) + 16(ouput GZIP header/tailer) */
+			const int windowbits = 31;
+
+			z_stream stream;
+			stream.zalloc	= Z_NULL;
+			stream.zfree	= Z_NULL;
+			stream.opaque	= Z_NULL;
+			stream.avail_in	= header->compressed_page_size;
+			stream.next_in	= (Bytef *) src;
+			
+			ret = inflateInit2(&stream, windowbits);
+			if (ret != Z_OK)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("zlib inflateInit2 failed: %s", stream.msg)));
+			}
+
+			size_t uncompressedLen = header->uncompressed_page_size;
+
+			stream.avail_out = uncompressedLen;
+			stream.next_out  = (Bytef *) dst;
+			ret = inflate(&stream, Z_FINISH);
+			if (ret != Z_STREAM_END)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("zlib inflate failed: %s", stream.msg)));
+			
+			}
+			/* should fill all uncompressed_page_size bytes */
+			Assert(stream.avail_out == 0);
+
+			inflateEnd(&stream);
+
+			break;
+		}
+		case LZO:
+			/* TODO */
+			Insist(false);
+			break;
+		default:
+			Insist(false);
+			break;
+	}
+}
+
+/*
+ * Decode the dictionary page of a column chunk. Dictionary values are
+ * PLAIN encoded, each of them is decoded once into `dictionary` here, and
+ * data pages only refer to them by index.
+ */
+static void
+readDictionaryPage(ParquetColumnReader *columnReader,
+				   ParquetPageHeader header,
+				   uint8_t *data)
+{
+	ColumnChunkMetadata_4C *chunkmd = columnReader->columnMetadata;
+	uint8_t *buf;
+
+	if (header->num_values < 0)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("invalid dictionary size %d for column %s",
+						header->num_values, chunkmd->colName)));
+	}
+
+	/*
+	 * dictionary is kept in its own buffer until the column chunk is
+	 * finished, page data of streaming column is overwritten meanwhile.
+	 */
+	if (columnReader->dictionaryBufferLen < header->uncompressed_page_size)
+	{
+		if (columnReader->dictionaryBuffer != NULL)
+			pfree(columnReader->dictionaryBuffer);
+		columnReader->dictionaryBufferLen = header->uncompressed_page_size * BUFFER_SCALE_FACTOR;
+		columnReader->dictionaryBuffer = palloc(columnReader->dictionaryBufferLen);
+	}
+	buf = (uint8_t *) columnReader->dictionaryBuffer;
+
+	if (chunkmd->codec == UNCOMPRESSED)
+	{
+		memcpy(buf, data, header->uncompressed_page_size);
+	}
+	else
+	{
+		decompressPage(chunkmd, header, data, buf, /*pageNumber*/ 0);
+	}
+
+	if (columnReader->dictionaryCapacity < header->num_values)
+	{
+		if (columnReader->dictionary != NULL)
+			pfree(columnReader->dictionary);
+		columnReader->dictionaryCapacity = header->num_values;
+		columnReader->dictionary = palloc(columnReader->dictionaryCapacity * sizeof(Datum));
+	}
+
+	for (int i = 0; i < header->num_values; i++)
+	{
+		decodePlain(&columnReader->dictionary[i], &buf, chunkmd->hawqTypeId);
+	}
+	columnReader->dictionarySize = header->num_values;
+}
+
 /**
  * Read the value from a certain columnReader, the value will be embedded in value,
  * and if the value is null, the null field should be true
@@ -430,6 +886,10 @@ ParquetColumnReader_readValue(
 		{
 			*value = BoolGetDatum((bool) BitPack_ReadInt(columnReader->currentPage->bool_values_reader));
 		}
+		else if (columnReader->currentPage->dictionary_index_reader != NULL)
+		{
+			*value = readDictionaryValue(columnReader);
+		}
 		else
 		{
 			decodePlain(value, &(columnReader->currentPage->values_buffer), hawqTypeID);
@@ -445,6 +905,241 @@ ParquetColumnReader_readValue(
 	}
 }
 
+/*
+ * Whether values of the column can be read by ParquetColumnReader_readBatch.
+ *
+ * Only non-repeated columns of by-value fixed-width types qualify. Their
+ * Datums never point into page buffers, so a batch stays valid after the
+ * pages it came from are reused, and no memory is allocated per value.
+ *
+ * The encoding is not checked: HAWQ only dictionary encodes text columns,
+ * but other writers dictionary encode fixed-width columns too, and those
+ * pages are read through the decoded dictionary.
+ */
+bool
+ParquetColumnReader_canReadBatch(ParquetColumnReader *columnReader, int hawqTypeID)
+{
+	if (columnReader->columnMetadata->r != 0)
+		return false;
+
+	switch (hawqTypeID)
+	{
+		case HAWQ_TYPE_BOOL:
+		case HAWQ_TYPE_INT2:
+		case HAWQ_TYPE_INT4:
+		case HAWQ_TYPE_DATE:
+		case HAWQ_TYPE_FLOAT4:
+		case HAWQ_TYPE_INT8:
+		case HAWQ_TYPE_TIME:
+		case HAWQ_TYPE_TIMESTAMP:
+		case HAWQ_TYPE_TIMESTAMPTZ:
+		case HAWQ_TYPE_FLOAT8:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Read at most `maxValues` values of the column into `values` and `nulls`.
+ *
+ * Return number of values read, which is less than `maxValues` only if the
+ * column chunk has no more values. Column must satisfy
+ * ParquetColumnReader_canReadBatch, and must not be read by
+ * ParquetColumnReader_readValue in the same column chunk.
+ */
+int
+ParquetColumnReader_readBatch(
+		ParquetColumnReader *columnReader,
+		Datum *values,
+		bool *nulls,
+		int maxValues,
+		int hawqTypeID)
+{
+	int numRead = 0;
+
+	Assert(ParquetColumnReader_canReadBatch(columnReader, hawqTypeID));
+
+	while (numRead < maxValues)
+	{
+		int count;
+		int numNotNull;
+
+		if (columnReader->currentPageValueRemained == 0)
+		{
+			if (!advanceToNextPage(columnReader))
+				break;
+			continue;
+		}
+
+		count = Min(maxValues - numRead, columnReader->currentPageValueRemained);
+
+		numNotNull = readBatchNulls(columnReader->currentPage,
+									columnReader->columnMetadata->d,
+									nulls + numRead,
+									count);
+		if (columnReader->currentPage->dictionary_index_reader != NULL)
+		{
+			/* dictionary entries are by-value Datums, copy them as they are */
+			for (int i = numRead; i < numRead + count; i++)
+			{
+				if (!nulls[i])
+					values[i] = readDictionaryValue(columnReader);
+			}
+		}
+		else
+		{
+			decodeBatch(columnReader->currentPage,
+						values + numRead,
+						nulls + numRead,
+						count,
+						numNotNull,
+						hawqTypeID);
+		}
+
+		columnReader->currentPageValueRemained -= count;
+		numRead += count;
+	}
+
+	return numRead;
+}
+
+/*
+ * Look up next value of current dictionary encoded page in dictionary.
+ */
+static Datum
+readDictionaryValue(ParquetColumnReader *columnReader)
+{
+	int index = RLEDecoder_ReadInt(columnReader->currentPage->dictionary_index_reader);
+
+	if (index < 0 || index >= columnReader->dictionarySize)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("invalid dictionary index %d for column %s, dictionary size %d",
+						index, columnReader->columnMetadata->colName,
+						columnReader->dictionarySize)));
+	}
+
+	return columnReader->dictionary[index];
+}
+
+/*
+ * Decode definition levels of next `count` values in page into `nulls`,
+ * return number of non-null values.
+ */
+static int
+readBatchNulls(ParquetDataPage page, int maxDefinitionLevel, bool *nulls, int count)
+{
+	int levels[DEFINITION_LEVEL_BATCH_SIZE];
+	int numNotNull = 0;
+
+	if (page->definition_level_reader == NULL)
+	{
+		memset(nulls, false, count * sizeof(bool));
+		return count;
+	}
+
+	for (int done = 0; done < count; )
+	{
+		int n = Min(count - done, DEFINITION_LEVEL_BATCH_SIZE);
+
+		RLEDecoder_ReadInts(page->definition_level_reader, levels, n);
+		for (int i = 0; i < n; i++)
+		{
+			nulls[done + i] = (levels[i] < maxDefinitionLevel);
+			numNotNull += !nulls[done + i];
+		}
+		done += n;
+	}
+
+	return numNotNull;
+}
+
+/*
+ * Decode next `numNotNull` PLAIN encoded values in page into non-null slots
+ * of `values`. Loops are specialized by type width and by whether there is
+ * any null, the common no-null case being a straight copy.
+ */
+static void
+decodeBatch(ParquetDataPage page,
+			Datum *values,
+			bool *nulls,
+			int count,
+			int numNotNull,
+			int hawqTypeID)
+{
+	uint8_t *buf = page->values_buffer;
+
+	switch (hawqTypeID)
+	{
+		case HAWQ_TYPE_BOOL:
+		{
+			for (int i = 0; i < count; i++)
+			{
+				if (!nulls[i])
+					values[i] = BoolGetDatum((bool) BitPack_ReadInt(page->bool_values_reader));
+			}
+			return;
+		}
+
+		case HAWQ_TYPE_INT2:
+		case HAWQ_TYPE_INT4:
+		case HAWQ_TYPE_DATE:
+		case HAWQ_TYPE_FLOAT4:
+		{
+			int32_t *src = (int32_t *) buf;
+
+			if (numNotNull == count)
+			{
+				for (int i = 0; i < count; i++)
+					values[i] = src[i];
+			}
+			else
+			{
+				for (int i = 0; i < count; i++)
+				{
+					if (!nulls[i])
+						values[i] = *src++;
+				}
+			}
+			buf += numNotNull * sizeof(int32_t);
+			break;
+		}
+
+		case HAWQ_TYPE_INT8:
+		case HAWQ_TYPE_TIME:
+		case HAWQ_TYPE_TIMESTAMPTZ:
+		case HAWQ_TYPE_TIMESTAMP:
+		case HAWQ_TYPE_FLOAT8:
+		{
+			int64_t *src = (int64_t *) buf;
+
+			if (numNotNull == count)
+			{
+				for (int i = 0; i < count; i++)
+					values[i] = src[i];
+			}
+			else
+			{
+				for (int i = 0; i < count; i++)
+				{
+					if (!nulls[i])
+						values[i] = *src++;
+				}
+			}
+			buf += numNotNull * sizeof(int64_t);
+			break;
+		}
+
+		default:
+			Insist(false);
+			break;
+	}
+
+	page->values_buffer = buf;
+}
+
 static bool
 decodePlain(Datum *value, uint8_t **buffer, int hawqTypeID)
 {
@@ -578,6 +1273,36 @@ decodePlain(Datum *value, uint8_t **buffer, int hawqTypeID)
 }
 
 
+/*
+ * Free page header and decoders of a data page.
+ */
+static void
+freePageReaders(ParquetDataPage page)
+{
+	pfree(page->header);
+
+	/* TODO may be reuse these decoder? */
+	if (page->repetition_level_reader != NULL)
+	{
+		pfree(page->repetition_level_reader);
+	}
+
+	if (page->definition_level_reader != NULL)
+	{
+		pfree(page->definition_level_reader);
+	}
+
+	if (page->bool_values_reader != NULL)
+	{
+		pfree(page->bool_values_reader);
+	}
+
+	if (page->dictionary_index_reader != NULL)
+	{
+		pfree(page->dictionary_index_reader);
+	}
+}
+
 /**
  * finish scan current column, free and reset column reader part
  */
@@ -591,23 +1316,7 @@ ParquetColumnReader_FinishedScanColumn(
 	{
 		ParquetDataPage page = columnReader->dataPages + i;
 
-		pfree(page->header);
-
-		/* TODO may be reuse these decoder? */
-		if (page->repetition_level_reader != NULL)
-		{
-			pfree(page->repetition_level_reader);
-		}
-
-		if (page->definition_level_reader != NULL)
-		{
-			pfree(page->definition_level_reader);
-		}
-
-		if (page->bool_values_reader != NULL)
-		{
-			pfree(page->bool_values_reader);
-		}
+		freePageReaders(page);
 
 		/*
 		 * compressed repeatable column keeps each page's decompressed
@@ -639,8 +1348,13 @@ ParquetColumnReader_FinishedScanColumn(
 
 	MemoryContextSwitchTo(oldContext);
 
+	/* row group may be left before its chunks are read up, e.g. by LIMIT */
+	if (columnReader->prefetch != NULL)
+		ParquetPrefetch_Cancel(columnReader->prefetcher, columnReader->prefetch);
+
 	columnReader->dataPageProcessed = 0;
 	columnReader->currentPageValueRemained = 0;
+	columnReader->dictionarySize = 0;
 }
 
 /*----------------------------------------------------------------
@@ -63,6 +63,11 @@ readColumnMetadata(
 		CompactProtocol *prot,
 		struct ColumnChunkMetadata_4C *colChunk);
 
+static int
+readColumnStatistics(
+		CompactProtocol *prot,
+		struct ColumnChunkMetadata_4C *colChunk);
+
 static void
 assignRDFromFieldToColumnChunk(
 		struct ColumnChunkMetadata_4C* columns,
@@ -90,6 +95,11 @@ writeColumnChunk(
 		struct ColumnChunkMetadata_4C *columnInfo,
 		CompactProtocol *prot);
 
+static int
+writeColumnStatistics(
+		struct ColumnChunkMetadata_4C *columnInfo,
+		CompactProtocol *prot);
+
 static int
 writeSchemaElement_Single(
 		CompactProtocol *prot,
@@ -754,7 +764,12 @@ readColumnMetadata(
 			break;
 		case 11:
 			if (ftype == T_I64) {
-				xfer += skipType(prot, ftype);
+				xfer += readI64(prot, &(colChunk->dictionaryPageOffset));
+			}
+			break;
+		case 12:
+			if (ftype == T_STRUCT) {
+				xfer += readColumnStatistics(prot, colChunk);
 			}
 			break;
 		default:
@@ -790,6 +805,73 @@ readColumnMetadata(
 	return xfer;
 }
 
+/**
+ * read column chunk statistics. min/max are only accepted if they have the
+ * length of a fixed-width value, anything else (e.g. statistics written by
+ * other parquet writers for binary columns) is ignored.
+ */
+int
+readColumnStatistics(
+		CompactProtocol *prot,
+		struct ColumnChunkMetadata_4C *colChunk)
+{
+	uint32_t xfer = 0;
+	TType ftype;
+	int16_t fid;
+	char *maxValue = NULL;
+	char *minValue = NULL;
+	int32_t maxLen = 0;
+	int32_t minLen = 0;
+	bool isset_null_count = false;
+
+	readStructBegin(prot);
+
+	while (true) {
+		xfer += readFieldBegin(prot, &ftype, &fid);
+		if (ftype == T_STOP) {
+			break;
+		}
+		switch (fid) {
+		case 1:
+			if (ftype == T_STRING) {
+				xfer += readBinary(prot, &maxValue, &maxLen);
+			}
+			break;
+		case 2:
+			if (ftype == T_STRING) {
+				xfer += readBinary(prot, &minValue, &minLen);
+			}
+			break;
+		case 3:
+			if (ftype == T_I64) {
+				xfer += readI64(prot, &(colChunk->nullCount));
+				isset_null_count = true;
+			}
+			break;
+		default:
+			xfer += skipType(prot, ftype);
+			break;
+		}
+	}
+	readStructEnd(prot);
+
+	colChunk->hasStatistics = isset_null_count;
+	colChunk->statisticsValueLen = 0;
+	if (minLen == maxLen && (minLen == 4 || minLen == 8))
+	{
+		memcpy(colChunk->minValue, minValue, minLen);
+		memcpy(colChunk->maxValue, maxValue, maxLen);
+		colChunk->statisticsValueLen = minLen;
+	}
+
+	if (maxValue != NULL)
+		pfree(maxValue);
+	if (minValue != NULL)
+		pfree(minValue);
+
+	return xfer;
+}
+
 /**
  * Assign the r and d value of column chunks, from pfields to column chunks
  */
@@ -1014,7 +1096,19 @@ writeColumnMetadata(
 	xfer += writeFieldBegin(prot, T_I64, 9);
 	xfer += writeI64(prot, columnInfo->firstDataPage);
 
-	/*write out index page offset and dictionary page offset. No need to write currently*/
+	/*write out dictionary page offset, index page offset is not used currently*/
+	if (columnInfo->dictionaryPageOffset > 0)
+	{
+		xfer += writeFieldBegin(prot, T_I64, 11);
+		xfer += writeI64(prot, columnInfo->dictionaryPageOffset);
+	}
+
+	/*write out column chunk statistics*/
+	if (columnInfo->hasStatistics)
+	{
+		xfer += writeFieldBegin(prot, T_STRUCT, 12);
+		xfer += writeColumnStatistics(columnInfo, prot);
+	}
 
 	/*write out field stop identifier*/
 	xfer += writeFieldStop(prot);
@@ -1023,6 +1117,34 @@ writeColumnMetadata(
 	return xfer;
 }
 
+int
+writeColumnStatistics(
+		struct ColumnChunkMetadata_4C *columnInfo,
+		CompactProtocol *prot)
+{
+	uint32_t xfer = 0;
+	xfer += writeStructBegin(prot);
+
+	/*write out max and min value, only if there is at least one non-null value*/
+	if (columnInfo->statisticsValueLen > 0)
+	{
+		xfer += writeFieldBegin(prot, T_STRING, 1);
+		xfer += writeBinary(prot, columnInfo->maxValue, columnInfo->statisticsValueLen);
+
+		xfer += writeFieldBegin(prot, T_STRING, 2);
+		xfer += writeBinary(prot, columnInfo->minValue, columnInfo->statisticsValueLen);
+	}
+
+	/*write out null count*/
+	xfer += writeFieldBegin(prot, T_I64, 3);
+	xfer += writeI64(prot, columnInfo->nullCount);
+
+	xfer += writeFieldStop(prot);
+	xfer += writeStructEnd(prot);
+
+	return xfer;
+}
+
 int
 writeColumnChunk(
 		struct ColumnChunkMetadata_4C *columnInfo,
@@ -218,6 +218,22 @@ uint32_t readI64(CompactProtocol *prot, int64_t *i64) {
 }
 
 uint32_t readString(CompactProtocol *prot, char **str) {
+	int32_t size = 0;
+	uint32_t rsize = readBinary(prot, str, &size);
+
+	/* Catch empty string case */
+	if (size == 0)
+		*str = "";
+
+	return rsize;
+}
+
+/**
+ * Read a binary field out. The returned buffer is palloced and has a
+ * trailing '\0', which makes it also usable as a string. For zero length
+ * binary, *str is set to NULL.
+ */
+uint32_t readBinary(CompactProtocol *prot, char **str, int32_t *len) {
 	int32_t rsize = 0;
 	int32_t size = 0;
 	uint8_t *tmp = NULL;
@@ -227,9 +243,10 @@ uint32_t readString(CompactProtocol *prot, char **str) {
   int bufRet;
 
 	rsize += readVarint32(prot, &size);
-	/* Catch empty string case */
+	*len = size;
+	/* Catch empty binary case */
 	if (size == 0) {
-		*str = "";
+		*str = NULL;
 		return rsize;
 	}
 
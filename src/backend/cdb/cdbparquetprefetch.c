@@ -0,0 +1,528 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbparquetprefetch.c
+ *	  Read-ahead of parquet column chunk data by background threads.
+ *
+ * (See .h file for usage comments)
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/xact.h"
+#include "cdb/cdbparquetprefetch.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+
+#define PREFETCH_READ_COMMAND	First_WorkCommand
+#define PREFETCH_DONE_ANSWER	First_WorkAnswer
+
+/*
+ * Prefetchers of the current transaction, each may have running work
+ * threads which write into buffers of its scan memory context.
+ */
+static ParquetPrefetcher *activePrefetchers = NULL;
+static bool prefetchCallbacksRegistered = false;
+
+static int prefetchWorkProc(void *passThru, int command);
+static void prefetchXactCallback(XactEvent event, void *arg);
+static void prefetchSubXactCallback(SubXactEvent event, SubTransactionId mySubid,
+									SubTransactionId parentSubid, void *arg);
+static void unlinkPrefetcher(ParquetPrefetcher *prefetcher);
+static void stopWorkers(ParquetPrefetcher *prefetcher);
+static void dispatchQueue(ParquetPrefetcher *prefetcher);
+static void pollWorkers(ParquetPrefetcher *prefetcher);
+static void completeRequest(ParquetPrefetcher *prefetcher,
+							ParquetPrefetchWorker *worker);
+static void waitRequest(ParquetPrefetcher *prefetcher,
+						ParquetPrefetchRequest *request);
+
+/*
+ * Body of work thread: read the range of worker's request.
+ *
+ * Runs outside of the backend, so it must not palloc or ereport, and
+ * RawFileRead calls nothing but pread or libhdfs3.
+ */
+static int
+prefetchWorkProc(void *passThru, int command)
+{
+	ParquetPrefetchWorker *worker = (ParquetPrefetchWorker *) passThru;
+	ParquetPrefetchRequest *request = worker->request;
+	instr_time	startTime;
+	int32		done = 0;
+
+	Assert(command == PREFETCH_READ_COMMAND);
+	Assert(request != NULL);
+
+	INSTR_TIME_SET_CURRENT(startTime);
+
+	while (done < request->length)
+	{
+		int len = RawFileRead(worker->file, request->offset + done,
+							  request->buffer + done, request->length - done,
+							  request->errmsg, sizeof(request->errmsg));
+		if (len <= 0)
+		{
+			if (len == 0)
+				strlcpy(request->errmsg, "unexpected end of file",
+						sizeof(request->errmsg));
+			done = -1;
+			break;
+		}
+		done += len;
+	}
+
+	request->bytesRead = done;
+
+	INSTR_TIME_SET_CURRENT(request->readTime);
+	INSTR_TIME_SUBTRACT(request->readTime, startTime);
+
+	return PREFETCH_DONE_ANSWER;
+}
+
+/*
+ * Work threads write into buffers of the scan memory context, stop them
+ * before the context is reset at transaction end.
+ */
+static void
+prefetchXactCallback(XactEvent event, void *arg)
+{
+	while (activePrefetchers != NULL)
+	{
+		ParquetPrefetcher *prefetcher = activePrefetchers;
+
+		stopWorkers(prefetcher);
+		unlinkPrefetcher(prefetcher);
+	}
+}
+
+/*
+ * Likewise for the scans of an aborted subtransaction. The scans of a
+ * committed subtransaction now belong to its parent.
+ */
+static void
+prefetchSubXactCallback(SubXactEvent event, SubTransactionId mySubid,
+						SubTransactionId parentSubid, void *arg)
+{
+	ParquetPrefetcher *prefetcher = activePrefetchers;
+
+	while (prefetcher != NULL)
+	{
+		ParquetPrefetcher *next = prefetcher->next;
+
+		if (prefetcher->subid == mySubid)
+		{
+			if (event == SUBXACT_EVENT_ABORT_SUB)
+			{
+				stopWorkers(prefetcher);
+				unlinkPrefetcher(prefetcher);
+			}
+			else if (event == SUBXACT_EVENT_COMMIT_SUB)
+				prefetcher->subid = parentSubid;
+		}
+
+		prefetcher = next;
+	}
+}
+
+static void
+unlinkPrefetcher(ParquetPrefetcher *prefetcher)
+{
+	ParquetPrefetcher **link;
+
+	for (link = &activePrefetchers; *link != NULL; link = &(*link)->next)
+	{
+		if (*link == prefetcher)
+		{
+			*link = prefetcher->next;
+			prefetcher->next = NULL;
+			break;
+		}
+	}
+}
+
+/*
+ * Wait for running reads, then quit work threads and close their handles.
+ */
+static void
+stopWorkers(ParquetPrefetcher *prefetcher)
+{
+	for (int i = 0; i < PARQUET_PREFETCH_WORKERS; i++)
+	{
+		ParquetPrefetchWorker *worker = &prefetcher->workers[i];
+		int answer;
+
+		if (worker->request != NULL)
+		{
+			ThreadWorkGetAnswer(&worker->threadWork, &answer);
+			worker->request->state = PREFETCH_IDLE;
+			worker->request = NULL;
+		}
+
+		if (worker->started)
+		{
+			ThreadWorkQuit(&worker->threadWork);
+			worker->started = false;
+		}
+
+		if (worker->file != NULL)
+		{
+			RawFileClose(worker->file);
+			worker->file = NULL;
+		}
+	}
+}
+
+/*
+ * Hand queued requests to idle workers.
+ */
+static void
+dispatchQueue(ParquetPrefetcher *prefetcher)
+{
+	for (int i = 0; i < PARQUET_PREFETCH_WORKERS && prefetcher->queue != NIL; i++)
+	{
+		ParquetPrefetchWorker *worker = &prefetcher->workers[i];
+		ParquetPrefetchRequest *request;
+
+		if (worker->request != NULL)
+			continue;
+
+		if (worker->file == NULL)
+		{
+			worker->file = RawFileOpenForRead(prefetcher->fileName);
+			if (worker->file == NULL)
+			{
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("file open error in file '%s' for parquet read-ahead: %s",
+								prefetcher->fileName, strerror(errno)),
+						 errdetail("%s", HdfsGetLastError())));
+			}
+		}
+
+		if (!worker->started)
+		{
+			ThreadWorkStart(&worker->threadWork, prefetchWorkProc, worker);
+			worker->started = true;
+		}
+
+		request = (ParquetPrefetchRequest *) linitial(prefetcher->queue);
+		prefetcher->queue = list_delete_first(prefetcher->queue);
+
+		request->state = PREFETCH_RUNNING;
+		worker->request = request;
+		ThreadWorkGiveCommand(&worker->threadWork, PREFETCH_READ_COMMAND);
+	}
+}
+
+/*
+ * Collect finished reads without blocking, and start queued ones.
+ */
+static void
+pollWorkers(ParquetPrefetcher *prefetcher)
+{
+	for (int i = 0; i < PARQUET_PREFETCH_WORKERS; i++)
+	{
+		ParquetPrefetchWorker *worker = &prefetcher->workers[i];
+		int answer;
+
+		if (worker->request != NULL &&
+			ThreadWorkTryAnswer(&worker->threadWork, &answer))
+			completeRequest(prefetcher, worker);
+	}
+
+	dispatchQueue(prefetcher);
+}
+
+static void
+completeRequest(ParquetPrefetcher *prefetcher, ParquetPrefetchWorker *worker)
+{
+	ParquetPrefetchRequest *request = worker->request;
+
+	worker->request = NULL;
+	request->state = PREFETCH_DONE;
+
+	prefetcher->stats.reads++;
+	if (request->bytesRead > 0)
+		prefetcher->stats.bytes += request->bytesRead;
+	INSTR_TIME_ADD(prefetcher->stats.ioTime, request->readTime);
+}
+
+/*
+ * Block until the running read of request finishes.
+ */
+static void
+waitRequest(ParquetPrefetcher *prefetcher, ParquetPrefetchRequest *request)
+{
+	Assert(request->state == PREFETCH_RUNNING);
+
+	for (int i = 0; i < PARQUET_PREFETCH_WORKERS; i++)
+	{
+		ParquetPrefetchWorker *worker = &prefetcher->workers[i];
+		int answer;
+
+		if (worker->request != request)
+			continue;
+
+		ThreadWorkGetAnswer(&worker->threadWork, &answer);
+		completeRequest(prefetcher, worker);
+		break;
+	}
+
+	Assert(request->state == PREFETCH_DONE);
+
+	dispatchQueue(prefetcher);
+}
+
+ParquetPrefetcher *
+ParquetPrefetch_Create(MemoryContext memoryContext)
+{
+	ParquetPrefetcher *prefetcher;
+
+	if (gp_parquet_prefetch_memory <= 0)
+		return NULL;
+
+	prefetcher = (ParquetPrefetcher *)
+		MemoryContextAllocZero(memoryContext, sizeof(ParquetPrefetcher));
+	prefetcher->memoryContext = memoryContext;
+	prefetcher->budget = (int64) gp_parquet_prefetch_memory * 1024;
+	prefetcher->subid = GetCurrentSubTransactionId();
+
+	if (!prefetchCallbacksRegistered)
+	{
+		RegisterXactCallback(prefetchXactCallback, NULL);
+		RegisterSubXactCallback(prefetchSubXactCallback, NULL);
+		prefetchCallbacksRegistered = true;
+	}
+
+	prefetcher->next = activePrefetchers;
+	activePrefetchers = prefetcher;
+
+	return prefetcher;
+}
+
+void
+ParquetPrefetch_Destroy(ParquetPrefetcher *prefetcher)
+{
+	ListCell *lc;
+
+	unlinkPrefetcher(prefetcher);
+
+	stopWorkers(prefetcher);
+
+	foreach(lc, prefetcher->requests)
+	{
+		ParquetPrefetchRequest *request = (ParquetPrefetchRequest *) lfirst(lc);
+
+		if (request->buffer != NULL)
+			pfree(request->buffer);
+		pfree(request);
+	}
+	list_free(prefetcher->requests);
+	list_free(prefetcher->queue);
+
+	if (prefetcher->fileName != NULL)
+		pfree(prefetcher->fileName);
+
+	pfree(prefetcher);
+}
+
+void
+ParquetPrefetch_SetFile(ParquetPrefetcher *prefetcher, char *fileName)
+{
+	if (prefetcher->fileName != NULL)
+		ParquetPrefetch_CloseFile(prefetcher);
+
+	/* without a file, every range is read synchronously */
+	if (!RawFileIsSupported(fileName))
+		return;
+
+	prefetcher->fileName = MemoryContextStrdup(prefetcher->memoryContext, fileName);
+}
+
+void
+ParquetPrefetch_CloseFile(ParquetPrefetcher *prefetcher)
+{
+	ListCell *lc;
+
+	foreach(lc, prefetcher->requests)
+		ParquetPrefetch_Cancel(prefetcher, (ParquetPrefetchRequest *) lfirst(lc));
+
+	Assert(prefetcher->queue == NIL);
+
+	for (int i = 0; i < PARQUET_PREFETCH_WORKERS; i++)
+	{
+		ParquetPrefetchWorker *worker = &prefetcher->workers[i];
+
+		Assert(worker->request == NULL);
+		if (worker->file != NULL)
+		{
+			RawFileClose(worker->file);
+			worker->file = NULL;
+		}
+	}
+
+	if (prefetcher->fileName != NULL)
+	{
+		pfree(prefetcher->fileName);
+		prefetcher->fileName = NULL;
+	}
+}
+
+ParquetPrefetchRequest *
+ParquetPrefetch_CreateRequest(ParquetPrefetcher *prefetcher)
+{
+	MemoryContext oldContext = MemoryContextSwitchTo(prefetcher->memoryContext);
+	ParquetPrefetchRequest *request = palloc0(sizeof(ParquetPrefetchRequest));
+
+	prefetcher->requests = lappend(prefetcher->requests, request);
+
+	MemoryContextSwitchTo(oldContext);
+
+	return request;
+}
+
+/*
+ * Start reading [offset, offset + length) of the current segment file into
+ * the request. The request must be idle.
+ *
+ * Return false if the request buffer can not be enlarged within the memory
+ * budget, the range should then be read synchronously.
+ */
+bool
+ParquetPrefetch_Start(ParquetPrefetcher *prefetcher,
+					  ParquetPrefetchRequest *request,
+					  int64 offset, int32 length)
+{
+	MemoryContext oldContext;
+
+	Assert(request->state == PREFETCH_IDLE);
+
+	if (prefetcher->fileName == NULL || length <= 0)
+		return false;
+
+	if (request->bufferLen < length)
+	{
+		if (prefetcher->memoryUsed - request->bufferLen + length > prefetcher->budget)
+			return false;
+
+		if (request->buffer != NULL)
+			pfree(request->buffer);
+		request->buffer = MemoryContextAlloc(prefetcher->memoryContext, length);
+		prefetcher->memoryUsed += length - request->bufferLen;
+		request->bufferLen = length;
+	}
+
+	request->offset = offset;
+	request->length = length;
+	request->taken = 0;
+	request->bytesRead = 0;
+	request->errmsg[0] = '\0';
+
+	oldContext = MemoryContextSwitchTo(prefetcher->memoryContext);
+	request->state = PREFETCH_QUEUED;
+	prefetcher->queue = lappend(prefetcher->queue, request);
+	MemoryContextSwitchTo(oldContext);
+
+	pollWorkers(prefetcher);
+
+	return true;
+}
+
+/*
+ * Copy up to `length` bytes of read-ahead data starting at file `offset`
+ * into `buffer`, waiting for the read to finish if necessary. The request
+ * becomes idle once all its data is taken.
+ *
+ * Return number of bytes copied, 0 if the request does not hold data at
+ * `offset` and the caller must read it synchronously.
+ */
+int32
+ParquetPrefetch_Take(ParquetPrefetcher *prefetcher,
+					 ParquetPrefetchRequest *request,
+					 int64 offset, char *buffer, int32 length)
+{
+	int32 len;
+
+	if (request == NULL || request->state == PREFETCH_IDLE ||
+		offset != request->offset + request->taken)
+	{
+		if (request != NULL)
+			ParquetPrefetch_Cancel(prefetcher, request);
+		prefetcher->stats.syncReads++;
+		return 0;
+	}
+
+	/* not started by any worker yet, cheaper to read it in the backend */
+	if (request->state == PREFETCH_QUEUED)
+	{
+		ParquetPrefetch_Cancel(prefetcher, request);
+		prefetcher->stats.syncReads++;
+		return 0;
+	}
+
+	if (request->state == PREFETCH_RUNNING)
+	{
+		instr_time	startTime;
+		instr_time	endTime;
+
+		INSTR_TIME_SET_CURRENT(startTime);
+		waitRequest(prefetcher, request);
+		INSTR_TIME_SET_CURRENT(endTime);
+		INSTR_TIME_ACCUM_DIFF(prefetcher->stats.stallTime, endTime, startTime);
+	}
+	else
+		pollWorkers(prefetcher);
+
+	Assert(request->state == PREFETCH_DONE);
+
+	if (request->bytesRead < 0)
+	{
+		request->state = PREFETCH_IDLE;
+		ereport(ERROR,
+				(errcode(ERRCODE_IO_ERROR),
+				 errmsg("parquet storage read error on reading ahead " INT64_FORMAT " bytes at position " INT64_FORMAT " of file '%s'",
+						(int64) request->length, request->offset, prefetcher->fileName),
+				 errdetail("%s", request->errmsg)));
+	}
+
+	len = Min(length, request->bytesRead - request->taken);
+	memcpy(buffer, request->buffer + request->taken, len);
+	request->taken += len;
+
+	if (request->taken >= request->bytesRead)
+		request->state = PREFETCH_IDLE;
+
+	return len;
+}
+
+void
+ParquetPrefetch_Cancel(ParquetPrefetcher *prefetcher,
+					   ParquetPrefetchRequest *request)
+{
+	if (request->state == PREFETCH_QUEUED)
+		prefetcher->queue = list_delete_ptr(prefetcher->queue, request);
+	else if (request->state == PREFETCH_RUNNING)
+		waitRequest(prefetcher, request);
+
+	request->state = PREFETCH_IDLE;
+}
+
+void
+ParquetPrefetch_Explain(ParquetPrefetcher *prefetcher, StringInfo buf)
+{
+	ParquetPrefetchStats *stats = &prefetcher->stats;
+	double		ioTime = INSTR_TIME_GET_MILLISEC(stats->ioTime);
+	double		stallTime = INSTR_TIME_GET_MILLISEC(stats->stallTime);
+
+	if (stats->reads == 0)
+		return;
+
+	appendStringInfo(buf,
+					 "Read-ahead " INT64_FORMAT " ranges, " INT64_FORMAT "KB in %.3f ms"
+					 "; %.3f ms overlapped with decoding, stalled %.3f ms"
+					 "; " INT64_FORMAT " synchronous reads.\n",
+					 stats->reads, (stats->bytes + 1023) / 1024, ioTime,
+					 Max(ioTime - stallTime, 0.0), stallTime,
+					 stats->syncReads);
+}
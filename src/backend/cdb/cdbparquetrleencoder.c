@@ -244,6 +244,50 @@ RLEDecoder_ReadInt(RLEDecoder *decoder)
 	return result;
 }
 
+/*
+ * Read next `count` values into `values`, a batch version of
+ * RLEDecoder_ReadInt which copies a whole run at a time.
+ */
+void
+RLEDecoder_ReadInts(RLEDecoder *decoder, int *values, int count)
+{
+	while (count > 0)
+	{
+		int n;
+
+		if (decoder->valueCount == 0)
+		{
+			readNextRun(decoder);
+			if (decoder->valueCount == 0)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("unexpected end of RLE encoded data")));
+			}
+		}
+
+		n = count < decoder->valueCount ? count : decoder->valueCount;
+
+		if (decoder->mode == MODE_RLE)
+		{
+			for (int i = 0; i < n; i++)
+			{
+				values[i] = decoder->rleValue;
+			}
+		}
+		else
+		{
+			memcpy(values,
+				   &decoder->bitpackBuffer[decoder->bitpackBufferSize - decoder->valueCount],
+				   n * sizeof(int));
+		}
+
+		decoder->valueCount -= n;
+		values += n;
+		count -= n;
+	}
+}
+
 void 
 readNextRun(RLEDecoder *decoder)
 {
@@ -7,11 +7,36 @@
 
 #include "cdb/cdbparquetrowgroup.h"
 #include "cdb/cdbparquetfooterserializer.h"
+#include "access/skey.h"
+#include "nodes/primnodes.h"
+#include "optimizer/clauses.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
 
 static bool ParquetRowGroupReader_Select(FileSplit split,
                                          ParquetMetadata parquetMetadata,
                                          bool *rowGroupInfoProcessed);
 
+static bool ParquetRowGroupReader_CanSkip(List *rowGroupFilter,
+                                          struct BlockMetadata_4C *rowGroupMetadata,
+                                          int *hawqAttrToParquetColChunks);
+
+static void addRowGroupPredicates(List **rowGroupFilter, Node *clause,
+                                  TupleDesc hawqTupleDesc);
+
+static ParquetRowGroupPredicate *makeComparePredicate(OpExpr *opexpr,
+                                                      TupleDesc hawqTupleDesc);
+
+static void ParquetRowGroupReader_ReadNextBatch(TupleDesc tupDesc,
+                                                ParquetRowGroupReader *rowGroupReader,
+                                                int *hawqAttrToParquetColNum,
+                                                bool *projs,
+                                                int natts);
+
+static int getStatisticsValueLen(int hawqTypeID);
+
+static Datum decodeStatisticsValue(uint8_t *value, int hawqTypeID);
+
 /*
  * Initialize the ExecutorReadGroup once.  Assumed to be zeroed out before the call.
  */
@@ -46,6 +71,7 @@ ParquetRowGroupReader_GetRowGroupInfo(
 	bool 					*projs,
 	TupleDesc 				hawqTupleDesc,
 	int 					*hawqAttrToParquetColChunks,
+	List					*rowGroupFilter,
 	bool                    toCloseFile)
 {
 	ParquetMetadata parquetMetadata;
@@ -74,10 +100,18 @@ ParquetRowGroupReader_GetRowGroupInfo(
 		storageRead->preRead = false;
 
 		if (ParquetRowGroupReader_Select(split, parquetMetadata, &rowGroupInfoProcessed))
-			break;
-
+		{
+			/* skip the row group if its statistics show no tuple can match */
+			if (!ParquetRowGroupReader_CanSkip(rowGroupFilter,
+											   parquetMetadata->currentBlockMD,
+											   hawqAttrToParquetColChunks))
+				break;
+
+			elog(DEBUG1, "parquet row group %d of %s skipped by column statistics",
+				 rowGroupIndex, storageRead->segmentFileName);
+		}
 		/* done with current split and pre-read the next rowgroup info */
-		if (rowGroupInfoProcessed) {
+		else if (rowGroupInfoProcessed) {
 			storageRead->preRead = true;
 			if (toCloseFile) {
 				freeFooterProtocol(storageRead->footerProtocol);
@@ -116,6 +150,8 @@ ParquetRowGroupReader_GetRowGroupInfo(
 		rowGroupReader->columnReaders = (ParquetColumnReader *)palloc0
 				(colReaderNum * sizeof(ParquetColumnReader));
 		rowGroupReader->columnReaderCount = colReaderNum;
+		rowGroupReader->batchValues = (Datum **) palloc0(colReaderNum * sizeof(Datum *));
+		rowGroupReader->batchNulls = (bool **) palloc0(colReaderNum * sizeof(bool *));
 	}
 	else if(rowGroupReader->columnReaderCount != colReaderNum){
 		ereport(ERROR, (errcode(ERRCODE_GP_INTERNAL_ERROR),
@@ -152,6 +188,8 @@ ParquetRowGroupReader_GetRowGroupInfo(
 					sizeof(struct ColumnChunkMetadata_4C));
 			rowGroupReader->columnReaders[hawqColIndex + j].memoryContext =
 					rowGroupReader->memoryContext;
+			rowGroupReader->columnReaders[hawqColIndex + j].prefetcher =
+					storageRead->prefetcher;
 		}
 		hawqColIndex += parquetColChunkNum;
 		parquetColIndex += parquetColChunkNum;
@@ -169,9 +207,7 @@ ParquetRowGroupReader_GetContents(
 	/*scan the file to get next row group data*/
 	ParquetColumnReader *columnReaders = rowGroupReader->columnReaders;
 	File file = rowGroupReader->storageRead->file;
-	for(int i = 0; i < rowGroupReader->columnReaderCount; i++){
-		ParquetExecutorReadColumn(&(columnReaders[i]), file);
-	}
+	ParquetExecutorReadColumns(columnReaders, rowGroupReader->columnReaderCount, file);
 	rowGroupReader->storageRead->rowGroupProcessedCount++;
 
 }
@@ -197,14 +233,20 @@ ParquetRowGroupReader_ScanNextTuple(
 		return false;
 	}
 
+	int natts = slot->tts_tupleDescriptor->natts;
+	Assert(natts <=	tupDesc->natts);
+
+	if (rowGroupReader->batchRead >= rowGroupReader->batchSize)
+	{
+		ParquetRowGroupReader_ReadNextBatch(tupDesc, rowGroupReader,
+											hawqAttrToParquetColNum, projs, natts);
+	}
+
 	/*
 	 * get the next item (tuple) from the row group
 	 */
 	rowGroupReader->rowRead++;
 
-	int natts = slot->tts_tupleDescriptor->natts;
-	Assert(natts <=	tupDesc->natts);
-
 	Datum *values = slot_get_values(slot);
 	bool *nulls = slot_get_isnull(slot);
 
@@ -221,7 +263,12 @@ ParquetRowGroupReader_ScanNextTuple(
 			&rowGroupReader->columnReaders[colReaderIndex];
 		int hawqTypeID = tupDesc->attrs[i]->atttypid;
 
-		if(hawqAttrToParquetColNum[i] == 1)
+		if(rowGroupReader->batchValues[colReaderIndex] != NULL)
+		{
+			values[i] = rowGroupReader->batchValues[colReaderIndex][rowGroupReader->batchRead];
+			nulls[i] = rowGroupReader->batchNulls[colReaderIndex][rowGroupReader->batchRead];
+		}
+		else if(hawqAttrToParquetColNum[i] == 1)
 		{
 			ParquetColumnReader_readValue(nextReader, &values[i], &nulls[i], hawqTypeID);
 		}
@@ -266,11 +313,75 @@ ParquetRowGroupReader_ScanNextTuple(
 		colReaderIndex += hawqAttrToParquetColNum[i];
 	}
 
+	rowGroupReader->batchRead++;
+
 	/*construct tuple, and return back*/
 	TupSetVirtualTupleNValid(slot, natts);
 	return true;
 }
 
+/*
+ * Decode next batch of rows for all projected columns which can be read in
+ * batches, the other columns are still read value by value in ScanNextTuple.
+ */
+static void
+ParquetRowGroupReader_ReadNextBatch(
+	TupleDesc				tupDesc,
+	ParquetRowGroupReader	*rowGroupReader,
+	int						*hawqAttrToParquetColNum,
+	bool					*projs,
+	int						natts)
+{
+	int batchSize = Min(PARQUET_SCAN_BATCH_SIZE,
+						rowGroupReader->rowCount - rowGroupReader->rowRead);
+	int colReaderIndex = 0;
+
+	for(int i = 0; i < natts; i++)
+	{
+		if(projs[i] == false)
+		{
+			continue;
+		}
+
+		ParquetColumnReader *reader = &rowGroupReader->columnReaders[colReaderIndex];
+		int hawqTypeID = tupDesc->attrs[i]->atttypid;
+
+		if(hawqAttrToParquetColNum[i] == 1 &&
+		   ParquetColumnReader_canReadBatch(reader, hawqTypeID))
+		{
+			if(rowGroupReader->batchValues[colReaderIndex] == NULL)
+			{
+				MemoryContext oldContext = MemoryContextSwitchTo(rowGroupReader->memoryContext);
+
+				rowGroupReader->batchValues[colReaderIndex] =
+						(Datum *) palloc0(PARQUET_SCAN_BATCH_SIZE * sizeof(Datum));
+				rowGroupReader->batchNulls[colReaderIndex] =
+						(bool *) palloc0(PARQUET_SCAN_BATCH_SIZE * sizeof(bool));
+
+				MemoryContextSwitchTo(oldContext);
+			}
+
+			if(ParquetColumnReader_readBatch(reader,
+											 rowGroupReader->batchValues[colReaderIndex],
+											 rowGroupReader->batchNulls[colReaderIndex],
+											 batchSize,
+											 hawqTypeID) != batchSize)
+			{
+				ereport(ERROR, (errcode(ERRCODE_GP_INTERNAL_ERROR),
+						errmsg("parquet column chunk of column %s has fewer values than "
+								"rows in row group of file %s",
+								reader->columnMetadata->colName,
+								rowGroupReader->storageRead->segmentFileName)));
+			}
+		}
+
+		colReaderIndex += hawqAttrToParquetColNum[i];
+	}
+
+	rowGroupReader->batchSize = batchSize;
+	rowGroupReader->batchRead = 0;
+}
+
 /**
  * finish scanning row group, but keeping the structure palloced
  */
@@ -281,6 +392,8 @@ ParquetRowGroupReader_FinishedScanRowGroup(
 	/*reset rowCount and rowRead*/
 	rowGroupReader->rowCount = 0;
 	rowGroupReader->rowRead = 0;
+	rowGroupReader->batchSize = 0;
+	rowGroupReader->batchRead = 0;
 
 	/*memset columnreader content to zero for later use*/
 	for(int i = 0; i < rowGroupReader->columnReaderCount; i++){
@@ -297,7 +410,10 @@ static bool ParquetRowGroupReader_Select(FileSplit split,
 
   int64 splitStart = split->offsets;
   int64 splitEnd = splitStart + split->lengths;
-  int64 rowGroupStart = rowGroupMetadata->columns[0].firstDataPage;
+  /* the first column chunk begins with its dictionary page, if any */
+  int64 rowGroupStart = rowGroupMetadata->columns[0].dictionaryPageOffset > 0 ?
+                        rowGroupMetadata->columns[0].dictionaryPageOffset :
+                        rowGroupMetadata->columns[0].firstDataPage;
 
   elog(DEBUG1, "parquetSplitSegNo/EOF: %d/"INT64_FORMAT"", split->segno, split->logiceof);
   elog(DEBUG1, "parquetSplitStart: "INT64_FORMAT"", splitStart);
@@ -314,3 +430,322 @@ static bool ParquetRowGroupReader_Select(FileSplit split,
 
   return false;
 }
+
+/*
+ * Check whether all tuples of the row group are filtered out by the
+ * row group filter, according to the column chunk statistics.
+ */
+static bool
+ParquetRowGroupReader_CanSkip(List *rowGroupFilter,
+							  struct BlockMetadata_4C *rowGroupMetadata,
+							  int *hawqAttrToParquetColChunks)
+{
+	ListCell *lc;
+
+	foreach(lc, rowGroupFilter)
+	{
+		ParquetRowGroupPredicate *pred = (ParquetRowGroupPredicate *) lfirst(lc);
+		struct ColumnChunkMetadata_4C *chunk;
+		int colIndex = 0;
+
+		/* only attributes stored in exactly one column chunk are filtered */
+		if (hawqAttrToParquetColChunks[pred->attnum] != 1)
+			continue;
+
+		for (int i = 0; i < pred->attnum; i++)
+			colIndex += hawqAttrToParquetColChunks[i];
+
+		Assert(colIndex < rowGroupMetadata->ColChunkCount);
+		chunk = &rowGroupMetadata->columns[colIndex];
+
+		/* files written before statistics were introduced */
+		if (!chunk->hasStatistics)
+			continue;
+
+		switch (pred->kind)
+		{
+			case PARQUET_PREDICATE_ISNULL:
+				if (chunk->nullCount == 0)
+					return true;
+				break;
+
+			case PARQUET_PREDICATE_ISNOTNULL:
+				if (chunk->nullCount == chunk->valueCount)
+					return true;
+				break;
+
+			case PARQUET_PREDICATE_COMPARE:
+			{
+				/* strict operator never matches a null value */
+				if (chunk->nullCount == chunk->valueCount)
+					return true;
+
+				if (chunk->statisticsValueLen != getStatisticsValueLen(pred->hawqTypeID))
+					break;
+
+				if (pred->checkMin)
+				{
+					Datum minValue = decodeStatisticsValue(chunk->minValue, pred->hawqTypeID);
+					if (!DatumGetBool(FunctionCall2(&pred->minCheck, minValue, pred->constValue)))
+						return true;
+				}
+
+				if (pred->checkMax)
+				{
+					Datum maxValue = decodeStatisticsValue(chunk->maxValue, pred->hawqTypeID);
+					if (!DatumGetBool(FunctionCall2(&pred->maxCheck, maxValue, pred->constValue)))
+						return true;
+				}
+				break;
+			}
+			default:
+				Insist(false);
+				break;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Build row group filter from the quals of a scan. Only top-level ANDed
+ * clauses of form "var op const", "const op var", "var IS NULL" and
+ * "var IS NOT NULL" on fixed-width ordered types are used, all others
+ * are simply ignored, they are still evaluated on each tuple.
+ */
+List *
+ParquetRowGroupFilter_Create(
+	List		*qual,
+	TupleDesc	hawqTupleDesc)
+{
+	List		*rowGroupFilter = NIL;
+	ListCell	*lc;
+
+	if (!gp_parquet_rowgroup_filter)
+		return NIL;
+
+	foreach(lc, qual)
+	{
+		addRowGroupPredicates(&rowGroupFilter, (Node *) lfirst(lc), hawqTupleDesc);
+	}
+
+	return rowGroupFilter;
+}
+
+static void
+addRowGroupPredicates(List **rowGroupFilter, Node *clause, TupleDesc hawqTupleDesc)
+{
+	if (clause == NULL)
+		return;
+
+	if (and_clause(clause))
+	{
+		ListCell *lc;
+		foreach(lc, ((BoolExpr *) clause)->args)
+		{
+			addRowGroupPredicates(rowGroupFilter, (Node *) lfirst(lc), hawqTupleDesc);
+		}
+	}
+	else if (IsA(clause, OpExpr))
+	{
+		ParquetRowGroupPredicate *pred = makeComparePredicate((OpExpr *) clause, hawqTupleDesc);
+		if (pred != NULL)
+			*rowGroupFilter = lappend(*rowGroupFilter, pred);
+	}
+	else if (IsA(clause, NullTest))
+	{
+		NullTest *ntest = (NullTest *) clause;
+		Var *var = (Var *) ntest->arg;
+
+		if (var == NULL || !IsA(var, Var) ||
+			var->varattno <= 0 || var->varattno > hawqTupleDesc->natts)
+			return;
+
+		ParquetRowGroupPredicate *pred = palloc0(sizeof(ParquetRowGroupPredicate));
+		pred->kind = (ntest->nulltesttype == IS_NULL) ?
+					 PARQUET_PREDICATE_ISNULL : PARQUET_PREDICATE_ISNOTNULL;
+		pred->attnum = var->varattno - 1;
+		pred->hawqTypeID = var->vartype;
+		*rowGroupFilter = lappend(*rowGroupFilter, pred);
+	}
+}
+
+/*
+ * Make predicate for "var op const" or "const op var", where op is a member
+ * of the default btree opclass of var's type. Return NULL if the clause
+ * can't be checked against statistics.
+ */
+static ParquetRowGroupPredicate *
+makeComparePredicate(OpExpr *opexpr, TupleDesc hawqTupleDesc)
+{
+	Oid			opno = opexpr->opno;
+	Node		*leftop;
+	Node		*rightop;
+	Var			*var;
+	Const		*con;
+	List		*opclasses;
+	List		*opstrats;
+	ListCell	*lcclass;
+	ListCell	*lcstrat;
+	ParquetRowGroupPredicate *pred = NULL;
+
+	if (list_length(opexpr->args) != 2)
+		return NULL;
+
+	leftop = (Node *) linitial(opexpr->args);
+	rightop = (Node *) lsecond(opexpr->args);
+
+	if (IsA(leftop, Var) && IsA(rightop, Const))
+	{
+		var = (Var *) leftop;
+		con = (Const *) rightop;
+	}
+	else if (IsA(leftop, Const) && IsA(rightop, Var))
+	{
+		/* commute the clause to make var on the left */
+		var = (Var *) rightop;
+		con = (Const *) leftop;
+		opno = get_commutator(opno);
+		if (!OidIsValid(opno))
+			return NULL;
+	}
+	else
+		return NULL;
+
+	if (var->varattno <= 0 || var->varattno > hawqTupleDesc->natts ||
+		hawqTupleDesc->attrs[var->varattno - 1]->atttypid != var->vartype)
+		return NULL;
+
+	if (con->constisnull || getStatisticsValueLen(var->vartype) == 0 || !op_strict(opno))
+		return NULL;
+
+	get_op_btree_interpretation(opno, &opclasses, &opstrats);
+
+	forboth(lcclass, opclasses, lcstrat, opstrats)
+	{
+		Oid		opclass = lfirst_oid(lcclass);
+		int		strategy;
+		Oid		subtype;
+		bool	recheck;
+		Oid		minOp = InvalidOid;
+		Oid		maxOp = InvalidOid;
+
+		/* statistics are ordered the same as the default opclass */
+		if (!opclass_is_default(opclass) || lfirst_int(lcstrat) == ROWCOMPARE_NE)
+			continue;
+
+		get_op_opclass_properties(opno, opclass, &strategy, &subtype, &recheck);
+
+		switch (strategy)
+		{
+			case BTLessStrategyNumber:
+			case BTLessEqualStrategyNumber:
+				minOp = opno;
+				break;
+			case BTEqualStrategyNumber:
+				minOp = get_opclass_member(opclass, subtype, BTLessEqualStrategyNumber);
+				maxOp = get_opclass_member(opclass, subtype, BTGreaterEqualStrategyNumber);
+				if (!OidIsValid(minOp) || !OidIsValid(maxOp))
+					continue;
+				break;
+			case BTGreaterEqualStrategyNumber:
+			case BTGreaterStrategyNumber:
+				maxOp = opno;
+				break;
+			default:
+				continue;
+		}
+
+		pred = palloc0(sizeof(ParquetRowGroupPredicate));
+		pred->kind = PARQUET_PREDICATE_COMPARE;
+		pred->attnum = var->varattno - 1;
+		pred->hawqTypeID = var->vartype;
+		pred->constValue = con->constvalue;
+		if (OidIsValid(minOp))
+		{
+			pred->checkMin = true;
+			fmgr_info(get_opcode(minOp), &pred->minCheck);
+		}
+		if (OidIsValid(maxOp))
+		{
+			pred->checkMax = true;
+			fmgr_info(get_opcode(maxOp), &pred->maxCheck);
+		}
+		break;
+	}
+
+	list_free(opclasses);
+	list_free(opstrats);
+
+	return pred;
+}
+
+/*
+ * Length of PLAIN encoded min/max statistics for the type, 0 if the type
+ * has no min/max statistics. Must agree with updateColumnChunkStatistics.
+ */
+static int
+getStatisticsValueLen(int hawqTypeID)
+{
+	switch (hawqTypeID)
+	{
+		case HAWQ_TYPE_INT2:
+		case HAWQ_TYPE_INT4:
+		case HAWQ_TYPE_DATE:
+		case HAWQ_TYPE_FLOAT4:
+			return 4;
+		case HAWQ_TYPE_INT8:
+		case HAWQ_TYPE_TIME:
+		case HAWQ_TYPE_TIMESTAMP:
+		case HAWQ_TYPE_TIMESTAMPTZ:
+		case HAWQ_TYPE_FLOAT8:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+static Datum
+decodeStatisticsValue(uint8_t *value, int hawqTypeID)
+{
+	switch (hawqTypeID)
+	{
+		case HAWQ_TYPE_INT2:
+		{
+			int32 val;
+			memcpy(&val, value, sizeof(int32));
+			return Int16GetDatum((int16) val);
+		}
+		case HAWQ_TYPE_INT4:
+		case HAWQ_TYPE_DATE:
+		{
+			int32 val;
+			memcpy(&val, value, sizeof(int32));
+			return Int32GetDatum(val);
+		}
+		case HAWQ_TYPE_FLOAT4:
+		{
+			float4 val;
+			memcpy(&val, value, sizeof(float4));
+			return Float4GetDatum(val);
+		}
+		case HAWQ_TYPE_FLOAT8:
+		{
+			float8 val;
+			memcpy(&val, value, sizeof(float8));
+			return Float8GetDatum(val);
+		}
+		case HAWQ_TYPE_INT8:
+		case HAWQ_TYPE_TIME:
+		case HAWQ_TYPE_TIMESTAMP:
+		case HAWQ_TYPE_TIMESTAMPTZ:
+		{
+			int64 val;
+			memcpy(&val, value, sizeof(int64));
+			return Int64GetDatum(val);
+		}
+		default:
+			Insist(false);
+			return (Datum) 0;
+	}
+}
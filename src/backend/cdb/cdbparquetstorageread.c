@@ -126,6 +126,9 @@ static void ParquetStorageRead_FinishOpenFile(ParquetStorageRead *storageRead,
 
 	storageRead->file = fileHandlerfordata;
 	storageRead->fileHandlerForFooter = fileHandlerforfooter;
+
+	if (storageRead->prefetcher != NULL)
+		ParquetPrefetch_SetFile(storageRead->prefetcher, filePathName);
 	storageRead->rowGroupCount = storageRead->parquetMetadata->blockCount;
 	storageRead->rowGroupProcessedCount = 0;
 
@@ -156,6 +159,10 @@ void ParquetStorageRead_CloseFile(ParquetStorageRead *storageRead) {
 	if (storageRead->file == -1)
 		return;
 
+	/* read-ahead must not outlive the file it reads */
+	if (storageRead->prefetcher != NULL)
+		ParquetPrefetch_CloseFile(storageRead->prefetcher);
+
 	FileClose(storageRead->file);
 
 	storageRead->file = -1;
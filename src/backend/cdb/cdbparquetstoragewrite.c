@@ -8,6 +8,9 @@
 
 #include "postgres.h"
 
+#include <math.h>
+
+#include "access/hash.h"
 #include "catalog/catquery.h"
 #include "cdb/cdbparquetstoragewrite.h"
 #include "cdb/cdbparquetfooterserializer.h"
@@ -18,6 +21,7 @@
 #include "utils/numeric.h"
 #include "utils/xml.h"
 #include "utils/inet.h"
+#include "utils/guc.h"
 
 #include "snappy-c.h"
 #include "zlib.h"
@@ -32,9 +36,13 @@ static int encodeCurrentPage(
 static int finalizeCurrentAndNewPage(
 		ParquetColumnChunk columnChunk);
 
-static void flushDataPage(
+static void finalizePage(
 		ParquetColumnChunk chunk,
-		int page_number);
+		ParquetDataPage page,
+		StringInfo buf);
+
+static void flushPage(
+		ParquetDataPage page);
 
 static void initGroupType(
 		FileField_4C *field,
@@ -177,8 +185,50 @@ static bool ensureBufferCapacity(ParquetDataPage page,
 								 int newValueSize,
 								 int pageSizeLimit);
 
+static void updateColumnChunkStatistics(
+		ColumnChunkMetadata chunkmd,
+		Datum value);
+
+static int compareFloat8ForStatistics(float8 a, float8 b);
+
+/*----------------------------------------------------------------
+ * dictionary encoding
+ *----------------------------------------------------------------*/
+static bool isDictionaryEncodable(int hawqTypeId);
+
+static ParquetDictionary createDictionary(void);
+
+static void freeDictionary(ParquetDictionary dict);
+
+static int lookupOrAddDictionaryEntry(
+		ParquetDictionary dict,
+		const char *data,
+		int len,
+		int pageSizeLimit,
+		int *dict_bytes_added);
+
+static int encodeDictionary(
+		Datum data,
+		ParquetColumnChunk chunk,
+		int *dict_bytes_added);
+
+static int encodeDictionaryIndexes(
+		ParquetDataPage page,
+		ParquetDictionary dict);
+
+static void finalizeDictionaryPage(
+		ParquetColumnChunk chunk);
+
+static int encodeValue(
+		ParquetColumnChunk chunk,
+		Datum value,
+		int *dict_bytes_added);
+
 #define ENCODE_INVALID_VALUE	-1
 #define ENCODE_OUTOF_PAGE		-2
+#define ENCODE_OUTOF_DICTIONARY	-3
+
+#define DICTIONARY_INIT_ENTRIES	1024
 
 /**
  * generate hawq schema in to string. for example:
@@ -915,6 +965,11 @@ flushRowGroup(ParquetRowGroup rowgroup,
 
 		bytes_added += encodeCurrentPage(chunk);
 
+		if (chunk->dictionary != NULL && chunk->dictionary->numEntries > 0)
+		{
+			finalizeDictionaryPage(chunk);
+		}
+
 		/*----------------------------------------------------------------
 		 * recompute estimate chunk size based on uncompressed size (excludes header)
 		 *----------------------------------------------------------------*/
@@ -925,6 +980,22 @@ flushRowGroup(ParquetRowGroup rowgroup,
 		}
 		parquetmd->estimateChunkSizes[i] = (int) (parquetmd->estimateChunkSizes[i] * 1.05);
 
+		/*----------------------------------------------------------------
+		 * write out dictionary page (if any) ahead of data pages
+		 *----------------------------------------------------------------*/
+		if (chunk->dictionary != NULL && chunk->dictionary->page.finalized)
+		{
+			chunkmd->dictionaryPageOffset = FileNonVirtualTell(rowgroup->parquetFile);
+			if (chunkmd->dictionaryPageOffset < 0)
+			{
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("file tell position error for segment file: %s", strerror(errno)),
+						 errdetail("%s", HdfsGetLastError())));
+			}
+			flushPage(&chunk->dictionary->page);
+		}
+
 		/*----------------------------------------------------------------
 		 * write out pages one by one
 		 *----------------------------------------------------------------*/
@@ -938,7 +1009,7 @@ flushRowGroup(ParquetRowGroup rowgroup,
 		}
 		for (int pageno = 0; pageno < chunk->pageNumber; ++pageno)
 		{
-			flushDataPage(chunk, pageno);
+			flushPage(&chunk->pages[pageno]);
 		}
 
 		/*----------------------------------------------------------------
@@ -1004,6 +1075,12 @@ freeRowGroup(ParquetRowGroup rowgroup)
 	{
 		pfree(rowgroup->columnChunks[i].pages);
 
+		if (rowgroup->columnChunks[i].dictionary != NULL)
+		{
+			freeDictionary(rowgroup->columnChunks[i].dictionary);
+			rowgroup->columnChunks[i].dictionary = NULL;
+		}
+
 		/* chunk metadata should be kept util parquet_insert_finish */
 		rowgroup->columnChunks[i].columnChunkMetadata = NULL;
 	}
@@ -1054,9 +1131,13 @@ addSingleColumn(AppendOnlyEntry *catalog,
 		chunkmd->pEncodings[2] 			= PLAIN; /*set data encoding as PLAIN*/
 		chunkmd->file_offset 			= 0;
 		chunkmd->firstDataPage 			= 0;
+		chunkmd->dictionaryPageOffset	= 0;
 		chunkmd->totalSize 				= 0;
 		chunkmd->totalUncompressedSize 	= 0;
 		chunkmd->valueCount 			= 0;
+		chunkmd->hasStatistics			= 1;
+		chunkmd->nullCount				= 0;
+		chunkmd->statisticsValueLen		= 0; /*no min/max until first non-null value*/
 
 		if (catalog->compresstype == NULL)
 		{
@@ -1109,18 +1190,24 @@ addSingleColumn(AppendOnlyEntry *catalog,
 		chunk->compresstype					= catalog->compresstype;
 		chunk->compresslevel				= catalog->compresslevel;
 		chunk->parquetFile					= parquetFile;
+		chunk->dictionary					= NULL;
+
+		if (gp_parquet_dictionary_encoding &&
+			isDictionaryEncodable(chunkmd->hawqTypeId))
+		{
+			chunk->dictionary = createDictionary();
+		}
 
 		*colIndex = *colIndex + 1;
 	}
 }
 
 /*
- * Write out a specified data page (page header + page data)
+ * Write out a finalized page (page header + page data)
  */
 static void
-flushDataPage(ParquetColumnChunk chunk, int page_number)
+flushPage(ParquetDataPage page)
 {
-	ParquetDataPage page = &chunk->pages[page_number];
 	Assert(page != NULL);
 	Assert(page->finalized);
 	Assert(page->header_buffer != NULL);
@@ -1575,11 +1662,13 @@ int
 encodeCurrentPage(ParquetColumnChunk chunk)
 {
 	int bytes_added;
+	int dict_bytes_added;
 	ParquetDataPage current_page;
 	ParquetPageHeader header;
 	ColumnChunkMetadata chunkmd;
 
 	bytes_added = 0;
+	dict_bytes_added = 0;
 	current_page = chunk->currentPage;
 	header = current_page->header;
 	chunkmd = chunk->columnChunkMetadata;
@@ -1589,6 +1678,25 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 	if (current_page->finalized)
 		return 0;
 
+	/*----------------------------------------------------------------
+	 * Replace dictionary indexes buffered in values_buffer with their
+	 * final encoding. A page without any index (all nulls) is simply
+	 * written as PLAIN, so that it does not require a dictionary.
+	 *----------------------------------------------------------------*/
+	if (header->encoding == PLAIN_DICTIONARY)
+	{
+		if (header->uncompressed_page_size == 0)
+		{
+			header->encoding = PLAIN;
+		}
+		else
+		{
+			int values_len = encodeDictionaryIndexes(current_page, chunk->dictionary);
+			dict_bytes_added = values_len - header->uncompressed_page_size;
+			header->uncompressed_page_size = values_len;
+		}
+	}
+
 	/*----------------------------------------------------------------
 	 * Flush RLE/BitPack encoded data. Size of r and d data are
 	 * accumulated into page's uncompressed_page_size in this phase.
@@ -1670,14 +1778,32 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 		pfree(current_page->values_buffer);
 	}
 
+	finalizePage(chunk, current_page, &buf);
+
+	return bytes_added + dict_bytes_added;
+}
+
+/*
+ * Compress page data in `buf` if needed and save it to page->data, then
+ * serialize the page header to page->header_buffer. Page header must have
+ * been filled except for compressed_page_size.
+ *
+ * `buf` is consumed: either freed or taken over by page->data.
+ */
+static void
+finalizePage(ParquetColumnChunk chunk, ParquetDataPage page, StringInfo buf)
+{
+	ParquetPageHeader header = page->header;
+	ColumnChunkMetadata chunkmd = chunk->columnChunkMetadata;
+
 	/*----------------------------------------------------------------
-	 * Compress page data if needed, saved it to current_page->data.
+	 * Compress page data if needed, saved it to page->data.
 	 *----------------------------------------------------------------*/
 	switch (chunkmd->codec)
 	{
 		case UNCOMPRESSED:
 		{
-			current_page->data = (uint8_t*) buf.data;
+			page->data = (uint8_t*) buf->data;
 			header->compressed_page_size = header->uncompressed_page_size;
 			break;
 		}
@@ -1685,19 +1811,19 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 		case SNAPPY:
 		{
 			size_t compressedLen = snappy_max_compressed_length(header->uncompressed_page_size);
-			current_page->data = (uint8_t *) palloc(compressedLen);
+			page->data = (uint8_t *) palloc(compressedLen);
 
-			if (snappy_compress(buf.data, header->uncompressed_page_size,
-								(char *)current_page->data, &compressedLen) == SNAPPY_OK)
+			if (snappy_compress(buf->data, header->uncompressed_page_size,
+								(char *)page->data, &compressedLen) == SNAPPY_OK)
 			{
-				pfree(buf.data);
+				pfree(buf->data);
 				header->compressed_page_size = compressedLen;
 			}
 			else
 			{
 				ereport(ERROR,
 					(errcode(ERRCODE_GP_INTERNAL_ERROR),
-					 errmsg("snappy compression failed: %s", (char *)current_page->data)));
+					 errmsg("snappy compression failed: %s", (char *)page->data)));
 			}
 
 			break;
@@ -1713,7 +1839,7 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 			stream.zfree	= Z_NULL;
 			stream.opaque	= Z_NULL;
 			stream.avail_in	= header->uncompressed_page_size;
-			stream.next_in	= (Bytef *) buf.data;
+			stream.next_in	= (Bytef *) buf->data;
 
 			ret = deflateInit2(&stream, chunk->compresslevel, Z_DEFLATED,
 							   windowbits, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
@@ -1725,9 +1851,9 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 			}
 
 			size_t compressedLen = header->uncompressed_page_size;
-			current_page->data = (uint8_t *) palloc(compressedLen);
+			page->data = (uint8_t *) palloc(compressedLen);
 
-			Bytef *out = (Bytef *) current_page->data;
+			Bytef *out = (Bytef *) page->data;
 			int outlen = compressedLen;
 			
 			/* process until all inputs have been compressed */
@@ -1743,8 +1869,8 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 				{
 					/* out buffer is not big enough, extend 4096 byte at a time */
 					outlen = 4096;
-					current_page->data = repalloc(current_page->data, compressedLen + outlen);
-					out = current_page->data + compressedLen;
+					page->data = repalloc(page->data, compressedLen + outlen);
+					out = page->data + compressedLen;
 					compressedLen += outlen;
 				}
 				else
@@ -1760,7 +1886,7 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 			compressedLen = stream.total_out;
 			deflateEnd(&stream);
 
-			pfree(buf.data);
+			pfree(buf->data);
 			header->compressed_page_size = compressedLen;
 			break;
 		}
@@ -1780,23 +1906,21 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 	 * header in thrift.
 	 *----------------------------------------------------------------*/
 	uint8_t* header_buffer = NULL;
-	if (writePageMetadata(&header_buffer, (uint32_t *) &current_page->header_len,
-					  current_page->header) < 0)
+	if (writePageMetadata(&header_buffer, (uint32_t *) &page->header_len,
+					  page->header) < 0)
 	{
 		ereport(ERROR,
 				(errcode(ERRCODE_GP_INTERNAL_ERROR),
 				 errmsg("failed to serialize page metadata using thrift for column: %s", chunkmd->colName)));
 	}
 
-	current_page->header_buffer = (uint8_t *) palloc0(current_page->header_len);
-	memcpy(current_page->header_buffer, header_buffer, current_page->header_len);
+	page->header_buffer = (uint8_t *) palloc0(page->header_len);
+	memcpy(page->header_buffer, header_buffer, page->header_len);
 
-	chunkmd->totalUncompressedSize	+= current_page->header_len + header->uncompressed_page_size;
-	chunkmd->totalSize				+= current_page->header_len + header->compressed_page_size;
+	chunkmd->totalUncompressedSize	+= page->header_len + header->uncompressed_page_size;
+	chunkmd->totalSize				+= page->header_len + header->compressed_page_size;
 	
-	current_page->finalized = true;
-
-	return bytes_added;
+	page->finalized = true;
 }
 
 static void
@@ -1816,6 +1940,8 @@ addDataPage(ParquetColumnChunk chunk)
 	chunk->currentPage->finalized = false;
 	chunk->currentPage->header = (ParquetPageHeader) palloc0(sizeof(PageMetadata_4C));
 	chunk->currentPage->header->page_type = DATA_PAGE;
+	chunk->currentPage->header->encoding =
+			(chunk->dictionary != NULL && !chunk->dictionary->fallback) ? PLAIN_DICTIONARY : PLAIN;
 	chunk->currentPage->header->definition_level_encoding = RLE;
 	chunk->currentPage->header->repetition_level_encoding = RLE;
 	chunk->currentPage->parquetFile = chunk->parquetFile;
@@ -1889,6 +2015,7 @@ appendParquetColumnNull(ParquetColumnChunk columnChunk)
 
 	columnChunk->currentPage->header->num_values++;
 	columnChunk->columnChunkMetadata->valueCount++;
+	columnChunk->columnChunkMetadata->nullCount++;
 	return bytes_added;
 }
 
@@ -1910,6 +2037,39 @@ finalizeCurrentAndNewPage(ParquetColumnChunk columnChunk)
 	return bytes_added;
 }
 
+/*
+ * Encode value to chunk's current page, using dictionary if the chunk is
+ * dictionary encoded, otherwise PLAIN.
+ *
+ * If the dictionary is full, the chunk falls back to PLAIN encoding: the
+ * current page is finished by returning ENCODE_OUTOF_PAGE, or turned into a
+ * PLAIN page directly if no value has been added to it.
+ */
+static int
+encodeValue(ParquetColumnChunk chunk, Datum value, int *dict_bytes_added)
+{
+	if (chunk->dictionary != NULL && !chunk->dictionary->fallback)
+	{
+		int encoded_len = encodeDictionary(value, chunk, dict_bytes_added);
+		if (encoded_len != ENCODE_OUTOF_DICTIONARY)
+		{
+			return encoded_len;
+		}
+
+		chunk->dictionary->fallback = true;
+		if (chunk->currentPage->header->num_values > 0)
+		{
+			return ENCODE_OUTOF_PAGE;
+		}
+		chunk->currentPage->header->encoding = PLAIN;
+	}
+
+	return encodePlain(value,
+					   chunk->currentPage,
+					   chunk->columnChunkMetadata->hawqTypeId,
+					   chunk->pageSizeLimit);
+}
+
 /**
  * add a value to a column. includes: adding r to repetition level; adding d to definition level;
  * adding the value itself to page data section
@@ -1935,10 +2095,7 @@ appendParquetColumnValue(ParquetColumnChunk chunk,
 		addDataPage(chunk);
 	}
 
-	encoded_len = encodePlain(value,
-							  chunk->currentPage,
-							  chunk->columnChunkMetadata->hawqTypeId,
-							  chunk->pageSizeLimit);
+	encoded_len = encodeValue(chunk, value, &bytes_added);
 
 	if (encoded_len == ENCODE_INVALID_VALUE)
 	{
@@ -1951,11 +2108,7 @@ appendParquetColumnValue(ParquetColumnChunk chunk,
 	if (encoded_len == ENCODE_OUTOF_PAGE)
 	{
 		bytes_added += finalizeCurrentAndNewPage(chunk);
-		encoded_len = encodePlain(value,
-								  chunk->currentPage,
-								  chunk->columnChunkMetadata->hawqTypeId,
-								  chunk->pageSizeLimit);
-
+		encoded_len = encodeValue(chunk, value, &bytes_added);
 	}
 
 	bytes_added += encoded_len;
@@ -1974,9 +2127,376 @@ appendParquetColumnValue(ParquetColumnChunk chunk,
 
 	chunk->columnChunkMetadata->valueCount++;
 
+	updateColumnChunkStatistics(chunk->columnChunkMetadata, value);
+
 	return bytes_added;
 }
 
+/*
+ * Track min/max value of a column chunk. Only fixed-width types with a
+ * plain numeric ordering are tracked; min/max are kept in PLAIN encoding,
+ * the same as the value is written in data page.
+ *
+ * The ordering must agree with the type's default btree opclass, since
+ * scan compares these values using its operators. For float types that
+ * means NaN sorts after all other values.
+ */
+static void
+updateColumnChunkStatistics(ColumnChunkMetadata chunkmd, Datum value)
+{
+	switch (chunkmd->hawqTypeId)
+	{
+	case HAWQ_TYPE_INT2:
+	case HAWQ_TYPE_INT4:
+	case HAWQ_TYPE_DATE:
+	{
+		int32 val = (chunkmd->hawqTypeId == HAWQ_TYPE_INT2) ?
+					(int32) DatumGetInt16(value) : DatumGetInt32(value);
+		int32 minval;
+		int32 maxval;
+
+		if (chunkmd->statisticsValueLen == 0)
+		{
+			chunkmd->statisticsValueLen = sizeof(int32);
+			memcpy(chunkmd->minValue, &val, sizeof(int32));
+			memcpy(chunkmd->maxValue, &val, sizeof(int32));
+			break;
+		}
+		memcpy(&minval, chunkmd->minValue, sizeof(int32));
+		memcpy(&maxval, chunkmd->maxValue, sizeof(int32));
+		if (val < minval)
+			memcpy(chunkmd->minValue, &val, sizeof(int32));
+		if (val > maxval)
+			memcpy(chunkmd->maxValue, &val, sizeof(int32));
+		break;
+	}
+	case HAWQ_TYPE_INT8:
+	case HAWQ_TYPE_TIME:
+	case HAWQ_TYPE_TIMESTAMP:
+	case HAWQ_TYPE_TIMESTAMPTZ:
+	{
+		int64 val = DatumGetInt64(value);
+		int64 minval;
+		int64 maxval;
+
+		if (chunkmd->statisticsValueLen == 0)
+		{
+			chunkmd->statisticsValueLen = sizeof(int64);
+			memcpy(chunkmd->minValue, &val, sizeof(int64));
+			memcpy(chunkmd->maxValue, &val, sizeof(int64));
+			break;
+		}
+		memcpy(&minval, chunkmd->minValue, sizeof(int64));
+		memcpy(&maxval, chunkmd->maxValue, sizeof(int64));
+		if (val < minval)
+			memcpy(chunkmd->minValue, &val, sizeof(int64));
+		if (val > maxval)
+			memcpy(chunkmd->maxValue, &val, sizeof(int64));
+		break;
+	}
+	case HAWQ_TYPE_FLOAT4:
+	{
+		float4 val = DatumGetFloat4(value);
+		float4 minval;
+		float4 maxval;
+
+		if (chunkmd->statisticsValueLen == 0)
+		{
+			chunkmd->statisticsValueLen = sizeof(float4);
+			memcpy(chunkmd->minValue, &val, sizeof(float4));
+			memcpy(chunkmd->maxValue, &val, sizeof(float4));
+			break;
+		}
+		memcpy(&minval, chunkmd->minValue, sizeof(float4));
+		memcpy(&maxval, chunkmd->maxValue, sizeof(float4));
+		if (compareFloat8ForStatistics(val, minval) < 0)
+			memcpy(chunkmd->minValue, &val, sizeof(float4));
+		if (compareFloat8ForStatistics(val, maxval) > 0)
+			memcpy(chunkmd->maxValue, &val, sizeof(float4));
+		break;
+	}
+	case HAWQ_TYPE_FLOAT8:
+	{
+		float8 val = DatumGetFloat8(value);
+		float8 minval;
+		float8 maxval;
+
+		if (chunkmd->statisticsValueLen == 0)
+		{
+			chunkmd->statisticsValueLen = sizeof(float8);
+			memcpy(chunkmd->minValue, &val, sizeof(float8));
+			memcpy(chunkmd->maxValue, &val, sizeof(float8));
+			break;
+		}
+		memcpy(&minval, chunkmd->minValue, sizeof(float8));
+		memcpy(&maxval, chunkmd->maxValue, sizeof(float8));
+		if (compareFloat8ForStatistics(val, minval) < 0)
+			memcpy(chunkmd->minValue, &val, sizeof(float8));
+		if (compareFloat8ForStatistics(val, maxval) > 0)
+			memcpy(chunkmd->maxValue, &val, sizeof(float8));
+		break;
+	}
+	default:
+		/* no min/max for other types, only null count is kept */
+		break;
+	}
+}
+
+/*
+ * float comparison consistent with float4/float8 btree opclass,
+ * all NaNs are equal and larger than non-NaN values.
+ */
+static int
+compareFloat8ForStatistics(float8 a, float8 b)
+{
+	if (isnan(a))
+		return isnan(b) ? 0 : 1;
+	if (isnan(b))
+		return -1;
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+}
+
+/*
+ * Only text-like columns ([strategy 1] varlena types) are dictionary encoded,
+ * their values are likely to repeat and are expensive to store in PLAIN.
+ */
+static bool
+isDictionaryEncodable(int hawqTypeId)
+{
+	switch (hawqTypeId)
+	{
+	case HAWQ_TYPE_BYTE:
+	case HAWQ_TYPE_CHAR:
+	case HAWQ_TYPE_BPCHAR:
+	case HAWQ_TYPE_VARCHAR:
+	case HAWQ_TYPE_TEXT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static ParquetDictionary
+createDictionary(void)
+{
+	ParquetDictionary dict = palloc0(sizeof(struct ParquetDictionary_S));
+
+	initStringInfo(&dict->values);
+
+	dict->numEntries	= 0;
+	dict->maxEntries	= DICTIONARY_INIT_ENTRIES;
+	dict->entryOffsets	= palloc(dict->maxEntries * sizeof(int));
+	dict->entryHashes	= palloc(dict->maxEntries * sizeof(uint32));
+	dict->entryChain	= palloc(dict->maxEntries * sizeof(int));
+
+	dict->numBuckets	= DICTIONARY_INIT_ENTRIES;
+	dict->buckets		= palloc(dict->numBuckets * sizeof(int));
+	memset(dict->buckets, -1, dict->numBuckets * sizeof(int));
+
+	dict->fallback		= false;
+	return dict;
+}
+
+static void
+freeDictionary(ParquetDictionary dict)
+{
+	/* once finalized, `values` buffer is owned (or freed) by dictionary page */
+	if (!dict->page.finalized)
+	{
+		pfree(dict->values.data);
+	}
+	pfree(dict->entryOffsets);
+	pfree(dict->entryHashes);
+	pfree(dict->entryChain);
+	pfree(dict->buckets);
+	pfree(dict);
+}
+
+/*
+ * Return index of the value in dictionary, the value is added to dictionary
+ * if it is not found, in which case `dict_bytes_added` is increased by its
+ * PLAIN encoded length.
+ *
+ * Return ENCODE_OUTOF_DICTIONARY if the value is not found and adding it
+ * will make dictionary exceed `pageSizeLimit`.
+ */
+static int
+lookupOrAddDictionaryEntry(ParquetDictionary dict,
+						   const char *data,
+						   int len,
+						   int pageSizeLimit,
+						   int *dict_bytes_added)
+{
+	uint32	hash = DatumGetUInt32(hash_any((const unsigned char *) data, len));
+	int		entry;
+
+	for (entry = dict->buckets[hash & (dict->numBuckets - 1)];
+		 entry >= 0;
+		 entry = dict->entryChain[entry])
+	{
+		char	*entryData = dict->values.data + dict->entryOffsets[entry];
+		int32	entryLen;
+
+		if (dict->entryHashes[entry] != hash)
+			continue;
+
+		memcpy(&entryLen, entryData, 4);
+		if (entryLen == len && memcmp(entryData + 4, data, len) == 0)
+			return entry;
+	}
+
+	if (dict->values.len + 4 + len > pageSizeLimit)
+	{
+		return ENCODE_OUTOF_DICTIONARY;
+	}
+
+	/* enlarge entry arrays, and rebuild buckets to keep chains short */
+	if (dict->numEntries >= dict->maxEntries)
+	{
+		dict->maxEntries *= 2;
+		dict->entryOffsets	= repalloc(dict->entryOffsets, dict->maxEntries * sizeof(int));
+		dict->entryHashes	= repalloc(dict->entryHashes, dict->maxEntries * sizeof(uint32));
+		dict->entryChain	= repalloc(dict->entryChain, dict->maxEntries * sizeof(int));
+
+		dict->numBuckets	= dict->maxEntries;
+		dict->buckets		= repalloc(dict->buckets, dict->numBuckets * sizeof(int));
+		memset(dict->buckets, -1, dict->numBuckets * sizeof(int));
+
+		for (int i = 0; i < dict->numEntries; i++)
+		{
+			int bucket = dict->entryHashes[i] & (dict->numBuckets - 1);
+			dict->entryChain[i] = dict->buckets[bucket];
+			dict->buckets[bucket] = i;
+		}
+	}
+
+	entry = dict->numEntries++;
+	dict->entryOffsets[entry]	= dict->values.len;
+	dict->entryHashes[entry]	= hash;
+	dict->entryChain[entry]		= dict->buckets[hash & (dict->numBuckets - 1)];
+	dict->buckets[hash & (dict->numBuckets - 1)] = entry;
+
+	/* same as PLAIN encoding of [strategy 1] types */
+	appendBinaryStringInfo(&dict->values, (char *) &(/*htole32(*/len/*)*/), 4);
+	appendBinaryStringInfo(&dict->values, data, len);
+
+	*dict_bytes_added += 4 + len;
+	return entry;
+}
+
+/*
+ * Append dictionary index of `data` to current page of `chunk`, add `data`
+ * to chunk's dictionary if needed. Indexes are buffered as int32 in page's
+ * values_buffer until the page is finalized.
+ *
+ * Return values are the same as encodePlain(), besides ENCODE_OUTOF_DICTIONARY
+ * is returned if `data` can not be added to the dictionary.
+ */
+static int
+encodeDictionary(Datum data, ParquetColumnChunk chunk, int *dict_bytes_added)
+{
+	ParquetDataPage page = chunk->currentPage;
+	struct varlena *varlen = (struct varlena *) DatumGetPointer(data);
+	Assert(!VARATT_IS_COMPRESSED(varlen) && !VARATT_IS_EXTERNAL(varlen));
+
+	int puredataSize = VARSIZE_ANY_EXHDR(varlen);
+	int32 index;
+
+	if (puredataSize + 4 > chunk->pageSizeLimit)
+	{
+		return ENCODE_INVALID_VALUE;
+	}
+	if (!ensureBufferCapacity(page, sizeof(int32), chunk->pageSizeLimit))
+	{
+		return ENCODE_OUTOF_PAGE;
+	}
+
+	index = lookupOrAddDictionaryEntry(chunk->dictionary,
+									   VARDATA_ANY(varlen),
+									   puredataSize,
+									   chunk->pageSizeLimit,
+									   dict_bytes_added);
+	if (index < 0)
+	{
+		return index;
+	}
+
+	memcpy(page->values_buffer + page->header->uncompressed_page_size,
+		   &index, sizeof(int32));
+	return sizeof(int32);
+}
+
+/*
+ * Encode int32 dictionary indexes buffered in page's values_buffer as
+ * <1-byte bit width> + <RLE/bit-packing hybrid encoded indexes>,
+ * the result overwrites values_buffer.
+ *
+ * Return length of the encoded values.
+ */
+static int
+encodeDictionaryIndexes(ParquetDataPage page, ParquetDictionary dict)
+{
+	RLEEncoder	encoder;
+	int32		*indexes = (int32 *) page->values_buffer;
+	int			numIndexes = page->header->uncompressed_page_size / sizeof(int32);
+	int			bitWidth = dict->numEntries > 1 ? widthFromMaxInt(dict->numEntries - 1) : 1;
+	int			len;
+
+	RLEEncoder_Init(&encoder, bitWidth);
+	for (int i = 0; i < numIndexes; i++)
+	{
+		RLEEncoder_WriteInt(&encoder, indexes[i]);
+	}
+	RLEEncoder_Flush(&encoder);
+
+	len = 1 + RLEEncoder_Size(&encoder);
+	if (len > page->values_buffer_capacity)
+	{
+		page->values_buffer_capacity = len;
+		page->values_buffer = repalloc(page->values_buffer, len);
+	}
+
+	page->values_buffer[0] = (uint8_t) bitWidth;
+	memcpy(page->values_buffer + 1, RLEEncoder_Data(&encoder), RLEEncoder_Size(&encoder));
+
+	pfree(encoder.writer.buffer);
+	pfree(encoder.packBuffer);
+
+	return len;
+}
+
+/*
+ * Build the dictionary page from chunk's dictionary. It is written before
+ * all data pages of the chunk, and accounted in chunk's total size.
+ */
+static void
+finalizeDictionaryPage(ParquetColumnChunk chunk)
+{
+	ParquetDictionary	dict = chunk->dictionary;
+	ParquetDataPage		page = &dict->page;
+	ColumnChunkMetadata	chunkmd = chunk->columnChunkMetadata;
+
+	Assert(dict->numEntries > 0);
+
+	page->header = (ParquetPageHeader) palloc0(sizeof(PageMetadata_4C));
+	page->header->page_type					= DICTIONARY_PAGE;
+	page->header->encoding					= PLAIN_DICTIONARY;
+	page->header->num_values				= dict->numEntries;
+	page->header->uncompressed_page_size	= dict->values.len;
+	page->parquetFile						= chunk->parquetFile;
+
+	finalizePage(chunk, page, &dict->values);
+
+	/* chunk contains dictionary encoded pages */
+	chunkmd->pEncodings = repalloc(chunkmd->pEncodings,
+								   (chunkmd->EncodingCount + 1) * sizeof(enum Encoding));
+	chunkmd->pEncodings[chunkmd->EncodingCount++] = PLAIN_DICTIONARY;
+}
+
 /*
  * Append null for field. 
  *
@@ -0,0 +1,545 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbsharedplan.c
+ *	  Sharing of a dispatched plan among the QEs of a segment host.
+ *
+ * (See .h file for usage comments)
+ *
+ * The cache is a fixed array of entries and a pool of fixed size chunks
+ * holding their data; the chunks of an entry are chained, so that entries
+ * of any size up to the whole pool fit without fragmentation. The publisher
+ * allocates the chunks under SharedPlanLock and copies the data without the
+ * lock, readers copy the data out under a shared lock.
+ *
+ * A publisher which cannot store the data leaves a failed entry without
+ * chunks behind, so that its readers give up at once instead of waiting for
+ * the data until they time out.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "cdb/cdbsharedplan.h"
+#include "cdb/cdbvars.h"
+#include "libpq/pqformat.h"
+#include "miscadmin.h"
+#include "postmaster/identity.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/timestamp.h"
+
+#define SHARED_PLAN_CHUNK_SIZE		(64 * 1024)
+#define SHARED_PLAN_MAX_ENTRIES		64
+
+/* how long readers wait for the publisher, and entries for their readers */
+#define SHARED_PLAN_TIMEOUT_MS		60000
+
+#define SHARED_PLAN_PARTS			4
+
+typedef enum SharedPlanEntryState
+{
+	SPE_FREE = 0,
+	SPE_FILLING,				/* chunks allocated, publisher copying */
+	SPE_READY,
+	SPE_FAILED					/* publisher could not store the data */
+} SharedPlanEntryState;
+
+typedef struct SharedPlanEntry
+{
+	SharedPlanEntryState state;
+
+	/* key */
+	int			session_id;
+	int			command_count;
+	uint32		hash;
+
+	int			lens[SHARED_PLAN_PARTS];
+	int			total_len;
+	int			readers;		/* readers which have not copied it yet */
+	TimestampTz stored_at;
+	int			first_chunk;
+} SharedPlanEntry;
+
+typedef struct SharedPlanCache
+{
+	int			num_chunks;
+	int			free_chunks;
+	int			free_list;		/* first free chunk, -1 if none */
+	SharedPlanEntry entries[SHARED_PLAN_MAX_ENTRIES];
+	int			chunk_next[1];	/* VARIABLE LENGTH ARRAY, then the chunks */
+} SharedPlanCache;
+
+static SharedPlanCache *sharedPlanCache = NULL;
+static char *sharedPlanChunks = NULL;
+
+#define SHARED_PLAN_CHUNK(i)	(sharedPlanChunks + (Size) (i) * SHARED_PLAN_CHUNK_SIZE)
+
+static int
+SharedPlanNumChunks(void)
+{
+	return ((int64) gp_dispatch_plan_cache_size * 1024) / SHARED_PLAN_CHUNK_SIZE;
+}
+
+/*
+ * Report shared-memory space needed by SharedPlanShmemInit. The cache is
+ * only needed by segments.
+ */
+Size
+SharedPlanShmemSize(void)
+{
+	Size		size;
+	int			num_chunks = SharedPlanNumChunks();
+
+	if (!AmISegment() || num_chunks == 0)
+		return 0;
+
+	size = offsetof(SharedPlanCache, chunk_next);
+	size = add_size(size, mul_size(sizeof(int), num_chunks));
+	size = MAXALIGN(size);
+	size = add_size(size, mul_size(SHARED_PLAN_CHUNK_SIZE, num_chunks));
+
+	return size;
+}
+
+void
+SharedPlanShmemInit(void)
+{
+	bool		found;
+	Size		size = SharedPlanShmemSize();
+	int			i;
+
+	if (size == 0)
+		return;
+
+	sharedPlanCache = (SharedPlanCache *)
+		ShmemInitStruct("Shared Dispatched Plan", size, &found);
+	sharedPlanChunks = (char *) sharedPlanCache +
+		MAXALIGN(offsetof(SharedPlanCache, chunk_next) +
+				 sizeof(int) * SharedPlanNumChunks());
+
+	if (found)
+		return;
+
+	MemSet(sharedPlanCache->entries, 0, sizeof(sharedPlanCache->entries));
+	sharedPlanCache->num_chunks = SharedPlanNumChunks();
+	sharedPlanCache->free_chunks = sharedPlanCache->num_chunks;
+	for (i = 0; i < sharedPlanCache->num_chunks; i++)
+		sharedPlanCache->chunk_next[i] = i + 1;
+	sharedPlanCache->chunk_next[sharedPlanCache->num_chunks - 1] = -1;
+	sharedPlanCache->free_list = 0;
+}
+
+static void
+SharedPlanGetParts(SharedPlanData *data, const char **parts, int *lens)
+{
+	parts[0] = data->querytree;
+	lens[0] = data->querytreelen;
+	parts[1] = data->plantree;
+	lens[1] = data->plantreelen;
+	parts[2] = data->sliceinfo;
+	lens[2] = data->sliceinfolen;
+	parts[3] = data->resource;
+	lens[3] = data->resourcelen;
+}
+
+static uint32
+SharedPlanHash(SharedPlanData *data)
+{
+	const char *parts[SHARED_PLAN_PARTS];
+	int			lens[SHARED_PLAN_PARTS];
+	uint32		hash = 0;
+	int			i;
+
+	SharedPlanGetParts(data, parts, lens);
+	for (i = 0; i < SHARED_PLAN_PARTS; i++)
+	{
+		hash = (hash << 1) | (hash >> 31);
+		if (lens[i] > 0)
+			hash ^= DatumGetUInt32(hash_any((const unsigned char *) parts[i], lens[i]));
+	}
+
+	return hash;
+}
+
+/*
+ * SharedPlanBuildRef
+ *	Build the reference to the shared data of a statement, which readers
+ *	receive in place of the query tree.
+ */
+char *
+SharedPlanBuildRef(SharedPlanData *data, int *reflen)
+{
+	StringInfoData buf;
+
+	initStringInfo(&buf);
+	pq_sendint(&buf, (int) SharedPlanHash(data), 4);
+	pq_sendint(&buf, data->querytreelen, 4);
+	pq_sendint(&buf, data->plantreelen, 4);
+	pq_sendint(&buf, data->sliceinfolen, 4);
+	pq_sendint(&buf, data->resourcelen, 4);
+
+	*reflen = buf.len;
+	return buf.data;
+}
+
+static SharedPlanEntry *
+SharedPlanLookup(uint32 hash)
+{
+	int			i;
+
+	for (i = 0; i < SHARED_PLAN_MAX_ENTRIES; i++)
+	{
+		SharedPlanEntry *entry = &sharedPlanCache->entries[i];
+
+		if (entry->state != SPE_FREE &&
+			entry->session_id == gp_session_id &&
+			entry->command_count == gp_command_count &&
+			entry->hash == hash)
+			return entry;
+	}
+
+	return NULL;
+}
+
+/* Caller must hold SharedPlanLock exclusively */
+static void
+SharedPlanFreeEntry(SharedPlanEntry *entry)
+{
+	int			chunk = entry->first_chunk;
+
+	while (chunk != -1)
+	{
+		int			next = sharedPlanCache->chunk_next[chunk];
+
+		sharedPlanCache->chunk_next[chunk] = sharedPlanCache->free_list;
+		sharedPlanCache->free_list = chunk;
+		sharedPlanCache->free_chunks++;
+		chunk = next;
+	}
+
+	entry->state = SPE_FREE;
+	entry->first_chunk = -1;
+}
+
+/*
+ * Reclaim entries whose readers did not come in time, the statement has
+ * failed on the QD by then. Caller must hold SharedPlanLock exclusively.
+ */
+static void
+SharedPlanReclaim(TimestampTz now)
+{
+	int			i;
+
+	for (i = 0; i < SHARED_PLAN_MAX_ENTRIES; i++)
+	{
+		SharedPlanEntry *entry = &sharedPlanCache->entries[i];
+
+		if (entry->state != SPE_FREE &&
+			TimestampDifferenceExceeds(entry->stored_at, now, SHARED_PLAN_TIMEOUT_MS))
+		{
+			elog(LOG, "reclaim shared plan of session %d command %d, %d readers did not come",
+				 entry->session_id, entry->command_count, entry->readers);
+			SharedPlanFreeEntry(entry);
+		}
+	}
+}
+
+/*
+ * Allocate an entry and its chunks for `total_len` bytes, return NULL if
+ * the cache is full. Caller must hold SharedPlanLock exclusively.
+ */
+static SharedPlanEntry *
+SharedPlanAllocEntry(int total_len)
+{
+	SharedPlanEntry *entry = NULL;
+	int			nchunks = (total_len + SHARED_PLAN_CHUNK_SIZE - 1) / SHARED_PLAN_CHUNK_SIZE;
+	int		   *link;
+	int			i;
+
+	if (nchunks > sharedPlanCache->free_chunks)
+		return NULL;
+
+	for (i = 0; i < SHARED_PLAN_MAX_ENTRIES; i++)
+	{
+		if (sharedPlanCache->entries[i].state == SPE_FREE)
+		{
+			entry = &sharedPlanCache->entries[i];
+			break;
+		}
+	}
+	if (entry == NULL)
+		return NULL;
+
+	entry->first_chunk = -1;
+	link = &entry->first_chunk;
+	for (i = 0; i < nchunks; i++)
+	{
+		int			chunk = sharedPlanCache->free_list;
+
+		sharedPlanCache->free_list = sharedPlanCache->chunk_next[chunk];
+		sharedPlanCache->free_chunks--;
+		sharedPlanCache->chunk_next[chunk] = -1;
+		*link = chunk;
+		link = &sharedPlanCache->chunk_next[chunk];
+	}
+
+	entry->state = SPE_FILLING;
+	entry->total_len = total_len;
+
+	return entry;
+}
+
+/*
+ * Tell the readers of a statement that its publisher could not store the
+ * data. No entry is left if all of them are in use, the readers time out
+ * then.
+ */
+static void
+SharedPlanPublishFailed(uint32 hash, int readers)
+{
+	SharedPlanEntry *entry;
+
+	LWLockAcquire(SharedPlanLock, LW_EXCLUSIVE);
+
+	/* Another publisher of the same statement may have stored it meanwhile. */
+	entry = SharedPlanLookup(hash);
+	if (entry != NULL)
+		entry->readers += readers;
+	else
+	{
+		entry = SharedPlanAllocEntry(0);
+		if (entry != NULL)
+		{
+			entry->state = SPE_FAILED;
+			entry->session_id = gp_session_id;
+			entry->command_count = gp_command_count;
+			entry->hash = hash;
+			MemSet(entry->lens, 0, sizeof(entry->lens));
+			entry->readers = readers;
+			entry->stored_at = GetCurrentTimestamp();
+		}
+	}
+
+	LWLockRelease(SharedPlanLock);
+}
+
+/*
+ * SharedPlanPublish
+ *	Keep the shared data of the current statement for `readers` other QEs
+ *	of this segment.
+ */
+void
+SharedPlanPublish(SharedPlanData *data, int readers)
+{
+	const char *parts[SHARED_PLAN_PARTS];
+	int			lens[SHARED_PLAN_PARTS];
+	uint32		hash = SharedPlanHash(data);
+	int			total_len = 0;
+	SharedPlanEntry *entry;
+	TimestampTz start = GetCurrentTimestamp();
+	int			chunk;
+	int			offset;
+	int			i;
+
+	if (sharedPlanCache == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not share dispatched plan, gp_dispatch_plan_cache_size is 0 on this segment")));
+
+	SharedPlanGetParts(data, parts, lens);
+	for (i = 0; i < SHARED_PLAN_PARTS; i++)
+		total_len += lens[i];
+
+	PG_TRY();
+	{
+		for (;;)
+		{
+			TimestampTz now = GetCurrentTimestamp();
+
+			LWLockAcquire(SharedPlanLock, LW_EXCLUSIVE);
+
+			/* Another publisher of the same statement already stored the data. */
+			entry = SharedPlanLookup(hash);
+			if (entry != NULL)
+			{
+				entry->readers += readers;
+				entry->stored_at = now;
+				LWLockRelease(SharedPlanLock);
+				entry = NULL;
+				break;
+			}
+
+			SharedPlanReclaim(now);
+			entry = SharedPlanAllocEntry(total_len);
+			if (entry != NULL)
+			{
+				entry->session_id = gp_session_id;
+				entry->command_count = gp_command_count;
+				entry->hash = hash;
+				memcpy(entry->lens, lens, sizeof(entry->lens));
+				entry->readers = readers;
+				entry->stored_at = now;
+				LWLockRelease(SharedPlanLock);
+				break;
+			}
+			LWLockRelease(SharedPlanLock);
+
+			/* Wait for readers of other statements to free some chunks. */
+			if (TimestampDifferenceExceeds(start, now, SHARED_PLAN_TIMEOUT_MS))
+				ereport(ERROR,
+						(errcode(ERRCODE_OUT_OF_MEMORY),
+						 errmsg("could not share dispatched plan of %d bytes, shared plan cache is full",
+								total_len),
+						 errhint("Increase gp_dispatch_plan_cache_size, or turn off gp_dispatch_plan_per_host.")));
+			pg_usleep(1000L);
+			CHECK_FOR_INTERRUPTS();
+		}
+	}
+	PG_CATCH();
+	{
+		SharedPlanPublishFailed(hash, readers);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	if (entry == NULL)
+		return;
+
+	/* The chunks are ours until the entry is ready, copy without the lock. */
+	chunk = entry->first_chunk;
+	offset = 0;
+	for (i = 0; i < SHARED_PLAN_PARTS; i++)
+	{
+		int			copied = 0;
+
+		while (copied < lens[i])
+		{
+			int			n = Min(lens[i] - copied, SHARED_PLAN_CHUNK_SIZE - offset);
+
+			memcpy(SHARED_PLAN_CHUNK(chunk) + offset, parts[i] + copied, n);
+			copied += n;
+			offset += n;
+			if (offset == SHARED_PLAN_CHUNK_SIZE)
+			{
+				chunk = sharedPlanCache->chunk_next[chunk];
+				offset = 0;
+			}
+		}
+	}
+
+	LWLockAcquire(SharedPlanLock, LW_EXCLUSIVE);
+	entry->state = SPE_READY;
+	LWLockRelease(SharedPlanLock);
+}
+
+/*
+ * SharedPlanFetch
+ *	Copy the shared data referred to by `ref` out of the cache, waiting for
+ *	the publisher if needed. The parts are palloc'd in one buffer.
+ */
+void
+SharedPlanFetch(const char *ref, int reflen, SharedPlanData *data)
+{
+	StringInfoData buf;
+	uint32		hash;
+	int			lens[SHARED_PLAN_PARTS];
+	int			total_len = 0;
+	char	   *copy;
+	TimestampTz start = GetCurrentTimestamp();
+	int			i;
+
+	if (sharedPlanCache == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not get shared dispatched plan, gp_dispatch_plan_cache_size is 0 on this segment")));
+
+	buf.data = (char *) ref;
+	buf.len = reflen;
+	buf.maxlen = reflen;
+	buf.cursor = 0;
+	hash = (uint32) pq_getmsgint(&buf, 4);
+	for (i = 0; i < SHARED_PLAN_PARTS; i++)
+	{
+		lens[i] = pq_getmsgint(&buf, 4);
+		total_len += lens[i];
+	}
+	pq_getmsgend(&buf);
+
+	/* allocate before taking the lock */
+	copy = palloc(Max(total_len, 1));
+
+	for (;;)
+	{
+		SharedPlanEntry *entry;
+		TimestampTz now;
+
+		LWLockAcquire(SharedPlanLock, LW_SHARED);
+		entry = SharedPlanLookup(hash);
+		if (entry != NULL && entry->state == SPE_FAILED)
+		{
+			LWLockRelease(SharedPlanLock);
+
+			LWLockAcquire(SharedPlanLock, LW_EXCLUSIVE);
+			entry = SharedPlanLookup(hash);
+			if (entry != NULL && --entry->readers <= 0)
+				SharedPlanFreeEntry(entry);
+			LWLockRelease(SharedPlanLock);
+
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("the QE publishing the shared dispatched plan of session %d command %d failed",
+							gp_session_id, gp_command_count)));
+		}
+		if (entry != NULL && entry->state == SPE_READY)
+		{
+			int			chunk = entry->first_chunk;
+			int			copied = 0;
+
+			if (entry->total_len != total_len ||
+				memcmp(entry->lens, lens, sizeof(lens)) != 0)
+			{
+				LWLockRelease(SharedPlanLock);
+				elog(ERROR, "shared dispatched plan of session %d command %d does not match its reference",
+					 gp_session_id, gp_command_count);
+			}
+
+			while (copied < total_len)
+			{
+				int			n = Min(total_len - copied, SHARED_PLAN_CHUNK_SIZE);
+
+				memcpy(copy + copied, SHARED_PLAN_CHUNK(chunk), n);
+				copied += n;
+				chunk = sharedPlanCache->chunk_next[chunk];
+			}
+			LWLockRelease(SharedPlanLock);
+
+			/* The entry cannot go away but by timeout, look it up again. */
+			LWLockAcquire(SharedPlanLock, LW_EXCLUSIVE);
+			entry = SharedPlanLookup(hash);
+			if (entry != NULL && --entry->readers <= 0)
+				SharedPlanFreeEntry(entry);
+			LWLockRelease(SharedPlanLock);
+			break;
+		}
+		LWLockRelease(SharedPlanLock);
+
+		now = GetCurrentTimestamp();
+		if (TimestampDifferenceExceeds(start, now, SHARED_PLAN_TIMEOUT_MS))
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("timed out waiting for the shared dispatched plan of session %d command %d",
+							gp_session_id, gp_command_count)));
+		pg_usleep(1000L);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	data->querytree = lens[0] > 0 ? copy : NULL;
+	data->querytreelen = lens[0];
+	data->plantree = lens[1] > 0 ? copy + lens[0] : NULL;
+	data->plantreelen = lens[1];
+	data->sliceinfo = lens[2] > 0 ? copy + lens[0] + lens[1] : NULL;
+	data->sliceinfolen = lens[2];
+	data->resource = lens[3] > 0 ? copy + lens[0] + lens[1] + lens[2] : NULL;
+	data->resourcelen = lens[3];
+}
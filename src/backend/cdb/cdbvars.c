@@ -89,6 +89,8 @@ int			gp_reject_percent_threshold; /* SREH reject % kicks off only after *
 
 int			gp_max_csv_line_length;		/* max allowed len for csv data line in bytes */
 
+bool		gp_copy_raw_chunks = false;	/* COPY FROM ships unparsed lines to segments */
+
 bool          gp_select_invisible=false; /* debug mode to allow select to see "invisible" rows */
 
 /*
@@ -157,6 +159,7 @@ int			Gp_interconnect_min_rto=20;
 int			Gp_interconnect_fc_method=INTERCONNECT_FC_METHOD_LOSS;
 int			Gp_interconnect_transmit_timeout=3600;
 int			Gp_interconnect_min_retries_before_timeout=100;
+int			Gp_interconnect_syscall_batch_size=1;
 
 int			Gp_interconnect_hash_multiplier=2;	/* sets the size of the hash table used by the UDP-IC */
 
@@ -255,6 +258,18 @@ bool		gp_enable_alter_table_inherit_cols = false;
 /* During insertion in a table with parquet partitions, require tuples to be sorted by partition key */
 bool		gp_parquet_insert_sort = true;
 
+/* Skip parquet row groups using column chunk statistics during scan */
+bool		gp_parquet_rowgroup_filter = true;
+
+/* Dictionary encode text-like parquet columns on insert */
+bool		gp_parquet_dictionary_encoding = true;
+
+/* Size (KB) of the per-column read window of parquet scan */
+int			gp_parquet_scan_buffer_size = 1024;
+
+/* Memory (KB) for parquet column data read ahead during scan */
+int			gp_parquet_prefetch_memory = 8 * 1024;
+
 /* The following GUCs is for HAWQ 2.o */
 
 bool optimizer_enforce_hash_dist_policy;
@@ -286,6 +301,8 @@ double metadata_cache_free_block_normal_ratio;
 char *metadata_cache_testfile;
 bool debug_fake_datalocality;
 bool datalocality_remedy_enable;
+int datalocality_fetch_threads;
+int datalocality_assignment_cache_size;
 bool get_tmpdir_from_rm;
 bool debug_fake_segmentnum;
 
@@ -356,6 +373,10 @@ bool		gp_enable_motion_deadlock_sanity = FALSE; /* planning time sanity check */
 #ifdef USE_ASSERT_CHECKING
 bool		gp_mk_sort_check = false;
 #endif
+/* Threads besides the backend sorting an in-memory mk sort, 0 for none */
+int			gp_mk_sort_parallel_workers = 0;
+/* Read-ahead per input tape of an mk sort merge, in KB, 0 for none */
+int			gp_mk_sort_merge_readahead = 0;
 bool 		trace_sort = false;
 int			gp_sort_flags = 0;
 int			gp_dbg_flags = 0;
@@ -379,14 +400,25 @@ int gp_segworker_relative_priority = PRIO_MAX;
 /* Max size of dispatched plans; 0 if no limit */
 int			gp_max_plan_size = 0;
 
+/* Dispatch the plan once per segment host, see cdbsharedplan.h */
+bool		gp_dispatch_plan_per_host = false;
+int			gp_dispatch_plan_cache_size = 16384;
+
+/* Watch all executors of a query in one reused thread */
+bool		gp_dispatch_event_driven = false;
+
 /* Disable setting of tuple hints while reading */
 bool		gp_disable_tuple_hints = false;
 int		gp_hashagg_compress_spill_files = 0;
 
 int gp_workfile_compress_algorithm = 0;
 bool gp_workfile_checksumming = false;
+/* Write and read bfz work files in a background thread */
+bool gp_workfile_async_io = true;
 bool gp_workfile_caching = false;
 bool gp_metadata_versioning = false;
+/* Size of the shared cache of translated metadata objects, in kilobytes */
+int gp_mdver_mdobj_cache_size = 0;
 int gp_workfile_caching_loglevel = DEBUG1;
 int gp_mdversioning_loglevel = DEBUG1;
 int gp_sessionstate_loglevel = DEBUG1;
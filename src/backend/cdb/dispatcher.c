@@ -29,6 +29,7 @@
 #include "cdb/cdbrelsize.h"	/* clear_relsize_cache */
 #include "utils/memutils.h"	/* GetMemoryChunkContext */
 #include "cdb/cdbsrlz.h"	/* serializeNode */
+#include "cdb/cdbsharedplan.h"	/* SharedPlanBuildRef */
 #include "utils/datum.h"	/* datumGetSize */
 #include "utils/lsyscache.h"	/* get_typlenbyval */
 #include "miscadmin.h"		/* CHECK_FOR_INTERRUPTS */
@@ -1027,6 +1028,108 @@ dispatcher_serialize_query_resource(DispatchData *data)
 	}
 }
 
+/*
+ * dispatcher_share_plan_per_host
+ *	With gp_dispatch_plan_per_host, pick one executor per segment host to
+ *	receive the query tree, plan, slice info and resource; it publishes them
+ *	to the shared plan cache of the segment, where the other executors of
+ *	the host read them. See cdbsharedplan.h.
+ */
+static void
+dispatcher_share_plan_per_host(DispatchData *data)
+{
+	typedef struct HostPublisher {
+		Segment					*segment;
+		struct QueryExecutor	*publisher;
+		int						readers;
+	} HostPublisher;
+
+	DispatchCommandQueryParms	*parms = data->pQueryParms;
+	QueryExecutorIterator	iterator;
+	struct QueryExecutor	*executor;
+	SharedPlanData	shared;
+	List		*hosts = NIL;
+	ListCell	*lc;
+	int64		shared_len;
+	int			readers = 0;
+
+	if (!gp_dispatch_plan_per_host || parms == NULL ||
+		parms->serializedPlantreelen == 0)
+		return;
+
+	/* The cache must hold the plan of other statements too. */
+	shared_len = (int64) parms->serializedQuerytreelen +
+		parms->serializedPlantreelen + parms->serializedSliceInfolen +
+		parms->serializedQueryResourcelen;
+	if (shared_len > (int64) gp_dispatch_plan_cache_size * 1024 / 2)
+		return;
+
+	dispmgt_init_query_executor_iterator(data->query_executor_team, &iterator);
+	while ((executor = dispmgt_get_query_executor_iterator(&iterator)) != NULL)
+	{
+		Segment		*segment = executormgr_get_executor_segment(executor);
+		HostPublisher	*host = NULL;
+
+		/* The entry db shares the memory of the QD host, leave it alone. */
+		if (segment == NULL || segment->master || segment->standby)
+			continue;
+
+		foreach(lc, hosts)
+		{
+			HostPublisher *h = lfirst(lc);
+
+			if (h->segment->port == segment->port &&
+				strcmp(h->segment->hostname, segment->hostname) == 0)
+			{
+				host = h;
+				break;
+			}
+		}
+
+		if (host == NULL)
+		{
+			host = palloc0(sizeof(HostPublisher));
+			host->segment = segment;
+			host->publisher = executor;
+			hosts = lappend(hosts, host);
+		}
+		else if (host->readers < GP_DISPATCH_FLAG_MAX_READERS)
+		{
+			executormgr_set_dispatch_flags(executor, GP_DISPATCH_FLAG_PLAN_SHARED);
+			host->readers++;
+			readers++;
+		}
+	}
+
+	foreach(lc, hosts)
+	{
+		HostPublisher *host = lfirst(lc);
+
+		if (host->readers > 0)
+			executormgr_set_dispatch_flags(host->publisher,
+					GP_DISPATCH_FLAG_PLAN_PUBLISH |
+					(host->readers << GP_DISPATCH_FLAG_READERS_SHIFT));
+	}
+
+	if (readers > 0)
+	{
+		shared.querytree = parms->serializedQuerytree;
+		shared.querytreelen = parms->serializedQuerytreelen;
+		shared.plantree = parms->serializedPlantree;
+		shared.plantreelen = parms->serializedPlantreelen;
+		shared.sliceinfo = parms->serializedSliceInfo;
+		shared.sliceinfolen = parms->serializedSliceInfolen;
+		shared.resource = parms->serializedQueryResource;
+		shared.resourcelen = parms->serializedQueryResourcelen;
+		parms->sharedPlanRef = SharedPlanBuildRef(&shared, &parms->sharedPlanReflen);
+
+		elog(DEBUG1, "dispatch plan of " INT64_FORMAT " bytes to %d hosts, shared by %d executors",
+			 shared_len, list_length(hosts), readers);
+	}
+
+	list_free_deep(hosts);
+}
+
 /*
  * dispatcher_unbind_executor
  */
@@ -1195,6 +1298,7 @@ dispatch_run(DispatchData *data)
 	 */
 	dispatcher_serialize_state(data);
 	dispatcher_serialize_query_resource(data);
+	dispatcher_share_plan_per_host(data);
 	dispatcher_set_state_run(data);
 	dispmgt_dispatch_and_run(data->worker_mgr_state, data->query_executor_team);
 
@@ -1575,7 +1679,13 @@ dispatcher_compute_threads_num(DispatchData *data)
 	/* TODO: decide the groups(threads) number. */
 	if (query_executors_num == 0)
 		threads_num = 1;
-	if (executors_num_per_thread == 0)
+	if (gp_dispatch_event_driven)
+	{
+		/* One thread watches all executors, see dispmgt_poll_executors_epoll */
+		threads_num = 1;
+		executors_num_per_thread = Max(query_executors_num, 1);
+	}
+	else if (executors_num_per_thread == 0)
 	{
 		threads_num = query_executors_num;
 		executors_num_per_thread = 1;
@@ -1729,5 +1839,20 @@ dispatcher_print_statistics(StringInfo buf, DispatchData *data)
 			INSTR_TIME_GET_MILLISEC(data->time_max_free),
 			INSTR_TIME_GET_MILLISEC(data->time_min_free),
 			INSTR_TIME_GET_MILLISEC(data->time_total_free) / data->num_of_dispatched);
+	if (data->query_executor_team)
+	{
+		int		threads_num;
+		int64	wakeups;
+		int64	events_num;
+
+		dispmgt_get_io_statistics(data->query_executor_team, &threads_num,
+								&wakeups, &events_num);
+		appendStringInfo(buf,
+				"  dispatcher threads: %d (%s); wakeups: " INT64_FORMAT
+				"; executor data arrivals: " INT64_FORMAT ".\n",
+				threads_num,
+				gp_dispatch_event_driven ? "event driven" : "thread per group",
+				wakeups, events_num);
+	}
 }
 
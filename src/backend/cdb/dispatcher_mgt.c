@@ -23,6 +23,15 @@
 #endif
 #include "cdb/cdbconn.h"		/* SOCK_ERRNO */
 
+/*
+ * With gp_dispatch_event_driven all executors of a query are watched by one
+ * thread; on Linux it waits on epoll, where the sockets are registered once.
+ */
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define DISPMGT_USE_EPOLL
+#endif
+
 
 typedef enum DispMgtConstant {
 	DISPMGT_POLL_TIME = 2 * 1000,
@@ -38,6 +47,13 @@ typedef struct QueryExecutorGroup {
 
 	struct QueryExecutor	**query_executors;
 	struct pollfd			*fds;
+#ifdef DISPMGT_USE_EPOLL
+	struct epoll_event		*events;
+#endif
+
+	/* Statistics, set by the thread */
+	int64					wakeups;	/* returns of poll/epoll_wait */
+	int64					events_num;	/* executors found readable */
 } QueryExecutorGroup;
 
 typedef struct QueryExecutorTeam {
@@ -86,6 +102,10 @@ static void	dispmgt_init_query_executor_group_iterator(QueryExecutorTeam *team,
 static QueryExecutorGroup *dispmgt_get_query_executor_group_iterator(
 							QueryExecutorGroupIterator *iterator);
 static bool dispmgt_bind_executor_task(List *executors);
+#ifdef DISPMGT_USE_EPOLL
+static bool dispmgt_poll_executors_epoll(QueryExecutorGroup *group,
+							struct WorkerMgrState *state);
+#endif
 
 
 
@@ -243,6 +263,9 @@ dispmgt_create_executor_group(QueryExecutorTeam *team, QueryExecutorGroup *group
 		group->query_executors[i] = executormgr_create_executor();
 
 	group->fds = palloc0(sizeof(struct pollfd) * group->query_executor_num);
+#ifdef DISPMGT_USE_EPOLL
+	group->events = palloc0(sizeof(struct epoll_event) * Max(group->query_executor_num, 1));
+#endif
 	return true;
 }
 
@@ -311,6 +334,15 @@ dispmgt_thread_func_run(QueryExecutorGroup *group, struct WorkerMgrState *state)
 		}
 	}
 
+#ifdef DISPMGT_USE_EPOLL
+	if (gp_dispatch_event_driven)
+	{
+		if (!dispmgt_poll_executors_epoll(group, state))
+			goto error_cleanup;
+		goto thread_return;
+	}
+#endif
+
 	/* Poll executors. */
 	while (1)
 	{
@@ -350,6 +382,7 @@ dispmgt_thread_func_run(QueryExecutorGroup *group, struct WorkerMgrState *state)
 		 * 4. check executor returns and stop them if executor finish
 		 */
 		n = poll(group->fds, nfds, DISPMGT_POLL_TIME);
+		group->wakeups++;
 
 		if (n < 0 && SOCK_ERRNO == EINTR)
 			continue;
@@ -375,6 +408,7 @@ dispmgt_thread_func_run(QueryExecutorGroup *group, struct WorkerMgrState *state)
 		}
 
 		/* Someone returns, check it. */
+		group->events_num += n;
 		dispmgt_init_query_executor_in_group_iterator(group, &iterator, true);
 		while ((executor = dispmgt_get_query_executor_in_group_iterator(group, &iterator)) != NULL)
 		{
@@ -421,6 +455,122 @@ thread_return:
 	return;
 }
 
+#ifdef DISPMGT_USE_EPOLL
+/*
+ * dispmgt_poll_executors_epoll
+ *	Same as the poll loop of dispmgt_thread_func_run, but the sockets of the
+ *	executors are registered with epoll once instead of being passed to every
+ *	poll call, which matters when one thread watches all executors of a
+ *	query. Return false if the query should stop.
+ */
+static bool
+dispmgt_poll_executors_epoll(QueryExecutorGroup *group,
+							struct WorkerMgrState *state)
+{
+	QueryExecutorInGroupIterator	iterator;
+	struct QueryExecutor			*executor;
+	int		epfd;
+	int		running = 0;
+	bool	ret = false;
+
+	epfd = epoll_create(Max(group->query_executor_num, 1));
+	if (epfd < 0)
+	{
+		write_log("dispmgt_poll_executors_epoll could not create epoll instance: %d", errno);
+		return false;
+	}
+
+	dispmgt_init_query_executor_in_group_iterator(group, &iterator, true);
+	while ((executor = dispmgt_get_query_executor_in_group_iterator(group, &iterator)) != NULL)
+	{
+		struct epoll_event	event;
+
+		event.events = EPOLLIN;
+		event.data.ptr = executor;
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, executormgr_get_fd(executor), &event) < 0)
+		{
+			write_log("dispmgt_poll_executors_epoll could not watch executor: %d", errno);
+			goto cleanup;
+		}
+		running++;
+	}
+
+	while (running > 0)
+	{
+		int		n;
+		int		i;
+
+		/* Check global state to abort query, same as the poll loop. */
+		if (workermgr_should_query_stop(state))
+		{
+			write_log("dispmgt_poll_executors_epoll meets should query stop when "
+					  "polling executors, entering error_cleanup");
+			goto cleanup;
+		}
+
+		n = epoll_wait(epfd, group->events, Max(group->query_executor_num, 1),
+					   DISPMGT_POLL_TIME);
+		group->wakeups++;
+
+		if (n < 0 && errno == EINTR)
+			continue;
+
+		if (n < 0)
+			goto cleanup;
+
+		group->events_num += n;
+		for (i = 0; i < n; i++)
+		{
+			executor = (struct QueryExecutor *) group->events[i].data.ptr;
+			if (executormgr_is_stop(executor))
+				continue;
+
+			if (!executormgr_consume(executor))
+			{
+				write_log("dispmgt_poll_executors_epoll meets consume error for executor, entering error_cleanup");
+				goto cleanup;
+			}
+
+			if (executormgr_is_stop(executor))
+			{
+				/* The socket may be closed already, that removes it too. */
+				epoll_ctl(epfd, EPOLL_CTL_DEL, executormgr_get_fd(executor), NULL);
+				running--;
+			}
+		}
+	}
+	ret = true;
+
+cleanup:
+	close(epfd);
+	return ret;
+}
+#endif
+
+/*
+ * dispmgt_get_io_statistics
+ *	Number of threads watching the executors of the team, and how often they
+ *	woke up and found executors with data.
+ */
+void
+dispmgt_get_io_statistics(struct QueryExecutorTeam *team, int *threads_num,
+						int64 *wakeups, int64 *events_num)
+{
+	QueryExecutorGroupIterator	group_iterator;
+	QueryExecutorGroup			*group;
+
+	*threads_num = team->query_executor_group_num;
+	*wakeups = 0;
+	*events_num = 0;
+
+	dispmgt_init_query_executor_group_iterator(team, &group_iterator);
+	while ((group = dispmgt_get_query_executor_group_iterator(&group_iterator)) != NULL)
+	{
+		*wakeups += group->wakeups;
+		*events_num += group->events_num;
+	}
+}
+
 void
 dispmgt_dispatch_and_run(struct WorkerMgrState *state,
 						struct QueryExecutorTeam *team)
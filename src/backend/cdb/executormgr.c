@@ -14,6 +14,7 @@
 
 #include "catalog/pg_authid.h"	/* TODO:BOOTSTRAP_USER_ID remove! */
 #include "cdb/cdbdisp.h"		/* TODO: DispatchCommandQueryParms */
+#include "cdb/cdbsharedplan.h"	/* GP_DISPATCH_FLAG_* */
 #include "cdb/cdbdispatchresult.h"	/* TODO: CdbDispatchResult & cdbdisp_makeDispatchResults */
 #include "cdb/cdbvars.h"		/* TODO: gp_commond_count */
 #include "miscadmin.h"			/* TODO: MyDatabaseId */
@@ -60,6 +61,9 @@ typedef struct QueryExecutor {
 	const char	*identity_msg;
 	int			identity_msg_len;
 
+	/* GP_DISPATCH_FLAG_* of the plan sharing among QEs of a host */
+	int			dispatch_flags;
+
 	instr_time	time_dispatch_begin;
 	instr_time	time_dispatch_end;
 	instr_time	time_connect_begin;
@@ -200,6 +204,7 @@ executormgr_bind_executor_task(struct DispatchData *data,
 	/* setup payload */
 	executor->refSlice = slice;
 	executor->refTask = task;
+	executor->dispatch_flags = 0;
 
 	/* TODO: set result slot */
 	executor->refResult = cdbdisp_makeResult(dispatch_get_results(data),
@@ -281,6 +286,23 @@ executormgr_get_executor_slice_id(QueryExecutor *executor)
 	return dispatch_get_task_identity(executor->refTask)->slice_id;
 }
 
+struct Segment *
+executormgr_get_executor_segment(QueryExecutor *executor)
+{
+	return executor->desc->segment;
+}
+
+/*
+ * executormgr_set_dispatch_flags
+ *	Set whether the executor publishes the plan to, or reads it from, the
+ *	shared plan cache of its segment.
+ */
+void
+executormgr_set_dispatch_flags(QueryExecutor *executor, int flags)
+{
+	executor->dispatch_flags = flags;
+}
+
 /*
  * executormgr_is_stop
  */
@@ -384,20 +406,37 @@ executormgr_dispatch_and_run(struct DispatchData *data, QueryExecutor *executor)
 	char		*query = NULL;
 	int			query_len;
 	DispatchCommandQueryParms	*parms = dispatcher_get_QueryParms(data);
+	const char	*querytree = parms->serializedQuerytree;
+	int			querytree_len = parms->serializedQuerytreelen;
+	const char	*plantree = parms->serializedPlantree;
+	int			plantree_len = parms->serializedPlantreelen;
+	const char	*sliceinfo = parms->serializedSliceInfo;
+	int			sliceinfo_len = parms->serializedSliceInfolen;
+	const char	*resource = parms->serializedQueryResource;
+	int			resource_len = parms->serializedQueryResourcelen;
 
 	if (!executormgr_is_dispatchable(executor))
 		return false;
 
+	/* Another executor of the host ships the plan, send the reference only. */
+	if (executor->dispatch_flags & GP_DISPATCH_FLAG_PLAN_SHARED)
+	{
+		querytree = parms->sharedPlanRef;
+		querytree_len = parms->sharedPlanReflen;
+		plantree = sliceinfo = resource = NULL;
+		plantree_len = sliceinfo_len = resource_len = 0;
+	}
+
 	TIMING_BEGIN(executor->time_dispatch_begin);
 	query = PQbuildGpQueryString(parms->strCommand, parms->strCommandlen,
-								parms->serializedQuerytree, parms->serializedQuerytreelen,
-								parms->serializedPlantree, parms->serializedPlantreelen,
+								querytree, querytree_len,
+								plantree, plantree_len,
 								parms->serializedParams, parms->serializedParamslen,
-								parms->serializedSliceInfo, parms->serializedSliceInfolen,
+								sliceinfo, sliceinfo_len,
 								NULL, 0,
 								executor->identity_msg, executor->identity_msg_len,
-								parms->serializedQueryResource, parms->serializedQueryResourcelen,
-								0,
+								resource, resource_len,
+								executor->dispatch_flags,
 								gp_command_count,
 								executormgr_get_executor_slice_id(executor),
 								parms->rootIdx,
@@ -134,6 +134,16 @@ timeoutArray[] =
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/*
+ * Packets moved per system call with recvmmsg()/sendmmsg(), see
+ * gp_interconnect_syscall_batch_size. On platforms without them, every
+ * packet costs a recvfrom() or sendto().
+ */
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define UDPIC_USE_MMSG
+#endif
+#define UDPIC_MAX_SYSCALL_BATCH (64)
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -636,6 +646,9 @@ typedef struct AckSendParam
  * duplicatedPktNum          - duplicate packet number.
  * recvAckNum                - the number of Acks received.
  * statusQueryMsgNum         - the number of status query messages sent.
+ * sndSyscallNum             - the number of system calls sending data packets, retransmits included.
+ * recvSyscallNum            - the number of system calls by rx thread receiving packets.
+ * recvSyscallPktNum         - the number of packets received by these calls.
  *
  */
 typedef struct ICStatistics
@@ -656,6 +669,9 @@ typedef struct ICStatistics
 	int32   duplicatedPktNum;
 	int32	recvAckNum;
 	int32	statusQueryMsgNum;
+	int32	sndSyscallNum;
+	int32	recvSyscallNum;
+	int32	recvSyscallPktNum;
 } ICStatistics;
 
 /* Statistics for UDP interconnect. */
@@ -764,6 +780,8 @@ static void checkQDConnectionAlive(void);
 
 
 static void *rxThreadFunc(void *arg);
+static int receivePackets(icpkthdr **pkts, int npkts, struct sockaddr_storage *peers, socklen_t *peerlens, int *readCounts);
+static bool handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer, socklen_t *peerlen);
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
 static void inline handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
@@ -779,6 +797,9 @@ static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn * conn);
+#ifdef UDPIC_USE_MMSG
+static void sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn);
+#endif
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
@@ -942,6 +963,10 @@ dumpTransProtoStats()
 
 	pthread_mutex_unlock(&trans_proto_stats.lock);
 
+	fprintf(ofile, "send syscalls %d packets %d, receive syscalls %d packets %d\n",
+			ic_statistics.sndSyscallNum, ic_statistics.sndPktNum,
+			ic_statistics.recvSyscallNum, ic_statistics.recvSyscallPktNum);
+
     fclose(ofile);
 }
 
@@ -3862,7 +3887,8 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
 			" freebuf_avg %f "
 			"mismatch_pkt_num %d disordered_pkt_num %d duplicated_pkt_num %d"
 			" rtt/dev [" UINT64_FORMAT "/" UINT64_FORMAT ", %f/%f, " UINT64_FORMAT "/" UINT64_FORMAT "] "
-			" cwnd %f status_query_msg_num %d",
+			" cwnd %f status_query_msg_num %d"
+			" snd_syscall_num %d recv_syscall_num %d recv_syscall_pkt_num %d",
 			ic_control_info.isSender, isReceiver,
 			Gp_interconnect_snd_queue_depth, Gp_interconnect_queue_depth, Gp_max_packet_size,
 			UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
@@ -3875,7 +3901,9 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
 			(double)((double)ic_statistics.totalBuffers)/((double)ic_statistics.bufferCountingTime),
 			ic_statistics.mismatchNum, ic_statistics.disorderedPktNum, ic_statistics.duplicatedPktNum,
 			(minRtt == ~((uint64)0) ? 0 : minRtt), (minDev == ~((uint64)0) ? 0 : minDev), avgRtt, avgDev, maxRtt, maxDev,
-			snd_control_info.cwnd, ic_statistics.statusQueryMsgNum);
+			snd_control_info.cwnd, ic_statistics.statusQueryMsgNum,
+			ic_statistics.sndSyscallNum, ic_statistics.recvSyscallNum,
+			ic_statistics.recvSyscallPktNum);
 
 	ic_control_info.isSender = false;
 	memset(&ic_statistics, 0, sizeof(ICStatistics));
@@ -4740,6 +4768,8 @@ xmit_retry:
 		/* not reached */
 	}
 
+	ic_statistics.sndSyscallNum++;
+
 	if (n != buf->pkt->len)
 	{
 		if (DEBUG1 >= log_min_messages)
@@ -4755,6 +4785,89 @@ xmit_retry:
 	return;
 }
 
+#ifdef UDPIC_USE_MMSG
+/*
+ * sendBatch
+ * 		Send packets of a connection with as few sendmmsg() calls as possible.
+ *
+ * Errors are handled like in sendOnce: a full socket buffer is not an error,
+ * the unsent packets are in the unack queue and will be retransmitted.
+ */
+static void
+sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn)
+{
+	struct mmsghdr	msgs[UDPIC_MAX_SYSCALL_BATCH];
+	struct iovec	iovs[UDPIC_MAX_SYSCALL_BATCH];
+	int				nmsgs = 0;
+	int				sent = 0;
+
+	Assert(nbufs <= UDPIC_MAX_SYSCALL_BATCH);
+
+	for (int i = 0; i < nbufs; i++)
+	{
+		ICBuffer *buf = bufs[i];
+
+#ifdef USE_ASSERT_CHECKING
+		if (testmode_inject_fault(gp_udpic_dropxmit_percent))
+		{
+		#ifdef AMS_VERBOSE_LOGGING
+			write_log("THROW PKT with seq %d srcpid %d despid %d", buf->pkt->seq, buf->pkt->srcPid, buf->pkt->dstPid);
+		#endif
+			continue;
+		}
+#endif
+
+		iovs[nmsgs].iov_base = buf->pkt;
+		iovs[nmsgs].iov_len = buf->pkt->len;
+
+		memset(&msgs[nmsgs], 0, sizeof(struct mmsghdr));
+		msgs[nmsgs].msg_hdr.msg_name = &conn->peer;
+		msgs[nmsgs].msg_hdr.msg_namelen = conn->peer_len;
+		msgs[nmsgs].msg_hdr.msg_iov = &iovs[nmsgs];
+		msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+		nmsgs++;
+	}
+
+	while (sent < nmsgs)
+	{
+		int n = sendmmsg(pEntry->txfd, msgs + sent, nmsgs - sent, 0);
+
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			if (errno == EAGAIN) /* no space ? not an error. */
+				return;
+
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error writing an outgoing packet: %m"),
+							errdetail("error during sendmmsg() call (error:%d).\n"
+									  "For Remote Connection: contentId=%d at %s",
+									  errno, conn->remoteContentId,
+									  conn->remoteHostAndPort)));
+			/* not reached */
+		}
+
+		if (n == 0)
+			break;
+
+		ic_statistics.sndSyscallNum++;
+
+		for (int i = sent; i < sent + n; i++)
+		{
+			if (msgs[i].msg_len != iovs[i].iov_len && DEBUG1 >= log_min_messages)
+				write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendmmsg() call."
+					  "For Remote Connection: contentId=%d at %s",
+					  ((icpkthdr *) iovs[i].iov_base)->seq, (int) iovs[i].iov_len, (int) msgs[i].msg_len,
+					  conn->remoteContentId,
+					  conn->remoteHostAndPort);
+		}
+
+		sent += n;
+	}
+}
+#endif
 
 /*
  * handleStopMsgs
@@ -4864,6 +4977,12 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+#ifdef UDPIC_USE_MMSG
+	ICBuffer   *batch[UDPIC_MAX_SYSCALL_BATCH];
+	int			nbatch = 0;
+	int			batchSize = Min(Gp_interconnect_syscall_batch_size, UDPIC_MAX_SYSCALL_BATCH);
+#endif
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer *buf = NULL;
@@ -4909,7 +5028,22 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
+#ifdef UDPIC_USE_MMSG
+		if (batchSize > 1)
+		{
+			/* the batch is sent when full, or when no more buffer can go */
+			batch[nbatch++] = buf;
+			if (nbatch == batchSize)
+			{
+				sendBatch(transportStates, pEntry, batch, nbatch, conn);
+				nbatch = 0;
+			}
+		}
+		else
+#endif
+		{
+			sendOnce(transportStates, pEntry, buf, conn);
+		}
 		ic_statistics.sndPktNum++;
 
 #ifdef AMS_VERBOSE_LOGGING
@@ -4918,6 +5052,11 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		buf->conn->sentSeq = buf->pkt->seq;
 	}
+
+#ifdef UDPIC_USE_MMSG
+	if (nbatch > 0)
+		sendBatch(transportStates, pEntry, batch, nbatch, conn);
+#endif
 }
 
 /*
@@ -6232,16 +6371,31 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 static void *
 rxThreadFunc(void *arg)
 {
-	icpkthdr *pkt=NULL;
+	icpkthdr *pkts[UDPIC_MAX_SYSCALL_BATCH];
+	struct sockaddr_storage peers[UDPIC_MAX_SYSCALL_BATCH];
+	socklen_t peerlens[UDPIC_MAX_SYSCALL_BATCH];
+	int		readCounts[UDPIC_MAX_SYSCALL_BATCH];
+	int		npkts = 0;
+	int		batchSize = 1;
 	bool	skip_poll=false;
 
 	gp_set_thread_sigmasks();
 
+	memset(pkts, 0, sizeof(pkts));
+
 	for (;;)
 	{
 		struct pollfd nfd;
 		int		n;
 
+#ifdef UDPIC_USE_MMSG
+		/*
+		 * The thread outlives the statements of the session, so pick up a
+		 * changed batch size. Buffers beyond a lowered one are kept.
+		 */
+		batchSize = Max(1, Min(Gp_interconnect_syscall_batch_size, UDPIC_MAX_SYSCALL_BATCH));
+#endif
+
 		/* check shutdown condition*/
 
 		if (compare_and_swap_32(&ic_control_info.shutdown, 1, 0))
@@ -6251,14 +6405,23 @@ rxThreadFunc(void *arg)
 			break;
 		}
 
-		/* Try to get a buffer */
-		if (pkt == NULL)
+		/*
+		 * Try to get buffers, pkts[0 .. npkts-1] are the buffers we have. Only
+		 * the first one is required, more are taken if the pool allows.
+		 */
+		if (npkts < batchSize)
 		{
 			pthread_mutex_lock(&ic_control_info.lock);
-			pkt = getRxBuffer(&rx_buffer_pool);
+			while (npkts < batchSize)
+			{
+				pkts[npkts] = getRxBuffer(&rx_buffer_pool);
+				if (pkts[npkts] == NULL)
+					break;
+				npkts++;
+			}
 			pthread_mutex_unlock(&ic_control_info.lock);
 
-			if (pkt == NULL)
+			if (npkts == 0)
 			{
 				setRxThreadError(ENOMEM);
 				continue;
@@ -6298,20 +6461,12 @@ rxThreadFunc(void *arg)
 			/* we've got something interesting to read */
 			/* handle incoming */
 			/* ready to read on our socket */
-			MotionConn *conn = NULL;
-			int read_count = 0;
-
-			struct sockaddr_storage peer;
-			socklen_t peerlen;
+			int		nread;
+			int		nkept = 0;
 
-			peerlen = sizeof(peer);
-			read_count = recvfrom(UDP_listenerFd, (char *)pkt, Gp_max_packet_size, 0,
-								  (struct sockaddr *)&peer, &peerlen);
+			nread = receivePackets(pkts, Min(npkts, batchSize), peers, peerlens, readCounts);
 
-			if (DEBUG5 >= log_min_messages)
-				write_log("received inbound len %d", read_count);
-
-			if (read_count < 0)
+			if (nread < 0)
 			{
 				skip_poll = false;
 
@@ -6330,115 +6485,216 @@ rxThreadFunc(void *arg)
 				continue;
 			}
 
-			if (read_count < sizeof(icpkthdr))
-			{
-				if (DEBUG1 >= log_min_messages)
-					write_log("Interconnect error: short conn receive (%d)", read_count);
-				continue;
-			}
+			gp_atomic_add_32(&ic_statistics.recvSyscallNum, 1);
+			gp_atomic_add_32(&ic_statistics.recvSyscallPktNum, nread);
 
-			/* when we get a "good" recvfrom() result, we can skip poll() until we get a bad one. */
-			skip_poll = true;
-
-			/* length must be >= 0 */
-			if (pkt->len < 0)
+			for (int i = 0; i < nread; i++)
 			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
+				if (readCounts[i] >= sizeof(icpkthdr))
+				{
+					/* when we get a "good" recvfrom() result, we can skip poll() until we get a bad one. */
+					skip_poll = true;
+				}
 
-			if (pkt->len != read_count)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
-				continue;
+				/* the buffer is kept if the packet is not queued */
+				if (handleRxPacket(pkts[i], readCounts[i], &peers[i], &peerlens[i]))
+					pkts[i] = NULL;
 			}
 
-			/*
-			 * check the CRC of the payload.
-			 */
-			if (gp_interconnect_full_crc)
+			/* move remaining buffers to the front */
+			for (int i = 0; i < npkts; i++)
 			{
-				if (!checkCRC(pkt))
-				{
-					gp_atomic_add_32(&ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
-					continue;
-				}
+				if (pkts[i] != NULL)
+					pkts[nkept++] = pkts[i];
 			}
+			for (int i = nkept; i < npkts; i++)
+				pkts[i] = NULL;
+			npkts = nkept;
+		}
 
-			#ifdef AMS_VERBOSE_LOGGING
-				logPkt("GOT MESSAGE", pkt);
-			#endif
+		/* pthread_yield(); */
+	}
 
-			AckSendParam param;
-			memset(&param, 0, sizeof(AckSendParam));
+	/* Before retrun, we release the packets. */
+	if (npkts > 0)
+	{
+		pthread_mutex_lock(&ic_control_info.lock);
+		for (int i = 0; i < npkts; i++)
+			freeRxBuffer(&rx_buffer_pool, pkts[i]);
+		npkts = 0;
+		pthread_mutex_unlock(&ic_control_info.lock);
+	}
 
-			/*
-			 * Get the connection for the pkt.
-			 *
-			 * 	The connection hash table should be locked until
-			 * 	finishing the processing of the packet to avoid
-			 *  the connection addition/removal from the hash table
-			 *  during the mean time.
-			 */
+	/* nothing to return */
+	return NULL;
+}
 
-			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+/*
+ * receivePackets
+ * 		Called by rx thread to read packets from the listener socket.
+ *
+ * Up to npkts packets are read, with one recvmmsg() call where available.
+ * Return number of packets read, or -1 on failure with errno set.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static int
+receivePackets(icpkthdr **pkts, int npkts, struct sockaddr_storage *peers, socklen_t *peerlens, int *readCounts)
+{
+#ifdef UDPIC_USE_MMSG
+	if (npkts > 1)
+	{
+		struct mmsghdr	msgs[UDPIC_MAX_SYSCALL_BATCH];
+		struct iovec	iovs[UDPIC_MAX_SYSCALL_BATCH];
+		int				n;
 
-			if (conn != NULL)
-			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets:
-				 *    a) Past packets from previous command after I was torn down
-				 *    b) Future packets from current command before my connections are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
-				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+		Assert(npkts <= UDPIC_MAX_SYSCALL_BATCH);
 
-				#ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
-				#endif
+		for (int i = 0; i < npkts; i++)
+		{
+			iovs[i].iov_base = pkts[i];
+			iovs[i].iov_len = Gp_max_packet_size;
+
+			memset(&msgs[i], 0, sizeof(struct mmsghdr));
+			msgs[i].msg_hdr.msg_name = &peers[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
 
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
-				}
-			}
-			pthread_mutex_unlock(&ic_control_info.lock);
+		/* the socket is nonblocking, this returns what is queued */
+		n = recvmmsg(UDP_listenerFd, msgs, npkts, 0, NULL);
 
-			/* real ack sending is after lock release to decrease the lock holding time. */
-			if (param.msg.len != 0)
-				sendAckWithParam(&param);
+		for (int i = 0; i < n; i++)
+		{
+			readCounts[i] = msgs[i].msg_len;
+			peerlens[i] = msgs[i].msg_hdr.msg_namelen;
+
+			if (DEBUG5 >= log_min_messages)
+				write_log("received inbound len %d", readCounts[i]);
 		}
 
-		/* pthread_yield(); */
+		return n;
 	}
+#endif
+
+	peerlens[0] = sizeof(peers[0]);
+	readCounts[0] = recvfrom(UDP_listenerFd, (char *)pkts[0], Gp_max_packet_size, 0,
+							 (struct sockaddr *)&peers[0], &peerlens[0]);
+
+	if (DEBUG5 >= log_min_messages)
+		write_log("received inbound len %d", readCounts[0]);
+
+	return readCounts[0] < 0 ? -1 : 1;
+}
+
+/*
+ * handleRxPacket
+ * 		Called by rx thread to handle a packet read from the listener socket.
+ *
+ * Return true if the packet buffer has been queued, false if it can be
+ * reused.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static bool
+handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer, socklen_t *peerlen)
+{
+	MotionConn *conn = NULL;
+	bool		queued = false;
 
-	/* Before retrun, we release the packet. */
-	if (pkt)
+	if (read_count < sizeof(icpkthdr))
 	{
-		pthread_mutex_lock(&ic_control_info.lock);
-		freeRxBuffer(&rx_buffer_pool, pkt);
-		pkt = NULL;
-		pthread_mutex_unlock(&ic_control_info.lock);
+		if (DEBUG1 >= log_min_messages)
+			write_log("Interconnect error: short conn receive (%d)", read_count);
+		return false;
 	}
 
-	/* nothing to return */
-	return NULL;
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return false;
+	}
+
+	if (pkt->len != read_count)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return false;
+	}
+
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			gp_atomic_add_32(&ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return false;
+		}
+	}
+
+	#ifdef AMS_VERBOSE_LOGGING
+		logPkt("GOT MESSAGE", pkt);
+	#endif
+
+	AckSendParam param;
+	memset(&param, 0, sizeof(AckSendParam));
+
+	/*
+	 * Get the connection for the pkt.
+	 *
+	 * 	The connection hash table should be locked until
+	 * 	finishing the processing of the packet to avoid
+	 *  the connection addition/removal from the hash table
+	 *  during the mean time.
+	 */
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+
+	if (conn != NULL)
+	{
+		/* Handling a regular packet */
+		if (handleDataPacket(conn, pkt, peer, peerlen, &param))
+			queued = true;
+		ic_statistics.recvPktNum++;
+	}
+	else
+	{
+		/*
+		 * There may have two kinds of Mismatched packets:
+		 *    a) Past packets from previous command after I was torn down
+		 *    b) Future packets from current command before my connections are built.
+		 *
+		 * The handling logic is to "Ack the past and Nak the future".
+		 */
+		if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+
+		#ifdef AMS_VERBOSE_LOGGING
+			logPkt("Got a Mismatched Packet", pkt);
+		#endif
+
+			if (handleMismatch(pkt, peer, *peerlen))
+				queued = true;
+			ic_statistics.mismatchNum++;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	/* real ack sending is after lock release to decrease the lock holding time. */
+	if (param.msg.len != 0)
+		sendAckWithParam(&param);
+
+	return queued;
 }
 
 /*
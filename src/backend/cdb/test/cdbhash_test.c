@@ -0,0 +1,126 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "../cdbhash.c"
+
+#define NVALUES 5
+
+/*
+ * Hash a value the way cdbhash did before the type-specialized kernels:
+ * through hashDatum and fnv1_32_buf.
+ */
+static uint32
+hashOneValue(Datum value, bool isnull, Oid typid)
+{
+	CdbHash h;
+
+	memset(&h, 0, sizeof(h));
+	h.hashalg = HASH_FNV_1;
+	h.hashfn = &fnv1_32_buf;
+	h.hash = FNV1_32_INIT;
+
+	if (isnull)
+		hashNullDatum(addToCdbHash, (void *) &h);
+	else
+		hashDatum(value, typid, addToCdbHash, (void *) &h);
+
+	return h.hash;
+}
+
+/*
+ * Check that cdbhash, and cdbhashnull for nulls, hash the values like
+ * hashDatum does, which data distribution depends on.
+ */
+static void
+checkKernelMatches(Datum *values, bool *isnulls, Oid typid)
+{
+	for (int i = 0; i < NVALUES; i++)
+	{
+		CdbHash h;
+
+		memset(&h, 0, sizeof(h));
+		h.hashalg = HASH_FNV_1;
+		h.hashfn = &fnv1_32_buf;
+		h.hash = FNV1_32_INIT;
+
+		if (isnulls[i])
+			cdbhashnull(&h);
+		else
+			cdbhash(&h, values[i], typid);
+
+		assert_int_equal(h.hash, hashOneValue(values[i], isnulls[i], typid));
+	}
+}
+
+void
+test__cdbhash__MatchesHashDatumForIntegers(void **state)
+{
+	bool isnulls[NVALUES] = {false, false, true, false, false};
+	Datum int2s[NVALUES] = {Int16GetDatum(0), Int16GetDatum(-1), 0,
+							Int16GetDatum(7), Int16GetDatum(32767)};
+	Datum int4s[NVALUES] = {Int32GetDatum(0), Int32GetDatum(-1), 0,
+							Int32GetDatum(42), Int32GetDatum(2147483647)};
+	Datum int8s[NVALUES] = {Int64GetDatum(0), Int64GetDatum(-1), 0,
+							Int64GetDatum(INT64CONST(1) << 40),
+							Int64GetDatum(INT64CONST(-9223372036854775807))};
+
+	checkKernelMatches(int2s, isnulls, INT2OID);
+	checkKernelMatches(int4s, isnulls, INT4OID);
+	checkKernelMatches(int8s, isnulls, INT8OID);
+	checkKernelMatches(int4s, isnulls, OIDOID);
+}
+
+void
+test__cdbhash__MatchesHashDatumForOtherFixedWidthTypes(void **state)
+{
+	bool isnulls[NVALUES] = {false, true, false, false, false};
+	Datum float8s[NVALUES] = {Float8GetDatum(0.0), 0, Float8GetDatum(-0.0),
+							  Float8GetDatum(1.5), Float8GetDatum(-1e300)};
+	Datum chars[NVALUES] = {CharGetDatum('a'), 0, CharGetDatum('\0'),
+							CharGetDatum('z'), CharGetDatum('\377')};
+	Datum bools[NVALUES] = {BoolGetDatum(true), 0, BoolGetDatum(false),
+							BoolGetDatum(false), BoolGetDatum(true)};
+	Datum dates[NVALUES] = {DateADTGetDatum(0), 0, DateADTGetDatum(-1),
+							DateADTGetDatum(3652), DateADTGetDatum(2147483647)};
+
+	checkKernelMatches(float8s, isnulls, FLOAT8OID);
+	checkKernelMatches(chars, isnulls, CHAROID);
+	checkKernelMatches(bools, isnulls, BOOLOID);
+	checkKernelMatches(dates, isnulls, DATEOID);
+
+	/* minus zero and zero hash the same */
+	assert_int_equal(hashOneValue(float8s[0], false, FLOAT8OID),
+					 hashOneValue(float8s[2], false, FLOAT8OID));
+}
+
+void
+test__cdbhashmix__EqualValuesHashEqual(void **state)
+{
+	assert_int_equal(cdbhashmixkind(F_HASHINT4), CDBHASH_MIX_INT4);
+	assert_int_equal(cdbhashmixkind(F_HASHOID), CDBHASH_MIX_INT4);
+	assert_int_equal(cdbhashmixkind(F_HASHTEXT), CDBHASH_MIX_NONE);
+
+	/* the high half of an int8 is not ignored */
+	assert_true(cdbhashmix(CDBHASH_MIX_INT8, Int64GetDatum(INT64CONST(1) << 32)) !=
+				cdbhashmix(CDBHASH_MIX_INT8, Int64GetDatum(1)));
+
+	/* an int2 hashes like the same int4 */
+	assert_int_equal(cdbhashmix(CDBHASH_MIX_INT2, Int16GetDatum(-5)),
+					 cdbhashmix(CDBHASH_MIX_INT4, Int32GetDatum(-5)));
+}
+
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__cdbhash__MatchesHashDatumForIntegers),
+		unit_test(test__cdbhash__MatchesHashDatumForOtherFixedWidthTypes),
+		unit_test(test__cdbhashmix__EqualValuesHashEqual)
+	};
+	return run_tests(tests);
+}
@@ -7,6 +7,11 @@
  *	to a thread in the worker manager. In each group, there are some tasks. The
  *	tasks in one group have to be same property. But each group may have
  *	different property.
+ *
+ *	With gp_dispatch_event_driven the threads are not created for each job
+ *	but taken from a pool of threads kept by the backend, so that a session
+ *	running many short queries does not create and join threads for each of
+ *	them.
  */
 #include "postgres.h"
 #include <pthread.h>
@@ -14,9 +19,31 @@
 #include "cdb/workermgr.h"
 
 #include "cdb/cdbgang.h"		/* gp_pthread_create */
+#include "cdb/cdbvars.h"		/* gp_dispatch_event_driven */
+#include "utils/memutils.h"		/* TopMemoryContext */
 #include "miscadmin.h"			/* TODO: InterruptPending */
 
 
+/* Idle pooled threads kept by the backend, more idle threads exit. */
+#define WORKERMGR_MAX_IDLE_THREADS	4
+
+struct WorkerMgrThread;
+
+/*
+ * A thread of the pool. It waits for a job, runs it, and waits again.
+ */
+typedef struct WorkerMgrPooledThread {
+	pthread_t		thread;
+	pthread_mutex_t	mutex;
+	pthread_cond_t	cond;
+
+	/* Protected by mutex. */
+	struct WorkerMgrThread	*job;	/* job to run, NULL when done */
+	bool			exit;
+
+	struct WorkerMgrPooledThread	*next;	/* in the idle list */
+} WorkerMgrPooledThread;
+
 /*
  * This structure abstract the general job.
  */
@@ -25,6 +52,7 @@ typedef struct WorkerMgrThread {
 	int		thread_errno;
 	int		thread_ret;
 	pthread_t	thread;
+	WorkerMgrPooledThread	*pooled;	/* runs the job, if from the pool */
 
 	/* Argument passed to thread. */
 	struct WorkerMgrState		*state;
@@ -35,6 +63,7 @@ typedef struct WorkerMgrThread {
 typedef struct WorkerMgrState {
 	/* Control flags */
 	volatile bool	cancel;
+	bool			use_pool;	/* take threads from the pool */
 
 	int					threads_num;
 	WorkerMgrThread		threads[0];
@@ -48,8 +77,14 @@ typedef struct WorkerMgrThreadIterator {
 static void	workermgr_init_thread_iterator(WorkerMgrState *state, WorkerMgrThreadIterator *iterator);
 static WorkerMgrThread *workermgr_get_thread_iterator(WorkerMgrState *state, WorkerMgrThreadIterator *iterator);
 static void *workermgr_thread_func(void *arg);
+static void *workermgr_pooled_thread_func(void *arg);
+static int	workermgr_start_pooled_thread(WorkerMgrThread *thread);
+static void	workermgr_finish_pooled_thread(WorkerMgrThread *thread);
 static void workermgr_join(WorkerMgrState *state);
 
+static WorkerMgrPooledThread	*idle_threads = NULL;
+static int						idle_threads_num = 0;
+
 
 /*
  * workermgr_create_workermgr_state
@@ -63,6 +98,7 @@ workermgr_create_workermgr_state(int threads_num)
 	/* Allocate the threads control data structure. */
 	state = palloc0(sizeof(WorkerMgrState) + threads_num * sizeof(WorkerMgrThread));
 	state->threads_num = threads_num;
+	state->use_pool = gp_dispatch_event_driven;
 
 	return state;
 }
@@ -95,7 +131,10 @@ workermgr_submit_job(WorkerMgrState *state,
 		i++;
 		worker_mgr_thread->func = func;
 
-		worker_mgr_thread->thread_ret = gp_pthread_create(&worker_mgr_thread->thread, workermgr_thread_func, worker_mgr_thread, "submit_plan_to_qe");
+		if (state->use_pool)
+			worker_mgr_thread->thread_ret = workermgr_start_pooled_thread(worker_mgr_thread);
+		else
+			worker_mgr_thread->thread_ret = gp_pthread_create(&worker_mgr_thread->thread, workermgr_thread_func, worker_mgr_thread, "submit_plan_to_qe");
 		if (worker_mgr_thread->thread_ret)
 			goto error_cleanup;
 		worker_mgr_thread->started = true;
@@ -163,6 +202,120 @@ workermgr_thread_func(void *arg)
 	return NULL;
 }
 
+/*
+ * workermgr_pooled_thread_func
+ *	Main loop of a pooled thread: run the jobs handed over by the backend
+ *	until told to exit.
+ */
+static void *
+workermgr_pooled_thread_func(void *arg)
+{
+	WorkerMgrPooledThread	*pooled = (WorkerMgrPooledThread *) arg;
+
+	pthread_mutex_lock(&pooled->mutex);
+	for (;;)
+	{
+		WorkerMgrThread	*job;
+
+		while (pooled->job == NULL && !pooled->exit)
+			pthread_cond_wait(&pooled->cond, &pooled->mutex);
+		if (pooled->exit)
+			break;
+
+		job = pooled->job;
+		pthread_mutex_unlock(&pooled->mutex);
+
+		job->func(job->task, job->state);
+
+		pthread_mutex_lock(&pooled->mutex);
+		pooled->job = NULL;
+		pthread_cond_broadcast(&pooled->cond);
+	}
+	pthread_mutex_unlock(&pooled->mutex);
+
+	return NULL;
+}
+
+/*
+ * workermgr_start_pooled_thread
+ *	Hand the job over to an idle pooled thread, create one if there is none.
+ *	Return 0 or the error of the thread creation.
+ */
+static int
+workermgr_start_pooled_thread(WorkerMgrThread *thread)
+{
+	WorkerMgrPooledThread	*pooled = idle_threads;
+
+	if (pooled != NULL)
+	{
+		idle_threads = pooled->next;
+		idle_threads_num--;
+	}
+	else
+	{
+		int		ret;
+
+		/* It outlives the memory contexts of the query. */
+		pooled = MemoryContextAllocZero(TopMemoryContext, sizeof(WorkerMgrPooledThread));
+		pthread_mutex_init(&pooled->mutex, NULL);
+		pthread_cond_init(&pooled->cond, NULL);
+
+		ret = gp_pthread_create(&pooled->thread, workermgr_pooled_thread_func, pooled, "submit_plan_to_qe");
+		if (ret)
+		{
+			pthread_cond_destroy(&pooled->cond);
+			pthread_mutex_destroy(&pooled->mutex);
+			pfree(pooled);
+			return ret;
+		}
+	}
+
+	pooled->next = NULL;
+	thread->pooled = pooled;
+
+	pthread_mutex_lock(&pooled->mutex);
+	pooled->job = thread;
+	pthread_cond_broadcast(&pooled->cond);
+	pthread_mutex_unlock(&pooled->mutex);
+
+	return 0;
+}
+
+/*
+ * workermgr_finish_pooled_thread
+ *	Wait for the pooled thread to finish the job and put it back to the pool.
+ */
+static void
+workermgr_finish_pooled_thread(WorkerMgrThread *thread)
+{
+	WorkerMgrPooledThread	*pooled = thread->pooled;
+
+	pthread_mutex_lock(&pooled->mutex);
+	while (pooled->job != NULL)
+		pthread_cond_wait(&pooled->cond, &pooled->mutex);
+	pthread_mutex_unlock(&pooled->mutex);
+
+	thread->pooled = NULL;
+
+	if (idle_threads_num < WORKERMGR_MAX_IDLE_THREADS)
+	{
+		pooled->next = idle_threads;
+		idle_threads = pooled;
+		idle_threads_num++;
+		return;
+	}
+
+	pthread_mutex_lock(&pooled->mutex);
+	pooled->exit = true;
+	pthread_cond_broadcast(&pooled->cond);
+	pthread_mutex_unlock(&pooled->mutex);
+
+	pthread_join(pooled->thread, NULL);
+	pthread_cond_destroy(&pooled->cond);
+	pthread_mutex_destroy(&pooled->mutex);
+	pfree(pooled);
+}
+
 bool
 workermgr_should_query_stop(WorkerMgrState *state)
 {
@@ -184,7 +337,10 @@ workermgr_thread_cleanup(WorkerMgrThread *thread)
 {
 	if (thread->started)
 	{
-		pthread_join(thread->thread, NULL);
+		if (thread->pooled)
+			workermgr_finish_pooled_thread(thread);
+		else
+			pthread_join(thread->thread, NULL);
 		thread->started = false;
 	}
 }
@@ -108,6 +108,9 @@ static char *scanTextLine(CopyState cstate, const char *s, char c, size_t len);
 static char *scanCSVLine(CopyState cstate, const char *s, char c1, char c2, char c3, size_t len);
 
 static void CopyExtractRowMetaData(CopyState cstate);
+static void CopyExtractChunkMetaData(CopyState cstate);
+static void CopyFromDispatchRawChunks(CopyState cstate, CdbCopy *cdbCopy,
+									  StringInfo cdbcopy_err);
 static void preProcessDataLine(CopyState cstate);
 static void concatenateEol(CopyState cstate);
 static char *escape_quotes(const char *src);
@@ -210,7 +213,7 @@ else \
 		if (cstate->cdbsreh->errtbl) \
 			truncateEol(&cstate->line_buf, cstate->eol_type); \
 \
-		if (Gp_role == GP_ROLE_EXECUTE)\
+		if (Gp_role == GP_ROLE_EXECUTE && !cstate->raw_chunks)\
 		{\
 			/* if line has embedded rownum, update the cursor to the pos right after */ \
 			Insist(cstate->err_loc_type == ROWNUM_EMBEDDED);\
@@ -1071,6 +1074,11 @@ DoCopy(const CopyStmt *stmt, const char *queryString)
 						 errmsg("conflicting or redundant options")));
 			cstate->eol_str = strVal(defel->arg);
 		}
+		else if (strcmp(defel->defname, "raw_chunks") == 0)
+		{
+			/* only added by the dispatcher, see cdbCopyStart() */
+			cstate->raw_chunks = intVal(defel->arg);
+		}
 		else
 			elog(ERROR, "option \"%s\" not recognized",
 				 defel->defname);
@@ -1443,6 +1451,18 @@ DoCopy(const CopyStmt *stmt, const char *queryString)
 	cstate->line_buf_converted = (Gp_role == GP_ROLE_EXECUTE ? true : false);
 	setEncodingConversionProc(cstate, pg_get_client_encoding(), !is_from);
 
+	/*
+	 * Raw chunks of lines are in server encoding as well, but the dispatcher
+	 * did not validate them. Do it here.
+	 */
+	if (cstate->raw_chunks)
+	{
+		cstate->client_encoding = GetDatabaseEncoding();
+		cstate->need_transcoding = (pg_database_encoding_max_length() > 1);
+		cstate->line_buf_converted = false;
+		cstate->enc_conversion_proc = NULL;
+	}
+
 	/*
 	 * some greenplum db specific vars
 	 */
@@ -2918,6 +2938,24 @@ CopyFromDispatch(CopyState cstate, List *err_segnos)
 		}
 	}
 
+	/*
+	 * Without a distribution key to compute, the segments can parse the
+	 * data themselves, see gp_copy_raw_chunks. Partitioned tables, non
+	 * constant defaults, OIDs and data to convert to the server encoding
+	 * still need the dispatcher to look at every row.
+	 */
+	if (gp_copy_raw_chunks && policy && policy->nattrs == 0 &&
+		!estate->es_result_partitions && !cstate->oids &&
+		cstate->client_encoding == GetDatabaseEncoding())
+	{
+		cdbCopy->raw_chunks = true;
+		for (i = 0; i < num_defaults; i++)
+		{
+			if (defexprs[i]->expr->type != T_Const)
+				cdbCopy->raw_chunks = false;
+		}
+	}
+
 	/* allocate memory for error and copy strings */
 	initStringInfo(&cdbcopy_err);
 	initStringInfo(&cdbcopy_cmd);
@@ -3046,7 +3084,13 @@ CopyFromDispatch(CopyState cstate, List *err_segnos)
 
 	CopyInitDataParser(cstate);
 
-	do
+	if (cdbCopy->raw_chunks)
+	{
+		CopyFromDispatchRawChunks(cstate, cdbCopy, &cdbcopy_err);
+		no_more_data = true;
+	}
+
+	while (!no_more_data)
 	{
 		size_t		bytesread = 0;
 
@@ -3557,7 +3601,7 @@ CopyFromDispatch(CopyState cstate, List *err_segnos)
 		{
 			no_more_data = true;
 		}
-	} while (!no_more_data);
+	}
 
 	/* Free p_attr_types */
 	pfree(p_attr_types);
@@ -3739,6 +3783,226 @@ CopyFromDispatch(CopyState cstate, List *err_segnos)
 	FreeExecutorState(estate);
 }
 
+/*
+ * CopyFromDispatchRawChunks
+ *
+ * The dispatcher side of gp_copy_raw_chunks: split the input into chunks of
+ * whole lines and send each chunk to the next segment, preceded by a header
+ * line "<original number of its first line>^<number of lines>" (see
+ * CopyExtractChunkMetaData). The segments parse the lines themselves.
+ *
+ * Lines must end exactly where CopyReadLineText and CopyReadLineCSV end them
+ * on the segments, or a segment would take a data line for a chunk header:
+ * at every EOL that is neither in CSV quotes nor a lone CR of CRLF data, and
+ * at an EOL in quotes once the line got longer than gp_max_csv_line_length.
+ *
+ * Like in CopyFromDispatch, no error may be raised before the COPY on the
+ * segments is ended.
+ */
+static void
+CopyFromDispatchRawChunks(CopyState cstate, CdbCopy *cdbCopy,
+						  StringInfo cdbcopy_err)
+{
+	StringInfoData chunk;		/* input not sent yet */
+	StringInfoData header;
+	char		quotec = '\0',
+				escapec = '\0';
+	int			scanned = 0;	/* bytes of chunk scanned for EOLs */
+	int			line_start = 0;	/* start of the current line in chunk */
+	int			split = 0;		/* end of the last whole line in chunk */
+	int64		nlines = 0;		/* whole lines in chunk before split */
+	int64		lineno = 0;		/* original lines before split */
+	int64		chunk_lineno = 1;	/* original number of the 1st line of chunk */
+	int			line_eols = 0;	/* EOLs in quotes of the current line */
+	int			target_seg = 0;
+	bool		eof = false;
+
+	initStringInfo(&chunk);
+	initStringInfo(&header);
+
+	if (cstate->csv_mode)
+	{
+		quotec = cstate->quote[0];
+		escapec = cstate->escape[0];
+
+		/* ignore special escape processing if it's the same as quotec */
+		if (quotec == escapec)
+			escapec = '\0';
+	}
+	else
+		cstate->quote = NULL;	/* as in CopyReadLineText, for DetectLineEnd */
+
+	PG_TRY();
+	{
+		while (!eof)
+		{
+			size_t		bytesread;
+			bool		end_marker = false;
+			int			eol_len = (cstate->eol_type == EOL_CRLF ? 2 : 1);
+
+			if (QueryCancelPending)
+				break;
+
+			bytesread = CopyGetData(cstate, cstate->raw_buf, RAW_BUF_SIZE);
+			if (bytesread == 0 && cstate->fe_eof)
+				eof = true;
+
+			/* detect end of line type if not already detected */
+			if (cstate->eol_type == EOL_UNKNOWN && bytesread > 0)
+			{
+				bool		save_inquote = cstate->in_quote;
+				bool		save_lastwas = cstate->last_was_esc;
+
+				if (DetectLineEnd(cstate, bytesread))
+					eol_len = (cstate->eol_type == EOL_CRLF ? 2 : 1);
+				else
+				{
+					/* scan this data for lines once the EOL is known */
+					cstate->in_quote = save_inquote;
+					cstate->last_was_esc = save_lastwas;
+				}
+			}
+
+			appendBinaryStringInfo(&chunk, cstate->raw_buf, bytesread);
+
+			/* find the whole lines in the new data */
+			while (cstate->eol_type != EOL_UNKNOWN && scanned < chunk.len)
+			{
+				char	   *endloc;
+				int			pos;
+
+				if (cstate->csv_mode)
+					endloc = scanCSVLine(cstate, chunk.data + scanned, cstate->eol_ch[0],
+										 escapec, quotec, chunk.len - scanned);
+				else
+					endloc = memchr(chunk.data + scanned, cstate->eol_ch[0],
+									chunk.len - scanned);
+
+				if (endloc == NULL)
+				{
+					scanned = chunk.len;
+					break;
+				}
+
+				pos = scanned = endloc - chunk.data + 1;
+
+				if (cstate->csv_mode && cstate->in_quote)
+				{
+					line_eols++;
+
+					/* invalid csv, the segment gives up on the line here */
+					if (pos - line_start < gp_max_csv_line_length)
+						continue;
+					cstate->in_quote = false;
+				}
+				else if (cstate->eol_type == EOL_CRLF)
+				{
+					/* look at the byte after the CR once we have it */
+					if (pos == chunk.len)
+					{
+						scanned = pos - 1;
+						break;
+					}
+
+					/* just a CR, not a line end */
+					if (chunk.data[pos] != '\n')
+						continue;
+
+					pos = scanned = pos + 1;
+				}
+
+				/* got a whole line, chunk.data[line_start, pos) */
+				if (cstate->header_line)
+				{
+					/* throw the header line away */
+					memmove(chunk.data, chunk.data + pos, chunk.len - pos);
+					chunk.len -= pos;
+					chunk.data[chunk.len] = '\0';
+					scanned = 0;
+					lineno += line_eols + 1;
+					chunk_lineno = lineno + 1;
+					line_eols = 0;
+					cstate->header_line = false;
+					continue;
+				}
+
+				if (pos - line_start == 2 + eol_len &&
+					chunk.data[line_start] == '\\' && chunk.data[line_start + 1] == '.')
+				{
+					end_marker = true;
+					break;
+				}
+
+				nlines++;
+				lineno += line_eols + 1;
+				line_eols = 0;
+				split = line_start = pos;
+			}
+
+			if (end_marker)
+			{
+				/* ignore anything after \., see CopyReadLineText */
+				if (cstate->copy_dest == COPY_NEW_FE)
+				{
+					while (!cstate->fe_eof)
+						CopyGetData(cstate, cstate->raw_buf, RAW_BUF_SIZE);	/* eat data */
+				}
+				cstate->fe_eof = true;
+				eof = true;
+			}
+			else if (eof && chunk.len > split && !cstate->header_line)
+			{
+				/* the last line lacks an EOL, see CopyCheckIsLastLine */
+				nlines++;
+				split = chunk.len;
+			}
+
+			if (nlines > 0)
+			{
+				resetStringInfo(&header);
+				appendStringInfo(&header, INT64_FORMAT "%c" INT64_FORMAT,
+								 chunk_lineno, COPY_METADATA_DELIM, nlines);
+				if (cstate->eol_type == EOL_UNKNOWN)
+					appendStringInfoChar(&header, '\n');
+				else
+					appendBinaryStringInfo(&header, cstate->eol_ch, eol_len);
+
+				cdbCopySendData(cdbCopy, target_seg, header.data, header.len);
+				if (!cdbCopy->io_errors)
+					cdbCopySendData(cdbCopy, target_seg, chunk.data, split);
+				if (cdbCopy->io_errors)
+				{
+					appendBinaryStringInfo(cdbcopy_err, cdbCopy->err_msg.data, cdbCopy->err_msg.len);
+					break;
+				}
+
+				cstate->processed += nlines;
+				target_seg = (target_seg + 1) % cdbCopy->partition_num;
+
+				/* keep the partial line for the next chunk */
+				memmove(chunk.data, chunk.data + split, chunk.len - split);
+				chunk.len -= split;
+				chunk.data[chunk.len] = '\0';
+				scanned -= split;
+				line_start -= split;
+				split = 0;
+				nlines = 0;
+				chunk_lineno = lineno + 1;
+			}
+		}
+	}
+	PG_CATCH();
+	{
+		/* end COPY in all the segdbs in progress */
+		cdbCopyEnd(cdbCopy);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	pfree(chunk.data);
+	pfree(header.data);
+}
+
 /*
  * Copy FROM file to relation.
  */
@@ -3874,7 +4138,9 @@ CopyFrom(CopyState cstate)
 	errcontext.previous = error_context_stack;
 	error_context_stack = &errcontext;
 
-	if (Gp_role == GP_ROLE_EXECUTE)
+	if (Gp_role == GP_ROLE_EXECUTE && cstate->raw_chunks)
+		cstate->err_loc_type = ROWNUM_CHUNKED; /* count rows from the chunk headers */
+	else if (Gp_role == GP_ROLE_EXECUTE)
 		cstate->err_loc_type = ROWNUM_EMBEDDED; /* get original row num from QD COPY */
 	else
 		cstate->err_loc_type = ROWNUM_ORIGINAL; /* we can count rows by ourselves */
@@ -3966,6 +4232,13 @@ CopyFrom(CopyState cstate)
 						break;
 				}
 
+				/* a chunk header was consumed by preProcessDataLine */
+				if (cstate->chunk_header)
+				{
+					cstate->chunk_header = false;
+					QE_GOTO_NEXT_ROW;
+				}
+
 				if (file_has_oids)
 				{
 					char	   *oid_string;
@@ -5127,8 +5400,7 @@ CopyReadAttributesText(CopyState cstate, bool * __restrict nulls,
 		*(stop-1) = delimc;
 
 		/* Find the next of: delimiter, or escape, or end of buffer */
-		for (scanner = scan_start; *scanner != delimc && *scanner != escapec; scanner++)
-			;
+		scanner = copy_scan_bytes(scan_start, bytes_remaining, delimc, escapec, escapec);
 		if (scanner == (stop-1) && endchar != delimc)
 		{
 			if (endchar != escapec)
@@ -5560,6 +5832,32 @@ CopyReadAttributesCSV(CopyState cstate, bool *nulls, int *attr_offsets,
 			break;
 		}
 
+		/*
+		 * Copy the bytes up to the next one that may need handling all at
+		 * once: a delimiter or quote outside of quotes, an escape or quote
+		 * inside of them.
+		 */
+		{
+			char	   *scan_start = cstate->line_buf.data + cstate->line_buf.cursor;
+			int			scan_len = cstate->line_buf.len - 1 - cstate->line_buf.cursor;
+			char	   *scan_end;
+			int			run_len;
+
+			if (in_quote)
+				scan_end = copy_scan_bytes(scan_start, scan_len, escapec, quotec, quotec);
+			else
+				scan_end = copy_scan_bytes(scan_start, scan_len, delimc, quotec, quotec);
+
+			run_len = (scan_end != NULL ? scan_end - scan_start : scan_len);
+			if (run_len > 0)
+			{
+				appendBinaryStringInfo(&cstate->attribute_buf, scan_start, run_len);
+				cstate->line_buf.cursor += run_len;
+				cstate->attribute_buf.cursor += run_len;
+				continue;
+			}
+		}
+
 		c = cstate->line_buf.data[cstate->line_buf.cursor++];
 
 		/* unquoted field delimiter  */
@@ -6174,6 +6472,44 @@ void CopyExtractRowMetaData(CopyState cstate)
 	cstate->line_buf.cursor += value_len;
 }
 
+/*
+ * CopyExtractChunkMetaData - extract the header of a chunk of lines.
+ *
+ * In ROWNUM_CHUNKED mode the QD precedes every chunk of data lines it sends
+ * with a line of its own:
+ *
+ *    line_buf: <original_num>^<num_lines><eol>
+ *
+ * where original_num is the line number of the first line of the chunk in
+ * the original data.
+ */
+static
+void CopyExtractChunkMetaData(CopyState cstate)
+{
+	char	   *line_start = cstate->line_buf.data;
+	char	   *end;
+	long		lineno;
+	long		nlines = 0;
+
+	lineno = strtol(line_start, &end, 10);
+	if (end != line_start && *end == COPY_METADATA_DELIM)
+	{
+		line_start = end + 1;
+		nlines = strtol(line_start, &end, 10);
+	}
+
+	if (end == line_start || lineno <= 0 || nlines <= 0 ||
+		(*end != '\0' && *end != '\n' && *end != '\r'))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_OBJECT_DEFINITION),
+				 errmsg("COPY chunk header not found. This probably means that there is a "
+						"mixture of newline types in the data. Use the NEWLINE keyword "
+						"in order to resolve this reliably.")));
+
+	cstate->cur_lineno = lineno - 1;
+	cstate->chunk_lines_left = nlines;
+}
+
 /*
  * error context callback for COPY FROM
  */
@@ -6472,16 +6808,33 @@ scanCSVLine(CopyState cstate, const char *s, char eol, char escapec, char quotec
 		cstate->missing_bytes = (s > end ? s - end : 0);
 	}
 	else
-		/* safe to scroll byte by byte */
+		/* safe to skip to the next eol, escape or quote byte */
 	{	
-		for ( ; *s != eol && s < end ; s++)
+		while (s < end)
 		{
+			const char *next = copy_scan_bytes(s, end - s, eol, escapec, quotec);
+
+			/* any other byte ends a run of escapes */
+			if (next != s)
+				cstate->last_was_esc = false;
+
+			if (next == NULL)
+			{
+				s = end;
+				break;
+			}
+
+			s = next;
+			if (*s == eol)
+				break;
+
 			if (cstate->in_quote && *s == escapec)
 				cstate->last_was_esc = !cstate->last_was_esc;
 			if (*s == quotec && !cstate->last_was_esc)
 				cstate->in_quote = !cstate->in_quote;
 			if (*s != escapec)
 				cstate->last_was_esc = false;
+			s++;
 		}
 	}
 
@@ -6782,6 +7135,24 @@ void preProcessDataLine(CopyState cstate)
 		}
 			
 	}
+	else if(cstate->err_loc_type == ROWNUM_CHUNKED)
+	{
+		Assert(Gp_role == GP_ROLE_EXECUTE);
+
+		/*
+		 * Every chunk of lines the QD sends us starts with a header line
+		 * telling the original number of its first line.
+		 */
+		if (cstate->chunk_lines_left == 0)
+		{
+			CopyExtractChunkMetaData(cstate);
+			cstate->chunk_header = true;
+			return;
+		}
+
+		cstate->chunk_lines_left--;
+		cstate->cur_lineno++;
+	}
 	else
 	{
 		Assert(false); /* byte offset not yet supported */
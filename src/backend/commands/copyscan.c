@@ -0,0 +1,170 @@
+/*-------------------------------------------------------------------------
+ *
+ * copyscan.c
+ *		Find the special bytes of COPY and external table data
+ *
+ * Parsing text and CSV data spends most of its time looking for the next
+ * byte that needs attention: an end of line, a delimiter, an escape or a
+ * quote. The bytes in between are just copied. copy_scan_bytes finds the
+ * first of up to three such bytes in a buffer.
+ *
+ * On x86 the buffer is compared a block of 16 (SSE2) or 32 (AVX2) bytes at
+ * a time. Each comparison gives a bitmap of the positions of the wanted
+ * bytes in the block, and the first set bit is the answer. The best method
+ * is picked the first time the function is called, by looking at what the
+ * CPU supports; other platforms, and CPUs without SSE2, compare a byte at
+ * a time.
+ *
+ * Portions Copyright (c) 2005-2008, Greenplum inc
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "commands/copy.h"
+
+static char *copy_scan_bytes_simple(const char *s, size_t len,
+									char c1, char c2, char c3);
+
+static char *
+copy_scan_bytes_simple(const char *s, size_t len, char c1, char c2, char c3)
+{
+	const char *end = s + len;
+
+	for (; s < end; s++)
+	{
+		if (*s == c1 || *s == c2 || *s == c3)
+			return (char *) s;
+	}
+
+	return NULL;
+}
+
+#if (defined(__X86__) || defined(__i386__) || defined(i386) || defined(_M_IX86) || defined(__386__) || defined(__x86_64__) || defined(_M_X64))
+
+#include <cpuid.h>
+
+#ifndef bit_AVX2
+#define bit_AVX2	(1 << 5)
+#endif
+
+static char *copy_scan_bytes_detect(const char *s, size_t len,
+									char c1, char c2, char c3);
+static char *copy_scan_bytes_sse2(const char *s, size_t len,
+								  char c1, char c2, char c3);
+static char *copy_scan_bytes_avx2(const char *s, size_t len,
+								  char c1, char c2, char c3);
+
+#pragma GCC push_options
+#pragma GCC target ("sse2")
+#include <emmintrin.h>
+
+/* SSE2 version, 16 bytes at a time */
+static char *
+copy_scan_bytes_sse2(const char *s, size_t len, char c1, char c2, char c3)
+{
+	const char *end = s + len;
+	__m128i		v1 = _mm_set1_epi8(c1);
+	__m128i		v2 = _mm_set1_epi8(c2);
+	__m128i		v3 = _mm_set1_epi8(c3);
+
+	for (; s + sizeof(__m128i) <= end; s += sizeof(__m128i))
+	{
+		__m128i		block = _mm_loadu_si128((const __m128i *) s);
+		int			mask;
+
+		mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, v1),
+														   _mm_cmpeq_epi8(block, v2)),
+											  _mm_cmpeq_epi8(block, v3)));
+		if (mask != 0)
+			return (char *) s + __builtin_ctz(mask);
+	}
+
+	return copy_scan_bytes_simple(s, end - s, c1, c2, c3);
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target ("avx2")
+#include <immintrin.h>
+
+/* AVX2 version, 32 bytes at a time */
+static char *
+copy_scan_bytes_avx2(const char *s, size_t len, char c1, char c2, char c3)
+{
+	const char *end = s + len;
+	__m256i		v1 = _mm256_set1_epi8(c1);
+	__m256i		v2 = _mm256_set1_epi8(c2);
+	__m256i		v3 = _mm256_set1_epi8(c3);
+
+	for (; s + sizeof(__m256i) <= end; s += sizeof(__m256i))
+	{
+		__m256i		block = _mm256_loadu_si256((const __m256i *) s);
+		uint32		mask;
+
+		mask = (uint32) _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, v1),
+																			  _mm256_cmpeq_epi8(block, v2)),
+															 _mm256_cmpeq_epi8(block, v3)));
+		if (mask != 0)
+			return (char *) s + __builtin_ctz(mask);
+	}
+
+	/* the rest is shorter than a block, finish it off with SSE2 */
+	return copy_scan_bytes_sse2(s, end - s, c1, c2, c3);
+}
+
+#pragma GCC pop_options
+
+/*
+ * Detect the best method on the first call, like crc32cDetectBestMethod.
+ *
+ * AVX2 needs support from the operating system as well: it must save the
+ * AVX registers on a context switch, which it reports in XCR0.
+ */
+static char *
+copy_scan_bytes_detect(const char *s, size_t len, char c1, char c2, char c3)
+{
+	uint32		eax,
+				ebx,
+				ecx = 0,
+				edx = 0;
+	bool		hasSSE2 = false;
+	bool		hasAVX2 = false;
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+	{
+		hasSSE2 = (edx & bit_SSE2) != 0;
+
+		if ((ecx & bit_OSXSAVE) != 0 && (ecx & bit_AVX) != 0 &&
+			__get_cpuid_max(0, NULL) >= 7)
+		{
+			uint32		xcr0_lo,
+						xcr0_hi;
+
+			__asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+			if ((xcr0_lo & 0x6) == 0x6)
+			{
+				__cpuid_count(7, 0, eax, ebx, ecx, edx);
+				hasAVX2 = (ebx & bit_AVX2) != 0;
+			}
+		}
+	}
+
+	if (hasAVX2)
+		copy_scan_bytes = &copy_scan_bytes_avx2;
+	else if (hasSSE2)
+		copy_scan_bytes = &copy_scan_bytes_sse2;
+	else
+		copy_scan_bytes = &copy_scan_bytes_simple;
+
+	return copy_scan_bytes(s, len, c1, c2, c3);
+}
+
+CopyScanFunctionPtr copy_scan_bytes = &copy_scan_bytes_detect;
+
+#else
+
+CopyScanFunctionPtr copy_scan_bytes = &copy_scan_bytes_simple;
+
+#endif
@@ -783,6 +783,12 @@ ExplainOnePlan_internal(PlannedStmt *plannedstmt,
     		appendStringInfo(buf, "PQO version %s\n", str->data);
 			pfree(str->data);
 			pfree(str);
+			if (queryDesc->plannedstmt->optimizerSearchStages > 0)
+			{
+				appendStringInfo(buf, "Optimizer search: %d of %d stages completed\n",
+								 queryDesc->plannedstmt->optimizerSearchStagesCompleted,
+								 queryDesc->plannedstmt->optimizerSearchStages);
+			}
     	}
     }
 #endif
@@ -0,0 +1,202 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "postgres.h"
+#include "../copyscan.c"
+
+#define BUFLEN		256
+#define MAXLEN		100
+#define MAXOFFSET	33
+
+typedef struct CopyScanMethod
+{
+	const char *name;
+	CopyScanFunctionPtr scan;
+} CopyScanMethod;
+
+/*
+ * The block at a time methods the CPU running the test supports, in the
+ * order copy_scan_bytes_detect prefers them.
+ */
+static int
+scan_methods(CopyScanMethod *methods)
+{
+	int			n = 0;
+
+#if (defined(__X86__) || defined(__i386__) || defined(i386) || defined(_M_IX86) || defined(__386__) || defined(__x86_64__) || defined(_M_X64))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		methods[n].name = "avx2";
+		methods[n++].scan = copy_scan_bytes_avx2;
+	}
+	if (__builtin_cpu_supports("sse2"))
+	{
+		methods[n].name = "sse2";
+		methods[n++].scan = copy_scan_bytes_sse2;
+	}
+#endif
+	methods[n].name = "detected";
+	methods[n++].scan = copy_scan_bytes;
+
+	return n;
+}
+
+/*
+ * Scan len bytes at offset of buf with every method, and check that they
+ * all find what the byte at a time method finds.
+ */
+static void
+check_methods_agree(const char *buf, int offset, int len,
+					char c1, char c2, char c3)
+{
+	CopyScanMethod	methods[3];
+	int			nmethods = scan_methods(methods);
+	char	   *expected = copy_scan_bytes_simple(buf + offset, len, c1, c2, c3);
+
+	for (int i = 0; i < nmethods; i++)
+	{
+		char	   *found = methods[i].scan(buf + offset, len, c1, c2, c3);
+
+		if (found != expected)
+			print_error("%s: offset %d, length %d: found %ld, expected %ld\n",
+						methods[i].name, offset, len,
+						found ? (long) (found - buf) : -1L,
+						expected ? (long) (expected - buf) : -1L);
+		assert_true(found == expected);
+	}
+}
+
+/*
+ * One special byte at every position of buffers of every length and
+ * alignment, and no special byte at all.
+ */
+void
+test__copy_scan_bytes__SingleByte(void **state)
+{
+	char		buf[BUFLEN];
+	const char	specials[] = {'\n', ',', '"'};
+
+	for (int offset = 0; offset < MAXOFFSET; offset++)
+	{
+		for (int len = 0; len <= MAXLEN; len++)
+		{
+			memset(buf, 'a', sizeof(buf));
+			check_methods_agree(buf, offset, len, '\n', ',', '"');
+
+			for (int pos = 0; pos < len; pos++)
+			{
+				memset(buf, 'a', sizeof(buf));
+				buf[offset + pos] = specials[pos % 3];
+				check_methods_agree(buf, offset, len, '\n', ',', '"');
+			}
+		}
+	}
+}
+
+/*
+ * A special byte just past the end of the buffer must not be found, also
+ * when it is in the same block as the last byte of the buffer.
+ */
+void
+test__copy_scan_bytes__PastEnd(void **state)
+{
+	char		buf[BUFLEN];
+
+	for (int offset = 0; offset < MAXOFFSET; offset++)
+	{
+		for (int len = 0; len <= MAXLEN; len++)
+		{
+			memset(buf, 'a', sizeof(buf));
+			buf[offset + len] = '\\';
+			check_methods_agree(buf, offset, len, '\\', '\\', '"');
+			assert_true(copy_scan_bytes(buf + offset, len, '\\', '\\', '"') == NULL);
+		}
+	}
+}
+
+/*
+ * CSV parsing resumes the scan after each quote and escape it finds. Put
+ * escaped quotes across the ends of the 16 and 32 byte blocks and check
+ * that scanning from one match to the next finds every byte of them.
+ */
+void
+test__copy_scan_bytes__AcrossBlocks(void **state)
+{
+	char		buf[BUFLEN];
+	const int	boundaries[] = {16, 32, 64};
+
+	for (int b = 0; b < lengthof(boundaries); b++)
+	{
+		for (int shift = -2; shift <= 1; shift++)
+		{
+			int			first = boundaries[b] + shift;
+			int			expected[] = {0, first, first + 1, first + 2, first + 3};
+			int			nfound = 0;
+			char	   *s = buf;
+			char	   *end = buf + 100;
+
+			memset(buf, 'x', sizeof(buf));
+			/* an opening quote, then a quote doubled and one escaped */
+			buf[0] = '"';
+			buf[first] = '"';
+			buf[first + 1] = '"';
+			buf[first + 2] = '\\';
+			buf[first + 3] = '"';
+
+			for (int offset = 0; offset < MAXOFFSET; offset++)
+				check_methods_agree(buf, offset, 100 - offset, '"', '\\', '\n');
+
+			while ((s = copy_scan_bytes(s, end - s, '"', '\\', '\n')) != NULL)
+			{
+				assert_true(nfound < lengthof(expected));
+				assert_int_equal(s - buf, expected[nfound]);
+				nfound++;
+				s++;
+			}
+			assert_int_equal(nfound, lengthof(expected));
+		}
+	}
+}
+
+/*
+ * The comparisons are done on bytes, so bytes with the high bit set, as in
+ * multibyte characters, must neither match ASCII bytes nor be missed.
+ */
+void
+test__copy_scan_bytes__HighBitBytes(void **state)
+{
+	char		buf[BUFLEN];
+
+	for (int offset = 0; offset < MAXOFFSET; offset++)
+	{
+		for (int pos = 0; pos < MAXLEN; pos++)
+		{
+			memset(buf, 0xc3, sizeof(buf));
+			check_methods_agree(buf, offset, MAXLEN, '\n', '\t', '\\');
+
+			buf[offset + pos] = (char) 0xa9;
+			check_methods_agree(buf, offset, MAXLEN, (char) 0xa9, '\t', '\\');
+			assert_true(copy_scan_bytes(buf + offset, MAXLEN, (char) 0xa9, '\t', '\\') ==
+						buf + offset + pos);
+		}
+	}
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+			unit_test(test__copy_scan_bytes__SingleByte),
+			unit_test(test__copy_scan_bytes__PastEnd),
+			unit_test(test__copy_scan_bytes__AcrossBlocks),
+			unit_test(test__copy_scan_bytes__HighBitBytes)
+	};
+	return run_tests(tests);
+}
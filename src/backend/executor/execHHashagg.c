@@ -28,6 +28,7 @@
 #include "executor/execWorkfile.h"
 #include "storage/bfz.h"
 #include "utils/datum.h"
+#include "utils/fmgroids.h"
 #include "utils/memutils.h"
 #include "utils/lsyscache.h"
 #include "utils/elog.h"
@@ -53,9 +54,15 @@ struct BatchFileInfo
 	ExecWorkFile *wfile;
 };
 
+/*
+ * The buffers of the asynchronous I/O of a batch file are freed along with
+ * its freeable stuff, so they are counted in both.
+ */
 #define BATCHFILE_METADATA \
-    (sizeof(BatchFileInfo) + sizeof(bfz_t) + sizeof(struct bfz_freeable_stuff))
-#define FREEABLE_BATCHFILE_METADATA (sizeof(struct bfz_freeable_stuff))
+    (sizeof(BatchFileInfo) + sizeof(bfz_t) + sizeof(struct bfz_freeable_stuff) + \
+     bfz_aio_buffer_overhead())
+#define FREEABLE_BATCHFILE_METADATA \
+    (sizeof(struct bfz_freeable_stuff) + bfz_aio_buffer_overhead())
 /*
  * Number of batchfile metadata to reserve during spilling in order to have
  * enough memory to open them at reuse.
@@ -96,6 +103,13 @@ typedef enum InputRecordType
 #define HAVE_FREESPACE(hashtable) \
    (GET_TOTAL_USED_SIZE(hashtable) < (hashtable)->max_mem)
 
+/* Tag of a non-empty slot in the open-addressing table */
+#define HASHAGG_SLOT_TAG(hashkey) ((uint8) (0x80 | ((hashkey) >> 25)))
+
+/* Memory used by the slot arrays of the open-addressing table */
+#define HASHAGG_SLOTS_SIZE(nslots) \
+	((double) (nslots) * (sizeof(uint8) + sizeof(HashKey) + sizeof(HashAggEntry *)))
+
 /* Methods that handle batch files */
 static SpillSet *createSpillSet(unsigned branching_factor, unsigned parent_hash_bit);
 static SpillSet *read_spill_set(AggState *aggstate);
@@ -113,10 +127,21 @@ static void *readHashEntry(AggState *aggstate,
 /* Methods for hash table */
 static uint32 calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot);
 static void spill_hash_table(AggState *aggstate);
+static void spill_hash_entry(AggState *aggstate, SpillFile *spill_file,
+							 HashAggEntry *entry);
 static void init_agg_hash_iter(HashAggTable* ht);
 static HashAggEntry *lookup_agg_hash_entry(AggState *aggstate, void *input_record,
 										   InputRecordType input_type, int32 input_size,
 										   uint32 hashkey, unsigned parent_hash_bit, bool *p_isnew);
+static HashAggEntry *lookup_agg_hash_slot(AggState *aggstate, void *input_record,
+										  InputRecordType input_type, uint16 input_keynulls,
+										  uint32 hashkey, unsigned parent_hash_bit,
+										  unsigned int *p_slot_idx);
+static bool reserve_agg_hash_slot(AggState *aggstate, uint32 hashkey,
+								  unsigned parent_hash_bit, unsigned int *p_slot_idx);
+static void alloc_agg_hash_slots(HashAggTable *hashtable, MemoryContext cxt,
+								 unsigned nslots);
+static void free_agg_hash_slots(HashAggTable *hashtable);
 static void agg_hash_table_stat_upd(HashAggTable *ht);
 static void reset_agg_hash_table(AggState *aggstate);
 static bool agg_hash_reload(AggState *aggstate);
@@ -164,7 +189,11 @@ calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot)
 
 		if (!isnull)			/* treat nulls as having hash key 0 */
 		{
-			hashtable->hashkey_buf[i] = DatumGetUInt32(FunctionCall1(info, value));
+			/* fixed-width keys need no function call */
+			if (hashtable->hashmixkinds[i] != CDBHASH_MIX_NONE)
+				hashtable->hashkey_buf[i] = cdbhashmix(hashtable->hashmixkinds[i], value);
+			else
+				hashtable->hashkey_buf[i] = DatumGetUInt32(FunctionCall1(info, value));
 		}
 		
 		else
@@ -176,6 +205,115 @@ calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot)
 	return (uint32) hash_any((unsigned char *) hashtable->hashkey_buf, agg->numCols * sizeof(HashKey));
 }
 
+/* Function: getGroupKeyCmp
+ *
+ * Return how a grouping column with the given equality function is compared.
+ */
+static HashAggKeyCmp
+getGroupKeyCmp(Oid eqfn)
+{
+	switch (eqfn)
+	{
+		case F_BOOLEQ:
+			return HASHAGG_KEYCMP_BOOL;
+		case F_CHAREQ:
+			return HASHAGG_KEYCMP_CHAR;
+		case F_INT2EQ:
+			return HASHAGG_KEYCMP_INT2;
+		case F_INT4EQ:
+		case F_OIDEQ:
+		case F_DATE_EQ:
+			return HASHAGG_KEYCMP_INT4;
+		case F_INT8EQ:
+#ifdef HAVE_INT64_TIMESTAMP
+		case F_TIME_EQ:
+		case F_TIMESTAMP_EQ:
+#endif
+			return HASHAGG_KEYCMP_INT8;
+		default:
+			return HASHAGG_KEYCMP_FMGR;
+	}
+}
+
+/* Function: normalizeGroupKey
+ *
+ * Return the normalized form of a non-null grouping key, which is equal
+ * for two keys iff the equality function of the column says so. Only
+ * valid for columns that are not HASHAGG_KEYCMP_FMGR.
+ */
+static inline Datum
+normalizeGroupKey(HashAggKeyCmp cmp, Datum value)
+{
+	switch (cmp)
+	{
+		case HASHAGG_KEYCMP_BOOL:
+			return BoolGetDatum(DatumGetBool(value));
+		case HASHAGG_KEYCMP_CHAR:
+			return (Datum) (uint8) DatumGetChar(value);
+		case HASHAGG_KEYCMP_INT2:
+			return (Datum) (uint16) DatumGetInt16(value);
+		case HASHAGG_KEYCMP_INT4:
+			return (Datum) (uint32) DatumGetInt32(value);
+		default:
+			return value;
+	}
+}
+
+/* Function: getInputGroupKey
+ *
+ * Extract the given grouping column from an input record of lookup_agg_hash_entry.
+ */
+static inline Datum
+getInputGroupKey(void *input_record, InputRecordType input_type,
+				 MemTupleBinding *mt_bind, AttrNumber att, bool *isnull)
+{
+	switch(input_type)
+	{
+		case INPUT_RECORD_TUPLE:
+			return slot_getattr((TupleTableSlot *)input_record, att, isnull);
+		case INPUT_RECORD_GROUP_AND_AGGS:
+			return memtuple_getattr((MemTuple)input_record, mt_bind, att, isnull);
+		default:
+			insist_log(false, "invalid record type %d", input_type);
+	}
+
+	return 0;
+}
+
+/* Function: getInputInlineKeys
+ *
+ * Store the normalized grouping keys of an input record into
+ * hashtable->input_keys, and return the bitmap of the null keys.
+ */
+static uint16
+getInputInlineKeys(AggState *aggstate, void *input_record, InputRecordType input_type)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	uint16 keynulls = 0;
+	int i;
+
+	Assert(hashtable->inline_keys);
+
+	for (i = 0; i < agg->numCols; i++)
+	{
+		bool isnull = false;
+		Datum value = getInputGroupKey(input_record, input_type, mt_bind,
+									   agg->grpColIdx[i], &isnull);
+
+		if (isnull)
+		{
+			hashtable->input_keys[i] = 0;
+			keynulls |= (uint16) (1 << i);
+		}
+		else
+			hashtable->input_keys[i] = normalizeGroupKey(hashtable->keycmps[i], value);
+	}
+
+	return keynulls;
+}
+
 /* Function: adjustInputGroup
  *
  * Adjust the datum pointers stored in the byte array of an input group.
@@ -378,6 +516,207 @@ setGroupAggs(HashAggTable *hashtable, MemTupleBinding *mt_bind, HashAggEntry *en
 	}
 }
 
+/*
+ * Function: matchHashAggEntry
+ *
+ * Returns true if the grouping keys of the given entry are equal to those
+ * of the input record. With inline keys, input_keynulls is the null bitmap
+ * returned by getInputInlineKeys for the record.
+ */
+static inline bool
+matchHashAggEntry(AggState *aggstate, HashAggEntry *entry,
+				  void *input_record, InputRecordType input_type,
+				  uint16 input_keynulls)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	MemTuple mtup = (MemTuple) entry->tuple_and_aggs;
+	int i;
+
+	if (hashtable->inline_keys)
+		return (entry->keynulls == input_keynulls &&
+				memcmp(entry->keys, hashtable->input_keys,
+					   agg->numCols * sizeof(Datum)) == 0);
+
+	for (i = 0; i < agg->numCols; i++)
+	{
+		AttrNumber	att = agg->grpColIdx[i];
+		HashAggKeyCmp cmp = hashtable->keycmps[i];
+		Datum input_datum = 0;
+		Datum entry_datum = 0;
+		bool input_isNull = false;
+		bool entry_isNull = false;
+
+		input_datum = getInputGroupKey(input_record, input_type, mt_bind,
+									   att, &input_isNull);
+		entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
+
+		if ( !input_isNull && !entry_isNull &&
+			 (cmp != HASHAGG_KEYCMP_FMGR ?
+			  normalizeGroupKey(cmp, input_datum) == normalizeGroupKey(cmp, entry_datum) :
+			  DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
+										 input_datum,
+										 entry_datum)) ) )
+			continue; /* Both non-NULL and equal. */
+
+		if (!(input_isNull && entry_isNull)) /* NULLs match in group keys. */
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Function: lookup_agg_hash_slot
+ *
+ * Probe the open-addressing table for the entry matching the input record.
+ * If there is none, return NULL and set *p_slot_idx to the empty slot
+ * ending the probe.
+ */
+static HashAggEntry *
+lookup_agg_hash_slot(AggState *aggstate, void *input_record,
+					 InputRecordType input_type, uint16 input_keynulls,
+					 uint32 hashkey, unsigned parent_hash_bit,
+					 unsigned int *p_slot_idx)
+{
+	HashAggSlots *slots = &aggstate->hhashtable->slots;
+	unsigned int mask = slots->nslots - 1;
+	unsigned int slot_idx = (hashkey >> parent_hash_bit) & mask;
+	uint8 tag = HASHAGG_SLOT_TAG(hashkey);
+
+	AssertImply(slots->nused > 0, slots->hash_bit == parent_hash_bit);
+	slots->hash_bit = parent_hash_bit;
+
+	/* The table always has an empty slot, which ends the probe. */
+	for (; slots->tags[slot_idx] != 0; slot_idx = (slot_idx + 1) & mask)
+	{
+		if (slots->tags[slot_idx] == tag &&
+			slots->hashes[slot_idx] == hashkey &&
+			matchHashAggEntry(aggstate, slots->entries[slot_idx],
+							  input_record, input_type, input_keynulls))
+			return slots->entries[slot_idx];
+	}
+
+	*p_slot_idx = slot_idx;
+	return NULL;
+}
+
+/*
+ * Function: alloc_agg_hash_slots
+ *
+ * Allocate empty slot arrays of at least the given size for the
+ * open-addressing table in the given context, and account for them in the
+ * metadata memory. The number of slots is rounded up to a power of two,
+ * which probing relies on; nbuckets need not be one when it was raised to
+ * gp_hashagg_default_nbatches.
+ */
+static void
+alloc_agg_hash_slots(HashAggTable *hashtable, MemoryContext cxt, unsigned nslots)
+{
+	HashAggSlots *slots = &hashtable->slots;
+	MemoryContext oldcxt;
+	unsigned	pow2 = 1;
+
+	while (pow2 < nslots)
+		pow2 <<= 1;
+	nslots = pow2;
+
+	oldcxt = MemoryContextSwitchTo(cxt);
+	slots->tags = (uint8 *)palloc0(nslots * sizeof(uint8));
+	slots->hashes = (HashKey *)palloc(nslots * sizeof(HashKey));
+	slots->entries = (HashAggEntry **)palloc(nslots * sizeof(HashAggEntry *));
+	MemoryContextSwitchTo(oldcxt);
+
+	slots->nslots = nslots;
+	slots->nused = 0;
+	hashtable->mem_for_metadata += HASHAGG_SLOTS_SIZE(nslots);
+}
+
+/*
+ * Function: free_agg_hash_slots
+ *
+ * Free the slot arrays of the open-addressing table.
+ */
+static void
+free_agg_hash_slots(HashAggTable *hashtable)
+{
+	HashAggSlots *slots = &hashtable->slots;
+
+	pfree(slots->tags);
+	pfree(slots->hashes);
+	pfree(slots->entries);
+	hashtable->mem_for_metadata -= HASHAGG_SLOTS_SIZE(slots->nslots);
+	slots->nslots = 0;
+	slots->nused = 0;
+}
+
+/*
+ * Function: reserve_agg_hash_slot
+ *
+ * Make sure the open-addressing table has room for one more entry, doubling
+ * it if it is 3/4 full. If the table was rebuilt, *p_slot_idx is set to the
+ * empty slot a new entry with the given hash value goes to.
+ *
+ * Returns false if the table is full and there is no memory to grow it.
+ */
+static bool
+reserve_agg_hash_slot(AggState *aggstate, uint32 hashkey,
+					  unsigned parent_hash_bit, unsigned int *p_slot_idx)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	HashAggSlots *slots = &hashtable->slots;
+	HashAggSlots old_slots;
+	unsigned int mask;
+	unsigned int i;
+
+	if ((uint64) (slots->nused + 1) * 4 <= (uint64) slots->nslots * 3)
+		return true;
+
+	if (slots->nslots > UINT_MAX / 2 ||
+		GET_TOTAL_USED_SIZE(hashtable) + HASHAGG_SLOTS_SIZE(2 * slots->nslots) >=
+		hashtable->max_mem)
+		return false;
+
+	old_slots = *slots;
+	alloc_agg_hash_slots(hashtable, aggstate->aggcontext, 2 * old_slots.nslots);
+	slots->hash_bit = old_slots.hash_bit;
+	mask = slots->nslots - 1;
+
+	/* Reinsert the entries by their stored hash values. */
+	for (i = 0; i < old_slots.nslots; i++)
+	{
+		unsigned int slot_idx;
+
+		if (old_slots.tags[i] == 0)
+			continue;
+
+		slot_idx = (old_slots.hashes[i] >> slots->hash_bit) & mask;
+		while (slots->tags[slot_idx] != 0)
+			slot_idx = (slot_idx + 1) & mask;
+
+		slots->tags[slot_idx] = old_slots.tags[i];
+		slots->hashes[slot_idx] = old_slots.hashes[i];
+		slots->entries[slot_idx] = old_slots.entries[i];
+		slots->nused++;
+	}
+
+	pfree(old_slots.tags);
+	pfree(old_slots.hashes);
+	pfree(old_slots.entries);
+	hashtable->mem_for_metadata -= HASHAGG_SLOTS_SIZE(old_slots.nslots);
+	hashtable->total_buckets += slots->nslots - old_slots.nslots;
+
+	elog(HHA_MSG_LVL, "HashAgg: grew hash table to %u slots", slots->nslots);
+
+	/* Find the empty slot for the new entry in the new table. */
+	*p_slot_idx = (hashkey >> parent_hash_bit) & mask;
+	while (slots->tags[*p_slot_idx] != 0)
+		*p_slot_idx = (*p_slot_idx + 1) & mask;
+
+	return true;
+}
+
 /*
  * Function: lookup_agg_hash_entry
  *
@@ -405,10 +744,10 @@ lookup_agg_hash_entry(AggState *aggstate,
 	HashAggTable *hashtable = aggstate->hhashtable;
 	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
 	ExprContext *tmpcontext = aggstate->tmpcontext; /* per input tuple context */
-	Agg *agg = (Agg*)aggstate->ss.ps.plan;
 	MemoryContext oldcxt;
-	unsigned int bucket_idx;
-	uint64 bloomval;			/* bloom filter value */
+	unsigned int bucket_idx = 0;
+	uint64 bloomval = 0;		/* bloom filter value */
+	uint16 input_keynulls = 0;
    
 	Assert(mt_bind != NULL);
 
@@ -416,68 +755,58 @@ lookup_agg_hash_entry(AggState *aggstate,
 		*p_isnew = false;
 
 	oldcxt = MemoryContextSwitchTo(tmpcontext->ecxt_per_tuple_memory);
-	bucket_idx = (hashkey >> parent_hash_bit) % (hashtable->nbuckets);
-	bloomval = ((uint64)1) << ((hashkey >> 23) & 0x3f);
-	entry = (0 == (hashtable->bloom[bucket_idx] & bloomval) ? NULL :
-			 hashtable->buckets[bucket_idx]);
 
 	/*
-	 * Search entry chain for the bucket. If such an entry found in the
-	 * chain, move it to the front of the chain. Otherwise, if there
-	 * are any space left, create a new entry, and insert it in
-	 * the front of the chain.
+	 * With inline keys, deform the input record once; the entries are
+	 * then matched by comparing the normalized keys.
 	 */
-	while (entry != NULL)
+	if (hashtable->inline_keys)
+		input_keynulls = getInputInlineKeys(aggstate, input_record, input_type);
+
+	if (hashtable->open_addressing)
+	{
+		entry = lookup_agg_hash_slot(aggstate, input_record, input_type,
+									 input_keynulls, hashkey, parent_hash_bit,
+									 &bucket_idx);
+	}
+	else
 	{
-		MemTuple mtup = (MemTuple) entry->tuple_and_aggs;
-		int i;
-		bool match = true;
+		bucket_idx = (hashkey >> parent_hash_bit) % (hashtable->nbuckets);
+		bloomval = ((uint64)1) << ((hashkey >> 23) & 0x3f);
+		entry = (0 == (hashtable->bloom[bucket_idx] & bloomval) ? NULL :
+				 hashtable->buckets[bucket_idx]);
 
-		if (hashkey != entry->hashvalue)
-		{
-			entry = entry->next;
-			continue;
-		}
-		
-		for (i = 0; match && i < agg->numCols; i++)
+		/*
+		 * Search entry chain for the bucket. If such an entry found in the
+		 * chain, move it to the front of the chain. Otherwise, if there
+		 * are any space left, create a new entry, and insert it in
+		 * the front of the chain.
+		 */
+		while (entry != NULL)
 		{
-			AttrNumber	att = agg->grpColIdx[i];
-			Datum input_datum = 0;
-			Datum entry_datum = 0;
-			bool input_isNull = false;
-			bool entry_isNull = false;
-				
-			switch(input_type)
-			{
-				case INPUT_RECORD_TUPLE:
-					input_datum = slot_getattr((TupleTableSlot *)input_record, att, &input_isNull);
-					break;
-				case INPUT_RECORD_GROUP_AND_AGGS:
-					input_datum = memtuple_getattr((MemTuple)input_record, mt_bind, att, &input_isNull);
-					break;
-				default:
-					insist_log(false, "invalid record type %d", input_type);
-			}
-
-			entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
+			/* Break if found an existing matching entry. */
+			if (hashkey == entry->hashvalue &&
+				matchHashAggEntry(aggstate, entry, input_record, input_type,
+								  input_keynulls))
+				break;
 
-			if ( !input_isNull && !entry_isNull &&
-				 (DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
-											 input_datum,
-											 entry_datum)) ) )
-				continue; /* Both non-NULL and equal. */
-			match = (input_isNull && entry_isNull);/* NULLs match in group keys. */
+			entry = entry->next;
 		}
-		
-		/* Break if found an existing matching entry. */
-		if (match)
-			break;
-
-		entry = entry->next;
 	}
 
 	if (entry == NULL)
 	{
+		/*
+		 * An open-addressing table must keep some empty slots. If it cannot
+		 * grow, there is no room for a new entry.
+		 */
+		if (hashtable->open_addressing &&
+			!reserve_agg_hash_slot(aggstate, hashkey, parent_hash_bit, &bucket_idx))
+		{
+			(void) MemoryContextSwitchTo(oldcxt);
+			return NULL;
+		}
+
 		/* Create a new matching entry. */
 		switch(input_type)
 		{
@@ -493,9 +822,28 @@ lookup_agg_hash_entry(AggState *aggstate,
 			
 		if (entry != NULL)
 		{
-			entry->next = hashtable->buckets[bucket_idx];
-			hashtable->buckets[bucket_idx] = entry;
-			hashtable->bloom[bucket_idx] |= bloomval;
+			if (hashtable->inline_keys)
+			{
+				memcpy(entry->keys, hashtable->input_keys,
+					   ((Agg *) aggstate->ss.ps.plan)->numCols * sizeof(Datum));
+				entry->keynulls = input_keynulls;
+			}
+
+			if (hashtable->open_addressing)
+			{
+				HashAggSlots *slots = &hashtable->slots;
+
+				slots->tags[bucket_idx] = HASHAGG_SLOT_TAG(hashkey);
+				slots->hashes[bucket_idx] = hashkey;
+				slots->entries[bucket_idx] = entry;
+				slots->nused++;
+			}
+			else
+			{
+				entry->next = hashtable->buckets[bucket_idx];
+				hashtable->buckets[bucket_idx] = entry;
+				hashtable->bloom[bucket_idx] |= bloomval;
+			}
 			
 			hashtable->num_ht_groups++;
 
@@ -522,6 +870,7 @@ bool
 calcHashAggTableSizes(double memquota,	/* Memory quota in bytes. */
 					  double ngroups,	/* Est # of groups. */
 					  int numaggs,		/* Est # of aggregate functions */
+					  int numkeys,		/* # of grouping columns */
 					  int keywidth,	/* Est per entry size of hash key. */
 					  int transpace,	/* Est per entry size of by-ref values. */
 					  bool force,      /* true => succeed even if work_mem too small */
@@ -529,7 +878,11 @@ calcHashAggTableSizes(double memquota,	/* Memory quota in bytes. */
 {
 	bool expectSpill = false;
 
-	int entrywidth = sizeof(HashAggEntry)
+	/*
+	 * Whether the keys are kept inline also depends on their equality
+	 * functions, which are not known when planning; assume they are.
+	 */
+	int entrywidth = HASHAGG_ENTRY_SIZE(numkeys <= HASHAGG_MAX_INLINE_KEYS ? numkeys : 0)
 		+ numaggs * sizeof(AggStatePerGroupData)
 		+ keywidth
 		+ transpace;
@@ -686,6 +1039,7 @@ create_agg_hash_table(AggState *aggstate)
 	HashAggTable *hashtable;
 	Agg *agg = (Agg *)aggstate->ss.ps.plan;
 	MemoryContext oldcxt;
+	int i;
 
 	oldcxt = MemoryContextSwitchTo(aggstate->aggcontext);
 	hashtable = (HashAggTable *)palloc0(sizeof(HashAggTable));
@@ -696,6 +1050,21 @@ create_agg_hash_table(AggState *aggstate)
 												 ALLOCSET_DEFAULT_INITSIZE,
 												 ALLOCSET_DEFAULT_MAXSIZE);
 
+	/*
+	 * Choose the comparison of each grouping column. If no column needs
+	 * the equality function, keep the normalized keys in the entries.
+	 */
+	hashtable->keycmps = (HashAggKeyCmp *)palloc(agg->numCols * sizeof(HashAggKeyCmp));
+	hashtable->inline_keys = (agg->numCols <= HASHAGG_MAX_INLINE_KEYS);
+	for (i = 0; i < agg->numCols; i++)
+	{
+		hashtable->keycmps[i] = getGroupKeyCmp(aggstate->eqfunctions[i].fn_oid);
+		if (hashtable->keycmps[i] == HASHAGG_KEYCMP_FMGR)
+			hashtable->inline_keys = false;
+	}
+	if (hashtable->inline_keys)
+		hashtable->input_keys = (Datum *)palloc0(agg->numCols * sizeof(Datum));
+
 	bool can_reuse_workfiles = false;
 	workfile_set *work_set = NULL;
 	if (gp_workfile_caching)
@@ -722,6 +1091,7 @@ create_agg_hash_table(AggState *aggstate)
 	if (!calcHashAggTableSizes(1024.0 * (double) operatorMemKB,
 							   (double)agg->numGroups,
 							   aggstate->numaggs,
+							   hashtable->inline_keys ? agg->numCols : 0,
 							   Min(est_hash_tuple_size(aggstate->ss.ss_ScanTupleSlot,
 													   aggstate->hash_needed),
 								   agg->plan.plan_width),
@@ -742,16 +1112,26 @@ create_agg_hash_table(AggState *aggstate)
 		hashtable->num_batches = work_set->metadata.num_leaf_files;
 	}
 
-	/* Initialize the hash buckets */
+	/*
+	 * Initialize the hash buckets. The open-addressing table starts with as
+	 * many slots as there would be buckets, and is allocated below.
+	 */
 	hashtable->nbuckets = hashtable->hats.nbuckets;
 	hashtable->total_buckets = hashtable->nbuckets;
-	hashtable->buckets = (HashAggEntry **)palloc0(hashtable->nbuckets * sizeof(HashAggEntry *));
-	hashtable->bloom = (uint64 *)palloc0(hashtable->nbuckets * sizeof(uint64));
+	hashtable->open_addressing = gp_hashagg_open_addressing;
+	if (!hashtable->open_addressing)
+	{
+		hashtable->buckets = (HashAggEntry **)palloc0(hashtable->nbuckets * sizeof(HashAggEntry *));
+		hashtable->bloom = (uint64 *)palloc0(hashtable->nbuckets * sizeof(uint64));
+	}
 
 	MemoryContextSwitchTo(hashtable->entry_cxt);
 	
 	/* Initialize buffer for hash entries */
-	CdbCellBuf_InitEasy(&(hashtable->entry_buf), sizeof(HashAggEntry));
+	CdbCellBuf_InitEasy(&(hashtable->entry_buf),
+						hashtable->inline_keys ?
+						HASHAGG_ENTRY_SIZE(agg->numCols) :
+						HASHAGG_ENTRY_SIZE(0));
 	hashtable->group_buf = mpool_create(hashtable->entry_cxt,
 										"GroupsAndAggs Context");
 	hashtable->groupaggs = (GroupKeysAndAggs *)palloc0(sizeof(GroupKeysAndAggs));
@@ -766,9 +1146,16 @@ create_agg_hash_table(AggState *aggstate)
 
 	hashtable->max_mem = 1024.0 * operatorMemKB;
 	hashtable->mem_for_metadata = sizeof(HashAggTable)
-		+ hashtable->nbuckets * sizeof(HashAggEntry *)
-		+ hashtable->nbuckets * sizeof(uint64)
+		+ agg->numCols * (sizeof(HashAggKeyCmp) + sizeof(Datum))
 		+ sizeof(GroupKeysAndAggs);
+	if (hashtable->open_addressing)
+	{
+		alloc_agg_hash_slots(hashtable, aggstate->aggcontext, hashtable->nbuckets);
+		hashtable->total_buckets = hashtable->slots.nslots;
+	}
+	else
+		hashtable->mem_for_metadata +=
+			hashtable->nbuckets * (sizeof(HashAggEntry *) + sizeof(uint64));
 	hashtable->mem_wanted = hashtable->mem_for_metadata;
 	hashtable->mem_used = hashtable->mem_for_metadata;
 
@@ -892,6 +1279,13 @@ agg_hash_initial_pass(AggState *aggstate)
 			
 			hashtable->hashkey_buf = (HashKey *)palloc0(size);
 			hashtable->mem_for_metadata += size;
+
+			size = ((Agg *)aggstate->ss.ps.plan)->numCols * sizeof(CdbHashMixKind);
+			hashtable->hashmixkinds = (CdbHashMixKind *)palloc(size);
+			hashtable->mem_for_metadata += size;
+			for (int i = 0; i < ((Agg *)aggstate->ss.ps.plan)->numCols; i++)
+				hashtable->hashmixkinds[i] =
+					cdbhashmixkind(aggstate->hashfunctions[i].fn_oid);
 		}
 
 		/* set up for advance_aggregates call */
@@ -1367,6 +1761,28 @@ read_spill_set(AggState *aggstate)
 	return spill_set;
 }
 
+/*
+ * Write one hash table entry to the given spill file.
+ */
+static void
+spill_hash_entry(AggState *aggstate, SpillFile *spill_file, HashAggEntry *entry)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	int32 written_bytes;
+
+	written_bytes = writeHashEntry(aggstate, spill_file->file_info, entry);
+	spill_file->file_info->ntuples++;
+	spill_file->file_info->total_bytes += written_bytes;
+
+	hashtable->num_spill_groups++;
+
+	Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLTUPLE);
+	Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLBYTE, written_bytes);
+
+	Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_TUPLE);
+	Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_BYTE, written_bytes);
+}
+
 /* Spill all entries from the hash table to file in order to make room
  * for new hash entries.
  *
@@ -1433,6 +1849,29 @@ spill_hash_table(AggState *aggstate)
 			CheckSendPlanStateGpmonPkt(&aggstate->ss.ps);
 		}
 
+		/*
+		 * In the open-addressing table an entry need not be in its home
+		 * slot, so pick the entries of this file by their hash values.
+		 */
+		if (hashtable->open_addressing)
+		{
+			HashAggSlots *slots = &hashtable->slots;
+			unsigned int slot_idx;
+
+			Assert(slots->nused == 0 ||
+				   slots->hash_bit == spill_file->batch_hash_bit);
+
+			for (slot_idx = 0; slot_idx < slots->nslots; slot_idx++)
+			{
+				if (slots->tags[slot_idx] != 0 &&
+					(slots->hashes[slot_idx] >> spill_file->batch_hash_bit) %
+					spill_set->num_spill_files == file_no)
+					spill_hash_entry(aggstate, spill_file, slots->entries[slot_idx]);
+			}
+
+			continue;
+		}
+
 		for (bucket_no = file_no; bucket_no < hashtable->nbuckets;
 			 bucket_no += spill_set->num_spill_files)
 		{
@@ -1448,27 +1887,19 @@ spill_hash_table(AggState *aggstate)
 				entry = spill_entry->next;
 
 				if (spill_entry != NULL)
-				{
-					int32 written_bytes;
-					
-					written_bytes = writeHashEntry(aggstate, spill_file->file_info, spill_entry);
-					spill_file->file_info->ntuples++;
-					spill_file->file_info->total_bytes += written_bytes;
-
-					hashtable->num_spill_groups++;
-
-					Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLTUPLE);
-					Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLBYTE, written_bytes);
-
-					Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_TUPLE);
-					Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_BYTE, written_bytes);
-				}
+					spill_hash_entry(aggstate, spill_file, spill_entry);
 			}
 
 			hashtable->buckets[bucket_no] = NULL;
 		}
 	}
 
+	if (hashtable->open_addressing)
+	{
+		MemSet(hashtable->slots.tags, 0, hashtable->slots.nslots * sizeof(uint8));
+		hashtable->slots.nused = 0;
+	}
+
 	/* Reset the buffer */
 	CdbCellBuf_Reset(&(hashtable->entry_buf));
 	mpool_reset(hashtable->group_buf);
@@ -1593,6 +2024,24 @@ agg_hash_table_stat_upd(HashAggTable *ht)
 
     char hostname[SEGMENT_IDENTITY_NAME_LENGTH];
     gethostname(hostname,SEGMENT_IDENTITY_NAME_LENGTH);
+
+    /* For the open-addressing table, count the slots probed per entry. */
+    if (ht->open_addressing)
+    {
+        unsigned int    mask = ht->slots.nslots - 1;
+
+        for (i = 0; i < ht->slots.nslots; i++)
+        {
+            if (ht->slots.tags[i] != 0)
+            {
+                unsigned int    home = (ht->slots.hashes[i] >> ht->slots.hash_bit) & mask;
+
+                cdbexplain_agg_upd(&ht->chainlength, ((i - home) & mask) + 1, i, hostname);
+            }
+        }
+        return;
+    }
+
     for (i = 0; i < ht->nbuckets; i++)
     {
         HashAggEntry   *entry = ht->buckets[i];
@@ -1613,7 +2062,9 @@ agg_hash_table_stat_upd(HashAggTable *ht)
  * Initialize the HashAggTable's (one and only) entry iterator. */
 void init_agg_hash_iter(HashAggTable* hashtable)
 {
-	Assert( hashtable != NULL && hashtable->buckets != NULL && hashtable->nbuckets > 0 );
+	Assert( hashtable != NULL && hashtable->nbuckets > 0 );
+	Assert( hashtable->open_addressing ? hashtable->slots.tags != NULL :
+			hashtable->buckets != NULL );
 	
 	hashtable->curr_bucket_idx = -1;
 	hashtable->next_entry = NULL;
@@ -1636,14 +2087,25 @@ agg_hash_iter(AggState *aggstate)
 	SpillSet *spill_set = hashtable->spill_set;
 	MemoryContext oldcxt;
 
-	Assert( hashtable != NULL && hashtable->buckets != NULL && hashtable->nbuckets > 0 );
+	Assert( hashtable != NULL && hashtable->nbuckets > 0 );
 
 	if (hashtable->curr_spill_file != NULL)
 		spill_set = hashtable->curr_spill_file->spill_set;
 	
 	oldcxt = MemoryContextSwitchTo(hashtable->entry_cxt);
 
-	while (entry == NULL &&
+	while (entry == NULL && hashtable->open_addressing &&
+		   hashtable->slots.nslots > ++ hashtable->curr_bucket_idx)
+	{
+		if (hashtable->slots.tags[hashtable->curr_bucket_idx] != 0)
+		{
+			entry = hashtable->slots.entries[hashtable->curr_bucket_idx];
+			Assert(entry->is_primodial);
+			break;
+		}
+	}
+
+	while (entry == NULL && !hashtable->open_addressing &&
 		   hashtable->nbuckets > ++ hashtable->curr_bucket_idx)
 	{
 		entry = hashtable->buckets[hashtable->curr_bucket_idx];
@@ -1767,7 +2229,8 @@ agg_hash_reload(AggState *aggstate)
 
 	hashtable->is_spilling = false;
 	hashtable->num_reloads++;
-	hashtable->total_buckets += hashtable->nbuckets;
+	hashtable->total_buckets += hashtable->open_addressing ?
+		hashtable->slots.nslots : hashtable->nbuckets;
 
 	reloaded_hash_bit = spill_file->batch_hash_bit +
 		(unsigned)ceil(log(spill_file->parent_spill_set->num_spill_files)/log(2));
@@ -1949,7 +2412,7 @@ reCalcNumberBatches(HashAggTable *hashtable, SpillFile *spill_file)
 	Assert(hashtable->max_mem > hashtable->mem_for_metadata);
 		
 	total_bytes = spill_file->file_info->total_bytes +
-		spill_file->file_info->ntuples * sizeof(HashAggEntry);
+		spill_file->file_info->ntuples * hashtable->entry_buf.cellbytes;
 	
 	nbatches =
 		(total_bytes - 1) / 
@@ -2172,8 +2635,16 @@ void reset_agg_hash_table(AggState *aggstate)
 		"HashAgg: resetting " INT64_FORMAT "-entry hash table",
 		hashtable->num_ht_groups);
 	
-	MemSet(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashAggEntry*));
-	MemSet(hashtable->bloom, 0, hashtable->nbuckets * sizeof(uint64));
+	if (hashtable->open_addressing)
+	{
+		MemSet(hashtable->slots.tags, 0, hashtable->slots.nslots * sizeof(uint8));
+		hashtable->slots.nused = 0;
+	}
+	else
+	{
+		MemSet(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashAggEntry*));
+		MemSet(hashtable->bloom, 0, hashtable->nbuckets * sizeof(uint64));
+	}
 	hashtable->num_ht_groups = 0;
 
 	CdbCellBuf_Reset(&(hashtable->entry_buf));
@@ -2211,10 +2682,20 @@ void destroy_agg_hash_table(AggState *aggstate)
 		reset_agg_hash_table(aggstate);
 
 		/* destroy_batches(aggstate->hhashtable); */
-		pfree(aggstate->hhashtable->buckets);
-		pfree(aggstate->hhashtable->bloom);
+		if (aggstate->hhashtable->open_addressing)
+			free_agg_hash_slots(aggstate->hhashtable);
+		else
+		{
+			pfree(aggstate->hhashtable->buckets);
+			pfree(aggstate->hhashtable->bloom);
+		}
 		if (aggstate->hhashtable->hashkey_buf)
 			pfree(aggstate->hhashtable->hashkey_buf);
+		if (aggstate->hhashtable->hashmixkinds)
+			pfree(aggstate->hhashtable->hashmixkinds);
+		pfree(aggstate->hhashtable->keycmps);
+		if (aggstate->hhashtable->input_keys)
+			pfree(aggstate->hhashtable->input_keys);
 
 		closeSpillFiles(aggstate, aggstate->hhashtable->spill_set);
 
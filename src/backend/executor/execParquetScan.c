@@ -91,6 +91,9 @@ BeginScanParquetRelation(ScanState *scanState)
 			node->opaque->proj);
 
 	node->opaque->scandesc->splits = scanState->splits;
+	node->opaque->scandesc->rowGroupFilter =
+		ParquetRowGroupFilter_Create(scanState->ps.plan->qual,
+									 RelationGetDescr(node->ss.ss_currentRelation));
 	node->ss.scan_state = SCAN_SCAN;
 }
 
@@ -105,6 +108,17 @@ EndScanParquetRelation(ScanState *scanState)
 	Assert(node->opaque != NULL &&
 		   node->opaque->scandesc != NULL);
 
+	/* CDB: Report read-ahead statistics for EXPLAIN ANALYZE. */
+	if (node->ss.ps.instrument &&
+		node->opaque->scandesc->prefetcher != NULL)
+	{
+		if (node->ss.ps.cdbexplainbuf == NULL)
+			node->ss.ps.cdbexplainbuf = makeStringInfo();
+
+		ParquetPrefetch_Explain(node->opaque->scandesc->prefetcher,
+								node->ss.ps.cdbexplainbuf);
+	}
+
 	parquet_endscan(node->opaque->scandesc);
 
 	FreeParquetScanOpaque(scanState);
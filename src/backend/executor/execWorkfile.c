@@ -569,6 +569,28 @@ ExecWorkFile_Flush(ExecWorkFile *workfile)
 	}
 }
 
+/*
+ * ExecWorkFile_Prefetch
+ *    hint that the given range of a work file is going to be read soon.
+ *
+ * bfz files read ahead on their own, see bfz_aio.c.
+ */
+void
+ExecWorkFile_Prefetch(ExecWorkFile *workfile, uint64 offset, Size amount)
+{
+	Assert(workfile != NULL);
+	switch(workfile->fileType)
+	{
+	case BUFFILE:
+		BufFilePrefetch((BufFile *) workfile->file, offset, amount);
+		break;
+	case BFZ:
+		break;
+	default:
+		insist_log(false, "invalid work file type: %d", workfile->fileType);
+	}
+}
+
 /*
  * Suspend a file without closing it. For bfz, which allocates a buffer for
  * each open a file, this frees up that buffer but keeps the fd so we can
@@ -202,6 +202,12 @@
 
 #define ALLOW_mdver_request_version
 #define ALLOW_mdver_enabled
+#define ALLOW_mdver_mdobj_cache_enabled
+#define ALLOW_mdver_mdobj_cache_find
+#define ALLOW_mdver_mdobj_cache_add
+#define ALLOW_OptPlanCacheKey
+#define ALLOW_OptPlanCacheLookup
+#define ALLOW_OptPlanCacheInsert
 
 
 #include "gpopt/utils/gpdbdefs.h"
@@ -3092,4 +3098,89 @@ gpdb::MdVerRequestVersion
 	GP_WRAP_END;
 }
 
+bool
+gpdb::FMdVerMDObjCacheEnabled(void)
+{
+	GP_WRAP_START;
+	{
+		return mdver_mdobj_cache_enabled();
+	}
+	GP_WRAP_END;
+	return false;
+}
+
+void *
+gpdb::PvMdVerMDObjCacheFind
+	(
+	const char *szKey,
+	Size *pulLen
+	)
+{
+	GP_WRAP_START;
+	{
+		return mdver_mdobj_cache_find(szKey, pulLen);
+	}
+	GP_WRAP_END;
+	return NULL;
+}
+
+void
+gpdb::MdVerMDObjCacheAdd
+	(
+	const char *szKey,
+	const void *pvData,
+	Size ulLen
+	)
+{
+	GP_WRAP_START;
+	{
+		mdver_mdobj_cache_add(szKey, pvData, ulLen);
+		return;
+	}
+	GP_WRAP_END;
+}
+
+char *
+gpdb::SzOptPlanCacheKey
+	(
+	Query *pquery
+	)
+{
+	GP_WRAP_START;
+	{
+		return OptPlanCacheKey(pquery);
+	}
+	GP_WRAP_END;
+	return NULL;
+}
+
+PlannedStmt *
+gpdb::PplstmtOptPlanCacheLookup
+	(
+	const char *szKey
+	)
+{
+	GP_WRAP_START;
+	{
+		return OptPlanCacheLookup(szKey);
+	}
+	GP_WRAP_END;
+	return NULL;
+}
+
+void
+gpdb::OptPlanCacheInsert
+	(
+	const char *szKey,
+	PlannedStmt *pplstmt
+	)
+{
+	GP_WRAP_START;
+	{
+		::OptPlanCacheInsert(szKey, pplstmt);
+		return;
+	}
+	GP_WRAP_END;
+}
+
 // EOF
@@ -18,9 +18,17 @@
 //---------------------------------------------------------------------------
 
 #include "postgres.h"
+#include "utils/mdver.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/mdcache/CMDAccessor.h"
+#include "gpopt/gpdbwrappers.h"
+
+#include "md/CMDIdGPDB.h"
+#include "md/CMDIdRelStats.h"
+#include "md/CMDIdColStats.h"
+#include "md/CMDIdCast.h"
+#include "md/CMDIdScCmp.h"
 
 #include "gpos/io/COstreamString.h"
 
@@ -50,6 +58,92 @@ CMDProviderRelcache::CMDProviderRelcache
 	GPOS_ASSERT(NULL != m_pmp);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::FVersioned
+//
+//	@doc:
+//		Checks if all GPDB objects a metadata id refers to carry a version
+//		from MD Versioning, which makes the id a valid key for the shared
+//		metadata object cache. Built-in types and objects looked up without
+//		a version get the fixed version 1.0, which does not change with the
+//		catalog.
+//
+//---------------------------------------------------------------------------
+BOOL
+CMDProviderRelcache::FVersioned
+	(
+	IMDId *pmdid
+	)
+{
+	switch(pmdid->Emdidt())
+	{
+		case IMDId::EmdidGPDB:
+		{
+			CMDIdGPDB *pmdidGPDB = CMDIdGPDB::PmdidConvert(pmdid);
+			return INVALID_MD_VERSION != pmdidGPDB->UlVersionMinor();
+		}
+
+		case IMDId::EmdidRelStats:
+			return FVersioned(CMDIdRelStats::PmdidConvert(pmdid)->PmdidRel());
+
+		case IMDId::EmdidColStats:
+			return FVersioned(CMDIdColStats::PmdidConvert(pmdid)->PmdidRel());
+
+		case IMDId::EmdidCastFunc:
+		{
+			CMDIdCast *pmdidCast = CMDIdCast::PmdidConvert(pmdid);
+			return FVersioned(pmdidCast->PmdidSrc()) && FVersioned(pmdidCast->PmdidDest());
+		}
+
+		case IMDId::EmdidScCmp:
+		{
+			CMDIdScCmp *pmdidScCmp = CMDIdScCmp::PmdidConvert(pmdid);
+			return FVersioned(pmdidScCmp->PmdidLeft()) && FVersioned(pmdidScCmp->PmdidRight());
+		}
+
+		default:
+			return false;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::FCacheKey
+//
+//	@doc:
+//		Builds the key of a metadata id in the shared metadata object cache.
+//		Returns false if the id cannot be cached.
+//
+//---------------------------------------------------------------------------
+BOOL
+CMDProviderRelcache::FCacheKey
+	(
+	IMDId *pmdid,
+	CHAR *szKey
+	)
+{
+	if (!gpdb::FMdVerMDObjCacheEnabled() || !FVersioned(pmdid))
+	{
+		return false;
+	}
+
+	// md ids are plain ASCII
+	const WCHAR *wszMDId = pmdid->Wsz();
+	ULONG ul = 0;
+	for (; WCHAR('\0') != wszMDId[ul]; ul++)
+	{
+		if (ul + 1 >= MDVER_MDOBJ_KEY_LEN || 0x7f < wszMDId[ul])
+		{
+			return false;
+		}
+		szKey[ul] = (CHAR) wszMDId[ul];
+	}
+	szKey[ul] = '\0';
+
+	return true;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMDProviderRelcache::PstrObject
@@ -67,6 +161,24 @@ CMDProviderRelcache::PstrObject
 	)
 	const
 {
+	// another session may have translated the object already
+	CHAR szKey[MDVER_MDOBJ_KEY_LEN];
+	BOOL fCache = FCacheKey(pmdid, szKey);
+	if (fCache)
+	{
+		Size ulSize = 0;
+		WCHAR *wszCached = (WCHAR *) gpdb::PvMdVerMDObjCacheFind(szKey, &ulSize);
+		if (NULL != wszCached)
+		{
+			GPOS_ASSERT(ulSize >= GPOS_SIZEOF(WCHAR) && WCHAR('\0') == wszCached[ulSize / GPOS_SIZEOF(WCHAR) - 1]);
+
+			CWStringDynamic *pstr = New(m_pmp) CWStringDynamic(m_pmp, wszCached);
+			gpdb::GPDBFree(wszCached);
+
+			return pstr;
+		}
+	}
+
 	IMDCacheObject *pimdobj = CTranslatorRelcacheToDXL::Pimdobj(pmp, pmda, pmdid);
 
 	GPOS_ASSERT(NULL != pimdobj);
@@ -76,6 +188,11 @@ CMDProviderRelcache::PstrObject
 	// cleanup DXL object
 	pimdobj->Release();
 
+	if (fCache)
+	{
+		gpdb::MdVerMDObjCacheAdd(szKey, pstr->Wsz(), (pstr->UlLength() + 1) * GPOS_SIZEOF(WCHAR));
+	}
+
 	return pstr;
 }
 
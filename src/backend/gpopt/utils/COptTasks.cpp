@@ -736,6 +736,103 @@ COptTasks::PdrgPssLoad
 	return pdrgpss;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::PdrgPssBudget
+//
+//	@doc:
+//		Search strategy for optimizer_search_time_budget: a first stage
+//		keeps the join order of the query, a second one explores all join
+//		orders. The thresholds of the stages are fixed before the search
+//		starts, so the budget is split between them: the first stage may
+//		use half of it, the second one what is left. A stage that runs out
+//		of its threshold stops exploring, and the best plan found by any
+//		stage is used
+//
+//---------------------------------------------------------------------------
+DrgPss *
+COptTasks::PdrgPssBudget
+	(
+	IMemoryPool *pmp,
+	ULONG ulTimeBudget
+	)
+{
+	// transformations reordering joins
+	const CHAR *rgszJoinOrder[] =
+	{
+		"CXformJoinCommutativity",
+		"CXformJoinAssociativity",
+	};
+
+	CXformSet *pxfsAll = New(pmp) CXformSet(pmp);
+	pxfsAll->Union(CXformFactory::Pxff()->PxfsExploration());
+	pxfsAll->Union(CXformFactory::Pxff()->PxfsImplementation());
+
+	CXformSet *pxfsFixedJoinOrder = New(pmp) CXformSet(pmp);
+	pxfsFixedJoinOrder->Union(pxfsAll);
+	for (ULONG ul = 0; ul < GPOS_ARRAY_SIZE(rgszJoinOrder); ul++)
+	{
+		CXform *pxform = CXformFactory::Pxff()->Pxf(rgszJoinOrder[ul]);
+		if (NULL != pxform)
+		{
+			(void) pxfsFixedJoinOrder->FExchangeClear(pxform->Exfid());
+		}
+	}
+
+	ULONG ulFixedJoinOrderBudget = ulTimeBudget / 2;
+
+	DrgPss *pdrgpss = New(pmp) DrgPss(pmp);
+	pdrgpss->Append(New(pmp) CSearchStage(pxfsFixedJoinOrder, ulFixedJoinOrderBudget, CCost(0.0)));
+	pdrgpss->Append(New(pmp) CSearchStage(pxfsAll, ulTimeBudget - ulFixedJoinOrderBudget, CCost(0.0)));
+
+	return pdrgpss;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::UlSearchStagesCompleted
+//
+//	@doc:
+//		Number of search stages that found a plan within their time
+//		threshold. The timer of a stage runs from its start until now,
+//		and the stages ran one after the other, so the time of a stage is
+//		the difference of its timer and the timer of the next stage
+//
+//---------------------------------------------------------------------------
+ULONG
+COptTasks::UlSearchStagesCompleted
+	(
+	DrgPss *pdrgpss
+	)
+{
+	ULONG ulStages = pdrgpss->UlLength();
+	ULONG ulStagesCompleted = 0;
+
+	for (ULONG ul = 0; ul < ulStages; ul++)
+	{
+		CSearchStage *pss = (*pdrgpss)[ul];
+		if (NULL == pss->PexprBest())
+		{
+			// the stage did not run, or found no plan
+			continue;
+		}
+
+		ULONG ulElapsed = pss->UlElapsedTime();
+		if (ul + 1 < ulStages)
+		{
+			ULONG ulElapsedNext = (*pdrgpss)[ul + 1]->UlElapsedTime();
+			ulElapsed = (ulElapsed > ulElapsedNext) ? ulElapsed - ulElapsedNext : 0;
+		}
+
+		if (ulElapsed <= pss->UlTimeThreshold())
+		{
+			ulStagesCompleted++;
+		}
+	}
+
+	return ulStagesCompleted;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::PoconfCreate
@@ -948,6 +1045,11 @@ COptTasks::PvOptimizeTask
 
 	// load search strategy
 	DrgPss *pdrgpss = PdrgPssLoad(pmp, optimizer_search_strategy_path);
+	BOOL fSearchBudget = (NULL == pdrgpss && 0 < optimizer_search_time_budget);
+	if (fSearchBudget)
+	{
+		pdrgpss = PdrgPssBudget(pmp, (ULONG) optimizer_search_time_budget);
+	}
 
 	CBitSet *pbsTraceFlags = NULL;
 	CBitSet *pbsEnabled = NULL;
@@ -1021,6 +1123,9 @@ COptTasks::PvOptimizeTask
 						(!optimizer_enable_motions_masteronly_queries && !ptrquerytodxl->FHasDistributedTables());
 			CAutoTraceFlag atf(EopttraceDisableMotions, fMasterOnly);
 
+			// keep the search stages to find out how far the search got
+			CRefCount::SafeAddRef(pdrgpss);
+
 			pdxlnPlan = COptimizer::PdxlnOptimize
 									(
 									pmp,
@@ -1036,6 +1141,21 @@ COptTasks::PvOptimizeTask
 									pocconf
 									);
 
+			ULONG ulStages = 0;
+			ULONG ulStagesCompleted = 0;
+			if (fSearchBudget)
+			{
+				ulStages = pdrgpss->UlLength();
+				ulStagesCompleted = UlSearchStagesCompleted(pdrgpss);
+
+				if (ulStagesCompleted < ulStages)
+				{
+					elog(DEBUG1, "[OPT]: optimizer_search_time_budget of %d ms exceeded, %d of %d search stages completed",
+						 optimizer_search_time_budget, (int) ulStagesCompleted, (int) ulStages);
+				}
+			}
+			CRefCount::SafeRelease(pdrgpss);
+
 			if (poctx->m_fSerializePlanDXL)
 			{
 				// serialize DXL to xml
@@ -1048,6 +1168,8 @@ COptTasks::PvOptimizeTask
 			if (poctx->m_fGeneratePlStmt)
 			{
 				poctx->m_pplstmt = (PlannedStmt *) gpdb::PvCopyObject(Pplstmt(pmp, &mda, pdxlnPlan));
+				poctx->m_pplstmt->optimizerSearchStages = ulStages;
+				poctx->m_pplstmt->optimizerSearchStagesCompleted = ulStagesCompleted;
 			}
 
 			CStatisticsConfig *pstatsconf = pocconf->Pstatsconf();
@@ -1731,6 +1853,19 @@ COptTasks::PplstmtOptimize
 {
 	Assert(pquery);
 
+	// reuse the plan of an earlier optimization of the same query
+	char *szPlanCacheKey = gpdb::SzOptPlanCacheKey(pquery);
+	if (NULL != szPlanCacheKey)
+	{
+		PlannedStmt *pplstmt = gpdb::PplstmtOptPlanCacheLookup(szPlanCacheKey);
+		if (NULL != pplstmt)
+		{
+			gpdb::GPDBFree(szPlanCacheKey);
+			*pfUnexpectedFailure = false;
+			return pplstmt;
+		}
+	}
+
 	SOptContext octx;
 	octx.m_pquery = pquery;
 	octx.m_fGeneratePlStmt= true;
@@ -1745,6 +1880,15 @@ COptTasks::PplstmtOptimize
 	// clean up context
 	octx.Free(octx.epinQuery, octx.epinPlStmt);
 
+	if (NULL != szPlanCacheKey)
+	{
+		if (NULL != octx.m_pplstmt)
+		{
+			gpdb::OptPlanCacheInsert(szPlanCacheKey, octx.m_pplstmt);
+		}
+		gpdb::GPDBFree(szPlanCacheKey);
+	}
+
 	return octx.m_pplstmt;
 }
 
@@ -199,6 +199,8 @@ _copyPlannedStmt(PlannedStmt *from)
 
 	COPY_SCALAR_FIELD(resource); // ?? What does this mean?
 	COPY_SCALAR_FIELD(planner_segments);
+	COPY_SCALAR_FIELD(optimizerSearchStages);
+	COPY_SCALAR_FIELD(optimizerSearchStagesCompleted);
 
 	return newnode;
 }
@@ -4674,6 +4674,7 @@ Plan *add_agg_cost(PlannerInfo *root, Plan *plan,
 		if (!calcHashAggTableSizes(global_work_mem(root),
 								   numGroups,
 								   numAggs,
+								   numGroupCols,
 								   /* The following estimate is very rough but good enough for planning. */
 								   sizeof(HeapTupleData) + sizeof(HeapTupleHeaderData) + plan->plan_width,
 								   transSpace,
@@ -2772,6 +2772,7 @@ choose_hashed_grouping(PlannerInfo *root, double tuple_fraction,
 		hash_ok = calcHashAggTableSizes(global_work_mem(root),
 								   dNumGroups,
 								   agg_counts->numAggs,
+								   numGroupCols,
 								   /* The following estimate is very rough but good enough for planning. */
 								   sizeof(HeapTupleData) + sizeof(HeapTupleHeaderData) + cheapest_path_width,
 								   agg_counts->transitionSpace,
@@ -36,6 +36,12 @@ static const struct{
 {
     {{"none", "false", "no", "off", "0", 0}, bfz_nothing_init},
     {{"zlib", 0}, bfz_zlib_init},
+#ifdef USE_BFZ_LZ4
+    {{"lz4", 0}, bfz_lz4_init},
+#endif
+#ifdef USE_BFZ_ZSTD
+    {{"zstd", 0}, bfz_zstd_init},
+#endif
     {{0}}
 };
 
@@ -135,6 +141,10 @@ write_bfz_buffer(bfz_t *bfz, bool isLast)
 	PG_TRY();
 	{
 		fs->write_ex(bfz, fs->buffer, fs->buffer_pointer - fs->buffer);
+
+		/* Wait for the writes done behind, see bfz_aio.c */
+		if (isLast)
+			bfz_aio_flush(bfz);
 	}
 	PG_CATCH();
 	{
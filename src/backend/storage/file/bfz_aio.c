@@ -0,0 +1,442 @@
+/*-------------------------------------------------------------------------
+ *
+ * bfz_aio.c
+ *	  Write-behind and read-ahead of bfz work files in a background thread.
+ *
+ * A spilling HashAgg writes and reads its batch files through bfz one
+ * buffer at a time, and used to wait for the disk on every buffer. With
+ * gp_workfile_async_io on, the I/O on the file descriptor of a bfz file is
+ * handed to one I/O thread kept by the backend for all its work files.
+ *
+ * Every file has two buffers of BFZ_AIO_BUFFER_SIZE. When writing, the
+ * backend fills one while the thread writes the other out. When reading,
+ * the thread reads the next part of the file into one buffer while the
+ * backend consumes the other. So at most one request per file is in
+ * flight, and the file position of the descriptor is only moved by the
+ * thread while a request is in flight.
+ *
+ * The thread must not palloc or elog: a failed request keeps its errno,
+ * and the error is raised by the backend when it waits for the request.
+ *
+ * This is only used by the compression algorithms doing I/O on the file
+ * descriptor themselves ("none" and the block codecs); zlib does its I/O
+ * inside the library and stays synchronous.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "cdb/cdbgang.h"		/* gp_pthread_create */
+#include "cdb/cdbvars.h"		/* gp_workfile_async_io */
+#include "storage/bfz.h"
+
+typedef struct bfz_aio_request
+{
+	struct bfz_aio_request *next;	/* in the queue of the thread */
+
+	bool		is_write;
+	int			fd;
+	char	   *buffer;
+	int			size;
+
+	/* Set by the thread. */
+	int			result;			/* bytes done, -1 on failure */
+	int			saved_errno;
+
+	bool		in_flight;		/* protected by bfz_aio_mutex */
+} bfz_aio_request;
+
+struct bfz_aio
+{
+	bfz_aio_request request;	/* the request in flight, if any */
+
+	char	   *buffers[2];
+	int			current;		/* buffer filled or consumed by the backend */
+	char	   *pointer;		/* position in the current buffer */
+	char	   *end;			/* end of the space or data in it */
+
+	bool		eof;			/* a read reached the end of the file */
+};
+
+static pthread_mutex_t bfz_aio_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bfz_aio_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t bfz_aio_done_cond = PTHREAD_COND_INITIALIZER;
+
+/* Requests to do, protected by bfz_aio_mutex. */
+static bfz_aio_request *bfz_aio_queue_head = NULL;
+static bfz_aio_request *bfz_aio_queue_tail = NULL;
+
+static pthread_t bfz_aio_thread;
+static bool bfz_aio_thread_started = false;
+static bool bfz_aio_thread_failed = false;
+
+static void *
+bfz_aio_thread_main(void *arg)
+{
+	gp_set_thread_sigmasks();
+
+	pthread_mutex_lock(&bfz_aio_mutex);
+	for (;;)
+	{
+		bfz_aio_request *req;
+		int			done = 0;
+		int			saved_errno = 0;
+
+		while (bfz_aio_queue_head == NULL)
+			pthread_cond_wait(&bfz_aio_work_cond, &bfz_aio_mutex);
+
+		req = bfz_aio_queue_head;
+		bfz_aio_queue_head = req->next;
+		if (bfz_aio_queue_head == NULL)
+			bfz_aio_queue_tail = NULL;
+		pthread_mutex_unlock(&bfz_aio_mutex);
+
+		/* Writes are done fully, reads until full or the end of the file */
+		while (done < req->size)
+		{
+			int			i;
+
+			if (req->is_write)
+				i = writeAndRetry(req->fd, req->buffer + done, req->size - done);
+			else
+				i = readAndRetry(req->fd, req->buffer + done, req->size - done);
+
+			if (i < 0)
+			{
+				saved_errno = errno;
+				done = -1;
+				break;
+			}
+			if (i == 0 && !req->is_write)
+				break;
+			done += i;
+		}
+
+		pthread_mutex_lock(&bfz_aio_mutex);
+		req->result = done;
+		req->saved_errno = saved_errno;
+		req->in_flight = false;
+		pthread_cond_broadcast(&bfz_aio_done_cond);
+	}
+
+	return NULL;
+}
+
+/*
+ * Start the I/O thread if not yet done. Return false if it could not be
+ * started, the backend does synchronous I/O then.
+ */
+static bool
+bfz_aio_start_thread(void)
+{
+	int			ret;
+
+	if (bfz_aio_thread_started)
+		return true;
+	if (bfz_aio_thread_failed)
+		return false;
+
+	ret = gp_pthread_create(&bfz_aio_thread, bfz_aio_thread_main, NULL,
+							"bfz_aio_start_thread");
+	if (ret)
+	{
+		elog(LOG, "could not create work file I/O thread, error %d; "
+			 "using synchronous I/O", ret);
+		bfz_aio_thread_failed = true;
+		return false;
+	}
+
+	bfz_aio_thread_started = true;
+	return true;
+}
+
+static void
+bfz_aio_submit(struct bfz_aio *aio, bool is_write, int fd, int buffer, int size)
+{
+	bfz_aio_request *req = &aio->request;
+
+	Assert(!req->in_flight);
+
+	req->next = NULL;
+	req->is_write = is_write;
+	req->fd = fd;
+	req->buffer = aio->buffers[buffer];
+	req->size = size;
+	req->result = 0;
+	req->saved_errno = 0;
+
+	pthread_mutex_lock(&bfz_aio_mutex);
+	req->in_flight = true;
+	if (bfz_aio_queue_tail)
+		bfz_aio_queue_tail->next = req;
+	else
+		bfz_aio_queue_head = req;
+	bfz_aio_queue_tail = req;
+	pthread_cond_signal(&bfz_aio_work_cond);
+	pthread_mutex_unlock(&bfz_aio_mutex);
+}
+
+/*
+ * Wait for the request of the file in flight, if any. This must not
+ * elog(ERROR), the caller checks the result.
+ */
+static void
+bfz_aio_wait(struct bfz_aio *aio)
+{
+	pthread_mutex_lock(&bfz_aio_mutex);
+	while (aio->request.in_flight)
+		pthread_cond_wait(&bfz_aio_done_cond, &bfz_aio_mutex);
+	pthread_mutex_unlock(&bfz_aio_mutex);
+}
+
+/*
+ * Wait for the request in flight and raise its error if it failed.
+ */
+static int
+bfz_aio_complete(struct bfz_aio *aio)
+{
+	bfz_aio_request *req = &aio->request;
+	int			result;
+
+	bfz_aio_wait(aio);
+
+	result = req->result;
+	if (result < 0)
+	{
+		req->result = 0;
+		errno = req->saved_errno;
+		if (req->is_write)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not write to temporary file: %m")));
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not read from temporary file: %m")));
+	}
+	return result;
+}
+
+/*
+ * Set up the asynchronous I/O of a file. Return NULL if the file does
+ * synchronous I/O.
+ */
+static struct bfz_aio *
+bfz_aio_create(bfz_t * thiz)
+{
+	struct bfz_aio *aio;
+
+	if (!gp_workfile_async_io || !bfz_aio_start_thread())
+		return NULL;
+
+	/* Freed by bfz_aio_free, which is called at transaction abort too */
+	aio = malloc(sizeof(*aio) + 2 * BFZ_AIO_BUFFER_SIZE);
+	if (!aio)
+		ereport(ERROR,
+			(errcode(ERRCODE_OUT_OF_MEMORY),
+			 errmsg("out of memory")));
+
+	memset(aio, 0, sizeof(*aio));
+	aio->buffers[0] = (char *) (aio + 1);
+	aio->buffers[1] = aio->buffers[0] + BFZ_AIO_BUFFER_SIZE;
+	aio->current = 0;
+	aio->pointer = aio->buffers[0];
+	if (thiz->mode == BFZ_MODE_APPEND)
+		aio->end = aio->pointer + BFZ_AIO_BUFFER_SIZE;
+	else
+	{
+		/* Start reading ahead, the current buffer is empty */
+		aio->end = aio->pointer;
+		bfz_aio_submit(aio, false, thiz->fd, 1, BFZ_AIO_BUFFER_SIZE);
+	}
+
+	thiz->aio = aio;
+	return aio;
+}
+
+static void
+bfz_aio_write_fully(int fd, const char *buffer, int size)
+{
+	while (size)
+	{
+		int			i = writeAndRetry(fd, buffer, size);
+
+		if (i < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not write to temporary file: %m")));
+		buffer += i;
+		size -= i;
+	}
+}
+
+static int
+bfz_aio_read_fully(int fd, char *buffer, int size)
+{
+	int			orig_size = size;
+
+	while (size)
+	{
+		int			i = readAndRetry(fd, buffer, size);
+
+		if (i < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not read from temporary file: %m")));
+		if (i == 0)
+			break;
+		buffer += i;
+		size -= i;
+	}
+	return orig_size - size;
+}
+
+/*
+ * Hand the current buffer over to the thread and switch to the other one.
+ */
+static void
+bfz_aio_write_buffer(bfz_t * thiz, struct bfz_aio *aio)
+{
+	int			size = aio->pointer - aio->buffers[aio->current];
+
+	/* The other buffer must be written out before it is filled again */
+	bfz_aio_complete(aio);
+
+	bfz_aio_submit(aio, true, thiz->fd, aio->current, size);
+
+	aio->current = 1 - aio->current;
+	aio->pointer = aio->buffers[aio->current];
+	aio->end = aio->pointer + BFZ_AIO_BUFFER_SIZE;
+}
+
+/*
+ * Write all of the buffer to the file.
+ */
+void
+bfz_aio_write(bfz_t * thiz, const char *buffer, int size)
+{
+	struct bfz_aio *aio = thiz->aio;
+
+	Assert(thiz->mode == BFZ_MODE_APPEND);
+
+	if (!aio && !(aio = bfz_aio_create(thiz)))
+	{
+		bfz_aio_write_fully(thiz->fd, buffer, size);
+		return;
+	}
+
+	while (size)
+	{
+		int			n = Min(size, aio->end - aio->pointer);
+
+		memcpy(aio->pointer, buffer, n);
+		aio->pointer += n;
+		buffer += n;
+		size -= n;
+
+		if (aio->pointer == aio->end)
+			bfz_aio_write_buffer(thiz, aio);
+	}
+}
+
+/*
+ * Write out everything written to the file so far, and wait for it.
+ */
+void
+bfz_aio_flush(bfz_t * thiz)
+{
+	struct bfz_aio *aio = thiz->aio;
+
+	if (!aio)
+		return;
+
+	Assert(thiz->mode == BFZ_MODE_APPEND);
+
+	if (aio->pointer > aio->buffers[aio->current])
+		bfz_aio_write_buffer(thiz, aio);
+	bfz_aio_complete(aio);
+}
+
+/*
+ * Read size bytes from the file, less only at the end of the file.
+ */
+int
+bfz_aio_read(bfz_t * thiz, char *buffer, int size)
+{
+	struct bfz_aio *aio = thiz->aio;
+	int			orig_size = size;
+
+	Assert(thiz->mode == BFZ_MODE_SCAN);
+
+	if (!aio && !(aio = bfz_aio_create(thiz)))
+		return bfz_aio_read_fully(thiz->fd, buffer, size);
+
+	while (size)
+	{
+		int			n;
+
+		if (aio->pointer == aio->end)
+		{
+			int			next = 1 - aio->current;
+			int			nread;
+
+			if (aio->eof)
+				break;
+
+			/* Switch to the buffer read ahead */
+			nread = bfz_aio_complete(aio);
+			aio->current = next;
+			aio->pointer = aio->buffers[next];
+			aio->end = aio->pointer + nread;
+
+			/* Read ahead into the one consumed, unless at the end */
+			if (nread == BFZ_AIO_BUFFER_SIZE)
+				bfz_aio_submit(aio, false, thiz->fd, 1 - next, BFZ_AIO_BUFFER_SIZE);
+			else
+				aio->eof = true;
+			continue;
+		}
+
+		n = Min(size, aio->end - aio->pointer);
+		memcpy(buffer, aio->pointer, n);
+		aio->pointer += n;
+		buffer += n;
+		size -= n;
+	}
+	return orig_size - size;
+}
+
+/*
+ * bfz_aio_free
+ *  Wait for the request in flight and free the buffers of the file.
+ *  Data not flushed by bfz_aio_flush is lost.
+ *
+ *  This is called by close_ex, hence it should not contain any
+ *  elog(ERROR) calls.
+ */
+void
+bfz_aio_free(bfz_t * thiz)
+{
+	if (!thiz->aio)
+		return;
+
+	bfz_aio_wait(thiz->aio);
+	free(thiz->aio);
+	thiz->aio = NULL;
+}
+
+/*
+ * Memory used by the asynchronous I/O of one open bfz file, to be counted
+ * by the operators in their memory quota.
+ */
+Size
+bfz_aio_buffer_overhead(void)
+{
+	if (!gp_workfile_async_io)
+		return 0;
+	return sizeof(struct bfz_aio) + 2 * BFZ_AIO_BUFFER_SIZE;
+}
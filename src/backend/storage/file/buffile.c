@@ -679,6 +679,18 @@ BufFileSeek(BufFile *file, int64 offset, int whence)
 	return 0;
 }
 
+/*
+ * BufFilePrefetch
+ *
+ * Hint that the given range of the file is going to be read soon, so the
+ * kernel can read it in the background. The position is not moved.
+ */
+void
+BufFilePrefetch(BufFile *file, int64 offset, Size amount)
+{
+	FilePrefetch(file->file, offset, (int) amount);
+}
+
 void BufFileTell(BufFile *file, int64 *offset)
 {
 	*offset = file->offset + file->pos;
@@ -0,0 +1,194 @@
+/* compress_block.c */
+
+#include "postgres.h"
+
+#include "c.h"
+#include <unistd.h>
+#include <storage/bfz.h>
+#include <storage/fd.h>
+
+/*
+ * This file implements the file format shared by the bfz compression
+ * algorithms built on a block codec, such as "lz4" and "zstd".
+ *
+ * bfz writes its buffer of BFZ_BUFFER_SIZE bytes at a time, so every buffer
+ * is compressed on its own and stored as a block: a header holding the
+ * compressed and the original length, followed by the compressed data. A
+ * buffer which does not compress is stored as it is, with a compressed
+ * length of zero. Unlike a stream compressor, a codec keeps no history
+ * between the blocks, which is what makes it fast enough for spill files.
+ */
+
+typedef struct bfz_block_header
+{
+	uint32		compressed_len;		/* 0 if the data is not compressed */
+	uint32		raw_len;
+} bfz_block_header;
+
+struct bfz_block_freeable_stuff
+{
+	struct bfz_freeable_stuff super;
+	const bfz_block_codec *codec;
+	void	   *state;
+
+	/* a block as stored in the file */
+	char	   *block;
+	int			block_size;
+
+	/* decompressed data of the last block read, not returned yet */
+	char	   *raw_pointer;
+	char	   *raw_end;
+	char		raw[BFZ_BUFFER_SIZE];
+};
+
+/*
+ * bfz_block_close_ex
+ *  Close a file and freeing up descriptor, buffers etc.
+ *
+ *  This is also called from an xact end callback, hence it should
+ *  not contain any elog(ERROR) calls.
+ */
+static void
+bfz_block_close_ex(bfz_t * thiz)
+{
+	struct bfz_block_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	bfz_aio_free(thiz);
+	gp_retry_close(thiz->fd);
+	thiz->fd = -1;
+	if (fs->state)
+		fs->codec->free_state(fs->state);
+	if (fs->block)
+		free(fs->block);
+	free(fs);
+	thiz->freeable_stuff = NULL;
+}
+
+/*
+ * Read the next block into the raw buffer. Return false at end of file.
+ */
+static bool
+read_next_block(bfz_t * thiz)
+{
+	struct bfz_block_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	bfz_block_header header;
+	char	   *data = fs->block + sizeof(header);
+	int			i;
+
+	i = bfz_aio_read(thiz, (char *) &header, sizeof(header));
+	if (i == 0)
+		return false;
+
+	if (i != sizeof(header) ||
+		header.raw_len > BFZ_BUFFER_SIZE ||
+		header.compressed_len > fs->block_size - sizeof(header))
+		ereport(ERROR,
+				(errcode(ERRCODE_IO_ERROR),
+				errmsg("corrupt block in temporary file %s", thiz->filename)));
+
+	if (header.compressed_len == 0)
+	{
+		if (bfz_aio_read(thiz, fs->raw, header.raw_len) != header.raw_len)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("unexpected end of temporary file %s", thiz->filename)));
+	}
+	else
+	{
+		if (bfz_aio_read(thiz, data, header.compressed_len) != header.compressed_len)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("unexpected end of temporary file %s", thiz->filename)));
+
+		i = fs->codec->decompress(fs->state, data, header.compressed_len,
+								  fs->raw, sizeof(fs->raw));
+		if (i != header.raw_len)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not decompress block in temporary file %s",
+						   thiz->filename)));
+	}
+
+	fs->raw_pointer = fs->raw;
+	fs->raw_end = fs->raw + header.raw_len;
+	return true;
+}
+
+static int
+bfz_block_read_ex(bfz_t * thiz, char *buffer, int size)
+{
+	struct bfz_block_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	int			orig_size = size;
+
+	while (size)
+	{
+		int			n;
+
+		if (fs->raw_pointer == fs->raw_end && !read_next_block(thiz))
+			break;
+
+		n = Min(size, fs->raw_end - fs->raw_pointer);
+		memcpy(buffer, fs->raw_pointer, n);
+		fs->raw_pointer += n;
+		buffer += n;
+		size -= n;
+	}
+	return orig_size - size;
+}
+
+static void
+bfz_block_write_ex(bfz_t * thiz, const char *buffer, int size)
+{
+	struct bfz_block_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	bfz_block_header header;
+	char	   *data = fs->block + sizeof(header);
+	int			i;
+
+	Assert(size <= BFZ_BUFFER_SIZE);
+
+	i = fs->codec->compress(fs->state, buffer, size,
+							data, fs->block_size - sizeof(header));
+	if (i <= 0 || i >= size)
+	{
+		header.compressed_len = 0;
+		memcpy(data, buffer, size);
+		i = size;
+	}
+	else
+		header.compressed_len = i;
+	header.raw_len = size;
+
+	memcpy(fs->block, &header, sizeof(header));
+	bfz_aio_write(thiz, fs->block, sizeof(header) + i);
+}
+
+void
+bfz_block_init(bfz_t * thiz, const bfz_block_codec *codec)
+{
+	struct bfz_block_freeable_stuff *fs = malloc(sizeof *fs);
+
+	if (!fs)
+		ereport(ERROR,
+			(errcode(ERRCODE_OUT_OF_MEMORY),
+			 errmsg("out of memory")));
+
+	thiz->freeable_stuff = &fs->super;
+	fs->super.read_ex = bfz_block_read_ex;
+	fs->super.write_ex = bfz_block_write_ex;
+	fs->super.close_ex = bfz_block_close_ex;
+	fs->codec = codec;
+	fs->raw_pointer = fs->raw_end = fs->raw;
+
+	/* a block that does not compress is stored in the same buffer */
+	fs->block_size = sizeof(bfz_block_header) +
+		Max(codec->compress_bound, BFZ_BUFFER_SIZE);
+	fs->block = malloc(fs->block_size);
+	fs->state = NULL;
+	if (codec->create_state)
+		fs->state = codec->create_state(thiz->mode == BFZ_MODE_APPEND);
+
+	if (!fs->block || (codec->create_state && !fs->state))
+		ereport(ERROR,
+			(errcode(ERRCODE_OUT_OF_MEMORY),
+			 errmsg("out of memory")));
+}
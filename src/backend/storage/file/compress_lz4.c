@@ -0,0 +1,45 @@
+/* compress_lz4.c */
+
+#include "postgres.h"
+
+#include "c.h"
+#include <storage/bfz.h>
+
+#ifdef USE_BFZ_LZ4
+
+#include <lz4.h>
+
+/*
+ * This file implements bfz compression algorithm "lz4", on top of the
+ * block format of compress_block.c.
+ */
+
+static int
+bfz_lz4_compress(void *state, const char *src, int srclen, char *dst, int dstcap)
+{
+	return LZ4_compress_default(src, dst, srclen, dstcap);
+}
+
+static int
+bfz_lz4_decompress(void *state, const char *src, int srclen, char *dst, int dstcap)
+{
+	int			i = LZ4_decompress_safe(src, dst, srclen, dstcap);
+
+	return i < 0 ? -1 : i;
+}
+
+static const bfz_block_codec bfz_lz4_codec = {
+	NULL,
+	NULL,
+	bfz_lz4_compress,
+	bfz_lz4_decompress,
+	LZ4_COMPRESSBOUND(BFZ_BUFFER_SIZE)
+};
+
+void
+bfz_lz4_init(bfz_t * thiz)
+{
+	bfz_block_init(thiz, &bfz_lz4_codec);
+}
+
+#endif   /* USE_BFZ_LZ4 */
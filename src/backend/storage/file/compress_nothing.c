@@ -22,6 +22,7 @@
 static void
 bfz_nothing_close_ex(bfz_t * thiz)
 {
+	bfz_aio_free(thiz);
 	gp_retry_close(thiz->fd);
 	thiz->fd = -1;
 	free(thiz->freeable_stuff);
@@ -31,38 +32,13 @@ bfz_nothing_close_ex(bfz_t * thiz)
 static int
 bfz_nothing_read_ex(bfz_t * thiz, char *buffer, int size)
 {
-	int			orig_size = size;
-
-	while (size)
-	{
-		int			i = readAndRetry(thiz->fd, buffer, size);
-
-		if (i < 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_IO_ERROR),
-					errmsg("could not read from temporary file: %m")));
-		if (i == 0)
-			break;
-		buffer += i;
-		size -= i;
-	}
-	return orig_size - size;
+	return bfz_aio_read(thiz, buffer, size);
 }
 
 static void
 bfz_nothing_write_ex(bfz_t * bfz, const char *buffer, int size)
 {
-	while (size)
-	{
-		int			i = writeAndRetry(bfz->fd, buffer, size);
-
-		if (i < 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_IO_ERROR),
-					errmsg("could not write to temporary file: %m")));
-		buffer += i;
-		size -= i;
-	}
+	bfz_aio_write(bfz, buffer, size);
 }
 
 void
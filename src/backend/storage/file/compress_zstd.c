@@ -0,0 +1,102 @@
+/* compress_zstd.c */
+
+#include "postgres.h"
+
+#include "c.h"
+#include <storage/bfz.h>
+
+#ifdef USE_BFZ_ZSTD
+
+#include <zstd.h>
+
+/*
+ * This file implements bfz compression algorithm "zstd", on top of the
+ * block format of compress_block.c. Spill files are written once and read
+ * once, so only the lowest level is used; it still compresses better than
+ * zlib at level 1 and runs several times faster.
+ */
+#define BFZ_ZSTD_LEVEL	1
+
+/* A compression context when writing, a decompression one when reading */
+typedef struct bfz_zstd_state
+{
+	bool		compress;
+	ZSTD_CCtx  *cctx;
+	ZSTD_DCtx  *dctx;
+} bfz_zstd_state;
+
+static void
+bfz_zstd_free_state(void *state)
+{
+	bfz_zstd_state *zs = state;
+
+	if (zs->cctx)
+		ZSTD_freeCCtx(zs->cctx);
+	if (zs->dctx)
+		ZSTD_freeDCtx(zs->dctx);
+	free(zs);
+}
+
+static void *
+bfz_zstd_create_state(bool compress)
+{
+	bfz_zstd_state *zs = malloc(sizeof *zs);
+
+	if (!zs)
+		return NULL;
+
+	zs->compress = compress;
+	zs->cctx = NULL;
+	zs->dctx = NULL;
+	if (compress)
+		zs->cctx = ZSTD_createCCtx();
+	else
+		zs->dctx = ZSTD_createDCtx();
+
+	if (!zs->cctx && !zs->dctx)
+	{
+		free(zs);
+		return NULL;
+	}
+	return zs;
+}
+
+static int
+bfz_zstd_compress(void *state, const char *src, int srclen, char *dst, int dstcap)
+{
+	bfz_zstd_state *zs = state;
+	size_t		i;
+
+	Assert(zs->compress);
+	i = ZSTD_compressCCtx(zs->cctx, dst, dstcap, src, srclen, BFZ_ZSTD_LEVEL);
+
+	return ZSTD_isError(i) ? 0 : (int) i;
+}
+
+static int
+bfz_zstd_decompress(void *state, const char *src, int srclen, char *dst, int dstcap)
+{
+	bfz_zstd_state *zs = state;
+	size_t		i;
+
+	Assert(!zs->compress);
+	i = ZSTD_decompressDCtx(zs->dctx, dst, dstcap, src, srclen);
+
+	return ZSTD_isError(i) ? -1 : (int) i;
+}
+
+static const bfz_block_codec bfz_zstd_codec = {
+	bfz_zstd_create_state,
+	bfz_zstd_free_state,
+	bfz_zstd_compress,
+	bfz_zstd_decompress,
+	ZSTD_COMPRESSBOUND(BFZ_BUFFER_SIZE)
+};
+
+void
+bfz_zstd_init(bfz_t * thiz)
+{
+	bfz_block_init(thiz, &bfz_zstd_codec);
+}
+
+#endif   /* USE_BFZ_ZSTD */
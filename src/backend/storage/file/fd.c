@@ -46,10 +46,13 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <sys/time.h>
 
 #include "access/xact.h"
 #include "cdb/cdbfilerep.h"
 #include "cdb/cdbfilesystemcredential.h"
+#include "cdb/cdbgang.h"
 #include "cdb/cdbvars.h"
 #include "miscadmin.h"
 #include "storage/fd.h"
@@ -1289,6 +1292,32 @@ retry:
 	return returnCode;
 }
 
+/*
+ * read at the given offset of a local file, the seek position is unchanged
+ */
+static int
+LocalFilePread(File file, char *buffer, int amount, int64 offset)
+{
+	int			returnCode;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "LocalFilePread: %d (%s) " INT64_FORMAT " %d %p",
+			   file, VfdCache[file].fileName,
+			   offset, amount, buffer));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	do
+	{
+		returnCode = pread(VfdCache[file].fd, buffer, amount, offset);
+	} while (returnCode < 0 && errno == EINTR);
+
+	return returnCode;
+}
+
 int
 LocalFileWrite(File file, const char *buffer, int amount)
 {
@@ -2731,6 +2760,63 @@ HdfsFileRead(File file, char *buffer, int amount)
 	return returnCode;
 }
 
+/*
+ * read from hdfs file at the given offset
+ *
+ * The file is left positioned after the data read, the plugin seeks only if
+ * it is not at the offset already, so sequential positional reads keep the
+ * block reader of the file.
+ */
+static int
+HdfsFilePread(File file, char *buffer, int amount, int64 offset)
+{
+	int returnCode;
+
+	Assert(FileIsValid(file));
+	DO_DB(elog(LOG, "HdfsFilePread: %d (%s) " INT64_FORMAT " %d %p",
+					file, VfdCache[file].fileName,
+					offset, amount, buffer));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	returnCode = HdfsPread(VfdCache[file].hProtocol, VfdCache[file].hFS,
+			VfdCache[file].hFile, offset, buffer, amount);
+	if (returnCode >= 0)
+		VfdCache[file].seekPos = offset + returnCode;
+	else
+		/* Trouble, so assume we don't know the file position anymore */
+		VfdCache[file].seekPos = FileUnknownPos;
+
+	return returnCode;
+}
+
+/*
+ * read several ranges of a hdfs file
+ */
+static int
+HdfsFilePreadv(File file, FileReadRange *ranges, int nranges)
+{
+	int returnCode;
+
+	Assert(FileIsValid(file));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	returnCode = HdfsPreadv(VfdCache[file].hProtocol, VfdCache[file].hFS,
+			VfdCache[file].hFile, ranges, nranges);
+	if (returnCode == 0 && nranges > 0)
+		VfdCache[file].seekPos = ranges[nranges - 1].offset +
+			ranges[nranges - 1].bytesRead;
+	else
+		VfdCache[file].seekPos = FileUnknownPos;
+
+	return returnCode;
+}
+
 /*
  * write into hdfs file
  */
@@ -3133,6 +3219,93 @@ FileRead(File file, char *buffer, int amount) {
 		return HdfsFileRead(file, buffer, amount);
 }
 
+/*
+ * read amount bytes at offset, or less at the end of the file
+ *
+ * Unlike FileSeek followed by FileRead, a local file keeps its position and
+ * a hdfs file is repositioned only if needed. The position afterwards is
+ * not specified, callers mixing FilePread and FileRead must FileSeek first.
+ */
+int
+FilePread(File file, char *buffer, int amount, int64 offset)
+{
+	int			done = 0;
+
+	Assert(offset >= INT64CONST(0));
+
+	while (done < amount)
+	{
+		int			returnCode;
+
+		if (IsLocalPath(VfdCache[file].fileName))
+			returnCode = LocalFilePread(file, buffer + done, amount - done,
+										offset + done);
+		else
+			returnCode = HdfsFilePread(file, buffer + done, amount - done,
+									   offset + done);
+		if (returnCode < 0)
+			return returnCode;
+		if (returnCode == 0)
+			break;
+		done += returnCode;
+	}
+
+	return done;
+}
+
+/*
+ * read several ranges of a file in one call, setting bytesRead of each range
+ *
+ * Ranges should be sorted by offset. On hdfs the ranges are passed to the
+ * filesystem at once, so it can serve them from one connection without
+ * a round trip per range. return 0 on success, -1 on failure.
+ */
+int
+FilePreadv(File file, FileReadRange *ranges, int nranges)
+{
+	if (!IsLocalPath(VfdCache[file].fileName))
+		return HdfsFilePreadv(file, ranges, nranges);
+
+	for (int i = 0; i < nranges; i++)
+	{
+		ranges[i].bytesRead = FilePread(file, ranges[i].buffer,
+										ranges[i].length, ranges[i].offset);
+		if (ranges[i].bytesRead < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * tell the kernel that amount bytes at offset will be read soon, so that
+ * it reads them in the background
+ *
+ * This is a no-op for hdfs files and where posix_fadvise is not available.
+ * return 0 on success, or an error number.
+ */
+int
+FilePrefetch(File file, int64 offset, int amount)
+{
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+	int			returnCode;
+
+	Assert(offset >= INT64CONST(0));
+
+	if (!IsLocalPath(VfdCache[file].fileName))
+		return 0;
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	return posix_fadvise(VfdCache[file].fd, offset, amount,
+						 POSIX_FADV_WILLNEED);
+#else
+	return 0;
+#endif
+}
+
 int
 FileWrite(File file, const char *buffer, int amount) {
 	if (IsLocalPath(VfdCache[file].fileName))
@@ -3228,6 +3401,145 @@ PathFileTruncate(FileName fileName) {
 	return HdfsPathFileTruncate(fileName);
 }
 
+/*
+ * return true if the file can be opened with RawFileOpenForRead.
+ *
+ * That is a local file, or a file of the "hdfs" protocol: RawFileRead
+ * passes its handles to libhdfs3 directly. Files of other protocols are
+ * only read through their filesystem UDFs, which must not be called outside
+ * of the backend thread.
+ */
+bool
+RawFileIsSupported(FileName fileName)
+{
+	char *protocol;
+	bool supported;
+
+	if (IsLocalPath(fileName))
+		return true;
+
+	if (HdfsParsePath(fileName, &protocol, NULL, NULL, NULL) || NULL == protocol)
+		return false;
+
+	supported = (strcmp(protocol, "hdfs") == 0);
+	pfree(protocol);
+
+	return supported;
+}
+
+/*
+ * open a file for positional read outside of the virtual file descriptor
+ * cache.
+ *
+ * The handle is never closed by the LRU logic, and RawFileRead does not
+ * touch VfdCache, so it can be read by a helper thread while the backend
+ * keeps using its virtual files. Open and close must be done by the backend,
+ * the file must be one RawFileIsSupported accepts.
+ *
+ * return NULL on failure
+ */
+RawFile
+RawFileOpenForRead(FileName fileName)
+{
+	RawFile file;
+
+	DO_DB(elog(LOG, "RawFileOpenForRead, path: %s", fileName));
+
+	Assert(RawFileIsSupported(fileName));
+
+	file = (RawFile) palloc0(sizeof(RawFileData));
+	file->fd = VFD_CLOSED;
+
+	while (nfile + numAllocatedDescs + 1 >= max_safe_fds)
+	{
+		if (!ReleaseLruFile())
+			break;
+	}
+
+	if (IsLocalPath(fileName))
+	{
+		file->fd = BasicOpenFile(fileName, O_RDONLY | PG_BINARY, 0);
+		if (file->fd < 0)
+		{
+			pfree(file);
+			return NULL;
+		}
+	}
+	else
+	{
+		char *protocol;
+
+		if (!HdfsBasicOpenFile(fileName, O_RDONLY, 0, &protocol,
+				&file->hFS, &file->hFile))
+		{
+			pfree(file);
+			return NULL;
+		}
+		file->hProtocol = pstrdup(protocol);
+		pfree(protocol);
+	}
+
+	return file;
+}
+
+/*
+ * read up to `amount` bytes at `offset` from a raw file.
+ *
+ * May run in a helper thread, different threads must use different
+ * handles. It calls only pread or libhdfs3, never the filesystem UDFs, and
+ * does not palloc or report errors; the error message is copied to `errbuf`
+ * if it is not NULL.
+ *
+ * return number of bytes read, or -1 on failure
+ */
+int
+RawFileRead(RawFile file, int64 offset, char *buffer, int amount,
+			char *errbuf, int errbuflen)
+{
+	int returnCode;
+
+	if (file->fd != VFD_CLOSED)
+	{
+		do
+		{
+			returnCode = pread(file->fd, buffer, amount, offset);
+		} while (returnCode < 0 && errno == EINTR);
+
+		if (returnCode < 0 && errbuf != NULL)
+			strlcpy(errbuf, strerror(errno), errbuflen);
+
+		return returnCode;
+	}
+
+	/* seek only if needed, sequential reads keep the block reader */
+	if (hdfsTell(file->hFS, file->hFile) != offset &&
+		hdfsSeek(file->hFS, file->hFile, offset) != 0)
+		returnCode = -1;
+	else
+		returnCode = hdfsRead(file->hFS, file->hFile, buffer, amount);
+
+	if (returnCode < 0 && errbuf != NULL)
+		strlcpy(errbuf, hdfsGetLastError(), errbuflen);
+
+	return returnCode;
+}
+
+/*
+ * close a raw file, the handle is freed.
+ */
+void
+RawFileClose(RawFile file)
+{
+	if (file->fd != VFD_CLOSED)
+		close(file->fd);
+	else if (HdfsCloseFile(file->hProtocol, file->hFS, file->hFile))
+		elog(WARNING, "could not close hdfs file: %s", HdfsGetLastError());
+
+	if (file->hProtocol)
+		pfree(file->hProtocol);
+	pfree(file);
+}
+
 
 /*
  * make a directory on given file system
@@ -3499,3 +3811,135 @@ HdfsGetFileBlockLocations(const char *path, int64 length, int *block_num)
 {
     return HdfsGetFileBlockLocations2(path, 0, length, block_num);
 }
+
+/*
+ * shared state of the threads of HdfsGetFileBlockLocationsBatch
+ */
+typedef struct HdfsBlockLocationBatch
+{
+	HdfsBlockLocationRequest *requests;
+	hdfsFS	   *fs;				/* connection of each request, NULL to skip */
+	char	  **relative_paths;
+	int			nrequests;
+
+	pthread_mutex_t mutex;
+	int			next;			/* next request to look up */
+} HdfsBlockLocationBatch;
+
+/*
+ * look up requests of the batch until there is none left.
+ *
+ * Runs in the backend and in helper threads, so it must not palloc or
+ * report errors.
+ */
+static void *
+HdfsBlockLocationBatchWorker(void *arg)
+{
+	HdfsBlockLocationBatch *batch = (HdfsBlockLocationBatch *) arg;
+
+	for (;;)
+	{
+		HdfsBlockLocationRequest *request;
+		struct timeval begin;
+		struct timeval end;
+		int			i;
+
+		pthread_mutex_lock(&batch->mutex);
+		i = batch->next++;
+		pthread_mutex_unlock(&batch->mutex);
+
+		if (i >= batch->nrequests)
+			break;
+		if (batch->fs[i] == NULL)
+			continue;
+
+		request = &batch->requests[i];
+		gettimeofday(&begin, NULL);
+		request->locations = hdfsGetFileBlockLocations(batch->fs[i],
+				batch->relative_paths[i], 0, request->length,
+				&request->block_num);
+		gettimeofday(&end, NULL);
+		request->elapsed = (int64) (end.tv_sec - begin.tv_sec) * 1000000 +
+			(end.tv_usec - begin.tv_usec);
+	}
+
+	return NULL;
+}
+
+/*
+ * look up the block locations of many hdfs files concurrently.
+ *
+ * Connections are made by the backend, then up to `nthreads` threads,
+ * including the backend, issue the namenode calls. The locations of each
+ * request are set as by HdfsGetFileBlockLocations, NULL if the lookup
+ * failed; free them with HdfsFreeFileBlockLocations. Failed requests are
+ * not reported, the caller may retry them with HdfsGetFileBlockLocations
+ * to get the error.
+ */
+void
+HdfsGetFileBlockLocationsBatch(HdfsBlockLocationRequest *requests,
+							   int nrequests, int nthreads)
+{
+	HdfsBlockLocationBatch batch;
+	pthread_t  *threads;
+	int			nstarted = 0;
+	int			i;
+
+	if (nrequests <= 0)
+		return;
+
+	batch.requests = requests;
+	batch.nrequests = nrequests;
+	batch.fs = (hdfsFS *) palloc0(nrequests * sizeof(hdfsFS));
+	batch.relative_paths = (char **) palloc0(nrequests * sizeof(char *));
+	batch.next = 0;
+	pthread_mutex_init(&batch.mutex, NULL);
+
+	for (i = 0; i < nrequests; i++)
+	{
+		char	   *protocol;
+
+		requests[i].locations = NULL;
+		requests[i].block_num = 0;
+		requests[i].elapsed = 0;
+
+		if (HdfsParsePath(requests[i].path, &protocol, NULL, NULL, NULL) ||
+			NULL == protocol)
+			continue;
+		pfree(protocol);
+
+		batch.relative_paths[i] = (char *) palloc(MAXPGPATH + 1);
+		if (NULL == ConvertToUnixPath(requests[i].path,
+				batch.relative_paths[i], MAXPGPATH + 1))
+			continue;
+
+		batch.fs[i] = HdfsGetConnection(requests[i].path);
+	}
+
+	nthreads = Min(nthreads, nrequests);
+	threads = (pthread_t *) palloc(Max(nthreads, 1) * sizeof(pthread_t));
+
+	/* if a thread cannot be started, the others do its share */
+	for (nstarted = 0; nstarted < nthreads - 1; nstarted++)
+	{
+		if (gp_pthread_create(&threads[nstarted], HdfsBlockLocationBatchWorker,
+				&batch, "HdfsGetFileBlockLocationsBatch") != 0)
+			break;
+	}
+
+	HdfsBlockLocationBatchWorker(&batch);
+
+	for (i = 0; i < nstarted; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_mutex_destroy(&batch.mutex);
+
+	for (i = 0; i < nrequests; i++)
+	{
+		if (batch.relative_paths[i] != NULL)
+			pfree(batch.relative_paths[i]);
+	}
+	pfree(batch.relative_paths);
+	pfree(batch.fs);
+	pfree(threads);
+}
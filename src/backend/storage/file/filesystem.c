@@ -55,6 +55,7 @@ typedef struct FsysInterfaceData
 {
 	char host[MAXPGPATH + 1];
 	FmgrInfo fsysFuncs[FSYS_FUNC_TOTALNUM];
+	FmgrInfo fsysOptFuncs[FSYS_OPTFUNC_TOTALNUM];	/* fn_addr NULL if missing */
 } FsysInterfaceData;
 
 typedef struct FsysInterfaceData *FsysInterface;
@@ -64,6 +65,51 @@ static HTAB *FsysInterfaceTable = NULL;
 static MemoryContext FsysGlobalContext = NULL;
 #define EXPECTED_MAX_FSYS_ENTRIES 10
 
+/*
+ * Look up the optional functions of a filesystem in its library, by the name
+ * of its read function with "read" replaced by the suffixes below.
+ */
+static const char *const fsys_optfunc_suffix[FSYS_OPTFUNC_TOTALNUM] =
+{
+	"pread",
+	"preadv"
+};
+
+static void
+InitFsysOptFuncs(FsysInterface fsys, char *libFile, const char *readFuncName)
+{
+	int			prefixLen = strlen(readFuncName) - strlen("read");
+
+	for(int i = 0; i < FSYS_OPTFUNC_TOTALNUM; i++)
+	{
+		FmgrInfo   *finfo = &(fsys->fsysOptFuncs[i]);
+		void	   *libraryhandle;
+		char		funcName[NAMEDATALEN * 2];
+
+		MemSet(finfo, 0, sizeof(FmgrInfo));
+
+		if (prefixLen < 0 || strcmp(readFuncName + prefixLen, "read") != 0)
+			continue;
+
+		snprintf(funcName, sizeof(funcName), "%.*s%s",
+				 prefixLen, readFuncName, fsys_optfunc_suffix[i]);
+
+		finfo->fn_addr = load_external_function(libFile, funcName, false,
+												&libraryhandle);
+		if (finfo->fn_addr == NULL)
+			continue;
+
+		finfo->fn_oid = (Oid) (FSYS_FUNC_TOTALNUM+i+1);
+		finfo->fn_nargs = 0;
+		finfo->fn_strict = 0;
+		finfo->fn_retset = 0;
+		finfo->fn_stats = 1;
+		finfo->fn_extra = NULL;
+		finfo->fn_mcxt = CurrentMemoryContext;
+		finfo->fn_expr = NULL;
+	}
+}
+
 /**
  * 
  */
@@ -76,6 +122,7 @@ InitFsysInterfaceFromFlatfile(FsysName name, FsysInterface fsys) {
 	ListCell   *cell;
 	char       *libFile;
 	char       *funcName;
+	char       *readFuncName = NULL;
 
 	filename = filesystem_getflatfilename();
 	fsys_file = AllocateFile(filename, "r");
@@ -107,6 +154,8 @@ InitFsysInterfaceFromFlatfile(FsysName name, FsysInterface fsys) {
 
 		funcName = lfirst(cell);
 		cell = lnext(cell);
+		if (i == FSYS_FUNC_READ)
+			readFuncName = funcName;
 
 		finfo->fn_addr = load_external_function(libFile, funcName, true,
 												&libraryhandle);
@@ -121,6 +170,8 @@ InitFsysInterfaceFromFlatfile(FsysName name, FsysInterface fsys) {
 		finfo->fn_expr = NULL;
 	}
 
+	InitFsysOptFuncs(fsys, libFile, readFuncName);
+
 	FreeFile(fsys_file);
 	pfree(filename);
 	if (list != NIL)
@@ -146,6 +197,7 @@ InitFsysInterface(FsysName name, FsysInterface fsys) {
 	Datum		libFileDatum;
 	char	   *libFile;
 	char	   *funcName;
+	char	   *readFuncName = NULL;
 	bool 		isNull;
 
 	/*
@@ -196,6 +248,8 @@ InitFsysInterface(FsysName name, FsysInterface fsys) {
 		}
 
 		funcName = NameStr(*(DatumGetName(funcDatum)));
+		if (i == FSYS_FUNC_READ)
+			readFuncName = funcName;
 
 		finfo->fn_addr = load_external_function(libFile, funcName, true,
 												&libraryhandle);
@@ -210,6 +264,8 @@ InitFsysInterface(FsysName name, FsysInterface fsys) {
 		finfo->fn_expr = NULL;
 	}
 
+	InitFsysOptFuncs(fsys, libFile, readFuncName);
+
 	heap_endscan(scandesc);
 	heap_close(rel, AccessShareLock);
 
@@ -284,6 +340,21 @@ FsysInterfaceGetFunc(FsysName name, FileSystemFuncType funcType)
 	return &(fsysInterface->fsysFuncs[funcType]);
 }
 
+/*
+ * Return an optional function of the filesystem, NULL if it has none.
+ */
+static FmgrInfo *
+FsysInterfaceGetOptFunc(FsysName name, FileSystemOptFuncType funcType)
+{
+	FsysInterface fsysInterface = NULL;
+	Assert(NULL != name && funcType >= 0 && funcType < FSYS_OPTFUNC_TOTALNUM);
+
+	fsysInterface = FsysInterfaceGet(name);
+	if (fsysInterface->fsysOptFuncs[funcType].fn_addr == NULL)
+		return NULL;
+	return &(fsysInterface->fsysOptFuncs[funcType]);
+}
+
 hdfsFS
 HdfsConnect(FsysName protocol, char * host, uint16_t port, char *ccname, void *token)
 {
@@ -618,6 +689,97 @@ int64_t HdfsTell(FsysName protocol, hdfsFS fileSystem, hdfsFile file)
 	return DatumGetInt64(d);
 }
 
+/*
+ * Read up to length bytes at position, leaving the file positioned after the
+ * data read. Filesystems without a pread function get a seek, skipped if the
+ * file is at the position already, and a read.
+ */
+int
+HdfsPread(FsysName protocol, hdfsFS fileSystem, hdfsFile file, int64_t position,
+		  void * buffer, int length)
+{
+	FunctionCallInfoData fcinfo;
+	FileSystemUdfData fsysUdf;
+	FmgrInfo *fsysFunc = FsysInterfaceGetOptFunc(protocol, FSYS_OPTFUNC_PREAD);
+
+	if (fsysFunc == NULL)
+	{
+		if (HdfsTell(protocol, fileSystem, file) != position &&
+			HdfsSeek(protocol, fileSystem, file, position) != 0)
+			return -1;
+		return HdfsRead(protocol, fileSystem, file, buffer, length);
+	}
+
+#ifdef USE_ASSERT_CHECKING
+    if (testmode_fault(gp_fsys_fault_inject_percent))
+        return -1;
+#endif
+
+	fsysUdf.type = T_FileSystemFunctionData;
+	fsysUdf.fsys_hdfs = fileSystem;
+	fsysUdf.fsys_hfile = file;
+	fsysUdf.fsys_databuf = buffer;
+	fsysUdf.fsys_maxbytes = length;
+	fsysUdf.fsys_pos = position;
+
+	InitFunctionCallInfoData(/* FunctionCallInfoData */ fcinfo,
+							 /* FmgrInfo */ fsysFunc,
+							 /* nArgs */ 0,
+							 /* Call Context */ (Node *) (&fsysUdf),
+							 /* ResultSetInfo */ NULL);
+
+	Datum d = FunctionCallInvoke(&fcinfo);
+
+	return DatumGetInt32(d);
+}
+
+/*
+ * Read several ranges of a file in one call, setting bytesRead of each
+ * range. Return 0, or -1 if any read failed.
+ */
+int
+HdfsPreadv(FsysName protocol, hdfsFS fileSystem, hdfsFile file,
+		   FileReadRange * ranges, int nranges)
+{
+	FunctionCallInfoData fcinfo;
+	FileSystemUdfData fsysUdf;
+	FmgrInfo *fsysFunc = FsysInterfaceGetOptFunc(protocol, FSYS_OPTFUNC_PREADV);
+
+	if (fsysFunc == NULL)
+	{
+		for (int i = 0; i < nranges; i++)
+		{
+			ranges[i].bytesRead = HdfsPread(protocol, fileSystem, file,
+											ranges[i].offset, ranges[i].buffer,
+											ranges[i].length);
+			if (ranges[i].bytesRead < 0)
+				return -1;
+		}
+		return 0;
+	}
+
+#ifdef USE_ASSERT_CHECKING
+    if (testmode_fault(gp_fsys_fault_inject_percent))
+        return -1;
+#endif
+
+	fsysUdf.type = T_FileSystemFunctionData;
+	fsysUdf.fsys_hdfs = fileSystem;
+	fsysUdf.fsys_hfile = file;
+	fsysUdf.fsys_ranges = ranges;
+	fsysUdf.fsys_nranges = nranges;
+
+	InitFunctionCallInfoData(/* FunctionCallInfoData */ fcinfo,
+							 /* FmgrInfo */ fsysFunc,
+							 /* nArgs */ 0,
+							 /* Call Context */ (Node *) (&fsysUdf),
+							 /* ResultSetInfo */ NULL);
+
+	Datum d = FunctionCallInvoke(&fcinfo);
+
+	return DatumGetInt32(d);
+}
+
 int HdfsTruncate(FsysName protocol, hdfsFS fileSystem, char * path, int64_t size)
 {
 	FunctionCallInfoData fcinfo;
@@ -33,6 +33,7 @@
 #include "cdb/cdbpersistentrelfile.h"
 #include "cdb/cdbpersistenttablespace.h"
 #include "cdb/cdbresynchronizechangetracking.h"
+#include "cdb/cdbsharedplan.h"
 #include "cdb/cdbvars.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -146,6 +147,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		if (AmIMaster()||AmIStandby())
 		{
 			size = add_size(size, mdver_shmem_size());
+			size = add_size(size, mdver_mdobj_cache_shmem_size());
 		}
 
 		size = add_size(size, ProcGlobalShmemSize());
@@ -158,6 +160,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		size = add_size(size, ProcArrayShmemSize());
 		size = add_size(size, BackendStatusShmemSize());
 		size = add_size(size, SharedSnapshotShmemSize());
+		size = add_size(size, SharedPlanShmemSize());
 
 		size = add_size(size, SInvalShmemSize());
 		size = add_size(size, PMSignalShmemSize());
@@ -329,6 +332,11 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 	 */
 	CreateSharedSnapshotArray(); 
 
+	/*
+	 * Set up the cache of plans shared by the QEs of a segment
+	 */
+	SharedPlanShmemInit();
+
 	/*
 	 * Set up shared-inval messaging
 	 */
@@ -378,6 +386,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 	if (AmIMaster() || AmIStandby())
 	{
 		mdver_shmem_init();
+		mdver_mdobj_cache_shmem_init();
 	}
 
 #ifdef EXEC_BACKEND
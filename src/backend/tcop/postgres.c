@@ -80,6 +80,7 @@
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/cdbgang.h"
+#include "cdb/cdbsharedplan.h"
 #include "cdb/cdbfilesystemcredential.h"
 #include "cdb/ml_ipc.h"
 #include "utils/guc.h"
@@ -4733,7 +4734,7 @@ PostgresMain(int argc, char *argv[], const char *username)
 					bool	suid_is_super = false;
 					bool	ouid_is_super = false;
 
-					int unusedFlags;
+					int dispatchFlags;
 
 					/* Set statement_timestamp() */
  					SetCurrentStatementStartTimestamp();
@@ -4787,9 +4788,8 @@ PostgresMain(int argc, char *argv[], const char *username)
 					else
 						serializedSnapshot = pq_getmsgbytes(&input_message,serializedSnapshotlen);
 
-					/* get the transaction options */
-					unusedFlags = pq_getmsgint(&input_message, 4);
-					Assert(0 == unusedFlags);
+					/* get the plan sharing options, see cdbsharedplan.h */
+					dispatchFlags = pq_getmsgint(&input_message, 4);
 
 					seqServerHostlen = pq_getmsgint(&input_message, 4);
 					seqServerPort = pq_getmsgint(&input_message, 4);
@@ -4821,6 +4821,42 @@ PostgresMain(int argc, char *argv[], const char *username)
 
 					pq_getmsgend(&input_message);
 
+					/*
+					 * Share the plan with the other QEs of this segment, or
+					 * get it from the one which received it.
+					 */
+					if (dispatchFlags & (GP_DISPATCH_FLAG_PLAN_PUBLISH | GP_DISPATCH_FLAG_PLAN_SHARED))
+					{
+						SharedPlanData shared;
+
+						if (dispatchFlags & GP_DISPATCH_FLAG_PLAN_SHARED)
+						{
+							SharedPlanFetch(serializedQuerytree, serializedQuerytreelen, &shared);
+						}
+						else
+						{
+							shared.querytree = serializedQuerytree;
+							shared.querytreelen = serializedQuerytreelen;
+							shared.plantree = serializedPlantree;
+							shared.plantreelen = serializedPlantreelen;
+							shared.sliceinfo = serializedSliceInfo;
+							shared.sliceinfolen = serializedSliceInfolen;
+							shared.resource = serializedResource;
+							shared.resourcelen = serializedResourceLen;
+							SharedPlanPublish(&shared, (dispatchFlags >> GP_DISPATCH_FLAG_READERS_SHIFT)
+											  & GP_DISPATCH_FLAG_MAX_READERS);
+						}
+
+						serializedQuerytree = shared.querytree;
+						serializedQuerytreelen = shared.querytreelen;
+						serializedPlantree = shared.plantree;
+						serializedPlantreelen = shared.plantreelen;
+						serializedSliceInfo = shared.sliceinfo;
+						serializedSliceInfolen = shared.sliceinfolen;
+						serializedResource = shared.resource;
+						serializedResourceLen = shared.resourcelen;
+					}
+
 					elog((Debug_print_full_dtm ? LOG : DEBUG5), "MPP dispatched stmt from QD: %s.",query_string);
 
 					if (suid > 0)
@@ -0,0 +1,503 @@
+/*-------------------------------------------------------------------------
+ *
+ * optplancache.c
+ *	  Per-backend cache of plans produced by the Pivotal Query Optimizer
+ *
+ * Optimizing a complex query takes far longer than looking it up, and
+ * reporting tools run the same queries over and over. The cache maps a key
+ * describing everything the optimizer bases its plan on to the PlannedStmt
+ * it produced:
+ *
+ *	- the query tree handed to the optimizer, after the constant folding of
+ *	  preprocess_query_optimizer, so parameter values are part of it,
+ *	- the settings of all optimizer GUCs and the other GUCs the optimizer
+ *	  reads, the disabled transformations and the number of segments the
+ *	  query runs on,
+ *	- the metadata versions of the relations, functions, operators and types
+ *	  the query references.
+ *
+ * Metadata versioning gives every object a new version after any change to
+ * the catalog, so the versions of the referenced objects change whenever
+ * anything the plan depends on may have changed; an entry is never
+ * invalidated, it just stops being looked up and ages out. Hence the cache
+ * is only used while metadata versioning is on, and not in a transaction
+ * which changed the catalog itself. Queries which reference no relation are
+ * cheap to optimize and are not cached, nor are plans which scan external
+ * tables: the locations of those are mapped to the hosts of the segments
+ * allocated to the query being optimized.
+ *
+ * Plans are kept in least recently used order, up to optimizer_plan_cache_size
+ * of them; each one lives in a memory context of its own.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "cdb/cdbvars.h"
+#include "lib/dllist.h"
+#include "lib/stringinfo.h"
+#include "nodes/parsenodes.h"
+#include "optimizer/walkers.h"
+#include "postmaster/identity.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/mdver.h"
+#include "utils/memutils.h"
+#include "utils/optplancache.h"
+
+typedef struct OptPlanCacheEntry
+{
+	uint32		hash;			/* hash key, must be first */
+	char	   *key;
+	PlannedStmt *stmt;
+	MemoryContext context;		/* holds the key and the plan */
+	int64		hits;
+	Dlelem		lru;			/* position in the LRU list */
+} OptPlanCacheEntry;
+
+/* cached plans, by hash of their key */
+static HTAB *OptPlanCacheHash = NULL;
+
+/* the most recently used plan at the head */
+static Dllist OptPlanCacheLRU;
+
+static MemoryContext OptPlanCacheContext = NULL;
+
+/* counters reported by gp_opt_plan_cache_stats() */
+static int64 OptPlanCacheHits = 0;
+static int64 OptPlanCacheMisses = 0;
+static int64 OptPlanCacheEvictions = 0;
+
+/* GUCs other than optimizer_* which the optimizer reads */
+static const char *const OptPlanCacheGucs[] = {
+	"gp_parquet_insert_sort",
+	"gp_external_max_segs",
+	"gp_external_enable_exec"
+};
+
+/* catalog objects a query references, see opt_plan_cache_objects_walker */
+typedef struct OptPlanCacheObjects
+{
+	List	   *oids;			/* distinct OIDs, in order of appearance */
+	int			nrelations;		/* number of relation references */
+} OptPlanCacheObjects;
+
+static void opt_plan_cache_add_object(OptPlanCacheObjects *objects, Oid oid);
+static bool opt_plan_cache_objects_walker(Node *node, OptPlanCacheObjects *objects);
+static bool opt_plan_cache_guc(const char *name);
+static bool opt_plan_cache_has_external_scan(PlannedStmt *stmt);
+
+static void
+OptPlanCacheInit(void)
+{
+	HASHCTL		ctl;
+
+	if (NULL != OptPlanCacheHash)
+		return;
+
+	OptPlanCacheContext = AllocSetContextCreate(TopMemoryContext,
+												"Optimizer plan cache",
+												ALLOCSET_DEFAULT_MINSIZE,
+												ALLOCSET_DEFAULT_INITSIZE,
+												ALLOCSET_DEFAULT_MAXSIZE);
+
+	MemSet(&ctl, 0, sizeof(ctl));
+	ctl.keysize = sizeof(uint32);
+	ctl.entrysize = sizeof(OptPlanCacheEntry);
+	ctl.hash = tag_hash;
+	ctl.hcxt = OptPlanCacheContext;
+	OptPlanCacheHash = hash_create("Optimizer plan cache", 64, &ctl,
+								   HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	DLInitList(&OptPlanCacheLRU);
+}
+
+static void
+OptPlanCacheRemove(OptPlanCacheEntry *entry)
+{
+	DLRemove(&entry->lru);
+	MemoryContextDelete(entry->context);
+	hash_search(OptPlanCacheHash, &entry->hash, HASH_REMOVE, NULL);
+}
+
+static void
+opt_plan_cache_add_object(OptPlanCacheObjects *objects, Oid oid)
+{
+	if (OidIsValid(oid))
+		objects->oids = list_append_unique_oid(objects->oids, oid);
+}
+
+/*
+ * Collect the relations, functions, operators and types referenced by a
+ * query tree.
+ */
+static bool
+opt_plan_cache_objects_walker(Node *node, OptPlanCacheObjects *objects)
+{
+	if (NULL == node)
+		return false;
+
+	switch (nodeTag(node))
+	{
+		case T_RangeTblEntry:
+			{
+				RangeTblEntry *rte = (RangeTblEntry *) node;
+
+				if (RTE_RELATION == rte->rtekind)
+				{
+					opt_plan_cache_add_object(objects, rte->relid);
+					objects->nrelations++;
+				}
+
+				/* subqueries and functions are walked by range_table_walker */
+				return false;
+			}
+
+		case T_Query:
+			{
+				Query	   *query = (Query *) node;
+
+				/* the sort clause is not walked by query_tree_walker */
+				if (opt_plan_cache_objects_walker((Node *) query->sortClause, objects))
+					return true;
+
+				return query_tree_walker(query,
+										 opt_plan_cache_objects_walker,
+										 objects,
+										 QTW_EXAMINE_RTES);
+			}
+
+		case T_SortClause:
+		case T_GroupClause:
+			opt_plan_cache_add_object(objects, ((SortClause *) node)->sortop);
+			return false;
+
+		case T_Var:
+			opt_plan_cache_add_object(objects, ((Var *) node)->vartype);
+			return false;
+
+		case T_Const:
+			opt_plan_cache_add_object(objects, ((Const *) node)->consttype);
+			return false;
+
+		case T_Param:
+			opt_plan_cache_add_object(objects, ((Param *) node)->paramtype);
+			break;
+
+		case T_Aggref:
+			opt_plan_cache_add_object(objects, ((Aggref *) node)->aggfnoid);
+			break;
+
+		case T_WindowRef:
+			opt_plan_cache_add_object(objects, ((WindowRef *) node)->winfnoid);
+			break;
+
+		case T_FuncExpr:
+			opt_plan_cache_add_object(objects, ((FuncExpr *) node)->funcid);
+			break;
+
+		case T_OpExpr:
+		case T_DistinctExpr:
+		case T_NullIfExpr:
+			opt_plan_cache_add_object(objects, ((OpExpr *) node)->opno);
+			break;
+
+		case T_ScalarArrayOpExpr:
+			opt_plan_cache_add_object(objects, ((ScalarArrayOpExpr *) node)->opno);
+			break;
+
+		case T_RowCompareExpr:
+			{
+				ListCell   *lc;
+
+				foreach(lc, ((RowCompareExpr *) node)->opnos)
+					opt_plan_cache_add_object(objects, lfirst_oid(lc));
+			}
+			break;
+
+		case T_RelabelType:
+			opt_plan_cache_add_object(objects, ((RelabelType *) node)->resulttype);
+			break;
+
+		case T_CoerceToDomain:
+			opt_plan_cache_add_object(objects, ((CoerceToDomain *) node)->resulttype);
+			break;
+
+		default:
+			break;
+	}
+
+	return expression_tree_walker(node, opt_plan_cache_objects_walker, objects);
+}
+
+/*
+ * Return true if the setting of a GUC is part of the cache key.
+ */
+static bool
+opt_plan_cache_guc(const char *name)
+{
+	int			i;
+
+	if (0 == strncmp(name, "optimizer", strlen("optimizer")))
+		return true;
+
+	for (i = 0; i < lengthof(OptPlanCacheGucs); i++)
+	{
+		if (0 == strcmp(name, OptPlanCacheGucs[i]))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Return true if a plan scans an external table.
+ */
+static bool
+opt_plan_cache_has_external_scan(PlannedStmt *stmt)
+{
+	ListCell   *lc;
+
+	if (NIL != extract_nodes_plan(stmt->planTree, T_ExternalScan, true))
+		return true;
+
+	foreach(lc, stmt->subplans)
+	{
+		Plan	   *subplan = (Plan *) lfirst(lc);
+
+		if (NULL != subplan &&
+			NIL != extract_nodes_plan(subplan, T_ExternalScan, true))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * OptPlanCacheKey
+ *	Build the cache key of a query about to be optimized.
+ *
+ * Returns NULL if the plan of the query must not be cached.
+ */
+char *
+OptPlanCacheKey(Query *query)
+{
+	StringInfoData buf;
+	mdver_local_mdvsn *local_mdvsn;
+	OptPlanCacheObjects objects;
+	ListCell   *lc;
+	int			i;
+
+	if (optimizer_plan_cache_size <= 0 || !mdver_enabled())
+		return NULL;
+
+	local_mdvsn = GetCurrentLocalMDVSN();
+	if (NULL == local_mdvsn || local_mdvsn->nuke_happened)
+		return NULL;
+
+	objects.oids = NIL;
+	objects.nrelations = 0;
+	(void) opt_plan_cache_objects_walker((Node *) query, &objects);
+	if (0 == objects.nrelations)
+	{
+		list_free(objects.oids);
+		return NULL;
+	}
+
+	initStringInfo(&buf);
+
+	appendStringInfo(&buf, "segments %d", GetPlannerSegmentNum());
+	foreach(lc, objects.oids)
+	{
+		Oid			oid = lfirst_oid(lc);
+		uint64		ddl_version;
+		uint64		dml_version;
+
+		mdver_request_version(oid, &ddl_version, &dml_version);
+		appendStringInfo(&buf, " %u:" UINT64_FORMAT "." UINT64_FORMAT,
+						 oid, ddl_version, dml_version);
+	}
+	list_free(objects.oids);
+
+	for (i = 0; i < GetNumConfigOptions(); i++)
+	{
+		const char *values[2];
+		bool		noshow;
+
+		GetConfigOptionByNum(i, values, &noshow);
+		if (opt_plan_cache_guc(values[0]))
+			appendStringInfo(&buf, "\n%s=%s", values[0],
+							 values[1] ? values[1] : "");
+	}
+
+	appendStringInfoString(&buf, "\nxforms ");
+	for (i = 0; i < OPTIMIZER_XFORMS_COUNT; i++)
+		appendStringInfoChar(&buf, optimizer_xforms[i] ? '1' : '0');
+
+	appendStringInfoChar(&buf, '\n');
+	appendStringInfoString(&buf, nodeToString(query));
+
+	return buf.data;
+}
+
+/*
+ * OptPlanCacheLookup
+ *	Look up the plan of a query by its key.
+ *
+ * Returns a copy of the plan, in the current memory context, or NULL.
+ */
+PlannedStmt *
+OptPlanCacheLookup(const char *key)
+{
+	OptPlanCacheEntry *entry;
+	uint32		hash = DatumGetUInt32(hash_any((const unsigned char *) key, strlen(key)));
+
+	OptPlanCacheInit();
+
+	entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hash, HASH_FIND, NULL);
+	if (NULL == entry || 0 != strcmp(entry->key, key))
+	{
+		OptPlanCacheMisses++;
+		return NULL;
+	}
+
+	OptPlanCacheHits++;
+	entry->hits++;
+	DLMoveToFront(&entry->lru);
+
+	return (PlannedStmt *) copyObject(entry->stmt);
+}
+
+/*
+ * OptPlanCacheInsert
+ *	Remember the plan produced for the query of the given key.
+ *
+ * Evicts the least recently used plans beyond optimizer_plan_cache_size.
+ * Plans which scan external tables are not kept.
+ */
+void
+OptPlanCacheInsert(const char *key, PlannedStmt *stmt)
+{
+	OptPlanCacheEntry *entry;
+	MemoryContext context;
+	MemoryContext oldcontext;
+	uint32		hash = DatumGetUInt32(hash_any((const unsigned char *) key, strlen(key)));
+	bool		found;
+
+	if (opt_plan_cache_has_external_scan(stmt))
+		return;
+
+	OptPlanCacheInit();
+
+	/* build the copy first, so an error leaves the cache untouched */
+	context = AllocSetContextCreate(OptPlanCacheContext,
+									"Optimizer cached plan",
+									ALLOCSET_SMALL_MINSIZE,
+									ALLOCSET_SMALL_INITSIZE,
+									ALLOCSET_DEFAULT_MAXSIZE);
+	oldcontext = MemoryContextSwitchTo(context);
+	PG_TRY();
+	{
+		stmt = (PlannedStmt *) copyObject(stmt);
+		key = pstrdup(key);
+	}
+	PG_CATCH();
+	{
+		MemoryContextSwitchTo(oldcontext);
+		MemoryContextDelete(context);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	MemoryContextSwitchTo(oldcontext);
+
+	/* a plan of another query with the same hash is replaced */
+	entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hash, HASH_FIND, NULL);
+	if (NULL != entry)
+		OptPlanCacheRemove(entry);
+
+	while (hash_get_num_entries(OptPlanCacheHash) >= optimizer_plan_cache_size &&
+		   NULL != DLGetTail(&OptPlanCacheLRU))
+	{
+		OptPlanCacheRemove((OptPlanCacheEntry *) DLE_VAL(DLGetTail(&OptPlanCacheLRU)));
+		OptPlanCacheEvictions++;
+	}
+
+	entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hash, HASH_ENTER, &found);
+	Assert(!found);
+	entry->key = (char *) key;
+	entry->stmt = stmt;
+	entry->context = context;
+	entry->hits = 0;
+	DLInitElem(&entry->lru, entry);
+	DLAddHead(&OptPlanCacheLRU, &entry->lru);
+}
+
+/*
+ * OptPlanCacheFlush
+ *	Drop all cached plans. Returns the number of plans dropped.
+ */
+long
+OptPlanCacheFlush(void)
+{
+	long		nplans;
+
+	if (NULL == OptPlanCacheHash)
+		return 0;
+
+	nplans = hash_get_num_entries(OptPlanCacheHash);
+
+	MemoryContextDelete(OptPlanCacheContext);
+	OptPlanCacheContext = NULL;
+	OptPlanCacheHash = NULL;
+
+	return nplans;
+}
+
+/*
+ * gp_opt_plan_cache_stats
+ *	Report the plans cached by this session and how often they were used.
+ */
+Datum
+gp_opt_plan_cache_stats(PG_FUNCTION_ARGS)
+{
+	StringInfoData buf;
+	long		nplans = 0;
+	int64		hits_cached = 0;
+	Dlelem	   *elem;
+
+	if (NULL != OptPlanCacheHash)
+	{
+		nplans = hash_get_num_entries(OptPlanCacheHash);
+		for (elem = DLGetHead(&OptPlanCacheLRU); NULL != elem; elem = DLGetSucc(elem))
+			hits_cached += ((OptPlanCacheEntry *) DLE_VAL(elem))->hits;
+	}
+
+	initStringInfo(&buf);
+	appendStringInfo(&buf,
+					 "%ld plans cached (limit %d), " INT64_FORMAT " hits on them; "
+					 INT64_FORMAT " hits, " INT64_FORMAT " misses, " INT64_FORMAT " evictions",
+					 nplans, optimizer_plan_cache_size, hits_cached,
+					 OptPlanCacheHits, OptPlanCacheMisses, OptPlanCacheEvictions);
+
+	PG_RETURN_TEXT_P(cstring_to_text(buf.data));
+}
+
+/*
+ * gp_opt_plan_cache_clear
+ *	Drop the plans cached by this session and reset the counters.
+ */
+Datum
+gp_opt_plan_cache_clear(PG_FUNCTION_ARGS)
+{
+	char		message[128];
+	long		nplans = OptPlanCacheFlush();
+
+	OptPlanCacheHits = 0;
+	OptPlanCacheMisses = 0;
+	OptPlanCacheEvictions = 0;
+
+	snprintf(message, sizeof(message), "Optimizer plan cache cleared %ld plans", nplans);
+	PG_RETURN_TEXT_P(cstring_to_text(message));
+}
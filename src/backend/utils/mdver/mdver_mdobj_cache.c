@@ -0,0 +1,340 @@
+/*-------------------------------------------------------------------------
+ *
+ * mdver_mdobj_cache.c
+ *	 Shared cache of metadata objects translated for the optimizer
+ *
+ * ORCA asks for metadata objects by their md ids, which embed the
+ * versions handed out by Metadata Versioning. An object translated to DXL
+ * by one session is therefore valid for every other session asking for the
+ * same md id in the same database: a change to the catalog gives the object
+ * a new version, so it is looked up under a new key, and the stale entry ages
+ * out of the cache. The cache is shared by all databases, whose objects may
+ * have the same OIDs, so the key is the md id prefixed with the database.
+ *
+ * The serialized objects are kept in a circular arena, in the order they
+ * were added; a shared hash table maps the md id string to the offset of
+ * the object in the arena. Adding an object evicts the oldest ones until
+ * there is room for it.
+ *
+ * Copyright (c) 2014, Pivotal, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+#include "utils/mdver.h"
+#include "utils/hsearch.h"
+#include "miscadmin.h"
+#include "cdb/cdbvars.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+
+/* Name to identify the metadata object cache shared memory */
+#define MDVER_MDOBJ_CACHE_SHMEM_NAME "MDVer Metadata Object Cache"
+#define MDVER_MDOBJ_HASH_SHMEM_NAME "MDVer Metadata Object Hash"
+
+/* Average size of a serialized object, used to size the hash table */
+#define MDVER_MDOBJ_AVG_SIZE 2048
+
+/* An object as stored in the arena, followed by its data */
+typedef struct mdver_mdobj
+{
+	char key[MDVER_MDOBJ_KEY_LEN];
+	uint32 size; /* Size of the object in the arena, header included */
+	uint32 len; /* Length of the data */
+} mdver_mdobj;
+
+/* Entry of the hash table mapping md ids to objects in the arena */
+typedef struct mdver_mdobj_entry
+{
+	char key[MDVER_MDOBJ_KEY_LEN];
+	uint32 offset;
+} mdver_mdobj_entry;
+
+typedef struct mdver_mdobj_cache
+{
+	uint32 arena_size;
+	uint32 head; /* Where the next object goes */
+	uint32 tail; /* Oldest object */
+	uint32 wrap_end; /* End of the objects before head wrapped around */
+	bool wrapped; /* Objects are in [tail, wrap_end) and [0, head) */
+	int num_objs;
+	char arena[1]; /* VARIABLE LENGTH ARRAY */
+} mdver_mdobj_cache;
+
+static mdver_mdobj_cache *mdobj_cache = NULL;
+static HTAB *mdobj_hash = NULL;
+
+#define MDOBJ_AT(offset) ((mdver_mdobj *) (mdobj_cache->arena + (offset)))
+
+static Size
+mdver_mdobj_arena_size(void)
+{
+	return MAXALIGN_DOWN((Size) gp_mdver_mdobj_cache_size * 1024);
+}
+
+static long
+mdver_mdobj_hash_size(void)
+{
+	return Max(mdver_mdobj_arena_size() / MDVER_MDOBJ_AVG_SIZE, 64);
+}
+
+/*
+ * Compute the size of shared memory required for the metadata object cache.
+ * Nothing is allocated when the cache is turned off.
+ */
+Size
+mdver_mdobj_cache_shmem_size(void)
+{
+	Size size;
+
+	if (0 == mdver_mdobj_arena_size())
+	{
+		return 0;
+	}
+
+	size = add_size(offsetof(mdver_mdobj_cache, arena), mdver_mdobj_arena_size());
+	size = add_size(size, hash_estimate_size(mdver_mdobj_hash_size(),
+			sizeof(mdver_mdobj_entry)));
+	return size;
+}
+
+/*
+ * Initialize the shared memory data structures of the metadata object cache
+ */
+void
+mdver_mdobj_cache_shmem_init(void)
+{
+	HASHCTL info;
+	bool found = false;
+
+	if (0 == mdver_mdobj_arena_size())
+	{
+		return;
+	}
+
+	mdobj_cache = (mdver_mdobj_cache *) ShmemInitStruct(MDVER_MDOBJ_CACHE_SHMEM_NAME,
+			offsetof(mdver_mdobj_cache, arena) + mdver_mdobj_arena_size(),
+			&found);
+
+	if (!found)
+	{
+		mdobj_cache->arena_size = mdver_mdobj_arena_size();
+		mdobj_cache->head = 0;
+		mdobj_cache->tail = 0;
+		mdobj_cache->wrap_end = 0;
+		mdobj_cache->wrapped = false;
+		mdobj_cache->num_objs = 0;
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = MDVER_MDOBJ_KEY_LEN;
+	info.entrysize = sizeof(mdver_mdobj_entry);
+
+	mdobj_hash = ShmemInitHash(MDVER_MDOBJ_HASH_SHMEM_NAME,
+			mdver_mdobj_hash_size(), mdver_mdobj_hash_size(),
+			&info, HASH_ELEM);
+	Assert(NULL != mdobj_hash);
+}
+
+/*
+ * Returns true if the current backend can look up and add objects.
+ *
+ * Objects are only versioned while Metadata Versioning is on. After this
+ * transaction changed the catalog, the objects it sees are not committed
+ * yet, so they are neither looked up nor shared. That is the case after a
+ * nuke, and also when the Local MDVSN holds versions this transaction
+ * bumped for individual objects.
+ */
+bool
+mdver_mdobj_cache_enabled(void)
+{
+	if (NULL == mdobj_cache || !mdver_enabled())
+	{
+		return false;
+	}
+
+	mdver_local_mdvsn *local_mdvsn = GetCurrentLocalMDVSN();
+	return NULL != local_mdvsn && !local_mdvsn->nuke_happened &&
+			hash_get_num_entries(local_mdvsn->htable) == 0;
+}
+
+/*
+ * Build the hash key of an md id, zero padded. Returns false if the key
+ * does not fit.
+ */
+static bool
+mdver_mdobj_make_key(const char *key, char *hash_key)
+{
+	MemSet(hash_key, 0, MDVER_MDOBJ_KEY_LEN);
+	return snprintf(hash_key, MDVER_MDOBJ_KEY_LEN, "%u:%s", MyDatabaseId, key)
+			< MDVER_MDOBJ_KEY_LEN;
+}
+
+/*
+ * Look up the object of the given md id in the cache.
+ * Returns a copy of the object data, palloc'ed in the current memory
+ * context, or NULL if it is not in the cache.
+ */
+void *
+mdver_mdobj_cache_find(const char *key, Size *len)
+{
+	Assert(NULL != mdobj_cache);
+
+	char hash_key[MDVER_MDOBJ_KEY_LEN];
+	void *data = NULL;
+
+	if (!mdver_mdobj_make_key(key, hash_key))
+	{
+		return NULL;
+	}
+
+	LWLockAcquire(MDVerMDObjCacheLock, LW_SHARED);
+
+	mdver_mdobj_entry *entry = (mdver_mdobj_entry *) hash_search(mdobj_hash,
+			hash_key, HASH_FIND, NULL);
+	if (NULL != entry)
+	{
+		mdver_mdobj *obj = MDOBJ_AT(entry->offset);
+
+		data = palloc(obj->len);
+		memcpy(data, (char *) obj + MAXALIGN(sizeof(mdver_mdobj)), obj->len);
+		*len = obj->len;
+	}
+
+	LWLockRelease(MDVerMDObjCacheLock);
+
+	return data;
+}
+
+/*
+ * Evict the oldest object from the cache.
+ * Caller must hold MDVerMDObjCacheLock exclusively.
+ */
+static void
+mdver_mdobj_evict(void)
+{
+	Assert(mdobj_cache->num_objs > 0);
+
+	mdver_mdobj *obj = MDOBJ_AT(mdobj_cache->tail);
+	mdver_mdobj_entry *entry = (mdver_mdobj_entry *) hash_search(mdobj_hash,
+			obj->key, HASH_FIND, NULL);
+
+	Assert(NULL != entry && entry->offset == mdobj_cache->tail);
+	hash_search(mdobj_hash, obj->key, HASH_REMOVE, NULL);
+
+	mdobj_cache->tail += obj->size;
+	mdobj_cache->num_objs--;
+
+	if (mdobj_cache->wrapped && mdobj_cache->tail == mdobj_cache->wrap_end)
+	{
+		mdobj_cache->tail = 0;
+		mdobj_cache->wrapped = false;
+	}
+
+	if (0 == mdobj_cache->num_objs)
+	{
+		mdobj_cache->head = 0;
+		mdobj_cache->tail = 0;
+		mdobj_cache->wrapped = false;
+	}
+}
+
+/*
+ * Make room for an object of the given size, evicting the oldest objects.
+ * Returns the offset of the room in the arena.
+ * Caller must hold MDVerMDObjCacheLock exclusively.
+ */
+static uint32
+mdver_mdobj_alloc(uint32 size)
+{
+	Assert(size <= mdobj_cache->arena_size);
+
+	for (;;)
+	{
+		if (!mdobj_cache->wrapped)
+		{
+			if (mdobj_cache->head + size <= mdobj_cache->arena_size)
+			{
+				break;
+			}
+
+			/* Not enough room at the end of the arena, start over at the beginning */
+			mdobj_cache->wrap_end = mdobj_cache->head;
+			mdobj_cache->wrapped = true;
+			mdobj_cache->head = 0;
+		}
+		else if (mdobj_cache->head + size <= mdobj_cache->tail)
+		{
+			break;
+		}
+
+		mdver_mdobj_evict();
+	}
+
+	uint32 offset = mdobj_cache->head;
+	mdobj_cache->head += size;
+	return offset;
+}
+
+/*
+ * Add the object of the given md id to the cache.
+ * Objects larger than a quarter of the cache are not cached, nor are md ids
+ * too long for a key.
+ */
+void
+mdver_mdobj_cache_add(const char *key, const void *data, Size len)
+{
+	Assert(NULL != mdobj_cache);
+
+	char hash_key[MDVER_MDOBJ_KEY_LEN];
+	Size size = MAXALIGN(sizeof(mdver_mdobj)) + MAXALIGN(len);
+	bool found = false;
+
+	if (!mdver_mdobj_make_key(key, hash_key) ||
+			size > mdobj_cache->arena_size / 4)
+	{
+		return;
+	}
+
+	LWLockAcquire(MDVerMDObjCacheLock, LW_EXCLUSIVE);
+
+	/* Another session may have added it meanwhile */
+	if (NULL != hash_search(mdobj_hash, hash_key, HASH_FIND, NULL))
+	{
+		LWLockRelease(MDVerMDObjCacheLock);
+		return;
+	}
+
+	mdver_mdobj_entry *entry = (mdver_mdobj_entry *) hash_search(mdobj_hash,
+			hash_key, HASH_ENTER_NULL, &found);
+	while (NULL == entry)
+	{
+		/*
+		 * The hash table is full, which happens when the objects are
+		 * smaller than average. Evict more of them.
+		 */
+		if (0 == mdobj_cache->num_objs)
+		{
+			LWLockRelease(MDVerMDObjCacheLock);
+			return;
+		}
+		mdver_mdobj_evict();
+		entry = (mdver_mdobj_entry *) hash_search(mdobj_hash,
+				hash_key, HASH_ENTER_NULL, &found);
+	}
+	Assert(!found);
+
+	uint32 offset = mdver_mdobj_alloc((uint32) size);
+
+	mdver_mdobj *obj = MDOBJ_AT(offset);
+	memcpy(obj->key, hash_key, MDVER_MDOBJ_KEY_LEN);
+	obj->size = (uint32) size;
+	obj->len = (uint32) len;
+	memcpy((char *) obj + MAXALIGN(sizeof(mdver_mdobj)), data, len);
+
+	entry->offset = offset;
+	mdobj_cache->num_objs++;
+
+	LWLockRelease(MDVerMDObjCacheLock);
+}
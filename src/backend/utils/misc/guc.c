@@ -655,6 +655,7 @@ bool		gp_enable_preunique = TRUE;
 bool		gp_eager_preunique = FALSE;
 bool		gp_enable_sequential_window_plans = FALSE;
 bool 		gp_hashagg_streambottom = true;
+bool		gp_hashagg_open_addressing = false;
 bool		gp_enable_agg_distinct = true;
 bool		gp_enable_dqa_pruning = true;
 bool		gp_eager_dqa_pruning = FALSE;
@@ -737,6 +738,8 @@ double 	optimizer_damping_factor_filter;
 double	optimizer_damping_factor_join;
 double 	optimizer_damping_factor_groupby;
 int		optimizer_segments;
+int		optimizer_plan_cache_size;
+int		optimizer_search_time_budget;
 bool		optimizer_analyze_root_partition;
 bool		optimizer_analyze_midlevel_partition;
 bool		optimizer_enable_constant_expression_evaluation;
@@ -1125,6 +1128,24 @@ static struct config_bool ConfigureNamesBool[] =
 		&gp_enable_direct_dispatch,
 		true, NULL, NULL
 	},
+	{
+		{"gp_dispatch_plan_per_host", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Dispatch the plan to one QE per segment host, which shares it with the other QEs of the host."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_dispatch_plan_per_host,
+		false, NULL, NULL
+	},
+	{
+		{"gp_dispatch_event_driven", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Watch all executors of a query in one thread, reused across queries of the session."),
+			gettext_noop("Otherwise a thread is created for every gp_connections_per_thread executors of each query."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_dispatch_event_driven,
+		false, NULL, NULL
+	},
 	{
 		{"gp_enable_predicate_propagation", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("When two expressions are equivalent (such as with "
@@ -1145,6 +1166,16 @@ static struct config_bool ConfigureNamesBool[] =
 		&gp_workfile_checksumming,
 		true, NULL, NULL
 	},
+	{
+		{"gp_workfile_async_io", PGC_USERSET, QUERY_TUNING_OTHER,
+		 gettext_noop("Overlap the disk I/O of executor work files with query execution."),
+		 gettext_noop("Uncompressed, LZ4 and ZSTD work files are written behind and "
+					  "read ahead by a background thread, sort tapes are prefetched."),
+		 GUC_GPDB_ADDOPT | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_workfile_async_io,
+		true, NULL, NULL
+	},
 	{
 		{"gp_workfile_caching", PGC_SUSET, QUERY_TUNING_OTHER,
 			gettext_noop("Enable work file caching"),
@@ -1978,6 +2009,27 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_parquet_rowgroup_filter", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable skipping of parquet row groups using column statistics."),
+			gettext_noop("Row groups whose column min/max/null count show no tuple can satisfy "
+						 "the scan quals are not read."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_rowgroup_filter,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_parquet_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Enable dictionary encoding of text-like columns when inserting into parquet tables."),
+			gettext_noop("Column chunks fall back to plain encoding once the dictionary exceeds the page size."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_dictionary_encoding,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_enable_mk_sort", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enable multi-key sort."),
@@ -2023,6 +2075,16 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_open_addressing", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Use an open-addressing hash table for hashagg"),
+			gettext_noop("Groups are found by linear probing instead of following bucket chains."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashagg_open_addressing,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_enable_motion_deadlock_sanity", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Enable verbose check at planning time."),
@@ -2353,6 +2415,15 @@ static struct config_bool ConfigureNamesBool[] =
 		false, NULL, NULL
     },
 
+	{
+		{"gp_copy_raw_chunks", PGC_USERSET, EXTERNAL_TABLES,
+			gettext_noop("Let COPY FROM into randomly distributed tables ship whole lines of input to the segments unparsed."),
+			gettext_noop("The segments parse the data in parallel instead of the master.")
+		},
+		&gp_copy_raw_chunks,
+		false, NULL, NULL
+	},
+
 	{
 		{"ignore_system_indexes", PGC_BACKEND, DEVELOPER_OPTIONS,
 			gettext_noop("Disables reading from system indexes."),
@@ -4551,6 +4622,25 @@ static struct config_int ConfigureNamesInt[] =
 		&split_read_size_mb,
 		128, 2, INT_MAX, NULL, NULL
 	},
+	{
+		{"gp_parquet_scan_buffer_size", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the read buffer size of each column when scanning parquet tables."),
+			gettext_noop("Pages larger than this enlarge the buffer as needed."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_scan_buffer_size,
+		1024, 64, 512 * 1024, NULL, NULL
+	},
+	{
+		{"gp_parquet_prefetch_memory", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the memory for reading ahead column chunks when scanning parquet tables."),
+			gettext_noop("Column data is read in background threads while the scan decodes "
+						 "other pages. Zero disables read-ahead."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_prefetch_memory,
+		8 * 1024, 0, 512 * 1024, NULL, NULL
+	},
 	{
 		{"geqo_threshold", PGC_USERSET, DEFUNCT_OPTIONS,
 			gettext_noop("Unused. Syntax check only for PostgreSQL compatibility."),
@@ -4887,6 +4977,26 @@ static struct config_int ConfigureNamesInt[] =
 		0, 0, MAX_KILOBYTES, NULL, NULL
 	},
 
+	{
+		{"gp_mdver_mdobj_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the shared memory cache of metadata objects translated for the optimizer."),
+			gettext_noop("Sessions share the objects while gp_metadata_versioning is on. Zero disables it."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_mdver_mdobj_cache_size,
+		0, 0, MAX_KILOBYTES, NULL, NULL
+	},
+
+	{
+		{"gp_dispatch_plan_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the shared memory cache of plans shared by the QEs of a segment."),
+			gettext_noop("Plans larger than half of it are dispatched to every QE."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_dispatch_plan_cache_size,
+		16384, 0, MAX_KILOBYTES, NULL, NULL
+	},
+
 	{
 		{"gp_max_partition_level", PGC_SUSET, PRESET_OPTIONS,
 		 	gettext_noop("Sets the maximum number of levels allowed when creating a partitioned table."),
@@ -5477,6 +5587,16 @@ static struct config_int ConfigureNamesInt[] =
         2, 1, 4096, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_syscall_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+            gettext_noop("Sets the maximum number of packets the UDP interconnect sends or receives per system call"),
+            gettext_noop("Values above 1 use sendmmsg() and recvmmsg() where available."),
+			GUC_GPDB_ADDOPT
+        },
+        &Gp_interconnect_syscall_batch_size,
+        1, 1, 64, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_timer_period", PGC_USERSET, GP_ARRAY_TUNING,
             gettext_noop("Sets the timer period (in ms) for UDP interconnect"),
@@ -5709,6 +5829,27 @@ static struct config_int ConfigureNamesInt[] =
 		20000, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_mk_sort_parallel_workers", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of threads helping the backend sort in memory with mk sort."),
+			gettext_noop("Only sorts on int4 keys are done in parallel. Zero disables it."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_mk_sort_parallel_workers,
+		0, 0, 64, NULL, NULL
+	},
+
+	{
+		{"gp_mk_sort_merge_readahead", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the size of the read-ahead of each run merged by mk sort."),
+			gettext_noop("Larger values merge fewer runs per pass, reading each sequentially, "
+						 "which suits rotating disks. Zero disables it, which suits SSDs."),
+			GUC_UNIT_KB | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_mk_sort_merge_readahead,
+		0, 0, 65536, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_setup_timeout", PGC_USERSET, DEPRECATED_OPTIONS,
 			gettext_noop("Timeout (in seconds) on interconnect setup that occurs at query start"),
@@ -6256,6 +6397,26 @@ static struct config_int ConfigureNamesInt[] =
 		0, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"optimizer_plan_cache_size", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the maximum number of plans of the optimizer a session keeps for reuse."),
+			gettext_noop("Plans are only cached while gp_metadata_versioning is on. Zero disables the cache."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_plan_cache_size,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"optimizer_search_time_budget", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the time after which the optimizer stops exploring join orders and keeps the best plan found so far."),
+			gettext_noop("Only used when optimizer_search_strategy_path is not set. Zero means no limit."),
+			GUC_NOT_IN_SAMPLE | GUC_UNIT_MS
+		},
+		&optimizer_search_time_budget,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"pxf_service_port", PGC_POSTMASTER, EXTERNAL_TABLES,
 			gettext_noop("PXF service port"),
@@ -6474,6 +6635,26 @@ static struct config_int ConfigureNamesInt[] =
 		128, 3, 1024, NULL, NULL
 	},
 
+	{
+		{"datalocality_fetch_threads", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the number of threads looking up hdfs block locations for data locality."),
+			gettext_noop("1 looks up the files one by one."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&datalocality_fetch_threads,
+		8, 1, 64, NULL, NULL
+	},
+
+	{
+		{"datalocality_assignment_cache_size", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the number of split assignments kept for queries on unchanged tables."),
+			gettext_noop("0 runs the data locality algorithm for every query."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&datalocality_assignment_cache_size,
+		64, 0, 1024, NULL, NULL
+	},
+
     {
         {"hawq_metadata_cache_block_capacity", PGC_POSTMASTER, DEVELOPER_OPTIONS,
 			gettext_noop("metadata cache block capacity."),
@@ -6876,7 +7057,8 @@ static struct config_string ConfigureNamesString[] =
 	{
 		{"gp_workfile_compress_algorithm", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Specify the compression algorithm that work files in the query executor use."),
-			gettext_noop("Valid values are \"NONE\", \"ZLIB\"."),
+			gettext_noop("Valid values are \"NONE\", \"ZLIB\", \"LZ4\", \"ZSTD\". "
+						 "LZ4 and ZSTD are available only if built with those libraries."),
 			GUC_GPDB_ADDOPT
 		},
 		&gp_workfile_compress_algorithm_str,
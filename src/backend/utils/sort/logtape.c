@@ -67,6 +67,20 @@ struct LogicalTape
 
 	int64 		firstBlkNum;  /* First block block number */
 	LogicalTapePos   currPos;         /* current postion */
+
+	/*
+	 * Read-ahead buffer, see LogicalTapeSetReadAhead().  It holds raCount
+	 * blocks of the file starting at raFirst, raUsed of which were read from
+	 * it.  Blocks of other tapes, read along, are counted as wasted.
+	 */
+	char	   *raBuf;
+	int			raSize;			/* capacity of raBuf, in blocks */
+	int			raCount;
+	int			raUsed;
+	int64		raFirst;
+
+	int64		nBlocksUsed;	/* blocks read by LogicalTapeRead */
+	int64		nBlocksWasted;	/* blocks read ahead, but not used */
 };
 
 /*
@@ -109,6 +123,9 @@ struct LogicalTapeSet
 
 static void ltsWriteBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer);
 static void ltsReadBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer);
+static void ltsPrefetchBlock(LogicalTapeSet *lts, int64 blocknum);
+static void ltsReadTapeBlock(LogicalTapeSet *lts, LogicalTape *lt, int64 blocknum);
+static void ltsResetReadAhead(LogicalTape *lt);
 static long ltsGetFreeBlock(LogicalTapeSet *lts);
 static void ltsReleaseBlock(LogicalTapeSet *lts, int64 blocknum);
 static LogicalTapeSet *LogicalTapeSetCreate_Named(const char *set_prefix, int ntapes, bool del_on_close);
@@ -161,6 +178,11 @@ LoadLogicalTapeSetState(ExecWorkFile *statefile, ExecWorkFile *tapefile)
 
 	lt->writing = false;
 	lt->frozen = true;
+	lt->raBuf = NULL;
+	lt->raSize = 0;
+	ltsResetReadAhead(lt);
+	lt->nBlocksUsed = 0;
+	lt->nBlocksWasted = 0;
 
 	readSize = ExecWorkFile_Read(statefile, &(lt->firstBlkNum), sizeof(lt->firstBlkNum));
 	if(readSize != sizeof(lt->firstBlkNum))
@@ -221,6 +243,84 @@ ltsReadBlock(LogicalTapeSet *lts, int64 blocknum, void *buffer)
 	}
 }
 
+/*
+ * Hint that the specified block is going to be read next, so that it is
+ * read in the background while the current block of the tape is consumed.
+ * A merge reads from many tapes, each block of a tape only after the one
+ * before it is consumed, so without this every block read waits for disk.
+ */
+static void
+ltsPrefetchBlock(LogicalTapeSet *lts, int64 blocknum)
+{
+	Assert(lts != NULL);
+	if (gp_workfile_async_io && blocknum != -1L)
+		ExecWorkFile_Prefetch(lts->pfile, blocknum * BLCKSZ, BLCKSZ);
+}
+
+/*
+ * Forget the blocks in the read-ahead buffer of a tape.
+ */
+static void
+ltsResetReadAhead(LogicalTape *lt)
+{
+	if (lt->raCount > lt->raUsed)
+		lt->nBlocksWasted += lt->raCount - lt->raUsed;
+	lt->raCount = 0;
+	lt->raUsed = 0;
+	lt->raFirst = -1L;
+}
+
+/*
+ * Read the next block of a tape, which is in read mode, into its current
+ * block.
+ *
+ * With a read-ahead buffer, the blocks following it in the file are read
+ * along in a single request. A tape written without other tapes writing
+ * at the same time, as the initial runs are, occupies consecutive blocks,
+ * so that most following blocks will be found in the buffer.
+ *
+ * A buffered block of another tape may be stale, but it is never used: the
+ * blocks of a tape being read are all written before the tape is rewound,
+ * it gets no new blocks until it is rewound for writing, and that resets
+ * the buffer.
+ */
+static void
+ltsReadTapeBlock(LogicalTapeSet *lts, LogicalTape *lt, int64 blocknum)
+{
+	lt->nBlocksUsed++;
+
+	if (lt->raSize == 0)
+	{
+		ltsReadBlock(lts, blocknum, &lt->currBlk);
+		return;
+	}
+
+	if (blocknum < lt->raFirst || blocknum >= lt->raFirst + lt->raCount)
+	{
+		int			nblocks = (int) Min((int64) lt->raSize, lts->nFileBlocks - blocknum);
+		size_t		nread;
+
+		ltsResetReadAhead(lt);
+
+		nblocks = Max(nblocks, 1);
+		if (ExecWorkFile_Seek(lts->pfile, blocknum * BLCKSZ, SEEK_SET) != 0)
+			nread = 0;
+		else
+			nread = ExecWorkFile_Read(lts->pfile, lt->raBuf, (size_t) nblocks * BLCKSZ);
+		if (nread < BLCKSZ)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read block " INT64_FORMAT  " of temporary file: %m",
+							blocknum)));
+
+		lt->raFirst = blocknum;
+		lt->raCount = nread / BLCKSZ;
+	}
+
+	memcpy(&lt->currBlk, lt->raBuf + (blocknum - lt->raFirst) * BLCKSZ, BLCKSZ);
+	lt->raUsed++;
+}
+
 /*
  * qsort comparator for sorting freeBlocks[] into decreasing order.
  */
@@ -316,6 +416,13 @@ LogicalTapeCreate(LogicalTapeSet *lts, LogicalTape *lt)
 	lt->firstBlkNum = -1L;
 	lt->currPos.blkNum = -1L;
 	lt->currPos.offset = 0;
+	lt->raBuf = NULL;
+	lt->raSize = 0;
+	lt->raCount = 0;
+	lt->raUsed = 0;
+	lt->raFirst = -1L;
+	lt->nBlocksUsed = 0;
+	lt->nBlocksWasted = 0;
 	return lt;
 }
 
@@ -407,8 +514,15 @@ LogicalTapeSet *LogicalTapeSetCreate_File(ExecWorkFile *ewfile, int ntapes)
 void
 LogicalTapeSetClose(LogicalTapeSet *lts, workfile_set *workset)
 {
+	int			i;
+
 	Assert(lts != NULL);
 	workfile_mgr_close_file(workset, lts->pfile);
+	for (i = 0; i < lts->nTapes; i++)
+	{
+		if (lts->tapes[i].raBuf)
+			pfree(lts->tapes[i].raBuf);
+	}
 	if(lts->freeBlocks)
 		pfree(lts->freeBlocks);
 	pfree(lts);
@@ -502,8 +616,10 @@ LogicalTapeRewind(LogicalTapeSet *lts, LogicalTape *lt, bool forWrite)
 				Assert(lt->currBlk.next_blk == -1L);
 				ltsWriteBlock(lts, lt->currPos.blkNum, &lt->currBlk);
 
+				ltsResetReadAhead(lt);
 				if(lt->currPos.blkNum != lt->firstBlkNum)
-					ltsReadBlock(lts, lt->firstBlkNum, &lt->currBlk);
+					ltsReadTapeBlock(lts, lt, lt->firstBlkNum);
+				ltsPrefetchBlock(lts, lt->currBlk.next_blk);
 			}
 			
 			lt->currPos.blkNum = lt->firstBlkNum;
@@ -526,6 +642,7 @@ LogicalTapeRewind(LogicalTapeSet *lts, LogicalTape *lt, bool forWrite)
 	}
 	else
 	{
+		ltsResetReadAhead(lt);
 		lt->firstBlkNum = -1L;
 		lt->currBlk.prev_blk = -1L;
 		lt->currBlk.next_blk = -1L;
@@ -571,7 +688,10 @@ LogicalTapeRead(LogicalTapeSet *lts, LogicalTape *lt, void *ptr, size_t size)
 			
 			lt->currPos.blkNum = lt->currBlk.next_blk;
 			lt->currPos.offset = 0;
-			ltsReadBlock(lts, lt->currBlk.next_blk, &lt->currBlk);
+			ltsReadTapeBlock(lts, lt, lt->currBlk.next_blk);
+			if (lt->currBlk.next_blk < lt->raFirst ||
+				lt->currBlk.next_blk >= lt->raFirst + lt->raCount)
+				ltsPrefetchBlock(lts, lt->currBlk.next_blk);
 
 			if(!lt->frozen)
 			{
@@ -736,5 +856,48 @@ LogicalTape *LogicalTapeSetDuplicateTape(LogicalTapeSet *lts, LogicalTape *lt)
 	Assert(lt->frozen);
 	memcpy(dup, lt, sizeof(LogicalTape));
 
+	/* The read-ahead buffer stays with the original */
+	dup->raBuf = NULL;
+	dup->raSize = 0;
+	dup->raCount = 0;
+	dup->raUsed = 0;
+	dup->raFirst = -1L;
+
 	return dup;
 }
+
+/*
+ * Read the tape ahead by nblocks blocks, or stop if nblocks is 0 or 1.
+ *
+ * The buffer is allocated in the current memory context.  Reading a block
+ * that is not in the buffer reads it and the blocks following it in the
+ * file in one request, which keeps a merge from seeking to another tape
+ * for every block.
+ */
+void
+LogicalTapeSetReadAhead(LogicalTapeSet *lts, LogicalTape *lt, int nblocks)
+{
+	if (nblocks < 2)
+		nblocks = 0;
+	if (nblocks == lt->raSize)
+		return;
+
+	ltsResetReadAhead(lt);
+	if (lt->raBuf)
+		pfree(lt->raBuf);
+	lt->raBuf = NULL;
+	lt->raSize = nblocks;
+	if (nblocks > 0)
+		lt->raBuf = palloc((Size) nblocks * BLCKSZ);
+}
+
+/*
+ * Report how many blocks were read from the tape, and how many of the
+ * blocks read ahead were not of any use.
+ */
+void
+LogicalTapeGetReadStats(LogicalTape *lt, int64 *nBlocksUsed, int64 *nBlocksWasted)
+{
+	*nBlocksUsed = lt->nBlocksUsed;
+	*nBlocksWasted = lt->nBlocksWasted;
+}
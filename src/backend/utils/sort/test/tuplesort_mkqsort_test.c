@@ -0,0 +1,182 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "../tuplesort_mkqsort.c"
+
+#define NENTRIES	(1 << 14)
+#define NPARTS		4
+
+static MKLvContext test_lvctxt[2];
+static MKContext test_mkctxt;
+
+/*
+ * A two level context on int32 normalized keys. There is no fetch
+ * function, so preparing an entry only sets its level and the entry keeps
+ * the key it was given; equal keys compare equal at every level.
+ */
+static MKContext *
+init_context(void)
+{
+	memset(test_lvctxt, 0, sizeof(test_lvctxt));
+	memset(&test_mkctxt, 0, sizeof(test_mkctxt));
+
+	for (int lv = 0; lv < 2; lv++)
+	{
+		test_lvctxt[lv].typByVal = true;
+		test_lvctxt[lv].typLen = 4;
+		test_lvctxt[lv].lvtype = MKLV_TYPE_INT32;
+		test_lvctxt[lv].nkkind = MKNK_INT32;
+		test_lvctxt[lv].nkexact = true;
+		test_lvctxt[lv].mkctxt = &test_mkctxt;
+	}
+	test_mkctxt.total_lv = 2;
+	test_mkctxt.lvctxt = test_lvctxt;
+
+	return &test_mkctxt;
+}
+
+/* fill the entries with keys of kind: 0 distinct, 1 eight values, 2 equal */
+static MKEntry *
+make_entries(int kind)
+{
+	MKEntry    *a = malloc(NENTRIES * sizeof(MKEntry));
+	uint32		seed = 12345;
+
+	for (int i = 0; i < NENTRIES; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+
+		mke_blank(a + i);
+		mke_set_not_null(a + i);
+		a[i].d = 0;
+		a[i].ptr = NULL;
+		if (kind == 0)
+			a[i].nkey = seed >> 1;
+		else if (kind == 1)
+			a[i].nkey = (seed >> 16) % 8;
+		else
+			a[i].nkey = 7;
+	}
+
+	return a;
+}
+
+/* split the entries into NPARTS ranges, then sort each like a thread does */
+static void
+split_and_sort(MKEntry *a, MKContext *ctxt, int *start)
+{
+	MKQSortSplit split;
+
+	split.nparts = NPARTS;
+	split.sample = malloc(NPARTS * MKQS_PARALLEL_SAMPLE * sizeof(MKEntry));
+	split.splitters = malloc((NPARTS - 1) * sizeof(MKEntry));
+	split.distributed = malloc(NENTRIES * sizeof(MKEntry));
+	split.range = malloc(NENTRIES * sizeof(uint8));
+	split.start = start;
+	memset(start, 0, (NPARTS + 1) * sizeof(int));
+
+	mk_qsort_parallel_split(a, NENTRIES, ctxt, &split);
+
+	assert_int_equal(start[0], 0);
+	assert_int_equal(start[NPARTS], NENTRIES);
+	for (int i = 0; i < NPARTS; i++)
+	{
+		assert_true(start[i] <= start[i + 1]);
+		mk_qsort_impl(a, start[i], start[i + 1] - 1, 0, false, ctxt, false);
+	}
+
+	/* the ranges are in order, so the whole array is sorted */
+	for (int i = 1; i < NENTRIES; i++)
+		assert_true(a[i - 1].nkey <= a[i].nkey);
+
+	free(split.range);
+	free(split.distributed);
+	free(split.splitters);
+	free(split.sample);
+}
+
+void
+test__mk_qsort_parallel_split__DistinctKeys(void **state)
+{
+	MKContext  *ctxt = init_context();
+	MKEntry    *a = make_entries(0);
+	int			start[NPARTS + 1];
+
+	split_and_sort(a, ctxt, start);
+
+	/* the sample gives every range about a quarter */
+	for (int i = 0; i < NPARTS; i++)
+	{
+		assert_true(start[i + 1] - start[i] > NENTRIES / 8);
+		assert_true(start[i + 1] - start[i] < NENTRIES / 2);
+	}
+
+	free(a);
+}
+
+void
+test__mk_qsort_parallel_split__DuplicateKeys(void **state)
+{
+	MKContext  *ctxt = init_context();
+	MKEntry    *a = make_entries(1);
+	int			start[NPARTS + 1];
+
+	split_and_sort(a, ctxt, start);
+
+	/*
+	 * The splitters fall into runs of equal keys of the sample, which the
+	 * sort prepared at the second level. Every range still gets some of
+	 * the eight key values, and none gets more than three of them.
+	 */
+	for (int i = 0; i < NPARTS; i++)
+	{
+		assert_true(start[i + 1] - start[i] > 0);
+		assert_true(start[i + 1] - start[i] < NENTRIES / 2);
+	}
+
+	/* equal keys are in the same range */
+	for (int i = 1; i < NPARTS; i++)
+		assert_true(a[start[i] - 1].nkey < a[start[i]].nkey);
+
+	free(a);
+}
+
+void
+test__mk_qsort_parallel_split__EqualKeys(void **state)
+{
+	MKContext  *ctxt = init_context();
+	MKEntry    *a = make_entries(2);
+	int			start[NPARTS + 1];
+	int			nonempty = 0;
+
+	split_and_sort(a, ctxt, start);
+
+	/* equal keys cannot be split, they all end up in one range */
+	for (int i = 0; i < NPARTS; i++)
+	{
+		if (start[i + 1] > start[i])
+		{
+			assert_int_equal(start[i + 1] - start[i], NENTRIES);
+			nonempty++;
+		}
+	}
+	assert_int_equal(nonempty, 1);
+
+	free(a);
+}
+
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__mk_qsort_parallel_split__DistinctKeys),
+		unit_test(test__mk_qsort_parallel_split__DuplicateKeys),
+		unit_test(test__mk_qsort_parallel_split__EqualKeys)
+	};
+	return run_tests(tests);
+}
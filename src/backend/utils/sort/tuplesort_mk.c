@@ -99,6 +99,8 @@
 
 #include "postgres.h"
 
+#include <math.h>
+
 #include "access/heapam.h"
 #include "access/nbtree.h"
 #include "access/tuptoaster.h"
@@ -119,6 +121,9 @@
 #include "utils/tuplesort.h"
 #include "utils/pg_locale.h"
 #include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/numeric.h"
+#include "utils/timestamp.h"
 #include "utils/tuplesort_mk.h"
 #include "utils/string_wrapper.h"
 #include "utils/faultinjector.h"
@@ -193,6 +198,10 @@ typedef struct TupsortMergeReadCtxt
 
     int mem_allowed;
     int mem_used;
+
+    /* tape read statistics when the run was started, for the read amplification */
+    int64 blocksUsed;
+    int64 blocksWasted;
 } TupsortMergeReadCtxt;
 
 
@@ -359,6 +368,12 @@ struct Tuplesortstate_mk
 	uint64 memUsedBeforeSpill; /* memory that is used by Sort at the time of spilling */
 	long arraySizeBeforeSpill; /* the value for entry_allocsize at the time of spilling */
 
+	/* Runs read by merges: read-ahead per tape, and blocks read per block used */
+	int mergeRunsRead;
+	int mergeReadAheadBlocks;
+	double mergeReadAmpSum;
+	double mergeReadAmpMax;
+
     /* 
      * File for dump/load logical tape set.  Used by sharing sort across slice
      */
@@ -458,6 +473,7 @@ static void puttuple_common(Tuplesortstate_mk *state, MKEntry *e);
 static void selectnewtape_mk(Tuplesortstate_mk *state);
 static void mergeruns(Tuplesortstate_mk *state);
 static void beginmerge(Tuplesortstate_mk *state);
+static int tuplesort_merge_order_mk(long allowedMem);
 static uint32 getlen(Tuplesortstate_mk *state, TuplesortPos_mk *pos, LogicalTape *lt, bool eofOK);
 static void markrunend(Tuplesortstate_mk *state, int tapenum);
 
@@ -482,6 +498,8 @@ static void readtup_datum(Tuplesortstate_mk *state, TuplesortPos_mk *pos, MKEntr
         LogicalTape *lt, uint32 len);
 
 static void tupsort_prepare_char(MKEntry *a, bool isChar);
+static void tupsort_prepare_normkey(MKEntry *a, MKLvContext *lvctxt);
+static MKNormKeyKind normkey_kind(PGFunction cmp);
 static int tupsort_compare_char(MKEntry *v1, MKEntry *v2, MKLvContext *lvctxt, MKContext *mkContext);
 
 static Datum tupsort_fetch_datum_mtup(MKEntry *a, MKContext *mkctxt, MKLvContext *lvctxt, bool *isNullOut);
@@ -660,6 +678,7 @@ create_mksort_context(
     mkctxt->cpfr = tupsort_cpfr;
     mkctxt->freeTup = freeTupleFn;
     mkctxt->estimatedExtraForPrep = 0;
+    mkctxt->parallel = false;
 
     lc_guess_strxfrm_scaling_factor(&mkctxt->strxfrmScaleFactor, &mkctxt->strxfrmConstantFactor);
 
@@ -696,6 +715,8 @@ create_mksort_context(
         sinfo->attno = attNums ? attNums[i] : i+1;
 
         sinfo->lvtype = MKLV_TYPE_NONE;
+        sinfo->nkkind = MKNK_NONE;
+        sinfo->nkexact = false;
 
         if (tupdesc)
         {
@@ -711,6 +732,14 @@ create_mksort_context(
                 else if (sinfo->fmgrinfo.fn_addr == bttextcmp)
                     sinfo->lvtype = MKLV_TYPE_TEXT;
             }
+
+            /* Normalized keys follow the order of a comparison function */
+            if (sinfo->sortfnkind == SORTFUNC_CMP || sinfo->sortfnkind == SORTFUNC_REVCMP)
+                sinfo->nkkind = normkey_kind(sinfo->fmgrinfo.fn_addr);
+            sinfo->nkexact = sinfo->nkkind != MKNK_NONE &&
+                sinfo->nkkind != MKNK_NUMERIC &&
+                sinfo->nkkind != MKNK_TEXT &&
+                sinfo->nkkind != MKNK_BPCHAR;
         }
         else
         {
@@ -1032,6 +1061,16 @@ tuplesort_finalize_stats_mk(Tuplesortstate_mk *state)
 				Max(state->instrument->workmemwanted, memwanted);
 		}
 
+		if (state->explainbuf && state->mergeRunsRead > 0)
+			appendStringInfo(state->explainbuf,
+							 "%d runs merged with merge order %d, %d KB read-ahead per tape"
+							 "; read amplification %.2f avg, %.2f max.\n",
+							 state->mergeRunsRead,
+							 state->tapeRange,
+							 state->mergeReadAheadBlocks * (BLCKSZ / 1024),
+							 state->mergeReadAmpSum / state->mergeRunsRead,
+							 state->mergeReadAmpMax);
+
 		state->statsFinalized = true;
     }
 }
@@ -1274,7 +1313,14 @@ tuplesort_performsort_mk(Tuplesortstate_mk *state)
              * amount of memory.  Just qsort 'em and we're done.
              */
             if(state->mkctxt.limit == 0)
-                mk_qsort(state->entries, state->entry_count, &state->mkctxt);
+            {
+                if (gp_mk_sort_parallel_workers > 0 &&
+                    mk_qsort_parallel_safe(&state->mkctxt))
+                    mk_qsort_parallel(state->entries, state->entry_count,
+                                      &state->mkctxt, gp_mk_sort_parallel_workers);
+                else
+                    mk_qsort(state->entries, state->entry_count, &state->mkctxt);
+            }
             else
                 tuplesort_limit_sort(state);
 
@@ -1665,6 +1711,32 @@ tuplesort_merge_order(long allowedMem)
     return mOrder;
 }
 
+/*
+ * tuplesort_merge_order_mk - merge order of an mk sort
+ *
+ * With gp_mk_sort_merge_readahead, every input tape also needs its
+ * read-ahead buffer, so fewer tapes are merged at a time.  The runs are
+ * then merged in more passes, but each pass reads its tapes in long
+ * sequential stretches, which is much faster on rotating disks.
+ */
+static int
+tuplesort_merge_order_mk(long allowedMem)
+{
+    long		readAhead = gp_mk_sort_merge_readahead * 1024L;
+    int			mOrder;
+
+    if (readAhead == 0)
+        return tuplesort_merge_order(allowedMem);
+
+    mOrder = (allowedMem - TAPE_BUFFER_OVERHEAD) /
+        (MERGE_BUFFER_SIZE + TAPE_BUFFER_OVERHEAD + readAhead);
+
+    mOrder = Max(mOrder, MINORDER);
+    mOrder = Min(mOrder, MAXORDER);
+
+    return mOrder;
+}
+
 /*
  * inittapes - initialize for tape sorting.
  *
@@ -1680,7 +1752,7 @@ inittapes_mk(Tuplesortstate_mk *state, const char* rwfile_prefix)
     Assert(is_under_sort_ctxt(state));
 
     /* Compute number of tapes to use: merge order plus 1 */
-    maxTapes = tuplesort_merge_order(state->memAllowed) + 1;
+    maxTapes = tuplesort_merge_order_mk(state->memAllowed) + 1;
 
 #ifdef PRINT_SPILL_AND_MEMORY_MESSAGES
     elog(INFO, "Spilling after %d", (int) state->entry_count);
@@ -2070,6 +2142,26 @@ mergeonerun_mk(Tuplesortstate_mk *state)
         PG_TRACE1(tuplesort__mergeonerun, state->activeTapes);
 }
 
+/*
+ * A merge has read all of a run: account for the blocks read to do it.
+ */
+static void tupsort_merge_run_done(TupsortMergeReadCtxt *ctxt)
+{
+    Tuplesortstate_mk *state = ctxt->tsstate;
+    int64 used;
+    int64 wasted;
+    double amp;
+
+    LogicalTapeGetReadStats(ctxt->pos.cur_work_tape, &used, &wasted);
+    used -= ctxt->blocksUsed;
+    wasted -= ctxt->blocksWasted;
+
+    amp = (used > 0) ? (double) (used + wasted) / used : 1.0;
+    state->mergeRunsRead++;
+    state->mergeReadAmpSum += amp;
+    state->mergeReadAmpMax = Max(state->mergeReadAmpMax, amp);
+}
+
 static bool tupsort_preread(TupsortMergeReadCtxt *ctxt)
 {
     uint32 tuplen;
@@ -2098,6 +2190,7 @@ static bool tupsort_preread(TupsortMergeReadCtxt *ctxt)
         else
         {
             ctxt->pos.eof_reached = true;
+            tupsort_merge_run_done(ctxt);
             break;
         }
     }
@@ -2143,6 +2236,7 @@ beginmerge(Tuplesortstate_mk *state)
     int 		totalSlots;
     int			slotsPerTape;
     long		spacePerTape;
+    long		readAheadPerTape;
 
     int i;
 
@@ -2224,6 +2318,28 @@ beginmerge(Tuplesortstate_mk *state)
 
     state->mkhreader_allocsize = activeTapes;
 
+    /*
+     * Give each input tape a read-ahead buffer of up to
+     * gp_mk_sort_merge_readahead, out of half the memory left, and take it
+     * off its share of preread space.  The buffer is shrunk to at most half
+     * of that share, so the merge stays within memAllowed.  Tapes that are
+     * not read by this merge give up theirs.
+     */
+    readAheadPerTape = (state->memAllowed - (long) MemoryContextGetCurrentSpace(state->sortcontext)) /
+        (2 * activeTapes);
+    readAheadPerTape = Min(readAheadPerTape, gp_mk_sort_merge_readahead * 1024L);
+    readAheadPerTape = Min(readAheadPerTape, spacePerTape / 2);
+    readAheadPerTape = Max(readAheadPerTape, 0);
+    state->mergeReadAheadBlocks = readAheadPerTape / BLCKSZ;
+    if (state->mergeReadAheadBlocks < 2)
+        state->mergeReadAheadBlocks = 0;
+    spacePerTape -= state->mergeReadAheadBlocks * BLCKSZ;
+
+    for (srcTape = 0; srcTape < state->maxTapes; srcTape++)
+        LogicalTapeSetReadAhead(state->tapeset,
+                                LogicalTapeSetGetTape(state->tapeset, srcTape),
+                                state->mergeactive[srcTape] ? state->mergeReadAheadBlocks : 0);
+
     for (i=0, srcTape = 0; srcTape < state->maxTapes; srcTape++)
     {
         if (state->mergeactive[srcTape])
@@ -2232,6 +2348,8 @@ beginmerge(Tuplesortstate_mk *state)
 
             mkhr_ctxt->pos.cur_work_tape = LogicalTapeSetGetTape(state->tapeset, srcTape);
             mkhr_ctxt->pos.eof_reached = false;
+            LogicalTapeGetReadStats(mkhr_ctxt->pos.cur_work_tape,
+                                    &mkhr_ctxt->blocksUsed, &mkhr_ctxt->blocksWasted);
             mkhr_ctxt->mem_allowed = spacePerTape;
             Assert(mkhr_ctxt->mem_allowed > 0);
             mkhr_ctxt->mem_used = 0;
@@ -3155,6 +3273,36 @@ static Datum tupsort_fetch_datum_itup(MKEntry *a, MKContext *mkctxt, MKLvContext
     return d;
 }
 
+/*
+ * Can the entries of this context be sorted by several threads?
+ *
+ * The threads must not palloc, elog or call functions through fmgr. So all
+ * keys must be int4, compared by their normalized keys, fetched by
+ * one of our fetch functions, which only read the tuple, and never copied,
+ * which needs palloc. Unique sorts free tuples and may raise errors.
+ */
+bool mk_qsort_parallel_safe(MKContext *mkctxt)
+{
+    int lv;
+
+    if (mkctxt->fetchForPrep != tupsort_fetch_datum_mtup &&
+        mkctxt->fetchForPrep != tupsort_fetch_datum_itup)
+        return false;
+
+    if (mkctxt->unique || mkctxt->enforceUnique || mkctxt->limit != 0)
+        return false;
+
+    for (lv = 0; lv < mkctxt->total_lv; lv++)
+    {
+        MKLvContext *lvctxt = mkctxt->lvctxt + lv;
+
+        if (lvctxt->lvtype != MKLV_TYPE_INT32 || !lvctxt->typByVal)
+            return false;
+    }
+
+    return true;
+}
+
 void tupsort_prepare(MKEntry *a, MKContext *mkctxt, int lv)
 {
     MKLvContext *lvctxt = mkctxt->lvctxt + lv;
@@ -3175,6 +3323,9 @@ void tupsort_prepare(MKEntry *a, MKContext *mkctxt, int lv)
         tupsort_prepare_char(a, true);
     else if (lvctxt->lvtype == MKLV_TYPE_TEXT)
         tupsort_prepare_char(a, false);
+
+    if (lvctxt->nkkind != MKNK_NONE && !isnull)
+        tupsort_prepare_normkey(a, lvctxt);
 }
 
 /* "True" length (not counting trailing blanks) of a BpChar */
@@ -3190,6 +3341,179 @@ static inline int bcTruelen(char *p, int len)
     return i + 1;
 }
 
+/**
+ * The kind of normalized key that orders like the given btree comparison function
+ */
+static MKNormKeyKind normkey_kind(PGFunction cmp)
+{
+    if (cmp == btint2cmp)
+        return MKNK_INT16;
+    if (cmp == btint4cmp || cmp == date_cmp)
+        return MKNK_INT32;
+    if (cmp == btint8cmp)
+        return MKNK_INT64;
+    if (cmp == btoidcmp)
+        return MKNK_OID;
+    if (cmp == btfloat4cmp)
+        return MKNK_FLOAT4;
+    if (cmp == btfloat8cmp)
+        return MKNK_FLOAT8;
+    if (cmp == timestamp_cmp)
+    {
+#ifdef HAVE_INT64_TIMESTAMP
+        return MKNK_INT64;
+#else
+        return MKNK_FLOAT8;
+#endif
+    }
+    if (cmp == numeric_cmp)
+        return MKNK_NUMERIC;
+
+    /* Only the C collation compares strings byte by byte */
+    if (lc_collate_is_c())
+    {
+        if (cmp == bttextcmp)
+            return MKNK_TEXT;
+        if (cmp == bpcharcmp)
+            return MKNK_BPCHAR;
+    }
+    return MKNK_NONE;
+}
+
+#define NKEY_SIGN_BIT   (UINT64CONST(1) << 63)
+
+/* Flip the sign bit, so that signed integers order as unsigned ones */
+static inline uint64 normkey_int(int64 i)
+{
+    return ((uint64) i) ^ NKEY_SIGN_BIT;
+}
+
+/*
+ * As btfloat8cmp: -0 equals 0, and NaNs are equal to each other and larger
+ * than anything else. Negative floats order backwards by their bits.
+ */
+static inline uint64 normkey_float(float8 f)
+{
+    uint64 bits;
+
+    if (isnan(f))
+        return ~UINT64CONST(0);
+    if (f == 0.0)
+        f = 0.0;
+
+    memcpy(&bits, &f, sizeof(bits));
+    return (bits & NKEY_SIGN_BIT) ? ~bits : (bits | NKEY_SIGN_BIT);
+}
+
+/* The first 8 bytes of a string, zero padded: shorter strings sort first */
+static inline uint64 normkey_bytes(const char *p, int len)
+{
+    uint64 key = 0;
+    int i;
+
+    for (i = 0; i < sizeof(key); i++)
+    {
+        key <<= 8;
+        if (i < len)
+            key |= (unsigned char) p[i];
+    }
+    return key;
+}
+
+/*
+ * A numeric is stored as its weight, sign and display scale, and its base
+ * 10000 digits without leading or trailing zeros. The key holds the sign
+ * in the top 2 bits (negative, zero, positive, NaN), then the biased weight
+ * and the first 3 digits, complemented for a negative number.
+ */
+static uint64 normkey_numeric(const char *p, int len)
+{
+    int16 weight;
+    uint16 sign_dscale;
+    int ndigits = (len - 2 * sizeof(int16)) / sizeof(int16);
+    uint64 key;
+    int i;
+
+    memcpy(&weight, p, sizeof(int16));
+    memcpy(&sign_dscale, p + sizeof(int16), sizeof(uint16));
+
+    if ((sign_dscale & NUMERIC_SIGN_MASK) != NUMERIC_POS &&
+        (sign_dscale & NUMERIC_SIGN_MASK) != NUMERIC_NEG)
+        return ~UINT64CONST(0);
+    if (ndigits == 0)
+        return UINT64CONST(1) << 62;
+
+    /* 16 bits of weight and 3 digits of 14 bits */
+    key = (uint16) ((int32) weight + 0x8000);
+    for (i = 0; i < 3; i++)
+    {
+        int16 digit = 0;
+
+        if (i < ndigits)
+            memcpy(&digit, p + (2 + i) * sizeof(int16), sizeof(int16));
+        key = (key << 14) | (uint16) digit;
+    }
+
+    if ((sign_dscale & NUMERIC_SIGN_MASK) == NUMERIC_NEG)
+        return (~key & ((UINT64CONST(1) << 58) - 1)) << 4;
+    return (UINT64CONST(2) << 62) | (key << 4);
+}
+
+/**
+ * Set the normalized key of an entry prepared with a non-null datum
+ */
+static void tupsort_prepare_normkey(MKEntry *a, MKLvContext *lvctxt)
+{
+    uint64 key = 0;
+
+    switch (lvctxt->nkkind)
+    {
+        case MKNK_INT16:
+            key = normkey_int(DatumGetInt16(a->d));
+            break;
+        case MKNK_INT32:
+            key = normkey_int(DatumGetInt32(a->d));
+            break;
+        case MKNK_INT64:
+            key = normkey_int(DatumGetInt64(a->d));
+            break;
+        case MKNK_OID:
+            key = DatumGetObjectId(a->d);
+            break;
+        case MKNK_FLOAT4:
+            key = normkey_float(DatumGetFloat4(a->d));
+            break;
+        case MKNK_FLOAT8:
+            key = normkey_float(DatumGetFloat8(a->d));
+            break;
+        case MKNK_NUMERIC:
+        case MKNK_TEXT:
+        case MKNK_BPCHAR:
+            {
+                char *p;
+                int len;
+                void *tofree = NULL;
+
+                varattrib_untoast_ptr_len(a->d, &p, &len, &tofree);
+                if (lvctxt->nkkind == MKNK_NUMERIC)
+                    key = normkey_numeric(p, len);
+                else if (lvctxt->nkkind == MKNK_BPCHAR)
+                    key = normkey_bytes(p, bcTruelen(p, len));
+                else
+                    key = normkey_bytes(p, len);
+
+                if (tofree)
+                    pfree(tofree);
+            }
+            break;
+        default:
+            Assert(!"Never reach here");
+    }
+
+    /* Keys order ascending, a reversed sort complements them */
+    a->nkey = (lvctxt->sortfnkind == SORTFUNC_CMP) ? key : ~key;
+}
+
 /**
  * should only be called for non-null Datum (caller must check the isnull flag from the fetch)
  */
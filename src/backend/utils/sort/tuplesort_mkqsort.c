@@ -11,6 +11,10 @@
  */
 
 #include "postgres.h"
+
+#include <pthread.h>
+
+#include "utils/memutils.h"
 #include "utils/tuplesort.h"
 #include "utils/tuplesort_mk.h"
 
@@ -41,7 +45,7 @@ static inline int32 mkqs_comp(MKEntry *a, MKEntry *b, MKLvContext *ctxt, MKConte
 	int ret = a->compflags - b->compflags;
 
 	if (ret == 0 && !mke_is_null(a))
-		ret = tupsort_compare_datum(a, b, ctxt, mkctxt);
+		ret = mke_compare_datum(a, b, ctxt, mkctxt);
 
 	return ret;
 }
@@ -259,7 +263,9 @@ void mk_qsort_impl(MKEntry *a, int left, int right, int lv, bool lvdown, MKConte
 	Assert(ctxt);
 	Assert(lv < ctxt->total_lv);
 
-    CHECK_FOR_INTERRUPTS();
+	/* Worker threads must not process interrupts, see mk_qsort_parallel */
+	if (!ctxt->parallel)
+		CHECK_FOR_INTERRUPTS();
 
 	if(right <= left)
 		return;
@@ -325,6 +331,234 @@ void mk_qsort_impl(MKEntry *a, int left, int right, int lv, bool lvdown, MKConte
 #endif
 }
 
+/*
+ * Parallel sort.
+ *
+ * The entries are prepared at the first level and distributed into one
+ * range of first level keys per thread, with splitters taken from a sorted
+ * sample. Every range is then sorted by mk_qsort_impl in its own thread,
+ * the backend sorting the first one. The ranges are in order, so nothing
+ * needs to be merged. Entries with equal first level keys always fall into
+ * the same range; a sort whose first key has few distinct values gains
+ * little.
+ *
+ * The caller must have checked the context with mk_qsort_parallel_safe:
+ * the threads must not palloc, elog or process interrupts.
+ */
+
+/* Fewer entries per range than this are not worth a thread */
+#define MKQS_PARALLEL_MIN_ENTRIES	(1 << 15)
+
+/* Sample entries per range, to choose the splitters */
+#define MKQS_PARALLEL_SAMPLE		64
+
+/*
+ * Stack of a sort thread. The sort recurses into all three parts of a
+ * partition, so it gets more than the 256K of gp_pthread_create.
+ */
+#define MKQS_THREAD_STACK_SIZE		(4 * 1024 * 1024)
+
+/* Buffers of mk_qsort_parallel_split, allocated by the caller */
+typedef struct MKQSortSplit
+{
+	int			nparts;
+	MKEntry    *sample;			/* nparts * MKQS_PARALLEL_SAMPLE entries */
+	MKEntry    *splitters;		/* nparts - 1 entries */
+	MKEntry    *distributed;	/* n entries */
+	uint8	   *range;			/* n range numbers */
+	int		   *start;			/* nparts + 1 range starts, zeroed */
+} MKQSortSplit;
+
+typedef struct MKQSortPart
+{
+	MKEntry    *a;
+	int			left;
+	int			right;			/* inclusive */
+	MKContext  *ctxt;
+
+	pthread_t	thread;
+	bool		started;
+} MKQSortPart;
+
+static void *
+mk_qsort_part_thread(void *arg)
+{
+	MKQSortPart *part = (MKQSortPart *) arg;
+
+	gp_set_thread_sigmasks();
+
+	mk_qsort_impl(part->a, part->left, part->right, 0, false, part->ctxt, false);
+
+	return NULL;
+}
+
+static bool
+mk_qsort_start_thread(MKQSortPart *part)
+{
+	pthread_attr_t attr;
+	int			ret;
+
+	if (pthread_attr_init(&attr) != 0)
+		return false;
+
+	ret = pthread_attr_setstacksize(&attr, MKQS_THREAD_STACK_SIZE);
+	if (ret == 0)
+		ret = pthread_create(&part->thread, &attr, mk_qsort_part_thread, part);
+	pthread_attr_destroy(&attr);
+
+	if (ret != 0)
+	{
+		elog(DEBUG1, "could not create mk sort thread, error %d", ret);
+		return false;
+	}
+	part->started = true;
+	return true;
+}
+
+/*
+ * Return the range of an entry prepared at the first level: the number of
+ * splitters not greater than it.
+ */
+static inline int
+mkqs_find_range(MKEntry *e, MKEntry *splitters, int nsplitters, MKContext *mkctxt)
+{
+	int			lo = 0;
+	int			hi = nsplitters;
+
+	while (lo < hi)
+	{
+		int			mid = (lo + hi) / 2;
+
+		if (mkqs_comp(splitters + mid, e, mkctxt->lvctxt, mkctxt) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/*
+ * Prepare the entries at the first level and reorder them into ranges of
+ * first level keys, in order. Range i is split->start[i] ..
+ * split->start[i + 1] - 1 afterwards.
+ */
+static void
+mk_qsort_parallel_split(MKEntry *a, int n, MKContext *ctxt, MKQSortSplit *split)
+{
+	int			nparts = split->nparts;
+	int			nsample = nparts * MKQS_PARALLEL_SAMPLE;
+	MKEntry    *sample = split->sample;
+	MKEntry    *splitters = split->splitters;
+	uint8	   *range = split->range;
+	int		   *start = split->start;
+	int			i;
+
+	mk_prepare_array(a, 0, n - 1, 0, ctxt);
+
+	/* Choose the splitters from an evenly spaced sample */
+	for (i = 0; i < nsample; i++)
+		sample[i] = a[(int) ((int64) n * i / nsample)];
+	mk_qsort_impl(sample, 0, nsample - 1, 0, false, ctxt, false);
+	for (i = 1; i < nparts; i++)
+		splitters[i - 1] = sample[i * MKQS_PARALLEL_SAMPLE];
+
+	/*
+	 * Sorting the sample prepared its ties at deeper levels, whose level
+	 * bits would make such a splitter compare below every entry of the
+	 * first level. Compare the splitters at the first level only.
+	 */
+	mk_prepare_array(splitters, 0, nparts - 2, 0, ctxt);
+
+	/* Distribute the entries into the ranges */
+	for (i = 0; i < n; i++)
+	{
+		range[i] = mkqs_find_range(a + i, splitters, nparts - 1, ctxt);
+		start[range[i] + 1]++;
+	}
+	for (i = 1; i <= nparts; i++)
+		start[i] += start[i - 1];
+	for (i = 0; i < n; i++)
+		split->distributed[start[range[i]]++] = a[i];
+	memcpy(a, split->distributed, n * sizeof(MKEntry));
+
+	/* start[i] has moved to the start of range i + 1 */
+	for (i = nparts; i > 0; i--)
+		start[i] = start[i - 1];
+	start[0] = 0;
+}
+
+void
+mk_qsort_parallel(MKEntry *a, int n, MKContext *ctxt, int nworkers)
+{
+	int			nparts = Min(nworkers + 1, n / MKQS_PARALLEL_MIN_ENTRIES);
+	MKQSortPart *parts;
+	MKQSortSplit split;
+	int			i;
+
+	Assert(mk_qsort_parallel_safe(ctxt));
+	Assert(nworkers < 256);
+
+	if (nparts < 2 || (Size) n * sizeof(MKEntry) > MaxAllocSize)
+	{
+		mk_qsort(a, n, ctxt);
+		return;
+	}
+
+	/* Allocate all memory up front, the threads cannot */
+	parts = palloc0(nparts * sizeof(MKQSortPart));
+	split.nparts = nparts;
+	split.sample = palloc(nparts * MKQS_PARALLEL_SAMPLE * sizeof(MKEntry));
+	split.splitters = palloc((nparts - 1) * sizeof(MKEntry));
+	split.distributed = palloc(n * sizeof(MKEntry));
+	split.range = palloc(n * sizeof(uint8));
+	split.start = palloc0((nparts + 1) * sizeof(int));
+
+	mk_qsort_parallel_split(a, n, ctxt, &split);
+
+	for (i = 0; i < nparts; i++)
+	{
+		parts[i].a = a;
+		parts[i].left = split.start[i];
+		parts[i].right = split.start[i + 1] - 1;
+		parts[i].ctxt = ctxt;
+	}
+
+	CHECK_FOR_INTERRUPTS();
+
+	ctxt->parallel = true;
+
+	for (i = 1; i < nparts; i++)
+		mk_qsort_start_thread(&parts[i]);
+
+	/* The backend sorts the first range, and any range lacking a thread */
+	for (i = 0; i < nparts; i++)
+	{
+		if (!parts[i].started)
+			mk_qsort_impl(a, parts[i].left, parts[i].right, 0, false, ctxt, false);
+	}
+
+	for (i = 1; i < nparts; i++)
+	{
+		if (parts[i].started)
+			pthread_join(parts[i].thread, NULL);
+	}
+
+	ctxt->parallel = false;
+
+	pfree(split.start);
+	pfree(split.range);
+	pfree(split.distributed);
+	pfree(split.splitters);
+	pfree(split.sample);
+	pfree(parts);
+
+	CHECK_FOR_INTERRUPTS();
+
+#ifdef MKQSORT_VERIFY 
+	mkqsort_verify(a, 0, n - 1, ctxt);
+#endif
+}
+
 #ifdef MKQSORT_VERIFY 
 static int mkqsort_comp_entry_all_lv(MKEntry *a, MKEntry *b, MKContext *mkctxt)
 {
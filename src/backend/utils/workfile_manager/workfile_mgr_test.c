@@ -14,6 +14,7 @@
 #include "cdb/cdbvars.h"
 #include "executor/execWorkfile.h"
 #include "miscadmin.h"
+#include "portability/instr_time.h"
 #include "postmaster/primary_mirror_mode.h"
 #include "storage/bfz.h"
 #include "storage/buffile.h"
@@ -69,6 +70,7 @@ static bool cache_test_evict_stress(void);
 static bool cache_test_clear(void);
 
 static bool bfz_test_reopen(void);
+static bool bfz_compression_throughput(void);
 static bool execworkfile_buffile_test(void);
 static bool execworkfile_bfz_zlib_test(void);
 static bool execworkfile_bfz_uncompressed_test(void);
@@ -118,6 +120,7 @@ static test_def test_defns[] = {
 		{"cache_test_evict_stress", cache_test_evict_stress},
 		{"cache_test_clear", cache_test_clear},
 		{"bfz_test_reopen", bfz_test_reopen},
+		{"bfz_compression_throughput", bfz_compression_throughput},
 		{"execworkfile_buffile_test", execworkfile_buffile_test},
 		{"execworkfile_bfz_zlib_test", execworkfile_bfz_zlib_test},
 		{"execworkfile_bfz_uncompressed_test", execworkfile_bfz_uncompressed_test},
@@ -1166,6 +1169,110 @@ bfz_test_reopen(void)
 	return unit_test_summary();
 }
 
+/*
+ * Compares the spill throughput of the bfz compression algorithms.
+ *
+ * Writes and reads back the same spill-like data with every algorithm this
+ * server is built with, and logs the throughput and compression ratio of
+ * each one. Fails only if the data read back differs from what was written.
+ */
+static bool
+bfz_compression_throughput(void)
+{
+	const char *algorithms[] = {"none", "zlib", "lz4", "zstd"};
+	const int chunk_size = 1024 * 1024;
+	const int nchunks = 64;
+	int i;
+	int j;
+
+	unit_test_reset();
+
+	elog(LOG, "Running test: bfz_compression_throughput");
+
+	/*
+	 * Build a chunk of rows looking like those of a spilled hash table:
+	 * a few integer columns and a text column with repeated words.
+	 */
+	StringInfo chunk = makeStringInfo();
+	int row = 0;
+	while (chunk->len < chunk_size)
+	{
+		appendStringInfo(chunk, "%d|%d|%u|Customer#%09d|%s|",
+						 row, row % 97, (unsigned) row * 2654435761U, row / 7,
+						 (row % 3 == 0) ? "BUILDING" : "MACHINERY");
+		row++;
+	}
+
+	StringInfo filename = makeStringInfo();
+	appendStringInfo(filename,
+						"%s/%s",
+						PG_TEMP_FILES_DIR,
+						"Test_bfz_throughput.dat");
+
+	char *result = palloc(chunk_size);
+
+	for (i = 0; i < lengthof(algorithms); i++)
+	{
+		int compress = bfz_string_to_compression(algorithms[i]);
+		instr_time start_time;
+		instr_time write_time;
+		instr_time read_time;
+		bool match = true;
+
+		if (compress < 0)
+		{
+			elog(LOG, "Skipping sub-test: compression %s is not available", algorithms[i]);
+			continue;
+		}
+
+		elog(LOG, "Running sub-test: compression %s", algorithms[i]);
+
+		INSTR_TIME_SET_CURRENT(start_time);
+		bfz_t * fileWrite = bfz_create(filename->data, false, compress);
+		fileWrite->del_on_close = false;
+		for (j = 0; j < nchunks; j++)
+		{
+			bfz_append(fileWrite, chunk->data, chunk_size);
+		}
+		int64 file_size = bfz_append_end(fileWrite);
+		INSTR_TIME_SET_CURRENT(write_time);
+		INSTR_TIME_SUBTRACT(write_time, start_time);
+
+		INSTR_TIME_SET_CURRENT(start_time);
+		bfz_t * fileRead = bfz_open(filename->data, true, compress);
+		bfz_scan_begin(fileRead);
+		for (j = 0; j < nchunks; j++)
+		{
+			if (bfz_scan_next(fileRead, result, chunk_size) != chunk_size ||
+				memcmp(result, chunk->data, chunk_size) != 0)
+			{
+				match = false;
+				break;
+			}
+		}
+		bfz_close(fileRead, true);
+		INSTR_TIME_SET_CURRENT(read_time);
+		INSTR_TIME_SUBTRACT(read_time, start_time);
+
+		double mbytes = (double) chunk_size * nchunks / (1024.0 * 1024.0);
+		elog(LOG, "compression %s: write %.1f MB/s, read %.1f MB/s, ratio %.2f",
+			 algorithms[i],
+			 mbytes / Max(INSTR_TIME_GET_DOUBLE(write_time), 1e-6),
+			 mbytes / Max(INSTR_TIME_GET_DOUBLE(read_time), 1e-6),
+			 file_size > 0 ? (double) chunk_size * nchunks / file_size : 0.0);
+
+		unit_test_result(match);
+	}
+
+	pfree(result);
+	pfree(filename->data);
+	pfree(chunk->data);
+	pfree(filename);
+	pfree(chunk);
+
+	return unit_test_summary();
+}
+
 /*
  * Creates a StringInfo object holding n_chars characters.
  */
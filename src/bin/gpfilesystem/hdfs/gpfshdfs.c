@@ -44,6 +44,8 @@ PG_FUNCTION_INFO_V1(gpfs_hdfs_read);
 PG_FUNCTION_INFO_V1(gpfs_hdfs_write);
 PG_FUNCTION_INFO_V1(gpfs_hdfs_seek);
 PG_FUNCTION_INFO_V1(gpfs_hdfs_tell);
+PG_FUNCTION_INFO_V1(gpfs_hdfs_pread);
+PG_FUNCTION_INFO_V1(gpfs_hdfs_preadv);
 
 PG_FUNCTION_INFO_V1(gpfs_hdfs_truncate);
 
@@ -63,6 +65,8 @@ Datum gpfs_hdfs_read(PG_FUNCTION_ARGS);
 Datum gpfs_hdfs_write(PG_FUNCTION_ARGS);
 Datum gpfs_hdfs_seek(PG_FUNCTION_ARGS);
 Datum gpfs_hdfs_tell(PG_FUNCTION_ARGS);
+Datum gpfs_hdfs_pread(PG_FUNCTION_ARGS);
+Datum gpfs_hdfs_preadv(PG_FUNCTION_ARGS);
 
 Datum gpfs_hdfs_truncate(PG_FUNCTION_ARGS);
 
@@ -632,6 +636,126 @@ gpfs_hdfs_tell(PG_FUNCTION_ARGS)
 	PG_RETURN_INT64(retval);
 }
 
+/*
+ * Read length bytes at position, or less at the end of the file. libhdfs has
+ * no positional read, so seek first, but only if the file is not positioned
+ * there already: sequential callers then keep the block reader of the file.
+ * Return bytes read, or -1 on failure.
+ */
+static int
+hdfs_pread_internal(hdfsFS hdfs, hdfsFile hFile, int64_t position,
+					char *buf, int length)
+{
+	int done = 0;
+
+	if (hdfsTell(hdfs, hFile) != position &&
+		hdfsSeek(hdfs, hFile, position) != 0)
+		return -1;
+
+	while (done < length)
+	{
+		int ret = hdfsRead(hdfs, hFile, buf + done, length - done);
+
+		if (ret < 0)
+			return -1;
+		if (ret == 0)
+			break;
+		done += ret;
+	}
+
+	return done;
+}
+
+/*
+ * int hdfsPread(hdfsFS fileSystem, hdfsFile file, int64_t position,
+ *               void * buffer, int length);
+ */
+Datum
+gpfs_hdfs_pread(PG_FUNCTION_ARGS)
+{
+	int retval = 0;
+	hdfsFS hdfs = NULL;
+	hdfsFile hFile = NULL;
+	char *buf = NULL;
+	int length = 0;
+	int64_t pos = 0;
+
+	/* Must be called via the filesystem manager */
+	if (!CALLED_AS_GPFILESYSTEM(fcinfo)) {
+		elog(WARNING, "cannot execute gpfs_hdfs_pread outside filesystem manager");
+		retval = -1;
+		errno = EINVAL;
+		PG_RETURN_INT32(retval);
+	}
+
+	hdfs = FSYS_UDF_GET_HDFS(fcinfo);
+	hFile = FSYS_UDF_GET_HFILE(fcinfo);
+	buf = FSYS_UDF_GET_DATABUF(fcinfo);
+	length = FSYS_UDF_GET_BUFLEN(fcinfo);
+	pos = FSYS_UDF_GET_POS(fcinfo);
+	/* no elog below, positional reads may run in a helper thread */
+	if (NULL == hdfs || NULL == hFile || NULL == buf || length < 0 || pos < 0) {
+		retval = -1;
+		errno = EINVAL;
+		PG_RETURN_INT32(retval);
+	}
+
+	retval = hdfs_pread_internal(hdfs, hFile, pos, buf, length);
+
+	PG_RETURN_INT32(retval);
+}
+
+/*
+ * int hdfsPreadv(hdfsFS fileSystem, hdfsFile file, FileReadRange * ranges,
+ *                int nranges);
+ *
+ * Ranges are read in the given order, callers sort them by offset so that
+ * adjacent ranges need no seek. The bytes read are set in each range.
+ */
+Datum
+gpfs_hdfs_preadv(PG_FUNCTION_ARGS)
+{
+	int retval = 0;
+	hdfsFS hdfs = NULL;
+	hdfsFile hFile = NULL;
+	FileReadRange *ranges = NULL;
+	int nranges = 0;
+
+	/* Must be called via the filesystem manager */
+	if (!CALLED_AS_GPFILESYSTEM(fcinfo)) {
+		elog(WARNING, "cannot execute gpfs_hdfs_preadv outside filesystem manager");
+		retval = -1;
+		errno = EINVAL;
+		PG_RETURN_INT32(retval);
+	}
+
+	hdfs = FSYS_UDF_GET_HDFS(fcinfo);
+	hFile = FSYS_UDF_GET_HFILE(fcinfo);
+	ranges = FSYS_UDF_GET_RANGES(fcinfo);
+	nranges = FSYS_UDF_GET_NRANGES(fcinfo);
+	/* no elog below, positional reads may run in a helper thread */
+	if (NULL == hdfs || NULL == hFile || NULL == ranges || nranges < 0) {
+		retval = -1;
+		errno = EINVAL;
+		PG_RETURN_INT32(retval);
+	}
+
+	for (int i = 0; i < nranges; i++)
+	{
+		FileReadRange *range = &ranges[i];
+
+		range->bytesRead = hdfs_pread_internal(hdfs, hFile, range->offset,
+											   range->buffer, range->length);
+		if (range->bytesRead < 0)
+		{
+			retval = -1;
+			break;
+		}
+	}
+
+	PG_RETURN_INT32(retval);
+}
+
 /*
  * int hdfsTruncate(hdfsFS fileSystem, const char * path, int64_t size);
  */
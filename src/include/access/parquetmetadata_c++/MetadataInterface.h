@@ -84,6 +84,10 @@ typedef struct ColumnChunkMetadata_4C
 	int64_t file_offset;
 
 	int64_t firstDataPage;
+
+	/* Byte offset of the dictionary page, 0 if chunk is not dictionary encoded */
+	int64_t dictionaryPageOffset;
+
 	long valueCount;
 
     /* total byte size of all compressed pages in this column chunk (including the headers) */
@@ -92,6 +96,17 @@ typedef struct ColumnChunkMetadata_4C
     /* total byte size of all uncompressed pages in this column chunk (including the headers) */
 	int64_t totalUncompressedSize;
 
+	/*
+	 * Column chunk statistics, used to skip row groups during scan.
+	 * min/max are only kept for fixed-width ordered types, stored in
+	 * PLAIN encoding (statisticsValueLen is 4 or 8, 0 if no min/max).
+	 */
+	int hasStatistics;
+	int64_t nullCount;
+	int statisticsValueLen;
+	uint8_t minValue[8];
+	uint8_t maxValue[8];
+
 } ColumnChunkMetadata_4C;
 
 /* rowgroup metadata */
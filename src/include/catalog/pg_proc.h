@@ -10363,6 +10363,14 @@ DESCR("enables transformations in the optimizer");
 DATA(insert OID = 6089 ( gp_opt_version  PGNSP PGUID 12 f f t f i 0 25 f "" _null_ _null_ _null_ gp_opt_version - _null_ n ));
 DESCR("Returns the optimizer and gpos library versions");
 
+/* gp_opt_plan_cache_stats() => text */ 
+DATA(insert OID = 8087 ( gp_opt_plan_cache_stats  PGNSP PGUID 12 f f t f v 0 25 f "" _null_ _null_ _null_ gp_opt_plan_cache_stats - _null_ n ));
+DESCR("Returns statistics of the optimizer plan cache of the session");
+
+/* gp_opt_plan_cache_clear() => text */ 
+DATA(insert OID = 8088 ( gp_opt_plan_cache_clear  PGNSP PGUID 12 f f t f v 0 25 f "" _null_ _null_ _null_ gp_opt_plan_cache_clear - _null_ n ));
+DESCR("Clears the optimizer plan cache of the session");
+
 /* tablespace_support_truncate(oid) => bool */
 DATA(insert OID = 6118 ( tablespace_support_truncate  PGNSP PGUID 12 f f t f i 1 16 f "26" _null_ _null_ _null_ tablespace_support_truncate - _null_ n ));
 DESCR("Test if table space support truncate feature");
@@ -10387,6 +10395,14 @@ DESCR("Check whether metadata cache key exists");
 DATA(insert OID = 8083 ( gp_metadata_cache_info  PGNSP PGUID 12 f f t f s 4 25 f "26 26 26 23" _null_ _null_ _null_ gp_metadata_cache_info - _null_ n ));
 DESCR("Get metadata cache info for specific key");
 
+/* gp_metadata_cache_stats() => SETOF record */ 
+DATA(insert OID = 8085 ( gp_metadata_cache_stats  PGNSP PGUID 12 f f t t v 0 2249 f "" _null_ _null_ _null_ gp_metadata_cache_stats - _null_ n ));
+DESCR("Get metadata cache statistics per relation");
+
+/* gp_metadata_cache_stats_reset() => text */ 
+DATA(insert OID = 8086 ( gp_metadata_cache_stats_reset  PGNSP PGUID 12 f f t f v 0 25 f "" _null_ _null_ _null_ gp_metadata_cache_stats_reset - _null_ n ));
+DESCR("Reset metadata cache statistics");
+
 
 /* TIDYCAT_END_PG_PROC_GEN */
 
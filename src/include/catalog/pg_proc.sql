@@ -5502,6 +5502,10 @@
 
  CREATE FUNCTION gp_opt_version() RETURNS text LANGUAGE internal IMMUTABLE STRICT AS 'gp_opt_version' WITH (OID=6089, DESCRIPTION="Returns the optimizer and gpos library versions");
 
+ CREATE FUNCTION gp_opt_plan_cache_stats() RETURNS text LANGUAGE internal VOLATILE STRICT AS 'gp_opt_plan_cache_stats' WITH (OID=8087, DESCRIPTION="Returns statistics of the optimizer plan cache of the session");
+
+ CREATE FUNCTION gp_opt_plan_cache_clear() RETURNS text LANGUAGE internal VOLATILE STRICT AS 'gp_opt_plan_cache_clear' WITH (OID=8088, DESCRIPTION="Clears the optimizer plan cache of the session");
+
  CREATE FUNCTION gp_metadata_cache_clear() RETURNS text LANGUAGE internal STABLE STRICT AS 'gp_metadata_cache_clear' WITH (OID=8080, DESCRIPTION="Clear all metadata cache content");
 
  CREATE FUNCTION gp_metadata_cache_current_num() RETURNS int8 LANGUAGE internal STABLE STRICT AS 'gp_metadata_cache_current_num' WITH (OID=8081, DESCRIPTION="Get metadata cache current entry number");
@@ -5511,5 +5515,9 @@
  CREATE FUNCTION gp_metadata_cache_exists(tablespace_oid, database_oid, relation_oid, segno) RETURNS bool LANGUAGE internal STABLE STRICT AS 'gp_metadata_cache_exists' WITH (OID=8082, DESCRIPTION="Check whether metadata cache key exists");
 
  CREATE FUNCTION gp_metadata_cache_info(tablespace_oid, database_oid, relation_oid, segno) RETURNS text LANGUAGE internal STABLE STRICT AS 'gp_metadata_cache_info' WITH (OID=8083, DESCRIPTION="Get metadata cache info for specific key");
+
+ CREATE FUNCTION gp_metadata_cache_stats() RETURNS SETOF record LANGUAGE internal VOLATILE STRICT AS 'gp_metadata_cache_stats' WITH (OID=8085, DESCRIPTION="Get metadata cache statistics per relation");
+
+ CREATE FUNCTION gp_metadata_cache_stats_reset() RETURNS text LANGUAGE internal VOLATILE STRICT AS 'gp_metadata_cache_stats_reset' WITH (OID=8086, DESCRIPTION="Reset metadata cache statistics");
  
  CREATE FUNCTION dump_resource_manager_status(info_type) RETURNS text LANGUAGE internal STABLE STRICT AS 'dump_resource_manager_status' WITH (OID=6450, DESCRIPTION="Dump resource manager status for testing");
@@ -55,6 +55,7 @@ typedef struct CdbCopy
 	PartitionNode *partitions;
 	List		  *ao_segnos;
 	HTAB		  *aotupcounts; /* hash of ao relation id to processed tuple count */
+	bool		raw_chunks;		/* send unparsed chunks of lines, see gp_copy_raw_chunks */
 } CdbCopy;
 
 
@@ -42,6 +42,14 @@ typedef struct DispatchCommandQueryParms
 	int			serializedSliceInfolen;
 	char		*serializedQueryResource;
 	int			serializedQueryResourcelen;
+
+	/*
+	 * Reference to the query tree, plan, slice info and resource in the
+	 * shared plan cache of the segment, sent to executors which don't get
+	 * them directly. NULL unless gp_dispatch_plan_per_host.
+	 */
+	char		*sharedPlanRef;
+	int			sharedPlanReflen;
 	
 	/*
 	 * serialized DTX context string
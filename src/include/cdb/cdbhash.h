@@ -84,6 +84,72 @@ extern void cdbhashnokey(CdbHash *h);
  */
 extern unsigned int cdbhashreduce(CdbHash *h);
 
+/*
+ * Fast hashing of fixed-width values for hash tables that live within a
+ * query, such as HashAgg. These values differ from cdbhash, never use them
+ * to distribute data.
+ */
+typedef enum CdbHashMixKind
+{
+	CDBHASH_MIX_NONE = 0,		/* no kernel, call the hash function */
+	CDBHASH_MIX_INT2,
+	CDBHASH_MIX_INT4,			/* int4 and oid */
+	CDBHASH_MIX_INT8,
+	CDBHASH_MIX_CHAR			/* "char" and bool */
+} CdbHashMixKind;
+
+/*
+ * Return the kernel equivalent to the hash function hashfn, that is, values
+ * equal for the function's type get equal hashes.
+ */
+extern CdbHashMixKind cdbhashmixkind(Oid hashfn);
+
+/* finalizers of MurmurHash3 */
+static inline uint32
+cdbhashmix32(uint32 h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+static inline uint32
+cdbhashmix64(uint64 k)
+{
+	k ^= k >> 33;
+	k *= UINT64CONST(0xff51afd7ed558ccd);
+	k ^= k >> 33;
+	k *= UINT64CONST(0xc4ceb9fe1a85ec53);
+	k ^= k >> 33;
+	return (uint32) k;
+}
+
+/*
+ * Hash a single non-null value with the kernel, kind must not be
+ * CDBHASH_MIX_NONE.
+ */
+static inline uint32
+cdbhashmix(CdbHashMixKind kind, Datum value)
+{
+	switch (kind)
+	{
+		case CDBHASH_MIX_INT2:
+			return cdbhashmix32((uint32) (int32) DatumGetInt16(value));
+		case CDBHASH_MIX_INT4:
+			return cdbhashmix32(DatumGetUInt32(value));
+		case CDBHASH_MIX_INT8:
+			return cdbhashmix64((uint64) DatumGetInt64(value));
+		case CDBHASH_MIX_CHAR:
+			return cdbhashmix32((uint32) (unsigned char) DatumGetChar(value));
+		default:
+			Assert(false);
+			return 0;
+	}
+}
+
 /*
  * Return true if Oid is hashable internally in Greenplum Database.
  */
@@ -39,6 +39,10 @@ void DumpHdfsFileBlockLocations(BlockLocation *locations, int block_num);
 
 void RemoveHdfsFileBlockLocations(const HdfsFileInfo *file_info);
 
+BlockLocation *PutHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation *hdfs_locations, int block_num, uint64_t fetch_time);
+
+bool HdfsFileBlockLocationsCached(const HdfsFileInfo *file_info);
+
 MetadataCacheEntry *MetadataCacheNew(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation *hdfs_locations, int block_num);
 
 /*
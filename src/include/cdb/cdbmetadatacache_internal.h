@@ -19,6 +19,11 @@
 #define FREE_BLOCK_NUM              (MetadataCacheSharedDataInstance->free_block_num)
 #define FREE_BLOCK_HEAD             (MetadataCacheSharedDataInstance->free_block_head)
 
+#define END_OF_SLOT                 -1
+
+/* usage count limit of the clock sweep, as in the buffer manager */
+#define METADATA_CACHE_MAX_USAGE    5
+
 typedef struct MetadataHdfsBlockInfo
 {
     uint32_t            node_num;
@@ -37,6 +42,8 @@ typedef struct MetadataCacheSharedData
     uint32_t    cur_hosts_idx;
     uint32_t    cur_names_idx;
     uint32_t    cur_topologyPaths_idx;
+    uint32_t    free_slot_head;
+    uint32_t    clock_hand;
 } MetadataCacheSharedData;
 
 /*
@@ -59,8 +66,51 @@ typedef struct MetadataCacheEntry
     uint32_t            last_block_id;
     uint32_t            create_time;
     uint32_t            last_access_time;
+    uint32_t            clock_slot;         // slot in the clock ring
+    uint32_t            usage_count;        // clock sweep usage count
+    uint32_t            access_count;       // accesses since the entry is filled
 } MetadataCacheEntry;
 
+/*
+ *  Metadata Cache Clock Ring, one slot per cache entry
+ */
+typedef struct MetadataCacheClockSlot
+{
+    MetadataCacheKey    key;
+    bool                in_use;
+    uint32_t            next_free_slot;
+} MetadataCacheClockSlot;
+
+/*
+ *  Metadata Cache Statistics, one entry per relation file node
+ */
+typedef struct MetadataCacheStatKey
+{
+    uint32_t            tablespace_oid;
+    uint32_t            database_oid;
+    uint32_t            relation_oid;
+} MetadataCacheStatKey;
+
+typedef struct MetadataCacheStatEntry
+{
+    MetadataCacheStatKey    key;
+    uint64_t            hits;
+    uint64_t            partial_hits;
+    uint64_t            misses;
+    uint64_t            evictions;
+    uint64_t            refreshes;
+    uint64_t            lookup_time;        // time spent in lookups, in us
+    uint64_t            fetch_time;         // time spent fetching from hdfs for lookups, in us
+    uint64_t            refresh_time;       // time spent fetching from hdfs for refreshes, in us
+} MetadataCacheStatEntry;
+
+typedef enum MetadataCacheLookupType
+{
+    METADATA_CACHE_LOOKUP_HIT       = 0,
+    METADATA_CACHE_LOOKUP_PARTIAL_HIT,
+    METADATA_CACHE_LOOKUP_MISS,
+} MetadataCacheLookupType;
+
 /*
  *  Metadata Cache Process Structure
  */
@@ -71,6 +121,7 @@ typedef struct MetadataCacheCheckInfo
     uint32_t    block_num;
     uint32_t    create_time;
     uint32_t    last_access_time;
+    uint32_t    access_count;
 } MetadataCacheCheckInfo;
 
 
@@ -78,9 +129,17 @@ extern MetadataCacheSharedData  *MetadataCacheSharedDataInstance;
 extern HTAB                     *MetadataCache;
 extern MetadataHdfsBlockInfo    *MetadataBlockArray;
 
-extern List                     *MetadataCacheLRUList;
 extern List                     *MetadataCacheRefreshList;
 
 BlockLocation *CreateHdfsFileBlockLocations(BlockLocation *hdfs_locations, int block_num);
 
+/*
+ *  Following functions must be called with MetadataCacheLock held exclusively
+ */
+void MetadataCacheRemoveEntry(MetadataCacheEntry *entry);
+
+bool MetadataCacheEvict(uint32_t free_block_num, const MetadataCacheKey *pinned);
+
+void MetadataCacheRecordRefresh(const MetadataCacheKey *key, uint64_t refresh_time);
+
 #endif
@@ -65,6 +65,15 @@ typedef struct ParquetScanDescData {
 
 	List *splits;
 	bool toCloseFile; // identify if it's ready to close segment file
+
+	/*
+	 * list of ParquetRowGroupPredicate built from scan quals, used to skip
+	 * row groups by column chunk statistics. NIL if no filter.
+	 */
+	List *rowGroupFilter;
+
+	/* read-ahead of column chunks, NULL if disabled */
+	ParquetPrefetcher *prefetcher;
 } ParquetScanDescData;
 
 typedef ParquetScanDescData *ParquetScanDesc;
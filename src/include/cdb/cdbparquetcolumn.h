@@ -9,6 +9,7 @@
 #define CDBPARQUETCOLUM_H_
 
 #include "cdb/cdbparquetstoragewrite.h"
+#include "cdb/cdbparquetprefetch.h"
 
 #define DAFAULT_DATAPAGE_NUM_PER_COLUMNCHUNK 10
 
@@ -48,6 +49,32 @@ typedef struct ParquetColumnReader
 	char 							*dataBuffer;
 	int32							dataLen;
 
+    /*
+     * Non-repeatable (r == 0) column chunk is streamed: `dataBuffer` is a
+     * window over the chunk holding a few pages, [windowStart, windowEnd)
+     * are the bytes not consumed yet. The window is refilled from `file`
+     * when the next page is not entirely in it, so memory is bounded by
+     * max(gp_parquet_scan_buffer_size, largest page) rather than chunk size.
+     * Only the current page is kept, in dataPages[0].
+     *
+     * Repeatable column reads the whole column chunk into `dataBuffer`,
+     * since values of one record may span multiple pages.
+     */
+    bool                            streaming;
+    File                            file;
+    int64                           fileOffset;          /* next file offset to read */
+    int64                           chunkBytesRemained;  /* bytes not read into window yet */
+    int64                           chunkValuesRemained; /* values in pages not read yet */
+    int32                           windowStart;
+    int32                           windowEnd;
+
+    /*
+     * Next window of a streaming column is read ahead by `prefetcher` (NULL
+     * if disabled) into `prefetch`, while the current window is decoded.
+     */
+    ParquetPrefetcher               *prefetcher;
+    ParquetPrefetchRequest          *prefetch;
+
     /*
      * For compressed non-repeatable (r == 0) column, we reuse a shared buffer
      * `pageBuffer` to store decompressed content for each page to save memory.
@@ -62,6 +89,19 @@ typedef struct ParquetColumnReader
     char                            *pageBuffer;
     int32                           pageBufferLen;
 
+    /*
+     * Decoded dictionary of current column chunk, `dictionarySize` is 0 if
+     * the chunk is not dictionary encoded. The dictionary page is copied, or
+     * decompressed, into `dictionaryBuffer` and decoded once into
+     * `dictionary`; entries of by-reference types point into
+     * `dictionaryBuffer`, which lives until the next dictionary page.
+     */
+    Datum                           *dictionary;
+    int                             dictionarySize;
+    int                             dictionaryCapacity;
+    char                            *dictionaryBuffer;
+    int32                           dictionaryBufferLen;
+
 	/*buffer reused for embedded type, avoid palloc each time for each tuple*/
     void                            *geoval;
 } ParquetColumnReader;
@@ -71,9 +111,19 @@ extern void ParquetExecutorReadColumn(
 		ParquetColumnReader *columnReaders,
 		File file);
 
+extern void ParquetExecutorReadColumns(
+		ParquetColumnReader *columnReaders,
+		int count,
+		File file);
+
 extern void ParquetColumnReader_readValue(ParquetColumnReader *columnReader,
 		Datum *value, bool *null, int hawqTypeID);
 
+extern bool ParquetColumnReader_canReadBatch(ParquetColumnReader *columnReader, int hawqTypeID);
+
+extern int ParquetColumnReader_readBatch(ParquetColumnReader *columnReader,
+		Datum *values, bool *nulls, int maxValues, int hawqTypeID);
+
 extern void ParquetColumnReader_readPoint(ParquetColumnReader readers[], Datum *value, bool *null);
 extern void ParquetColumnReader_readLSEG(ParquetColumnReader readers[], Datum *value, bool *null);
 extern void ParquetColumnReader_readPATH(ParquetColumnReader readers[], Datum *value, bool *null);
@@ -0,0 +1,136 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbparquetprefetch.h
+ *	  Read-ahead of parquet column chunk data by background threads.
+ *
+ * A parquet scan streams each projected column chunk through a window (see
+ * cdbparquetcolumn.h). The prefetcher lets the scan ask for the next range
+ * of a column chunk before it is needed: the range is read by one of a few
+ * work threads into a buffer of the request, so reads of all projected
+ * columns proceed in parallel and overlap with page decoding. The scan later
+ * takes the data out of the request, waiting only if the read is still in
+ * progress.
+ *
+ * Work threads read through their own RawFile handles of the current
+ * segment file, which are opened by the backend; the threads call only pread
+ * or libhdfs3, never touch backend memory contexts or report errors. Files
+ * of other filesystems are not read ahead. All buffers are allocated by the
+ * backend within gp_parquet_prefetch_memory. The threads are stopped when
+ * the scan ends or its (sub)transaction aborts.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef CDBPARQUETPREFETCH_H
+#define CDBPARQUETPREFETCH_H
+
+#include "postgres.h"
+#include "cdb/cdbthreadwork.h"
+#include "lib/stringinfo.h"
+#include "nodes/pg_list.h"
+#include "portability/instr_time.h"
+#include "storage/fd.h"
+
+#define PARQUET_PREFETCH_WORKERS	4
+
+typedef enum ParquetPrefetchState
+{
+	PREFETCH_IDLE = 0,		/* no read, or data all taken */
+	PREFETCH_QUEUED,		/* waiting for a free worker */
+	PREFETCH_RUNNING,		/* being read by a worker */
+	PREFETCH_DONE			/* read finished, data not taken yet */
+} ParquetPrefetchState;
+
+typedef struct ParquetPrefetchRequest
+{
+	ParquetPrefetchState state;
+
+	int64		offset;			/* file offset of the range */
+	int32		length;			/* length of the range */
+	int32		taken;			/* bytes already taken by the scan */
+
+	char	   *buffer;
+	int32		bufferLen;
+
+	/* set by the work thread */
+	int32		bytesRead;		/* -1 on failure */
+	instr_time	readTime;
+	char		errmsg[256];
+} ParquetPrefetchRequest;
+
+typedef struct ParquetPrefetchWorker
+{
+	ThreadWork	threadWork;
+	bool		started;
+	RawFile		file;			/* handle of the current segment file */
+	ParquetPrefetchRequest *request;	/* request being read, or NULL */
+} ParquetPrefetchWorker;
+
+/*
+ * Statistics reported by EXPLAIN ANALYZE. `ioTime` is the total time spent
+ * in background reads, `stallTime` the time the scan waited for them; the
+ * rest of the I/O time overlapped with decoding.
+ */
+typedef struct ParquetPrefetchStats
+{
+	int64		reads;			/* ranges read in background */
+	int64		bytes;			/* bytes read in background */
+	int64		syncReads;		/* window fills without read-ahead data */
+	instr_time	ioTime;
+	instr_time	stallTime;
+} ParquetPrefetchStats;
+
+typedef struct ParquetPrefetcher
+{
+	MemoryContext memoryContext;
+
+	char	   *fileName;		/* current segment file, NULL if none */
+	int64		budget;			/* bytes allowed for request buffers */
+	int64		memoryUsed;		/* bytes of request buffers allocated */
+
+	List	   *requests;		/* all requests, for cancel and cleanup */
+	List	   *queue;			/* QUEUED requests in issue order */
+
+	ParquetPrefetchWorker workers[PARQUET_PREFETCH_WORKERS];
+
+	ParquetPrefetchStats stats;
+
+	SubTransactionId subid;		/* subtransaction the scan belongs to */
+	struct ParquetPrefetcher *next;	/* in the list of active prefetchers */
+} ParquetPrefetcher;
+
+/* Create a prefetcher, return NULL if read-ahead is disabled */
+extern ParquetPrefetcher *ParquetPrefetch_Create(MemoryContext memoryContext);
+
+/* Stop work threads and free all resources of the prefetcher */
+extern void ParquetPrefetch_Destroy(ParquetPrefetcher *prefetcher);
+
+/* Set the segment file subsequent requests read from */
+extern void ParquetPrefetch_SetFile(ParquetPrefetcher *prefetcher,
+									char *fileName);
+
+/* Cancel all requests and close handles of the current segment file */
+extern void ParquetPrefetch_CloseFile(ParquetPrefetcher *prefetcher);
+
+/* Allocate an idle request, it is owned by the prefetcher */
+extern ParquetPrefetchRequest *ParquetPrefetch_CreateRequest(
+									ParquetPrefetcher *prefetcher);
+
+/* Start reading a range of the current file, false if out of budget */
+extern bool ParquetPrefetch_Start(ParquetPrefetcher *prefetcher,
+								  ParquetPrefetchRequest *request,
+								  int64 offset, int32 length);
+
+/* Copy read-ahead data at `offset` into `buffer`, return bytes copied */
+extern int32 ParquetPrefetch_Take(ParquetPrefetcher *prefetcher,
+								  ParquetPrefetchRequest *request,
+								  int64 offset, char *buffer, int32 length);
+
+/* Discard the request's data, waiting for the read if it is in progress */
+extern void ParquetPrefetch_Cancel(ParquetPrefetcher *prefetcher,
+								   ParquetPrefetchRequest *request);
+
+/* Append statistics for EXPLAIN ANALYZE to buf */
+extern void ParquetPrefetch_Explain(ParquetPrefetcher *prefetcher,
+									StringInfo buf);
+
+#endif   /* CDBPARQUETPREFETCH_H */
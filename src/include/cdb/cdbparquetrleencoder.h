@@ -155,4 +155,6 @@ extern void RLEDecoder_Init(RLEDecoder *decoder, int bitWidth, uint8_t *in, int
 
 extern int  RLEDecoder_ReadInt(RLEDecoder *decoder);
 
+extern void RLEDecoder_ReadInts(RLEDecoder *decoder, int *values, int count);
+
 #endif /* CDBPARQUETRLEENCODER_H_ */
@@ -14,6 +14,11 @@
 #include "access/filesplit.h"
 #include "access/htup.h"
 #include "executor/tuptable.h"
+#include "fmgr.h"
+#include "nodes/pg_list.h"
+
+/* number of rows decoded at a time for columns read in batches */
+#define PARQUET_SCAN_BATCH_SIZE	1024
 
 typedef struct ParquetRowGroupReader
 {
@@ -23,10 +28,50 @@ typedef struct ParquetRowGroupReader
 	int					rowRead;
 	ParquetColumnReader	*columnReaders;
 	int					columnReaderCount;
+
+	/*
+	 * Decoded values of columns which are read in batches (see
+	 * ParquetColumnReader_readBatch), indexed by column reader. Entries are
+	 * NULL for columns read value by value. All batched columns are refilled
+	 * together, `batchRead` of `batchSize` rows have been returned.
+	 */
+	Datum				**batchValues;
+	bool				**batchNulls;
+	int					batchSize;
+	int					batchRead;
+
 	/* synthetic system attributes */
 	ItemPointerData 	cdb_fake_ctid;
 } ParquetRowGroupReader;
 
+/*
+ * Kind of qual clause which can be checked against column chunk statistics
+ */
+typedef enum ParquetRowGroupPredicateKind
+{
+	PARQUET_PREDICATE_COMPARE,		/* var op const */
+	PARQUET_PREDICATE_ISNULL,		/* var IS NULL */
+	PARQUET_PREDICATE_ISNOTNULL		/* var IS NOT NULL */
+} ParquetRowGroupPredicateKind;
+
+/*
+ * A simple qual clause on one column. A row group may contain matching
+ * tuples only if minCheck(min, constValue) and maxCheck(max, constValue)
+ * both hold for its column chunk, otherwise the row group is skipped
+ * without reading its data.
+ */
+typedef struct ParquetRowGroupPredicate
+{
+	ParquetRowGroupPredicateKind kind;
+	int					attnum;		/* 0-based hawq attribute index */
+	int					hawqTypeID;
+	Datum				constValue;
+	bool				checkMin;
+	FmgrInfo			minCheck;
+	bool				checkMax;
+	FmgrInfo			maxCheck;
+} ParquetRowGroupPredicate;
+
 /* read row group initialization*/
 void
 ParquetRowGroupReader_Init(
@@ -38,7 +83,13 @@ ParquetRowGroupReader_Init(
 bool ParquetRowGroupReader_GetRowGroupInfo(
     FileSplit split, ParquetStorageRead *storageRead,
     ParquetRowGroupReader *rowGroupReader, bool *projs, TupleDesc hawqTupleDesc,
-    int *hawqAttrToParquetColChunks, bool toCloseFile);
+    int *hawqAttrToParquetColChunks, List *rowGroupFilter, bool toCloseFile);
+
+/* Build row group filter (list of ParquetRowGroupPredicate) from scan quals*/
+List *
+ParquetRowGroupFilter_Create(
+	List					*qual,
+	TupleDesc				hawqTupleDesc);
 
 /* Get contents of row group*/
 void
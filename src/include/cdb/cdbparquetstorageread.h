@@ -12,6 +12,7 @@
 #include "catalog/pg_compression.h"
 #include "cdb/cdbparquetfooterprocessor.h"
 #include "cdb/cdbappendonlystoragelayer.h"
+#include "cdb/cdbparquetprefetch.h"
 
 /*
  * This structure contains read session information.  Consider the fields
@@ -50,6 +51,9 @@ typedef struct ParquetStorageRead {
 
 	bool             preRead;
 
+	/* Read-ahead of column chunks, owned by the scan. NULL if disabled. */
+	ParquetPrefetcher *prefetcher;
+
 } ParquetStorageRead;
 
 
@@ -17,6 +17,7 @@
 #include "cdb/cdbparquetrleencoder.h"
 #include "cdb/cdbparquetbytepacker.h"
 #include "cdb/cdbparquetfooterprocessor.h"
+#include "lib/stringinfo.h"
 
 typedef struct PageMetadata_4C* ParquetPageHeader;
 typedef struct ColumnChunkMetadata_4C* ColumnChunkMetadata;
@@ -78,6 +79,7 @@ typedef struct FileField_4C* ParquetFileField;
 typedef struct ParquetDataPage_S    *ParquetDataPage;
 typedef struct ParquetColumnChunk_S *ParquetColumnChunk;
 typedef struct ParquetRowGroup_S    *ParquetRowGroup;
+typedef struct ParquetDictionary_S  *ParquetDictionary;
 
 struct ParquetDataPage_S
 {
@@ -94,6 +96,9 @@ struct ParquetDataPage_S
 	ByteBasedBitPackingEncoder	*bool_values;
 	ByteBasedBitPackingDecoder	*bool_values_reader;
 
+	/* dictionary encoded page stores RLE encoded dictionary indexes as values */
+	RLEDecoder					*dictionary_index_reader;
+
 	/* For non-bool columns, this is where the output is accumulated before compression. */
 	uint8_t						*values_buffer;
     int                         values_buffer_capacity; /* palloced size for values_buffer */
@@ -117,6 +122,34 @@ struct ParquetDataPage_S
 	File 						parquetFile;
 };
 
+/*
+ * Dictionary of a dictionary encoded column chunk.
+ *
+ * Distinct values are kept PLAIN encoded in `values`, which becomes the
+ * content of the chunk's dictionary page. Data pages of the chunk store
+ * indexes into the dictionary instead of values.
+ *
+ * Once the dictionary grows beyond pageSizeLimit, it stops accepting new
+ * entries and the rest pages of the chunk are PLAIN encoded.
+ */
+struct ParquetDictionary_S
+{
+	StringInfoData				values;			/* PLAIN encoded distinct values */
+
+	int							numEntries;
+	int							maxEntries;		/* allocated size of entryOffsets/entryChain */
+	int							*entryOffsets;	/* offset of each entry in `values` */
+	uint32						*entryHashes;	/* hash value of each entry */
+	int							*entryChain;	/* next entry in same hash bucket, -1 ends */
+
+	int							*buckets;		/* first entry of each hash bucket */
+	int							numBuckets;		/* power of 2 */
+
+	bool						fallback;		/* if true, new pages are PLAIN encoded */
+
+	struct ParquetDataPage_S	page;			/* the dictionary page */
+};
+
 struct ParquetColumnChunk_S
 {
 	ColumnChunkMetadata 		columnChunkMetadata;
@@ -142,6 +175,8 @@ struct ParquetColumnChunk_S
 
 	int                         pageSizeLimit;          /* pagesize in pg_appendonly */
 
+	ParquetDictionary			dictionary;	/* NULL if chunk is not dictionary encoded */
+
     char    					*compresstype;
     int     					compresslevel;
 
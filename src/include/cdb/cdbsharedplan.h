@@ -0,0 +1,52 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbsharedplan.h
+ *	  Sharing of a dispatched plan among the QEs of a segment host.
+ *
+ * With gp_dispatch_plan_per_host on, the QD sends the serialized query tree,
+ * plan, slice table and query resource of a statement to one QE per segment
+ * host only, the publisher. The publisher puts them into a shared memory
+ * cache of its segment, the other QEs of the statement on that host, the
+ * readers, receive a short reference to the cache entry in place of the
+ * query tree and copy the data out of the cache. An entry is freed when its
+ * last reader has copied it, or reclaimed once it has waited too long for
+ * readers which never come.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef CDBSHAREDPLAN_H
+#define CDBSHAREDPLAN_H
+
+/*
+ * Dispatch flags of the 'M' message. The number of readers a publisher has
+ * to keep the data for is in the high half of the flags.
+ */
+#define GP_DISPATCH_FLAG_PLAN_PUBLISH	0x0001
+#define GP_DISPATCH_FLAG_PLAN_SHARED	0x0002
+#define GP_DISPATCH_FLAG_READERS_SHIFT	16
+#define GP_DISPATCH_FLAG_MAX_READERS	0xFFFF
+
+/* The parts of a dispatched statement that are shared */
+typedef struct SharedPlanData
+{
+	const char *querytree;
+	int			querytreelen;
+	const char *plantree;
+	int			plantreelen;
+	const char *sliceinfo;
+	int			sliceinfolen;
+	const char *resource;
+	int			resourcelen;
+} SharedPlanData;
+
+extern Size SharedPlanShmemSize(void);
+extern void SharedPlanShmemInit(void);
+
+/* QD side: the reference readers receive in place of the query tree */
+extern char *SharedPlanBuildRef(SharedPlanData *data, int *reflen);
+
+/* QE side */
+extern void SharedPlanPublish(SharedPlanData *data, int readers);
+extern void SharedPlanFetch(const char *ref, int reflen, SharedPlanData *data);
+
+#endif   /* CDBSHAREDPLAN_H */
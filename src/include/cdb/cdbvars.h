@@ -188,6 +188,16 @@ extern int			gp_reject_percent_threshold;
  */
 extern int 			gp_max_csv_line_length;
 
+/*
+ * gp_copy_raw_chunks
+ *
+ * COPY FROM into a randomly distributed table has no distribution key to
+ * compute, so the dispatcher only splits the input into chunks of whole
+ * lines and sends them to the segments in turn, which parse the lines. The
+ * other tables are still parsed on the dispatcher to route each row.
+ */
+extern bool			gp_copy_raw_chunks;
+
 /*
  * For use while debugging DTM issues: alter MVCC semantics such that
  * "invisible" rows are returned.
@@ -454,6 +464,16 @@ extern int	Gp_interconnect_min_rto;
 extern int  Gp_interconnect_transmit_timeout;
 extern int	Gp_interconnect_min_retries_before_timeout;
 
+/*
+ * Parameter Gp_interconnect_syscall_batch_size
+ *
+ * The maximum number of packets the UDP interconnect moves per system call,
+ * with recvmmsg() in the rx thread and sendmmsg() when sending buffers.
+ * 1 disables batching, it is also ignored where these calls don't exist.
+ * The rx thread re-reads it on each pass of its receive loop.
+ */
+extern int	Gp_interconnect_syscall_batch_size;
+
 /* UDP recv buf size in KB.  For testing */
 extern int 	Gp_udp_bufsize_k;
 
@@ -863,6 +883,8 @@ extern bool gp_enable_motion_mk_sort;
 #ifdef USE_ASSERT_CHECKING
 extern bool gp_mk_sort_check;
 #endif
+extern int gp_mk_sort_parallel_workers;
+extern int gp_mk_sort_merge_readahead;
 
 extern bool trace_sort;
 
@@ -915,6 +937,13 @@ extern int gp_segworker_relative_priority;
 /*  Max size of dispatched plans; 0 if no limit */
 extern int gp_max_plan_size;
 
+/* Dispatch the plan once per segment host, see cdbsharedplan.h */
+extern bool gp_dispatch_plan_per_host;
+extern int gp_dispatch_plan_cache_size;
+
+/* Watch all executors of a query in one reused thread */
+extern bool gp_dispatch_event_driven;
+
 /* The maximum number of times on average that the hybrid hashed aggregation
  * algorithm will plan to spill an input row to disk before including it in
  * an aggregation.  Increasing this parameter will cause the planner to choose
@@ -931,6 +960,9 @@ extern bool gp_hashagg_recalc_density;
 /* If we use two stage hashagg, we can stream the bottom half */
 extern bool gp_hashagg_streambottom;
 
+/* Use an open-addressing table instead of bucket chains in hashagg */
+extern bool gp_hashagg_open_addressing;
+
 /* The default number of batches to use when the hybrid hashed aggregation
  * algorithm (re-)spills in-memory groups to disk.
  */
@@ -974,8 +1006,10 @@ extern bool force_bitmap_table_scan;
 extern int gp_hashagg_compress_spill_files;
 extern int gp_workfile_compress_algorithm;
 extern bool gp_workfile_checksumming;
+extern bool gp_workfile_async_io;
 extern bool gp_workfile_caching;
 extern bool gp_metadata_versioning;
+extern int gp_mdver_mdobj_cache_size;
 extern double gp_workfile_limit_per_segment;
 extern double gp_workfile_limit_per_query;
 extern int gp_workfile_limit_files_per_query;
@@ -1143,6 +1177,8 @@ extern double metadata_cache_free_block_normal_ratio;
 extern char *metadata_cache_testfile;
 extern bool debug_fake_datalocality;
 extern bool datalocality_remedy_enable;
+extern int datalocality_fetch_threads;
+extern int datalocality_assignment_cache_size;
 extern bool get_tmpdir_from_rm;
 extern bool debug_fake_segmentnum;
 
@@ -45,6 +45,9 @@ extern void dispmgt_free_preconnect_info(struct ConcurrentConnectExecutorInfo *i
 
 extern void dispmgt_dispatch_and_run(struct WorkerMgrState *state,
 									struct QueryExecutorTeam *team);
+extern void dispmgt_get_io_statistics(struct QueryExecutorTeam *team,
+									int *threads_num, int64 *wakeups,
+									int64 *events_num);
 
 extern bool dispmgt_concurrent_connect(List *tasks, int executors_num_per_thread);
 
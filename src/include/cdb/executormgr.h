@@ -52,6 +52,8 @@ extern void executormgr_get_executor_connection_info(struct QueryExecutor *execu
 extern bool	executormgr_is_stop(struct QueryExecutor *executor);
 extern bool	executormgr_has_error(struct QueryExecutor *executor);
 extern int	executormgr_get_executor_slice_id(struct QueryExecutor *executor);
+extern struct Segment *executormgr_get_executor_segment(struct QueryExecutor *executor);
+extern void	executormgr_set_dispatch_flags(struct QueryExecutor *executor, int flags);
 extern int	executormgr_get_fd(struct QueryExecutor *executor);
 extern bool	executormgr_cancel(struct QueryExecutor * executor);
 extern bool	executormgr_dispatch_and_run(struct DispatchData *data, struct QueryExecutor *executor);
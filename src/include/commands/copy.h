@@ -66,6 +66,11 @@ typedef enum EolType
  * distributor (COPY dispatcher, or gpfdist) embeds the original row number in
  * the beginning of each data row, and this number is extracted later on.
  *
+ * ROWNUM_CHUNKED - Used by COPY in execute mode when the dispatcher sends
+ * unparsed chunks of whole lines (see gp_copy_raw_chunks). Each chunk is
+ * preceded by a line holding the original number of its first line and the
+ * number of lines in it, and the lines of the chunk are counted from there.
+ *
  * BYTENUM_EMBEDDED - Original row isn't even known to the distributor, only
  * the byte offset of each chunk it sends. We report errors in byte offset
  * number, not row number. We keep track of byte counts. This is currently
@@ -76,6 +81,7 @@ typedef enum ErrLocType
 {
 	ROWNUM_ORIGINAL,
 	ROWNUM_EMBEDDED,
+	ROWNUM_CHUNKED,
 	BYTENUM_EMBEDDED
 } ErrLocType;
 
@@ -232,6 +238,11 @@ typedef struct CopyStateData
 #define COPY_METADATA_DELIM '^'
 	ErrLocType  err_loc_type;   /* see enum def for description */
 	bool		md_error;
+
+	/* for ROWNUM_CHUNKED */
+	bool		raw_chunks;		/* data comes in raw chunks of lines */
+	int64		chunk_lines_left;	/* lines of the current chunk not read yet */
+	bool		chunk_header;	/* line_buf holds a chunk header, not data */
 	
 	/* Error handling options */
 	CopyErrMode	errMode;
@@ -277,4 +288,13 @@ extern void truncateEol(StringInfo buf, EolType	eol_type);
 extern void setEncodingConversionProc(CopyState cstate, int client_encoding, bool iswritable);
 extern void CopyEolStrToType(CopyState cstate);
 
+/*
+ * Find the first of the bytes c1, c2 and c3 in the len bytes at s. Returns
+ * NULL if none of them is there. Maps to the fastest method the CPU
+ * supports, see copyscan.c.
+ */
+typedef char *(*CopyScanFunctionPtr)(const char *s, size_t len, char c1, char c2, char c3);
+
+extern CopyScanFunctionPtr copy_scan_bytes;
+
 #endif   /* COPY_H */
@@ -21,10 +21,35 @@
 #include "utils/memutils.h"
 #include "executor/execWorkfile.h"
 #include "utils/workfile_mgr.h"
+#include "cdb/cdbhash.h"
 
 typedef uint32 HashKey;
 typedef struct BatchFileInfo BatchFileInfo;
 
+/*
+ * How a grouping column is compared.
+ *
+ * For the common pass-by-value types whose equality operator is plain
+ * equality of the value, two keys are equal iff their normalized Datums
+ * (see normalizeGroupKey) are equal, and no function call is needed.
+ * Other columns call the equality function.
+ */
+typedef enum HashAggKeyCmp
+{
+	HASHAGG_KEYCMP_FMGR = 0,	/* call the equality function */
+	HASHAGG_KEYCMP_BOOL,
+	HASHAGG_KEYCMP_CHAR,
+	HASHAGG_KEYCMP_INT2,
+	HASHAGG_KEYCMP_INT4,		/* int4, oid, date */
+	HASHAGG_KEYCMP_INT8			/* int8, integer time and timestamp */
+} HashAggKeyCmp;
+
+/*
+ * Max number of grouping columns whose normalized keys are stored
+ * inline in the hash entries, one bit each in HashAggEntry.keynulls.
+ */
+#define HASHAGG_MAX_INLINE_KEYS 16
+
 /* An entry in an Agg hash table.
  * 
  * Each such entry corresponds to a single group and includes the grouping
@@ -37,6 +62,11 @@ typedef struct BatchFileInfo BatchFileInfo;
  * value of the grouping key.  Additional space is used for and pass-by-
  * reference Datum values in the grouping key and in transValues
  * in the per-group structure.
+ *
+ * If all grouping columns are compared without function calls (see
+ * HashAggKeyCmp), the entry also holds the normalized grouping keys, so
+ * that matching an input record against it needs no memtuple deforming.
+ * The entry is then HASHAGG_ENTRY_SIZE(numCols) bytes long.
  */
 typedef struct HashAggEntry
 {
@@ -46,8 +76,14 @@ typedef struct HashAggEntry
 						   */
 	HashKey	hashvalue;
 	bool is_primodial; /* indicate if this entry is there before spilling. */
+	uint16 keynulls; /* bitmap of the null inline keys */
+	Datum keys[1]; /* VARIABLE LENGTH ARRAY: normalized grouping keys,
+					* 0 for nulls, only if HashAggTable.inline_keys */
 } HashAggEntry;
 
+#define HASHAGG_ENTRY_SIZE(nkeys) \
+	MAXALIGN(offsetof(HashAggEntry, keys) + (nkeys) * sizeof(Datum))
+
 /* A SpillFile controls access to a temporary file used to hold  
  * transition tuples spilled from the hash table in order to free 
  * up space.
@@ -147,6 +183,27 @@ typedef enum HashAggState
 	HASHAGG_END_OF_PASSES
 } HashAggState;
 
+/*
+ * Open-addressing layout of an Agg hash table, used instead of the bucket
+ * chains when gp_hashagg_open_addressing is set.
+ *
+ * An entry is found by linear probing from slot (hashvalue >> hash_bit) &
+ * (nslots - 1). Each slot has a one-byte tag, 0 if the slot is empty and
+ * otherwise derived from the hash value, and the full hash value. Tags,
+ * hash values and entry pointers are kept in separate arrays, so that a
+ * probe mostly reads the dense tag array. The table doubles when it gets
+ * 3/4 full, as long as memory allows.
+ */
+typedef struct HashAggSlots
+{
+	unsigned nslots; /* number of slots, a power of 2 */
+	unsigned nused; /* number of non-empty slots */
+	unsigned hash_bit; /* number of bits to shift hash values by */
+	uint8 *tags;
+	HashKey *hashes;
+	HashAggEntry **entries;
+} HashAggSlots;
+
 /* An Agg hash table with associated overflow batches and processing
  * state.  
  * 
@@ -165,6 +222,10 @@ typedef struct HashAggTable
 	HashAggEntry  **buckets;
 	uint64 *bloom;
 
+	/* Open-addressing layout, used instead of the buckets if set */
+	bool open_addressing;
+	HashAggSlots slots;
+
 	/* Overflow batches */
 	SpillSet       *spill_set;
 	/* Representation of all workfile names, used by the workfile manager */
@@ -197,6 +258,18 @@ typedef struct HashAggTable
 	/* buffer for calculating the hashkey */
 	HashKey *hashkey_buf;
 
+	/* fast hashing kernel of each grouping column, or CDBHASH_MIX_NONE */
+	CdbHashMixKind *hashmixkinds;
+
+	/* how each grouping column is compared */
+	HashAggKeyCmp *keycmps;
+
+	/* true if the entries hold the normalized grouping keys */
+	bool inline_keys;
+
+	/* normalized grouping keys of the record being looked up */
+	Datum *input_keys;
+
 	/* GPDB: Statistics for EXPLAIN ANALYZE */
 	HashAggTableSizes   hats;
 
@@ -234,6 +307,7 @@ extern bool
 calcHashAggTableSizes(double memquota,	/* Memory quota in bytes. */
 					   double ngroups,	/* Est # of groups. */
 					   int numaggs,		/* Est # of aggregate functions */
+					   int numkeys,		/* # of grouping columns */
 					   int keywidth,	/* Est per entry size of hash key. */
 					   int transpace,	/* Est per entry size of by-ref values. */
                        bool force,      /* true => succeed even if work_mem too small */
@@ -141,6 +141,7 @@ ExecWorkFile_Close(ExecWorkFile *workfile);
 
 int ExecWorkFile_Seek(ExecWorkFile *workfile, uint64 offset, int whence);
 void ExecWorkFile_Flush(ExecWorkFile *workfile);
+void ExecWorkFile_Prefetch(ExecWorkFile *workfile, uint64 offset, Size amount);
 int64 ExecWorkFile_GetSize(ExecWorkFile *workfile);
 int64 ExecWorkFile_Suspend(ExecWorkFile *workfile);
 void ExecWorkFile_Restart(ExecWorkFile *workfile);
@@ -637,6 +637,24 @@ namespace gpdb {
 	// requests version for object from MD Versioning component
 	void MdVerRequestVersion(Oid key, uint64 *ddl_version, uint64 *dml_version);
 
+	// is the shared cache of translated metadata objects usable by this backend
+	bool FMdVerMDObjCacheEnabled(void);
+
+	// look up a serialized metadata object in the shared cache, returns a palloc'ed copy
+	void *PvMdVerMDObjCacheFind(const char *szKey, Size *pulLen);
+
+	// add a serialized metadata object to the shared cache
+	void MdVerMDObjCacheAdd(const char *szKey, const void *pvData, Size ulLen);
+
+	// key of a query in the optimizer plan cache, NULL if its plan must not be cached
+	char *SzOptPlanCacheKey(Query *pquery);
+
+	// look up a plan in the optimizer plan cache, returns a copy
+	PlannedStmt *PplstmtOptPlanCacheLookup(const char *szKey);
+
+	// add a plan to the optimizer plan cache
+	void OptPlanCacheInsert(const char *szKey, PlannedStmt *pplstmt);
+
 } //namespace gpdb
 
 #define ForEach(cell, l)	\
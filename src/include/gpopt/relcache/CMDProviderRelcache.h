@@ -57,6 +57,14 @@ namespace gpmd
 			// private copy ctor
 			CMDProviderRelcache(const CMDProviderRelcache&);
 
+			// do all GPDB objects the md id refers to carry a version from MD Versioning
+			static
+			BOOL FVersioned(IMDId *pmdid);
+
+			// build the key of the md id in the shared metadata object cache
+			static
+			BOOL FCacheKey(IMDId *pmdid, CHAR *szKey);
+
 		public:
 			// ctor/dtor
 			explicit
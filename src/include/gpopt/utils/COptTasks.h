@@ -222,6 +222,14 @@ class COptTasks
 		static
 		DrgPss *PdrgPssLoad(IMemoryPool *pmp, char *szPath);
 
+		// search strategy bounding join order exploration by a time budget
+		static
+		DrgPss *PdrgPssBudget(IMemoryPool *pmp, ULONG ulTimeBudget);
+
+		// number of search stages that completed within their time threshold
+		static
+		ULONG UlSearchStagesCompleted(DrgPss *pdrgpss);
+
 		// allocate memory for string
 		static
 		CHAR *SzAllocate(IMemoryPool *pmp, ULONG ulSize);
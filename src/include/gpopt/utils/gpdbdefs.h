@@ -70,6 +70,7 @@ extern "C" {
 #include "postmaster/identity.h"
 #include "utils/faultinjector.h"
 #include "utils/mdver.h"
+#include "utils/optplancache.h"
 
 extern
 Query *preprocess_query_optimizer(Query *pquery, ParamListInfo boundParams);
@@ -181,6 +181,14 @@ typedef struct PlannedStmt
 		struct QueryResource *resource;
 		int	planner_segments;
 
+		/*
+		 * Search stages of the Pivotal Query Optimizer under
+		 * optimizer_search_time_budget, and how many of them completed
+		 * before the budget ran out; both are 0 if no budget was set.
+		 */
+		int	optimizerSearchStages;
+		int	optimizerSearchStagesCompleted;
+
     /* The overall memory consumption account (i.e., outside of an operator) */
 		MemoryAccount *memoryAccount;
 
@@ -11,7 +11,14 @@
 
 #define BFZ_BUFFER_SIZE		(1<<14)
 
+/*
+ * Size of each of the two buffers of a file written behind or read ahead
+ * by the bfz I/O thread, see bfz_aio.c.
+ */
+#define BFZ_AIO_BUFFER_SIZE	(BFZ_BUFFER_SIZE * 2)
+
 struct bfz;
+struct bfz_aio;
 
 struct bfz_freeable_stuff
 {
@@ -62,15 +69,66 @@ typedef struct bfz
 
 	int64 tot_bytes;
 
+	/* Asynchronous I/O of the file, NULL if it does synchronous I/O. */
+	struct bfz_aio *aio;
+
 }	bfz_t;
 
+#if defined(HAVE_LZ4_H) && defined(HAVE_LIBLZ4)
+#define USE_BFZ_LZ4
+#endif
+
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+#define USE_BFZ_ZSTD
+#endif
+
+/*
+ * A block codec compresses every buffer written by bfz on its own,
+ * see compress_block.c.
+ */
+typedef struct bfz_block_codec
+{
+	/* state kept for the file, NULL if none; must not elog(ERROR) */
+	void	   *(*create_state) (bool compress);
+	void		(*free_state) (void *state);
+
+	/* return the compressed size, or 0 if it does not fit in dstcap */
+	int			(*compress) (void *state, const char *src, int srclen,
+							 char *dst, int dstcap);
+
+	/* return the decompressed size, or -1 if the data is corrupt */
+	int			(*decompress) (void *state, const char *src, int srclen,
+							   char *dst, int dstcap);
+
+	/* worst case compressed size of a buffer of BFZ_BUFFER_SIZE bytes */
+	int			compress_bound;
+} bfz_block_codec;
+
 /* These functions are internal to bfz. */
 extern void bfz_nothing_init(bfz_t * thiz);
 extern void bfz_zlib_init(bfz_t * thiz);
 extern void bfz_lzop_init(bfz_t * thiz);
+extern void bfz_block_init(bfz_t * thiz, const bfz_block_codec *codec);
+#ifdef USE_BFZ_LZ4
+extern void bfz_lz4_init(bfz_t * thiz);
+#endif
+#ifdef USE_BFZ_ZSTD
+extern void bfz_zstd_init(bfz_t * thiz);
+#endif
 extern void bfz_write_ex(bfz_t * thiz, const char *buffer, int size);
 extern int	bfz_read_ex(bfz_t * thiz, char *buffer, int size);
 
+/*
+ * I/O on the file descriptor of a bfz file, for the compression algorithms
+ * that do their own. They are done by the bfz I/O thread if
+ * gp_workfile_async_io is on.
+ */
+extern void bfz_aio_write(bfz_t * thiz, const char *buffer, int size);
+extern int	bfz_aio_read(bfz_t * thiz, char *buffer, int size);
+extern void bfz_aio_flush(bfz_t * thiz);
+extern void bfz_aio_free(bfz_t * thiz);
+extern Size bfz_aio_buffer_overhead(void);
+
 /* These functions are interface to bfz. */
 extern const char *bfz_compression_to_string(int compress);
 extern int	bfz_string_to_compression(const char *string);
@@ -50,6 +50,44 @@ typedef const char *FileName;
 
 typedef int File;
 
+/*
+ * file opened outside of the virtual file descriptor cache, see
+ * RawFileOpenForRead
+ */
+typedef struct RawFileData
+{
+	int			fd;			/* local file descriptor, or -1 for hdfs file */
+	hdfsFS		hFS;
+	hdfsFile	hFile;
+	char	   *hProtocol;
+} RawFileData;
+
+typedef RawFileData *RawFile;
+
+/*
+ * one range of a vectored read, see FilePreadv
+ */
+typedef struct FileReadRange
+{
+	int64		offset;
+	char	   *buffer;
+	int			length;
+	int			bytesRead;		/* set by the read, -1 on failure */
+} FileReadRange;
+
+/*
+ * one file of a batched block location lookup, see
+ * HdfsGetFileBlockLocationsBatch
+ */
+typedef struct HdfsBlockLocationRequest
+{
+	char	   *path;
+	int64		length;
+	BlockLocation *locations;	/* set by the lookup, NULL on failure */
+	int			block_num;
+	int64		elapsed;		/* time of the namenode call, in us */
+} HdfsBlockLocationRequest;
+
 
 /* GUC parameter */
 extern int	max_files_per_process;
@@ -115,6 +153,9 @@ extern void FileClose(File file);
 extern void FileUnlink(File file);
 extern int	FileRead(File file, char *buffer, int amount);
 extern int	FileReadIntr(File file, char *buffer, int amount, bool fRetryInt);
+extern int	FilePread(File file, char *buffer, int amount, int64 offset);
+extern int	FilePreadv(File file, FileReadRange *ranges, int nranges);
+extern int	FilePrefetch(File file, int64 offset, int amount);
 extern int	FileWrite(File file, const char *buffer, int amount);
 extern int	FileSync(File file);
 extern int64 FileSeek(File file, int64 offset, int whence);
@@ -123,6 +164,13 @@ extern int	FileTruncate(File file, int64 offset);
 extern int  PathFileTruncate(FileName fileName);
 extern int64 FileDiskSize(File file);
 
+/* Operations on raw files, which may be read from a helper thread */
+extern bool RawFileIsSupported(FileName fileName);
+extern RawFile RawFileOpenForRead(FileName fileName);
+extern int RawFileRead(RawFile file, int64 offset, char *buffer, int amount,
+					   char *errbuf, int errbuflen);
+extern void RawFileClose(RawFile file);
+
 /* Operations that allow use of regular stdio --- USE WITH CAUTION */
 extern FILE *AllocateFile(const char *name, const char *mode);
 extern int	FreeFile(FILE *file);
@@ -180,6 +228,9 @@ extern BlockLocation *HdfsGetFileBlockLocations2(const char *path, int64 offset,
 
 extern void HdfsFreeFileBlockLocations(BlockLocation *locations, int block_num);
 
+extern void HdfsGetFileBlockLocationsBatch(HdfsBlockLocationRequest *requests,
+										   int nrequests, int nthreads);
+
 extern FileName FileGetName(File file);
 
 extern int IsLocalPath(const char *filename);
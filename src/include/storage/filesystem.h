@@ -38,6 +38,7 @@
 #include "fmgr.h"
 #include "catalog/pg_filesystem.h"
 #include "hdfs/hdfs.h"
+#include "storage/fd.h"
 
 typedef const char *FsysName;
 
@@ -66,8 +67,23 @@ typedef struct FileSystemUdfData
 	hdfsFileInfo*   fsys_fileinfo;
 	int             fsys_fileinfonum;
 	void*			fsys_user_ctx;
+	FileReadRange*	fsys_ranges;          /* ranges of vectored read */
+	int				fsys_nranges;
 } FileSystemUdfData;
 
+/*
+ * Optional functions of a filesystem. They are not registered in
+ * pg_filesystem, but looked up in the filesystem library by the name of its
+ * read function with "read" replaced, e.g. gpfs_hdfs_pread for
+ * gpfs_hdfs_read. Missing ones are emulated with seek and read.
+ */
+typedef enum FileSystemOptFuncType
+{
+	FSYS_OPTFUNC_PREAD,			/* read fsys_maxbytes at fsys_pos */
+	FSYS_OPTFUNC_PREADV,		/* read fsys_nranges of fsys_ranges */
+	FSYS_OPTFUNC_TOTALNUM
+} FileSystemOptFuncType;
+
 #define CALLED_AS_GPFILESYSTEM(fcinfo) \
 	((fcinfo->context != NULL && IsA((fcinfo)->context, FileSystemFunctionData)))
 
@@ -88,6 +104,8 @@ typedef struct FileSystemUdfData
 #define FSYS_UDF_GET_BUFLEN(fcinfo)			(((FileSystemUdfData *) (fcinfo)->context)->fsys_maxbytes)
 #define FSYS_UDF_GET_FILEINFO(fcinfo)		(((FileSystemUdfData *) (fcinfo)->context)->fsys_fileinfo)
 #define FSYS_UDF_GET_FILEINFONUM(fcinfo)	(((FileSystemUdfData *) (fcinfo)->context)->fsys_fileinfonum)
+#define FSYS_UDF_GET_RANGES(fcinfo)			(((FileSystemUdfData *) (fcinfo)->context)->fsys_ranges)
+#define FSYS_UDF_GET_NRANGES(fcinfo)		(((FileSystemUdfData *) (fcinfo)->context)->fsys_nranges)
 
 #define FSYS_UDF_SET_HDFS(fcinfo, hdfs)       (((FileSystemUdfData *) (fcinfo)->context)->fsys_hdfs=hdfs)
 #define FSYS_UDF_SET_HFILE(fcinfo, hFile)     (((FileSystemUdfData *) (fcinfo)->context)->fsys_hfile=hFile)
@@ -113,6 +131,10 @@ int HdfsRead(FsysName protocol, hdfsFS fileSystem, hdfsFile file, void * buffer,
 int HdfsWrite(FsysName protocol, hdfsFS fileSystem, hdfsFile file, const void * buffer, int length);
 int HdfsSeek(FsysName protocol, hdfsFS fileSystem, hdfsFile file, int64_t desiredPos);
 int64_t HdfsTell(FsysName protocol, hdfsFS fileSystem, hdfsFile file);
+int HdfsPread(FsysName protocol, hdfsFS fileSystem, hdfsFile file, int64_t position,
+			  void * buffer, int length);
+int HdfsPreadv(FsysName protocol, hdfsFS fileSystem, hdfsFile file,
+			   FileReadRange * ranges, int nranges);
 
 int HdfsTruncate(FsysName protocol, hdfsFS fileSystem, char * path, int64_t size);
 
@@ -97,6 +97,8 @@ typedef enum LWLockId
 	ResQueueLock,
 	FileRepAppendOnlyCommitCountLock,
 	MDVerWriteLock,
+	MDVerMDObjCacheLock,
+	SharedPlanLock,
 	FirstWorkfileMgrLock,
 	FirstWorkfileQuerySpaceLock = FirstWorkfileMgrLock + NUM_WORKFILEMGR_PARTITIONS,
 	FirstMDVersioningLock = FirstWorkfileQuerySpaceLock + NUM_WORKFILE_QUERYSPACE_PARTITIONS,
@@ -1191,6 +1191,10 @@ extern Datum enable_xform(PG_FUNCTION_ARGS);
 /* Optimizer's version */
 extern Datum gp_opt_version(PG_FUNCTION_ARGS);
 
+/* utils/cache/optplancache.c */
+extern Datum gp_opt_plan_cache_stats(PG_FUNCTION_ARGS);
+extern Datum gp_opt_plan_cache_clear(PG_FUNCTION_ARGS);
+
 /* utils/workfile_manager/workfile_mgr_test.c */
 extern Datum gp_workfile_mgr_test_harness(PG_FUNCTION_ARGS);
 
@@ -1200,5 +1204,7 @@ extern Datum gp_metadata_cache_current_num(PG_FUNCTION_ARGS);
 extern Datum gp_metadata_cache_current_block_num(PG_FUNCTION_ARGS);
 extern Datum gp_metadata_cache_exists(PG_FUNCTION_ARGS);
 extern Datum gp_metadata_cache_info(PG_FUNCTION_ARGS);
+extern Datum gp_metadata_cache_stats(PG_FUNCTION_ARGS);
+extern Datum gp_metadata_cache_stats_reset(PG_FUNCTION_ARGS);
 
 #endif   /* BUILTINS_H */
@@ -398,6 +398,8 @@ extern int optimizer_cte_inlining_bound;
 extern double optimizer_damping_factor_filter;
 extern double optimizer_damping_factor_join;
 extern double optimizer_damping_factor_groupby;
+extern int optimizer_plan_cache_size;
+extern int optimizer_search_time_budget;
 extern int optimizer_segments;
 extern bool optimizer_analyze_root_partition;
 extern bool optimizer_analyze_midlevel_partition;
@@ -432,6 +434,30 @@ extern bool	optimizer_partition_selection_log;
  */
 extern bool gp_parquet_insert_sort;
 
+/*
+ * Skip parquet row groups during scan if column chunk min/max/null count
+ * statistics show that no tuple in it can satisfy the scan quals.
+ */
+extern bool gp_parquet_rowgroup_filter;
+
+/*
+ * Dictionary encode text-like parquet columns on insert. A column chunk falls
+ * back to PLAIN encoding once its dictionary exceeds the page size.
+ */
+extern bool gp_parquet_dictionary_encoding;
+
+/*
+ * Size (KB) of the window through which parquet scan streams pages of each
+ * non-repeated column chunk. A larger page enlarges the window as needed.
+ */
+extern int gp_parquet_scan_buffer_size;
+
+/*
+ * Memory (KB) for buffers of parquet column data read ahead by background
+ * threads during scan, 0 disables read-ahead.
+ */
+extern int gp_parquet_prefetch_memory;
+
 #if USE_EMAIL
 extern char  *gp_email_smtp_server;
 extern char  *gp_email_smtp_userid;
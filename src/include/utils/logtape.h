@@ -56,5 +56,7 @@ extern void LogicalTapeSetForgetFreeSpace(LogicalTapeSet *lts);
 
 extern LogicalTape *LogicalTapeSetGetTape(LogicalTapeSet *lts, int tapenum);
 extern LogicalTape *LogicalTapeSetDuplicateTape(LogicalTapeSet *lts, LogicalTape *lt);
+extern void LogicalTapeSetReadAhead(LogicalTapeSet *lts, LogicalTape *lt, int nblocks);
+extern void LogicalTapeGetReadStats(LogicalTape *lt, int64 *nBlocksUsed, int64 *nBlocksWasted);
 
 #endif   /* LOGTAPE_H */
@@ -17,6 +17,9 @@
 
 #define INVALID_MD_VERSION 0
 
+/* Maximum length, including the terminator, of a md id in the metadata object cache */
+#define MDVER_MDOBJ_KEY_LEN 64
+
 typedef struct mdver_entry
 {
 	Oid key; /* Key of the versioned entry */
@@ -71,6 +74,13 @@ uint64 mdver_next_global_version(void);
 void mdver_request_version(Oid key, uint64 *ddl_version, uint64 *dml_version);
 bool mdver_enabled(void);
 
+/* MD Versioning shared cache of translated metadata objects */
+void mdver_mdobj_cache_shmem_init(void);
+Size mdver_mdobj_cache_shmem_size(void);
+bool mdver_mdobj_cache_enabled(void);
+void *mdver_mdobj_cache_find(const char *key, Size *len);
+void mdver_mdobj_cache_add(const char *key, const void *data, Size len);
+
 /* inval.c */
 extern mdver_local_mdvsn *GetCurrentLocalMDVSN(void);
 
@@ -0,0 +1,19 @@
+/*-------------------------------------------------------------------------
+ *
+ * optplancache.h
+ *	  Per-backend cache of plans produced by the Pivotal Query Optimizer
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef OPTPLANCACHE_H
+#define OPTPLANCACHE_H
+
+#include "nodes/parsenodes.h"
+#include "nodes/plannodes.h"
+
+extern char *OptPlanCacheKey(Query *query);
+extern PlannedStmt *OptPlanCacheLookup(const char *key);
+extern void OptPlanCacheInsert(const char *key, PlannedStmt *stmt);
+extern long OptPlanCacheFlush(void);
+
+#endif   /* OPTPLANCACHE_H */
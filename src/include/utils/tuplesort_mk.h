@@ -45,6 +45,12 @@ typedef struct MKEntry
      */
     Datum d;
 
+    /**
+     * Normalized key of the datum, for levels with one (see MKNormKeyKind).
+     * Keys order as unsigned integers, as memcmp orders their big-endian bytes.
+     */
+    uint64 nkey;
+
     /**
      * Ptr to the tuple that contains this entry's key.  Is a void * to provide polymorphism: it could be a memtuple, heaptuple, or really anything that has multi-key behavior!
      *   Deciphering of this field is done by the functions that are passed when the multi-key heap is prepared
@@ -140,6 +146,7 @@ static inline void mke_set_empty(MKEntry *e)
     e->compflags = MKE_CF_Empty; 
     e->flags = 0;
 	e->d = 0;
+	e->nkey = 0;
 	e->ptr = 0;
 }
 static inline bool mke_is_empty(MKEntry *e)
@@ -215,6 +222,26 @@ typedef enum MKLvType
     MKLV_TYPE_TEXT,  /* this level contains text values */
 } MKLvType;
 
+/*
+ * Types for which a normalized key is kept in MKEntry.nkey, so that most
+ * comparisons need neither fmgr nor the tuple. The key of an int or float
+ * is exact; the key of a numeric or a C collation string is only a prefix,
+ * so equal keys are compared again with the sort function.
+ */
+typedef enum MKNormKeyKind
+{
+    MKNK_NONE,
+    MKNK_INT16,
+    MKNK_INT32,
+    MKNK_INT64,
+    MKNK_OID,
+    MKNK_FLOAT4,
+    MKNK_FLOAT8,
+    MKNK_NUMERIC,
+    MKNK_TEXT,
+    MKNK_BPCHAR,
+} MKNormKeyKind;
+
 typedef struct MKLvContext
 {
 	/* Is the type of datums in this level passed by value instead of reference */
@@ -229,6 +256,12 @@ typedef struct MKLvContext
     SortFunctionKind sortfnkind;
     FmgrInfo fmgrinfo;
 
+    /* kind of the normalized keys of this level, MKNK_NONE if there are none */
+    MKNormKeyKind nkkind;
+
+    /* do equal normalized keys mean equal datums */
+    bool nkexact;
+
     /* should null sort first (low) in this level */
     bool nullfirst;
 
@@ -288,6 +321,9 @@ typedef struct MKContext {
 
     /* enforce Unique, for index build */
     bool enforceUnique;
+
+    /* Sorted by several threads: no interrupts, see mk_qsort_parallel */
+    bool parallel;
 } MKContext;
 
 /**
@@ -309,6 +345,22 @@ static inline void mk_prepare_array(MKEntry *a, int i, int j, int32 lv, struct M
 extern void tupsort_cpfr(MKEntry *dst, MKEntry *src, MKLvContext *ctxt);
 extern int tupsort_compare_datum(MKEntry *v1, MKEntry *v2, MKLvContext *ctxt, MKContext *mkContext);
 
+/**
+ * Compare two non null entries prepared for the given level: by normalized
+ *   key if the level has one, with the full comparison only on a tie of prefixes.
+ */
+static inline int mke_compare_datum(MKEntry *v1, MKEntry *v2, MKLvContext *lvctxt, MKContext *mkContext)
+{
+    if (lvctxt->nkkind != MKNK_NONE)
+    {
+        if (v1->nkey != v2->nkey)
+            return v1->nkey < v2->nkey ? -1 : 1;
+        if (lvctxt->nkexact)
+            return 0;
+    }
+    return tupsort_compare_datum(v1, v2, lvctxt, mkContext);
+}
+
 extern void create_mksort_context(
         MKContext *mkctxt,
         int nkeys, 
@@ -323,6 +375,8 @@ static inline void mk_qsort(MKEntry* a, int n, MKContext *ctxt)
 {
     mk_qsort_impl(a, 0, n-1, 0, true, ctxt, false);
 }
+extern bool mk_qsort_parallel_safe(MKContext *ctxt);
+extern void mk_qsort_parallel(MKEntry *a, int n, MKContext *ctxt, int nworkers);
 
 /* MK Heap stuff */
 typedef bool (*MKFlagPtrReader) (void *ctxt, MKEntry *e);
@@ -0,0 +1,38 @@
+-- The block locations of the segment files a query reads are looked up
+-- on datalocality_fetch_threads threads at once. Plan queries over many
+-- files with serial and concurrent lookups, with and without the
+-- metadata cache, and check they give the same results.
+set client_min_messages = warning;
+create table dl_fetch_part (id int4, k int4, v text) distributed randomly
+  partition by range (k) (start (0) end (20) every (1));
+reset client_min_messages;
+insert into dl_fetch_part select i, i % 20, 'v' || i from generate_series(1, 20000) i;
+insert into dl_fetch_part select i, i % 20, 'v' || i from generate_series(20001, 40000) i;
+create table dl_fetch_t (k int4, name text) distributed randomly;
+insert into dl_fetch_t select i, 'k' || i from generate_series(0, 19) i;
+
+set metadata_cache_enable = off;
+set datalocality_fetch_threads = 1;
+select count(*), sum(id), count(distinct k) from dl_fetch_part;
+select count(*), sum(p.id) from dl_fetch_part p join dl_fetch_t t on p.k = t.k
+  where t.name in ('k1', 'k3');
+
+set datalocality_fetch_threads = 8;
+select count(*), sum(id), count(distinct k) from dl_fetch_part;
+select count(*), sum(p.id) from dl_fetch_part p join dl_fetch_t t on p.k = t.k
+  where t.name in ('k1', 'k3');
+
+set datalocality_fetch_threads = 64;
+select count(*), sum(id), count(distinct k) from dl_fetch_part;
+select count(*), sum(p.id) from dl_fetch_part p join dl_fetch_t t on p.k = t.k
+  where t.name in ('k1', 'k3');
+
+-- the looked up locations go into the metadata cache, and are found there
+-- by the next query
+reset metadata_cache_enable;
+select count(*), sum(id), count(distinct k) from dl_fetch_part;
+select count(*), sum(id), count(distinct k) from dl_fetch_part;
+
+reset datalocality_fetch_threads;
+drop table dl_fetch_part;
+drop table dl_fetch_t;
@@ -0,0 +1,56 @@
+-- With gp_dispatch_event_driven one thread dispatches to all the executors
+-- of a query. Run queries of one and several slices, an insert, a query
+-- that fails on the segments and a statement dispatched while a cursor is
+-- open, with it on and off, and check they give the same results.
+set enforce_virtual_segment_number = 4;
+create table dispatch_ev_t1 (a int4, b int4) distributed by (a);
+create table dispatch_ev_t2 (a int4, c int4) distributed randomly;
+create table dispatch_ev_t3 (a int4, b int4) distributed randomly;
+insert into dispatch_ev_t1 select i, i * 2 from generate_series(1, 1000) i;
+insert into dispatch_ev_t2 select i, i % 5 from generate_series(1, 1000) i;
+
+set gp_dispatch_event_driven = on;
+select count(*), sum(a), sum(b) from dispatch_ev_t1;
+select t2.c, count(*), sum(t1.b)
+  from dispatch_ev_t1 t1 join dispatch_ev_t2 t2 on t1.a = t2.a
+  group by t2.c order by t2.c;
+insert into dispatch_ev_t3 select a, b from dispatch_ev_t1 where a <= 100;
+select count(*), sum(b) from dispatch_ev_t3;
+-- an error on the segments, then a query on the same gang
+select count(*) from dispatch_ev_t1 where 10 / (a - 500) > 0;
+select count(*) from dispatch_ev_t1 where a > 500;
+-- a statement dispatched while a cursor is open
+begin;
+declare dispatch_ev_c cursor for
+  select * from dispatch_ev_t1 t1 join dispatch_ev_t2 t2 on t1.a = t2.a;
+move 10 in dispatch_ev_c;
+select count(*) from dispatch_ev_t2 where c = 3;
+move 10 in dispatch_ev_c;
+close dispatch_ev_c;
+commit;
+
+set gp_dispatch_event_driven = off;
+select count(*), sum(a), sum(b) from dispatch_ev_t1;
+select t2.c, count(*), sum(t1.b)
+  from dispatch_ev_t1 t1 join dispatch_ev_t2 t2 on t1.a = t2.a
+  group by t2.c order by t2.c;
+insert into dispatch_ev_t3 select a, b from dispatch_ev_t1 where a <= 100;
+select count(*), sum(b) from dispatch_ev_t3;
+-- an error on the segments, then a query on the same gang
+select count(*) from dispatch_ev_t1 where 10 / (a - 500) > 0;
+select count(*) from dispatch_ev_t1 where a > 500;
+-- a statement dispatched while a cursor is open
+begin;
+declare dispatch_ev_c cursor for
+  select * from dispatch_ev_t1 t1 join dispatch_ev_t2 t2 on t1.a = t2.a;
+move 10 in dispatch_ev_c;
+select count(*) from dispatch_ev_t2 where c = 3;
+move 10 in dispatch_ev_c;
+close dispatch_ev_c;
+commit;
+
+reset gp_dispatch_event_driven;
+reset enforce_virtual_segment_number;
+drop table dispatch_ev_t1;
+drop table dispatch_ev_t2;
+drop table dispatch_ev_t3;
@@ -0,0 +1,31 @@
+-- Dispatch the plan once per segment host, and let the other QEs of the
+-- host get it from the shared plan cache.
+set gp_dispatch_plan_per_host = on;
+set enforce_virtual_segment_number = 4;
+
+create table dispatch_plan_t1 (a int, b text) distributed randomly;
+create table dispatch_plan_t2 (a int, c int) distributed by (a);
+
+insert into dispatch_plan_t1 select i, 'row ' || i from generate_series(1, 1000) i;
+insert into dispatch_plan_t2 select i, i % 10 from generate_series(1, 1000) i;
+
+select count(*), sum(a) from dispatch_plan_t1;
+
+-- several slices
+select t2.c, count(*)
+  from dispatch_plan_t1 t1 join dispatch_plan_t2 t2 on t1.a = t2.a
+  group by t2.c order by t2.c;
+
+insert into dispatch_plan_t2 select a, 100 from dispatch_plan_t1 where a <= 10;
+select count(*) from dispatch_plan_t2 where c = 100;
+
+-- the same statements with the plan dispatched to every QE
+set gp_dispatch_plan_per_host = off;
+select t2.c, count(*)
+  from dispatch_plan_t1 t1 join dispatch_plan_t2 t2 on t1.a = t2.a
+  group by t2.c order by t2.c;
+
+reset enforce_virtual_segment_number;
+reset gp_dispatch_plan_per_host;
+drop table dispatch_plan_t1;
+drop table dispatch_plan_t2;
@@ -0,0 +1,111 @@
+-- HashAgg compares grouping keys of common fixed-width types without
+-- calling their equality functions, and keeps up to 16 of them inline in
+-- the hash entries. Group by those types, by more keys than are kept
+-- inline, and together with other types, with nulls, and check hash and
+-- sort grouping agree, also when the hash table spills.
+create table hashagg_keys (id int4, b bool, c "char", s int2, n int4, o oid, d date, l int8,
+                           t time, ts timestamp, f float8, x text)
+  distributed randomly;
+insert into hashagg_keys
+  select i,
+         case when i % 13 = 0 then null else i % 2 = 0 end,
+         case when i % 17 = 0 then null else chr(65 + i % 3)::"char" end,
+         case when i % 19 = 0 then null else (i % 100)::int2 end,
+         case when i % 23 = 0 then null else i % 600 end,
+         (i % 50)::oid,
+         date '2000-01-01' + i % 30,
+         (i % 40)::int8 * 1000000007,
+         time '00:00' + (i % 12) * interval '1 minute',
+         timestamp '2000-01-01' + (i % 20) * interval '1 day',
+         (i % 7) / 2.0,
+         'x' || (i % 11)
+  from generate_series(1, 50000) i;
+
+set enable_groupagg = off;
+select * from (
+  select 'a bool, "char"' as q, count(*) as groups, sum(cnt * cnt) as cnt2, sum(sid * sid) as sid2
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c) g
+  union all select 'b int2, int4, oid', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by s, n, o) g
+  union all select 'c date, int8, time, timestamp', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by d, l, t, ts) g
+  union all select 'd nine keys', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c, s, n, o, d, l, t, ts) g
+  union all select 'e int4 and text', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by n, x) g
+  union all select 'f float8 and int2', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by f, s) g
+  union all select 'g seventeen keys', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c, s, n, o, d, l, t, ts, n + 1, n + 2, n + 3, n + 4, n + 5, n + 6, n + 7, n + 8) g
+  union all select 'h int4, many groups', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by id / 2, (id / 2) % 7) g
+) r order by q;
+
+set statement_mem = 2560;
+select * from (
+  select 'a bool, "char"' as q, count(*) as groups, sum(cnt * cnt) as cnt2, sum(sid * sid) as sid2
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c) g
+  union all select 'b int2, int4, oid', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by s, n, o) g
+  union all select 'c date, int8, time, timestamp', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by d, l, t, ts) g
+  union all select 'd nine keys', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c, s, n, o, d, l, t, ts) g
+  union all select 'e int4 and text', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by n, x) g
+  union all select 'f float8 and int2', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by f, s) g
+  union all select 'g seventeen keys', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c, s, n, o, d, l, t, ts, n + 1, n + 2, n + 3, n + 4, n + 5, n + 6, n + 7, n + 8) g
+  union all select 'h int4, many groups', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by id / 2, (id / 2) % 7) g
+) r order by q;
+
+reset statement_mem;
+reset enable_groupagg;
+set enable_hashagg = off;
+select * from (
+  select 'a bool, "char"' as q, count(*) as groups, sum(cnt * cnt) as cnt2, sum(sid * sid) as sid2
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c) g
+  union all select 'b int2, int4, oid', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by s, n, o) g
+  union all select 'c date, int8, time, timestamp', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by d, l, t, ts) g
+  union all select 'd nine keys', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c, s, n, o, d, l, t, ts) g
+  union all select 'e int4 and text', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by n, x) g
+  union all select 'f float8 and int2', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by f, s) g
+  union all select 'g seventeen keys', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by b, c, s, n, o, d, l, t, ts, n + 1, n + 2, n + 3, n + 4, n + 5, n + 6, n + 7, n + 8) g
+  union all select 'h int4, many groups', count(*), sum(cnt * cnt), sum(sid * sid)
+    from (select count(*) as cnt, sum(id)::numeric as sid from hashagg_keys
+          group by id / 2, (id / 2) % 7) g
+) r order by q;
+
+reset enable_hashagg;
+drop table hashagg_keys;
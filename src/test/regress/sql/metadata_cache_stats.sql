@@ -0,0 +1,23 @@
+-- The metadata cache keeps the hdfs block locations of the files queries
+-- read, and counts the lookups of each relation.
+set metadata_cache_enable = on;
+select gp_metadata_cache_stats_reset() like 'Metadata cache statistics reset % items' as reset;
+
+create table metadata_cache_t (a int, b text) distributed randomly;
+insert into metadata_cache_t select i, 'row ' || i from generate_series(1, 1000) i;
+
+-- the first scan fetches the block locations, the second finds them cached
+select count(*) from metadata_cache_t;
+select count(*) from metadata_cache_t;
+select relname, cached_files > 0 as cached, cached_blocks > 0 as blocks,
+       misses > 0 as missed, hits > 0 as hit, hit_ratio > 0 and hit_ratio < 1 as ratio,
+       evictions, lookup_time >= 0 as lookup
+  from gp_metadata_cache_stats where relname = 'metadata_cache_t';
+
+-- a reset drops the counters, the cached files are still there
+select gp_metadata_cache_stats_reset() like 'Metadata cache statistics reset % items' as reset;
+select relname, cached_files > 0 as cached, hits, partial_hits, misses, hit_ratio
+  from gp_metadata_cache_stats where relname = 'metadata_cache_t';
+
+drop table metadata_cache_t;
+reset metadata_cache_enable;
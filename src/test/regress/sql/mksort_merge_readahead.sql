@@ -0,0 +1,45 @@
+-- gp_mk_sort_merge_readahead reads the runs an mk sort merges ahead in
+-- large blocks, and merges fewer of them per pass. Sort more than fits in
+-- memory with read-ahead off, small, and larger than the memory of a run,
+-- and check the output is in order.
+create table mksort_merge (k int4, t text, pad text) distributed randomly;
+insert into mksort_merge
+  select i * 7919 % 200003, lpad((i * 7919 % 200003)::text, 8, '0'), repeat('x', 100)
+  from generate_series(1, 200000) i;
+set gp_enable_mk_sort = on;
+set statement_mem = 2560;
+
+set gp_mk_sort_merge_readahead = 0;
+select rn, k from (select k, row_number() over (order by k) as rn from mksort_merge) s
+  where rn between 100001 and 100005 order by rn;
+select rn, t from (select t, row_number() over (order by t desc) as rn from mksort_merge) s
+  where rn between 150001 and 150003 order by rn;
+select count(*) as nrows, sum(case when prev > k then 1 else 0 end) as unordered
+  from (select k, lag(k) over (order by k) as prev from mksort_merge) s;
+select count(*) as nrows, sum(case when prev < t then 1 else 0 end) as unordered
+  from (select t, lag(t) over (order by t desc) as prev from mksort_merge) s;
+
+set gp_mk_sort_merge_readahead = 64;
+select rn, k from (select k, row_number() over (order by k) as rn from mksort_merge) s
+  where rn between 100001 and 100005 order by rn;
+select rn, t from (select t, row_number() over (order by t desc) as rn from mksort_merge) s
+  where rn between 150001 and 150003 order by rn;
+select count(*) as nrows, sum(case when prev > k then 1 else 0 end) as unordered
+  from (select k, lag(k) over (order by k) as prev from mksort_merge) s;
+select count(*) as nrows, sum(case when prev < t then 1 else 0 end) as unordered
+  from (select t, lag(t) over (order by t desc) as prev from mksort_merge) s;
+
+set gp_mk_sort_merge_readahead = 65536;
+select rn, k from (select k, row_number() over (order by k) as rn from mksort_merge) s
+  where rn between 100001 and 100005 order by rn;
+select rn, t from (select t, row_number() over (order by t desc) as rn from mksort_merge) s
+  where rn between 150001 and 150003 order by rn;
+select count(*) as nrows, sum(case when prev > k then 1 else 0 end) as unordered
+  from (select k, lag(k) over (order by k) as prev from mksort_merge) s;
+select count(*) as nrows, sum(case when prev < t then 1 else 0 end) as unordered
+  from (select t, lag(t) over (order by t desc) as prev from mksort_merge) s;
+
+reset gp_mk_sort_merge_readahead;
+reset statement_mem;
+reset gp_enable_mk_sort;
+drop table mksort_merge;
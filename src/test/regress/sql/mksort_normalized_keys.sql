@@ -0,0 +1,99 @@
+-- mk sort compares prepared entries by a normalized key of their first
+-- bytes before calling the comparison function. Sort values that tie on
+-- those keys, extremes, NaN, -0, nulls and blank padding, ascending and
+-- descending, and check the order is the one the comparison functions
+-- give, with mk sort on and off.
+create table mksort_keys_small (id int4, i8 int8, f8 float8, num numeric, txt text, bp char(6))
+  distributed randomly;
+insert into mksort_keys_small values
+  (1, 9223372036854775807, 'NaN'::float8, 1.000000000002, 'abcdefgh1', 'ab'),
+  (2, -9223372036854775808, '-Infinity', -1.000000000001, 'abcdefgh', 'ab '),
+  (3, 0, '-0', 1.000000000001, 'abcdefgh0', 'abc'),
+  (4, -1, 0, 0, '', 'a'),
+  (5, 1, 1.5, -0.0001, 'abcdefg', 'abcdef'),
+  (6, null, 1e-300, 10000.5, 'b', 'abcde'),
+  (7, 42, null, null, null, null),
+  (8, -42, 'Infinity', 9999.99999999, 'abcdefgha', 'b'),
+  (9, 42, -1.5, 1.000000000002, 'abcdefgh', 'ab');
+create table mksort_keys (i4 int4, i8 int8, f8 float8, num numeric, txt text, bp char(12),
+                          d date, ts timestamp)
+  distributed randomly;
+insert into mksort_keys
+  select k - 10000,
+         (k - 10000)::int8 * 1000000007,
+         (k - 10000) / 7.0,
+         1000000 + k / 1e12,
+         case when i % 3 = 0 then 'prefix' || lpad((k % 1000)::text, 6, '0') else md5(k::text) end,
+         lpad(k::text, 12 - i % 5, '0'),
+         date '2000-01-01' + k,
+         timestamp '2000-01-01' + k * interval '1 minute'
+  from (select i, i * 7919 % 20011 as k from generate_series(1, 20000) i) x;
+insert into mksort_keys (i4) values (null);
+
+set gp_enable_mk_sort = on;
+select id, i8 from mksort_keys_small order by i8, id;
+select id, i8 from mksort_keys_small order by i8 desc, id;
+select id, f8 from mksort_keys_small order by f8, id;
+select id, f8 from mksort_keys_small order by f8 desc, id;
+select id, num from mksort_keys_small order by num, id;
+select id, num from mksort_keys_small order by num desc, id;
+select id, txt from mksort_keys_small order by txt, id;
+select id, txt from mksort_keys_small order by txt desc, id;
+select id, bp from mksort_keys_small order by bp, id;
+select id, bp from mksort_keys_small order by bp desc, id;
+
+select count(*) from (select i4, lag(i4) over (order by i4) as prev from mksort_keys) s where prev > i4;
+select count(*) from (select i4, lag(i4) over (order by i4 desc) as prev from mksort_keys) s where prev < i4;
+select count(*) from (select i8, lag(i8) over (order by i8) as prev from mksort_keys) s where prev > i8;
+select count(*) from (select i8, lag(i8) over (order by i8 desc) as prev from mksort_keys) s where prev < i8;
+select count(*) from (select f8, lag(f8) over (order by f8) as prev from mksort_keys) s where prev > f8;
+select count(*) from (select f8, lag(f8) over (order by f8 desc) as prev from mksort_keys) s where prev < f8;
+select count(*) from (select num, lag(num) over (order by num) as prev from mksort_keys) s where prev > num;
+select count(*) from (select num, lag(num) over (order by num desc) as prev from mksort_keys) s where prev < num;
+select count(*) from (select txt, lag(txt) over (order by txt) as prev from mksort_keys) s where prev > txt;
+select count(*) from (select txt, lag(txt) over (order by txt desc) as prev from mksort_keys) s where prev < txt;
+select count(*) from (select bp, lag(bp) over (order by bp) as prev from mksort_keys) s where prev > bp;
+select count(*) from (select bp, lag(bp) over (order by bp desc) as prev from mksort_keys) s where prev < bp;
+select count(*) from (select d, lag(d) over (order by d) as prev from mksort_keys) s where prev > d;
+select count(*) from (select d, lag(d) over (order by d desc) as prev from mksort_keys) s where prev < d;
+select count(*) from (select ts, lag(ts) over (order by ts) as prev from mksort_keys) s where prev > ts;
+select count(*) from (select ts, lag(ts) over (order by ts desc) as prev from mksort_keys) s where prev < ts;
+select count(*) from (select txt, i4, lag(txt) over (order by txt, i4 desc) as ptxt,
+                             lag(i4) over (order by txt, i4 desc) as pi4 from mksort_keys) s
+  where ptxt > txt or (ptxt = txt and pi4 < i4);
+
+set gp_enable_mk_sort = off;
+select id, i8 from mksort_keys_small order by i8, id;
+select id, i8 from mksort_keys_small order by i8 desc, id;
+select id, f8 from mksort_keys_small order by f8, id;
+select id, f8 from mksort_keys_small order by f8 desc, id;
+select id, num from mksort_keys_small order by num, id;
+select id, num from mksort_keys_small order by num desc, id;
+select id, txt from mksort_keys_small order by txt, id;
+select id, txt from mksort_keys_small order by txt desc, id;
+select id, bp from mksort_keys_small order by bp, id;
+select id, bp from mksort_keys_small order by bp desc, id;
+
+select count(*) from (select i4, lag(i4) over (order by i4) as prev from mksort_keys) s where prev > i4;
+select count(*) from (select i4, lag(i4) over (order by i4 desc) as prev from mksort_keys) s where prev < i4;
+select count(*) from (select i8, lag(i8) over (order by i8) as prev from mksort_keys) s where prev > i8;
+select count(*) from (select i8, lag(i8) over (order by i8 desc) as prev from mksort_keys) s where prev < i8;
+select count(*) from (select f8, lag(f8) over (order by f8) as prev from mksort_keys) s where prev > f8;
+select count(*) from (select f8, lag(f8) over (order by f8 desc) as prev from mksort_keys) s where prev < f8;
+select count(*) from (select num, lag(num) over (order by num) as prev from mksort_keys) s where prev > num;
+select count(*) from (select num, lag(num) over (order by num desc) as prev from mksort_keys) s where prev < num;
+select count(*) from (select txt, lag(txt) over (order by txt) as prev from mksort_keys) s where prev > txt;
+select count(*) from (select txt, lag(txt) over (order by txt desc) as prev from mksort_keys) s where prev < txt;
+select count(*) from (select bp, lag(bp) over (order by bp) as prev from mksort_keys) s where prev > bp;
+select count(*) from (select bp, lag(bp) over (order by bp desc) as prev from mksort_keys) s where prev < bp;
+select count(*) from (select d, lag(d) over (order by d) as prev from mksort_keys) s where prev > d;
+select count(*) from (select d, lag(d) over (order by d desc) as prev from mksort_keys) s where prev < d;
+select count(*) from (select ts, lag(ts) over (order by ts) as prev from mksort_keys) s where prev > ts;
+select count(*) from (select ts, lag(ts) over (order by ts desc) as prev from mksort_keys) s where prev < ts;
+select count(*) from (select txt, i4, lag(txt) over (order by txt, i4 desc) as ptxt,
+                             lag(i4) over (order by txt, i4 desc) as pi4 from mksort_keys) s
+  where ptxt > txt or (ptxt = txt and pi4 < i4);
+
+reset gp_enable_mk_sort;
+drop table mksort_keys_small;
+drop table mksort_keys;
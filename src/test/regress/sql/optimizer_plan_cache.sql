@@ -0,0 +1,46 @@
+-- Reuse optimizer plans of repeated queries, and stop reusing them when an
+-- object they reference changes.
+create table plan_cache_t (a int, b int) distributed by (a);
+insert into plan_cache_t select i, i % 10 from generate_series(1, 100) i;
+
+create function plan_cache_f(int) returns int as $$
+begin
+	return $1 + 1;
+end;
+$$ language plpgsql volatile;
+
+set optimizer = on;
+set gp_metadata_versioning = on;
+set optimizer_plan_cache_size = 10;
+select gp_opt_plan_cache_clear();
+
+-- the first run fills the cache, the second one uses it
+select count(*) from plan_cache_t where b < plan_cache_f(4);
+select count(*) from plan_cache_t where b < plan_cache_f(4);
+select gp_opt_plan_cache_stats();
+
+-- a redefined function gets a new version, the cached plan is not used
+create or replace function plan_cache_f(int) returns int as $$
+begin
+	return $1 + 2;
+end;
+$$ language plpgsql volatile;
+
+select count(*) from plan_cache_t where b < plan_cache_f(4);
+select gp_opt_plan_cache_stats();
+
+-- and the new plan is cached in turn
+select count(*) from plan_cache_t where b < plan_cache_f(4);
+select gp_opt_plan_cache_stats();
+
+-- plans are not cached while the cache is off
+set optimizer_plan_cache_size = 0;
+select count(*) from plan_cache_t where b < plan_cache_f(4);
+select gp_opt_plan_cache_clear();
+select gp_opt_plan_cache_stats();
+
+reset optimizer_plan_cache_size;
+reset gp_metadata_versioning;
+reset optimizer;
+drop function plan_cache_f(int);
+drop table plan_cache_t;
@@ -0,0 +1,67 @@
+-- Bound the optimizer's join order search by optimizer_search_time_budget.
+set optimizer = on;
+set optimizer_explain_show_status = on;
+
+create table search_budget_t1 (a int, b int) distributed by (a);
+create table search_budget_t2 (a int, b int) distributed by (a);
+create table search_budget_t3 (a int, b int) distributed by (a);
+create table search_budget_t4 (a int, b int) distributed by (a);
+create table search_budget_t5 (a int, b int) distributed by (a);
+
+insert into search_budget_t1 select i, i % 7 from generate_series(1, 100) i;
+insert into search_budget_t2 select i, i % 5 from generate_series(1, 100) i;
+insert into search_budget_t3 select i, i % 3 from generate_series(1, 100) i;
+insert into search_budget_t4 select i, i % 2 from generate_series(1, 100) i;
+insert into search_budget_t5 select i, i % 11 from generate_series(1, 100) i;
+
+-- the search stage line of the EXPLAIN output, if any
+create function search_budget_stages(query text) returns text as $$
+declare
+	r record;
+begin
+	for r in execute 'explain ' || query loop
+		if r."QUERY PLAN" like 'Optimizer search:%' then
+			return r."QUERY PLAN";
+		end if;
+	end loop;
+	return null;
+end;
+$$ language plpgsql;
+
+-- no budget, no search stages
+select search_budget_stages('select count(*) from search_budget_t1 t1, search_budget_t2 t2 where t1.a = t2.a');
+
+-- a budget that is never used up
+set optimizer_search_time_budget = 3600000;
+select search_budget_stages('select count(*) from search_budget_t1 t1, search_budget_t2 t2 where t1.a = t2.a');
+
+-- a tiny budget still gives a plan, how many stages complete depends on
+-- the speed of the machine
+set optimizer_search_time_budget = 1;
+select regexp_replace(search_budget_stages('
+select count(*)
+  from search_budget_t1 t1, search_budget_t2 t2, search_budget_t3 t3,
+       search_budget_t4 t4, search_budget_t5 t5
+ where t1.a = t2.a and t2.b = t3.a and t3.b = t4.a and t4.b = t5.a and t5.b = t1.b'),
+	'[0-9]+ of', '# of');
+
+select count(*), sum(t1.a + t5.a)
+  from search_budget_t1 t1, search_budget_t2 t2, search_budget_t3 t3,
+       search_budget_t4 t4, search_budget_t5 t5
+ where t1.a = t2.a and t2.b = t3.a and t3.b = t4.a and t4.b = t5.a and t5.b = t1.b;
+
+-- the same result without a budget
+reset optimizer_search_time_budget;
+select count(*), sum(t1.a + t5.a)
+  from search_budget_t1 t1, search_budget_t2 t2, search_budget_t3 t3,
+       search_budget_t4 t4, search_budget_t5 t5
+ where t1.a = t2.a and t2.b = t3.a and t3.b = t4.a and t4.b = t5.a and t5.b = t1.b;
+
+drop function search_budget_stages(text);
+drop table search_budget_t1;
+drop table search_budget_t2;
+drop table search_budget_t3;
+drop table search_budget_t4;
+drop table search_budget_t5;
+reset optimizer_explain_show_status;
+reset optimizer;
@@ -0,0 +1,41 @@
+-- Fixed-width parquet columns are decoded a batch of rows at a time, and
+-- other columns a value at a time. Read every batch-decoded type, with
+-- and without nulls, over more rows than fit in a whole number of
+-- batches, and check they read back as written.
+create table parquet_batch_src (id int4, b bool, s int2, l int8, r float4, f float8,
+                                d date, t time, ts timestamp, tz timestamptz, txt text, nn int4)
+  distributed randomly;
+insert into parquet_batch_src
+  select i,
+         case when i % 3 = 0 then null else i % 2 = 0 end,
+         case when i % 5 = 0 then null else (i % 30000)::int2 end,
+         case when i % 7 = 0 then null else i::int8 * 1000000007 end,
+         case when i % 11 = 0 then null else (i / 8.0)::float4 end,
+         case when i % 13 = 0 then null else i * 0.5 end,
+         case when i % 17 = 0 then null else date '2000-01-01' + i end,
+         case when i % 19 = 0 then null else time '00:00:00' + i * interval '1 second' end,
+         case when i % 23 = 0 then null else timestamp '2000-01-01' + i * interval '1 hour' end,
+         case when i % 29 = 0 then null else timestamptz '2000-01-01 00:00:00+00' + i * interval '1 minute' end,
+         case when i % 31 = 0 then null else 'text ' || i end,
+         i
+  from generate_series(1, 10007) i;
+
+create table parquet_batch (like parquet_batch_src)
+  with (appendonly=true, orientation=parquet) distributed randomly;
+insert into parquet_batch select * from parquet_batch_src;
+
+select count(*), count(b), sum(s), sum(l), count(r), count(f), count(d), count(t),
+       count(ts), count(tz), count(txt), sum(nn)
+  from parquet_batch;
+select count(*) from (select * from parquet_batch_src except all select * from parquet_batch) x;
+select count(*) from (select * from parquet_batch except all select * from parquet_batch_src) x;
+
+-- only some of the columns projected
+select count(*) from (select l, txt, tz from parquet_batch_src
+                      except all select l, txt, tz from parquet_batch) x;
+select count(*) from (select b, r, nn from parquet_batch
+                      except all select b, r, nn from parquet_batch_src) x;
+select count(*), sum(l), sum(s) from parquet_batch where nn % 100 = 1 and f is not null;
+
+drop table parquet_batch_src;
+drop table parquet_batch;
@@ -0,0 +1,57 @@
+-- Text-like parquet columns are dictionary encoded on insert, and fall
+-- back to plain encoding when the dictionary outgrows the page size. Data
+-- written with and without dictionaries must read back the same.
+create table parquet_dict_src (id int4, low text, mid varchar(20), c char(6), b bytea, high text, nul text)
+  distributed randomly;
+insert into parquet_dict_src
+  select i,
+         case when i % 7 = 0 then null when i % 11 = 0 then '' else 'v' || (i % 5) end,
+         'mid' || (i % 300),
+         (i % 4)::text,
+         decode(to_hex(i % 16 + 16), 'hex'),
+         md5(i::text),
+         null
+  from generate_series(1, 5000) i;
+
+set gp_parquet_dictionary_encoding = on;
+create table parquet_dict_on (like parquet_dict_src)
+  with (appendonly=true, orientation=parquet, pagesize=4096, rowgroupsize=65536)
+  distributed randomly;
+insert into parquet_dict_on select * from parquet_dict_src;
+create table parquet_dict_snappy (like parquet_dict_src)
+  with (appendonly=true, orientation=parquet, compresstype=snappy, pagesize=4096, rowgroupsize=65536)
+  distributed randomly;
+insert into parquet_dict_snappy select * from parquet_dict_src;
+
+set gp_parquet_dictionary_encoding = off;
+create table parquet_dict_off (like parquet_dict_src)
+  with (appendonly=true, orientation=parquet, pagesize=4096, rowgroupsize=65536)
+  distributed randomly;
+insert into parquet_dict_off select * from parquet_dict_src;
+
+reset gp_parquet_dictionary_encoding;
+select count(*), count(low), count(distinct low), count(distinct mid), count(distinct c),
+       count(distinct b), count(distinct high), count(nul)
+  from parquet_dict_on;
+select count(*), count(low), count(distinct low), count(distinct mid), count(distinct c),
+       count(distinct b), count(distinct high), count(nul)
+  from parquet_dict_snappy;
+select count(*), count(low), count(distinct low), count(distinct mid), count(distinct c),
+       count(distinct b), count(distinct high), count(nul)
+  from parquet_dict_off;
+
+select count(*) from (select * from parquet_dict_src except all select * from parquet_dict_on) d;
+select count(*) from (select * from parquet_dict_on except all select * from parquet_dict_src) d;
+select count(*) from (select * from parquet_dict_src except all select * from parquet_dict_snappy) d;
+select count(*) from (select * from parquet_dict_snappy except all select * from parquet_dict_src) d;
+select count(*) from (select * from parquet_dict_on except all select * from parquet_dict_off) d;
+select count(*) from (select * from parquet_dict_off except all select * from parquet_dict_on) d;
+
+-- projections and quals on dictionary encoded columns
+select low, count(*) from parquet_dict_on where mid = 'mid7' group by low order by low;
+select low, count(*) from parquet_dict_off where mid = 'mid7' group by low order by low;
+
+drop table parquet_dict_src;
+drop table parquet_dict_on;
+drop table parquet_dict_snappy;
+drop table parquet_dict_off;
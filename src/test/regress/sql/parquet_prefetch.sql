@@ -0,0 +1,48 @@
+-- Parquet scans read column chunks ahead in background threads, within
+-- gp_parquet_prefetch_memory. Scan with read-ahead off, with too little
+-- memory for every column, and with the default, and stop scans early
+-- and abort them while reads are in flight.
+create table parquet_prefetch_src (id int4, l int8, f float8, s text, w text) distributed randomly;
+insert into parquet_prefetch_src
+  select i, i * 7, case when i % 10 = 0 then null else i / 4.0 end,
+         'row ' || i, repeat(md5(i::text), i % 50)
+  from generate_series(1, 20000) i;
+create table parquet_prefetch (like parquet_prefetch_src)
+  with (appendonly=true, orientation=parquet, pagesize=65536, rowgroupsize=1048576)
+  distributed randomly;
+insert into parquet_prefetch select * from parquet_prefetch_src;
+
+set gp_parquet_prefetch_memory = 0;
+select count(*), sum(id), sum(l), count(f), sum(length(w)) from parquet_prefetch;
+select count(*) from (select * from parquet_prefetch_src except all select * from parquet_prefetch) x;
+
+set gp_parquet_prefetch_memory = 64;
+select count(*), sum(id), sum(l), count(f), sum(length(w)) from parquet_prefetch;
+select count(*) from (select * from parquet_prefetch_src except all select * from parquet_prefetch) x;
+
+reset gp_parquet_prefetch_memory;
+select count(*), sum(id), sum(l), count(f), sum(length(w)) from parquet_prefetch;
+select count(*) from (select * from parquet_prefetch_src except all select * from parquet_prefetch) x;
+select count(*) from (select * from parquet_prefetch except all select * from parquet_prefetch_src) x;
+
+-- scans that end early or are aborted
+select count(*) from (select * from parquet_prefetch limit 10) x;
+begin;
+declare parquet_prefetch_c cursor for select * from parquet_prefetch;
+move 100 in parquet_prefetch_c;
+rollback;
+begin;
+savepoint s1;
+declare parquet_prefetch_c cursor for select * from parquet_prefetch;
+move 100 in parquet_prefetch_c;
+rollback to savepoint s1;
+select count(*), sum(id) from parquet_prefetch;
+commit;
+begin;
+declare parquet_prefetch_c cursor for select * from parquet_prefetch;
+move 100 in parquet_prefetch_c;
+commit;
+select count(*), sum(id), sum(l), count(f), sum(length(w)) from parquet_prefetch;
+
+drop table parquet_prefetch_src;
+drop table parquet_prefetch;
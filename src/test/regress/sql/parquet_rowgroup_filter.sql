@@ -0,0 +1,48 @@
+-- Row groups whose column statistics show that no row can satisfy the
+-- quals of a parquet scan are skipped. Small row groups of ascending
+-- values, so that most are skipped, must give the same results as
+-- scanning them all.
+create table parquet_rgf (id int4, v int8, f float8, d date, n int4)
+  with (appendonly=true, orientation=parquet, pagesize=1024, rowgroupsize=8192)
+  distributed randomly;
+insert into parquet_rgf
+  select i, i * 10, (i / 1000.0)::float8, date '2000-01-01' + i,
+         case when i <= 3000 then null else i end
+  from generate_series(1, 10000) i;
+
+set gp_parquet_rowgroup_filter = on;
+select q, count(*), sum(id) from (
+  select 'a lt' as q, id from parquet_rgf where id < 100
+  union all select 'b ge', id from parquet_rgf where id >= 9901
+  union all select 'c eq', id from parquet_rgf where id = 5000
+  union all select 'd commuted', id from parquet_rgf where 5000 > id and 4990 <= id
+  union all select 'e int8 and int4', id from parquet_rgf where v > 99950
+  union all select 'f float8', id from parquet_rgf where f <= 1.5
+  union all select 'g date', id from parquet_rgf where d = date '2000-01-11'
+  union all select 'h is null', id from parquet_rgf where n is null and id > 2990
+  union all select 'i is not null', id from parquet_rgf where n is not null and id < 3010
+  union all select 'j or', id from parquet_rgf where id < 10 or id > 9990
+  union all select 'k ne', id from parquet_rgf where id <> 5 and id < 20
+  union all select 'l none', id from parquet_rgf where id = -1 or id < null::int4
+  union all select 'm null n', id from parquet_rgf where n < 3005
+) s group by q order by q;
+
+set gp_parquet_rowgroup_filter = off;
+select q, count(*), sum(id) from (
+  select 'a lt' as q, id from parquet_rgf where id < 100
+  union all select 'b ge', id from parquet_rgf where id >= 9901
+  union all select 'c eq', id from parquet_rgf where id = 5000
+  union all select 'd commuted', id from parquet_rgf where 5000 > id and 4990 <= id
+  union all select 'e int8 and int4', id from parquet_rgf where v > 99950
+  union all select 'f float8', id from parquet_rgf where f <= 1.5
+  union all select 'g date', id from parquet_rgf where d = date '2000-01-11'
+  union all select 'h is null', id from parquet_rgf where n is null and id > 2990
+  union all select 'i is not null', id from parquet_rgf where n is not null and id < 3010
+  union all select 'j or', id from parquet_rgf where id < 10 or id > 9990
+  union all select 'k ne', id from parquet_rgf where id <> 5 and id < 20
+  union all select 'l none', id from parquet_rgf where id = -1 or id < null::int4
+  union all select 'm null n', id from parquet_rgf where n < 3005
+) s group by q order by q;
+
+reset gp_parquet_rowgroup_filter;
+drop table parquet_rgf;
@@ -0,0 +1,49 @@
+-- Parquet scans read the pages of a column through a window of
+-- gp_parquet_scan_buffer_size, which grows for pages larger than it.
+-- Columns of repeated values, like polygons, are still read whole. Scan
+-- with the smallest window and with the default one, over pages smaller
+-- and larger than the window, compressed and not.
+create table parquet_window_src (id int4, s text, w text, l int8, p polygon) distributed randomly;
+insert into parquet_window_src
+  select i,
+         case when i % 9 = 0 then null else 'short ' || i end,
+         case when i % 500 = 0 then repeat('x', 300000) || i
+              when i % 7 = 0 then null
+              else repeat(md5(i::text), i % 20) end,
+         i * 3,
+         case when i % 4 = 0 then null
+              else polygon(box(point(0, 0), point(i, 1))) end
+  from generate_series(1, 3000) i;
+
+create table parquet_window (like parquet_window_src)
+  with (appendonly=true, orientation=parquet, pagesize=65536) distributed randomly;
+insert into parquet_window select * from parquet_window_src;
+create table parquet_window_snappy (like parquet_window_src)
+  with (appendonly=true, orientation=parquet, compresstype=snappy) distributed randomly;
+insert into parquet_window_snappy select * from parquet_window_src;
+
+set gp_parquet_scan_buffer_size = 64;
+select count(*), count(s), count(w), sum(length(w)), sum(l), count(p), sum(area(p))
+  from parquet_window;
+select count(*), count(s), count(w), sum(length(w)), sum(l), count(p), sum(area(p))
+  from parquet_window_snappy;
+select count(*) from (select id, s, w, l, area(p) from parquet_window_src
+                      except all select id, s, w, l, area(p) from parquet_window) x;
+select count(*) from (select id, s, w, l, area(p) from parquet_window_snappy
+                      except all select id, s, w, l, area(p) from parquet_window_src) x;
+select id, length(w) from parquet_window where length(w) > 100000 order by id;
+
+reset gp_parquet_scan_buffer_size;
+select count(*), count(s), count(w), sum(length(w)), sum(l), count(p), sum(area(p))
+  from parquet_window;
+select count(*), count(s), count(w), sum(length(w)), sum(l), count(p), sum(area(p))
+  from parquet_window_snappy;
+select count(*) from (select id, s, w, l, area(p) from parquet_window_src
+                      except all select id, s, w, l, area(p) from parquet_window) x;
+select count(*) from (select id, s, w, l, area(p) from parquet_window_snappy
+                      except all select id, s, w, l, area(p) from parquet_window_src) x;
+select id, length(w) from parquet_window where length(w) > 100000 order by id;
+
+drop table parquet_window_src;
+drop table parquet_window;
+drop table parquet_window_snappy;